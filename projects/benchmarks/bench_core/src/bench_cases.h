@@ -0,0 +1,27 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_BENCH_BENCH_CASES_H_INCLUDED
+#define SCM_BENCH_BENCH_CASES_H_INCLUDED
+
+#include <string>
+
+namespace scm {
+namespace bench {
+
+class benchmark_registry;
+
+void register_math_benchmarks(benchmark_registry& r);
+void register_primitive_benchmarks(benchmark_registry& r);
+void register_render_benchmarks(benchmark_registry& r);
+void register_imaging_benchmarks(benchmark_registry& r);
+void register_volume_benchmarks(benchmark_registry& r, const std::string& data_dir);
+void register_wavefront_obj_benchmarks(benchmark_registry& r, const std::string& data_dir);
+void register_byte_swap_benchmarks(benchmark_registry& r);
+void register_log_benchmarks(benchmark_registry& r);
+
+} // namespace bench
+} // namespace scm
+
+#endif // SCM_BENCH_BENCH_CASES_H_INCLUDED
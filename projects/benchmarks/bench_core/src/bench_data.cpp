@@ -0,0 +1,279 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include "bench_cases.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int.hpp>
+#include <boost/random/variate_generator.hpp>
+
+#include <scm/core/math.h>
+#include <scm/core/memory.h>
+
+#include <scm/gl_core/data_formats.h>
+
+#include <scm/gl_util/data/imaging/texture_data_util.h>
+#include <scm/gl_util/data/volume/volume_reader_raw.h>
+#include <scm/gl_core/primitives/ray.h>
+
+#include <scm/gl_util/primitives/triangle_bvh.h>
+#include <scm/gl_util/primitives/util/wavefront_obj_file.h>
+#include <scm/gl_util/primitives/util/wavefront_obj_loader.h>
+#include <scm/gl_util/primitives/util/wavefront_obj_to_vertex_array.h>
+
+#include "benchmark.h"
+
+namespace {
+
+// synthetic input data ///////////////////////////////////////////////////////////////////////////
+void
+fill_random(std::vector<scm::uint8>& d)
+{
+    boost::mt19937                      rand_gen(5489u);
+    boost::uniform_int<>                rand_dist(0, 255);
+    boost::variate_generator<boost::mt19937&, boost::uniform_int<> > die(rand_gen, rand_dist);
+
+    for (std::vector<scm::uint8>::iterator v = d.begin(); v != d.end(); ++v) {
+        *v = static_cast<scm::uint8>(die());
+    }
+}
+
+// removes the generated files with the last reference to the fixture data
+struct temporary_file
+{
+    explicit temporary_file(const std::string& p) : _path(p) {}
+    ~temporary_file() { std::remove(_path.c_str()); }
+
+    std::string                 _path;
+}; // struct temporary_file
+
+typedef scm::shared_ptr<temporary_file> temporary_file_ptr;
+
+temporary_file_ptr
+write_raw_volume(const std::string& data_dir, const scm::math::vec3ui& dim)
+{
+    std::ostringstream  fname;
+    fname << "scm_bench_volume_" << dim.x << "x" << dim.y << "x" << dim.z << ".raw";
+
+    temporary_file_ptr  f = scm::make_shared<temporary_file>((boost::filesystem::path(data_dir) / fname.str()).string());
+
+    std::vector<scm::uint8> d(static_cast<scm::size_t>(dim.x) * dim.y * dim.z);
+    fill_random(d);
+
+    std::ofstream out(f->_path.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+    out.write(reinterpret_cast<const char*>(&d.front()), static_cast<std::streamsize>(d.size()));
+    if (!out) {
+        throw std::runtime_error("write_raw_volume(): unable to write synthetic volume: " + f->_path);
+    }
+
+    return f;
+}
+
+temporary_file_ptr
+write_grid_obj(const std::string& data_dir, unsigned grid_size)
+{
+    std::ostringstream  fname;
+    fname << "scm_bench_grid_" << grid_size << ".obj";
+
+    temporary_file_ptr  f = scm::make_shared<temporary_file>((boost::filesystem::path(data_dir) / fname.str()).string());
+
+    std::ofstream out(f->_path.c_str(), std::ios_base::out | std::ios_base::trunc);
+
+    const unsigned  vcount = grid_size + 1;
+    const float     vscale = 1.0f / static_cast<float>(grid_size);
+
+    out << "o grid" << std::endl;
+    for (unsigned y = 0; y < vcount; ++y) {
+        for (unsigned x = 0; x < vcount; ++x) {
+            out << "v " << x * vscale << " " << 0.1f * ((x * y) % 7) * vscale << " " << y * vscale << "\n";
+        }
+    }
+    for (unsigned y = 0; y < vcount; ++y) {
+        for (unsigned x = 0; x < vcount; ++x) {
+            out << "vt " << x * vscale << " " << y * vscale << "\n";
+        }
+    }
+    out << "vn 0 1 0" << "\n";
+    for (unsigned y = 0; y < grid_size; ++y) {
+        for (unsigned x = 0; x < grid_size; ++x) {
+            const unsigned i0 = y * vcount + x + 1; // obj indices start at 1
+            const unsigned i1 = i0 + 1;
+            const unsigned i2 = i0 + vcount;
+            const unsigned i3 = i2 + 1;
+            out << "f " << i0 << "/" << i0 << "/1 " << i2 << "/" << i2 << "/1 " << i1 << "/" << i1 << "/1\n"
+                << "f " << i1 << "/" << i1 << "/1 " << i2 << "/" << i2 << "/1 " << i3 << "/" << i3 << "/1\n";
+        }
+    }
+    if (!out) {
+        throw std::runtime_error("write_grid_obj(): unable to write synthetic model: " + f->_path);
+    }
+
+    return f;
+}
+
+// fixtures ///////////////////////////////////////////////////////////////////////////////////////
+scm::bench::benchmark_fixture
+mipmap_fixture(const scm::math::vec3ui& dim, scm::gl::data_format fmt)
+{
+    return [dim, fmt]() -> scm::bench::benchmark_body {
+        typedef std::vector<scm::uint8> data_vector;
+
+        scm::shared_ptr<data_vector> src = scm::make_shared<data_vector>(scm::gl::size_of_format(fmt) * dim.x * dim.y * dim.z);
+        fill_random(*src);
+
+        return [src, dim, fmt]() {
+            std::vector<scm::uint8*> levels;
+            if (!scm::gl::util::generate_mipmaps(dim, fmt, &src->front(), levels)) {
+                throw std::runtime_error("mipmap_fixture(): error generating mip maps.");
+            }
+            // the first level is the source data
+            for (scm::size_t l = 1; l < levels.size(); ++l) {
+                delete [] levels[l];
+            }
+        };
+    };
+}
+
+scm::bench::benchmark_fixture
+volume_fixture(const std::string&       data_dir,
+               const scm::math::vec3ui& dim,
+               const scm::math::vec3ui& read_size)
+{
+    return [data_dir, dim, read_size]() -> scm::bench::benchmark_body {
+        using namespace scm::math;
+
+        temporary_file_ptr                      f = write_raw_volume(data_dir, dim);
+        scm::shared_ptr<scm::gl::volume_reader> r = scm::make_shared<scm::gl::volume_reader_raw>(f->_path, dim, scm::gl::FORMAT_R_8);
+        if (!(*r)) {
+            throw std::runtime_error("volume_fixture(): unable to open synthetic volume: " + f->_path);
+        }
+
+        const vec3ui                            block_count = dim / read_size;
+        scm::shared_ptr<std::vector<scm::uint8> > dst = scm::make_shared<std::vector<scm::uint8> >(read_size.x * read_size.y * read_size.z);
+        scm::shared_ptr<unsigned>               next_block = scm::make_shared<unsigned>(0);
+
+        return [f, r, dim, read_size, block_count, dst, next_block]() {
+            // walk through all blocks of the volume to defeat trivial caching of the same region
+            const unsigned b = (*next_block)++ % (block_count.x * block_count.y * block_count.z);
+            const vec3ui   o = vec3ui(b % block_count.x,
+                                      (b / block_count.x) % block_count.y,
+                                      b / (block_count.x * block_count.y)) * read_size;
+
+            if (!r->read(o, read_size, &dst->front())) {
+                throw std::runtime_error("volume_fixture(): error reading synthetic volume.");
+            }
+        };
+    };
+}
+
+} // namespace
+
+namespace scm {
+namespace bench {
+
+void
+register_imaging_benchmarks(benchmark_registry& r)
+{
+    using namespace scm::math;
+
+    r.add("imaging/generate_mipmaps_1024x1024_rgba8", mipmap_fixture(vec3ui(1024, 1024, 1), gl::FORMAT_RGBA_8),
+          1024 * 1024, 1024 * 1024 * 4);
+    r.add("imaging/generate_mipmaps_1024x1024_r32f", mipmap_fixture(vec3ui(1024, 1024, 1), gl::FORMAT_R_32F),
+          1024 * 1024, 1024 * 1024 * 4);
+    r.add("imaging/generate_mipmaps_128x128x128_r8", mipmap_fixture(vec3ui(128, 128, 128), gl::FORMAT_R_8),
+          128 * 128 * 128, 128 * 128 * 128);
+}
+
+void
+register_volume_benchmarks(benchmark_registry& r, const std::string& data_dir)
+{
+    using namespace scm::math;
+
+    const vec3ui dim(256, 256, 256);
+
+    r.add("volume/raw_read_full_256", volume_fixture(data_dir, dim, dim),
+          1, dim.x * dim.y * dim.z);
+    r.add("volume/raw_read_slab_256x256x16", volume_fixture(data_dir, dim, vec3ui(256, 256, 16)),
+          1, 256 * 256 * 16);
+    r.add("volume/raw_read_brick_32", volume_fixture(data_dir, dim, vec3ui(32)),
+          1, 32 * 32 * 32);
+}
+
+void
+register_wavefront_obj_benchmarks(benchmark_registry& r, const std::string& data_dir)
+{
+    const unsigned grid_size = 256;
+    const unsigned tri_count = grid_size * grid_size * 2;
+
+    r.add("wavefront_obj/open_obj_file_grid_256", [data_dir, grid_size]() -> benchmark_body {
+        temporary_file_ptr f = write_grid_obj(data_dir, grid_size);
+        return [f]() {
+            gl::util::wavefront_model m;
+            if (!gl::util::open_obj_file(f->_path, m)) {
+                throw std::runtime_error("register_wavefront_obj_benchmarks(): error loading synthetic model: " + f->_path);
+            }
+        };
+    }, tri_count);
+
+    r.add("wavefront_obj/generate_vertex_buffer_grid_256", [data_dir, grid_size]() -> benchmark_body {
+        temporary_file_ptr                          f = write_grid_obj(data_dir, grid_size);
+        scm::shared_ptr<gl::util::wavefront_model>  m = scm::make_shared<gl::util::wavefront_model>();
+        if (!gl::util::open_obj_file(f->_path, *m)) {
+            throw std::runtime_error("register_wavefront_obj_benchmarks(): error loading synthetic model: " + f->_path);
+        }
+        return [m]() {
+            gl::util::vertexbuffer_data vb;
+            if (!gl::util::generate_vertex_buffer(*m, vb, true)) {
+                throw std::runtime_error("register_wavefront_obj_benchmarks(): error generating vertex buffer.");
+            }
+            do_not_optimize(vb._vert_array_count);
+        };
+    }, tri_count);
+
+    r.add("wavefront_obj/triangle_bvh_build_grid_256", [data_dir, grid_size]() -> benchmark_body {
+        temporary_file_ptr                          f = write_grid_obj(data_dir, grid_size);
+        scm::shared_ptr<gl::util::wavefront_model>  m = scm::make_shared<gl::util::wavefront_model>();
+        if (!gl::util::open_obj_file(f->_path, *m)) {
+            throw std::runtime_error("register_wavefront_obj_benchmarks(): error loading synthetic model: " + f->_path);
+        }
+        return [m]() {
+            gl::triangle_bvh bvh(*m);
+            do_not_optimize(bvh.node_count());
+        };
+    }, tri_count);
+
+    // a 32x32 block of coherent picking rays straight down onto the grid
+    const unsigned ray_dim = 32;
+
+    r.add("wavefront_obj/triangle_bvh_closest_hit_grid_256", [data_dir, grid_size, ray_dim]() -> benchmark_body {
+        temporary_file_ptr                          f = write_grid_obj(data_dir, grid_size);
+        scm::shared_ptr<gl::util::wavefront_model>  m = scm::make_shared<gl::util::wavefront_model>();
+        if (!gl::util::open_obj_file(f->_path, *m)) {
+            throw std::runtime_error("register_wavefront_obj_benchmarks(): error loading synthetic model: " + f->_path);
+        }
+        scm::shared_ptr<gl::triangle_bvh>           bvh  = scm::make_shared<gl::triangle_bvh>(*m);
+        scm::shared_ptr<std::vector<gl::rayf> >     rays = scm::make_shared<std::vector<gl::rayf> >();
+        scm::shared_ptr<std::vector<gl::ray_hit> >  hits = scm::make_shared<std::vector<gl::ray_hit> >(ray_dim * ray_dim);
+        for (unsigned y = 0; y < ray_dim; ++y) {
+            for (unsigned x = 0; x < ray_dim; ++x) {
+                rays->push_back(gl::rayf(math::vec3f((x + 0.5f) / ray_dim, 1.0f, (y + 0.5f) / ray_dim),
+                                         math::vec3f(0.0f, -1.0f, 0.0f)));
+            }
+        }
+        return [bvh, rays, hits]() {
+            bvh->closest_hit(&rays->front(), &hits->front(), rays->size());
+            do_not_optimize(hits->front());
+        };
+    }, ray_dim * ray_dim);
+}
+
+} // namespace bench
+} // namespace scm
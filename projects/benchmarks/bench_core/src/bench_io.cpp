@@ -0,0 +1,109 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include "bench_cases.h"
+
+#include <sstream>
+#include <vector>
+
+#include <scm/log.h>
+#include <scm/core/memory.h>
+#include <scm/core/log/listener_ostream.h>
+#include <scm/core/log/logger.h>
+#include <scm/core/platform/byte_swap.h>
+
+#include "benchmark.h"
+
+namespace {
+
+const scm::size_t swap_element_count = 64 * 1024;
+
+template<typename T>
+scm::bench::benchmark_fixture
+byte_swap_fixture()
+{
+    return []() -> scm::bench::benchmark_body {
+        scm::shared_ptr<std::vector<T> > d = scm::make_shared<std::vector<T> >(swap_element_count);
+        for (scm::size_t i = 0; i < swap_element_count; ++i) {
+            (*d)[i] = static_cast<T>(i * 2654435761u);
+        }
+        return [d]() {
+            scm::swap_bytes_array(&d->front(), d->size());
+            scm::bench::do_not_optimize(d->front());
+        };
+    };
+}
+
+// a detached logger without a parent, messages do not reach the console listeners
+struct log_data
+{
+    log_data(scm::log::listener::log_style s)
+      : _logger(new scm::log::logger("bench", scm::log::ll_info, scm::log::logger::logger_ptr()))
+      , _listener(new scm::log::listener_ostream(_stream))
+      , _counter(0)
+    {
+        _listener->style(s);
+        _logger->add_listener(_listener);
+    }
+
+    void reset_stream() {
+        if (_stream.tellp() > (1 << 20)) {
+            _stream.str(std::string());
+        }
+    }
+
+    std::ostringstream                  _stream;
+    scm::shared_ptr<scm::log::logger>   _logger;
+    scm::log::logger::listener_ptr      _listener;
+    scm::uint64                         _counter;
+}; // struct log_data
+
+typedef scm::shared_ptr<log_data>   log_data_ptr;
+
+} // namespace
+
+namespace scm {
+namespace bench {
+
+void
+register_byte_swap_benchmarks(benchmark_registry& r)
+{
+    r.add("byte_swap/swap_bytes_array_uint16", byte_swap_fixture<scm::uint16>(),
+          swap_element_count, swap_element_count * sizeof(scm::uint16));
+    r.add("byte_swap/swap_bytes_array_uint32", byte_swap_fixture<scm::uint32>(),
+          swap_element_count, swap_element_count * sizeof(scm::uint32));
+    r.add("byte_swap/swap_bytes_array_uint64", byte_swap_fixture<scm::uint64>(),
+          swap_element_count, swap_element_count * sizeof(scm::uint64));
+}
+
+void
+register_log_benchmarks(benchmark_registry& r)
+{
+    r.add("log/info_message_plain", []() -> benchmark_body {
+        log_data_ptr d = make_shared<log_data>(log::listener::log_plain);
+        return [d]() {
+            d->_logger->info() << "benchmark message " << d->_counter++ << " value " << 3.1415f << log::end;
+            d->reset_stream();
+        };
+    });
+
+    r.add("log/info_message_full_decorated", []() -> benchmark_body {
+        log_data_ptr d = make_shared<log_data>(log::listener::log_full_decorated);
+        return [d]() {
+            d->_logger->info() << "benchmark message " << d->_counter++ << " value " << 3.1415f << log::end;
+            d->reset_stream();
+        };
+    });
+
+    r.add("log/debug_message_filtered", []() -> benchmark_body {
+        log_data_ptr d = make_shared<log_data>(log::listener::log_plain);
+        return [d]() {
+            // below the logger level, measures the cost of discarded messages
+            d->_logger->debug() << "benchmark message " << d->_counter++ << " value " << 3.1415f << log::end;
+        };
+    });
+}
+
+} // namespace bench
+} // namespace scm
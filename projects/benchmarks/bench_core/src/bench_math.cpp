@@ -0,0 +1,260 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include "bench_cases.h"
+
+#include <string>
+#include <vector>
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_real.hpp>
+#include <boost/random/variate_generator.hpp>
+
+#include <scm/core/math.h>
+#include <scm/core/memory.h>
+#include <scm/core/math/batch.h>
+#include <scm/core/utilities/thread_pool.h>
+
+#include "benchmark.h"
+
+namespace {
+
+const scm::size_t element_count = 1024;
+
+struct math_data
+{
+    math_data()
+      : _mat_a(element_count)
+      , _mat_b(element_count)
+      , _mat_r(element_count)
+      , _vec_a(element_count)
+      , _vec_r(element_count)
+      , _vec3_a(element_count)
+      , _vec3_r(element_count)
+      , _quat_a(element_count)
+      , _quat_b(element_count)
+      , _quat_r(element_count)
+    {
+        using namespace scm::math;
+
+        boost::mt19937                      rand_gen(5489u);
+        boost::uniform_real<float>          rand_dist(-1.0f, 1.0f);
+        boost::variate_generator<boost::mt19937&, boost::uniform_real<float> > die(rand_gen, rand_dist);
+
+        for (scm::size_t i = 0; i < element_count; ++i) {
+            for (unsigned e = 0; e < 16; ++e) {
+                _mat_a[i].data_array[e] = die();
+                _mat_b[i].data_array[e] = die();
+            }
+            // keep the matrices well conditioned for the inverse
+            for (unsigned d = 0; d < 4; ++d) {
+                _mat_a[i].data_array[d * 5] += 4.0f;
+            }
+            _vec_a[i]  = vec4f(die(), die(), die(), 1.0f);
+            _vec3_a[i] = vec3f(die(), die(), die()) + vec3f(2.0f);
+            _quat_a[i] = quatf::from_axis(die() * 180.0f, normalize(_vec3_a[i]));
+            _quat_b[i] = quatf::from_axis(die() * 180.0f, normalize(vec3f(die(), die(), die()) + vec3f(2.0f)));
+        }
+    }
+
+    std::vector<scm::math::mat4f>   _mat_a;
+    std::vector<scm::math::mat4f>   _mat_b;
+    std::vector<scm::math::mat4f>   _mat_r;
+    std::vector<scm::math::vec4f>   _vec_a;
+    std::vector<scm::math::vec4f>   _vec_r;
+    std::vector<scm::math::vec3f>   _vec3_a;
+    std::vector<scm::math::vec3f>   _vec3_r;
+    std::vector<scm::math::quatf>   _quat_a;
+    std::vector<scm::math::quatf>   _quat_b;
+    std::vector<scm::math::quatf>   _quat_r;
+}; // struct math_data
+
+typedef scm::shared_ptr<math_data>  math_data_ptr;
+
+const scm::size_t stream_count = 1024 * 1024;
+
+struct stream_data
+{
+    stream_data()
+      : _data(stream_count * 12)
+      , _transform(scm::math::quatf::from_axis(30.0f, scm::math::normalize(scm::math::vec3f(1.0f, 2.0f, 3.0f))).to_matrix())
+    {
+        boost::mt19937                      rand_gen(5489u);
+        boost::uniform_real<float>          rand_dist(-100.0f, 100.0f);
+        boost::variate_generator<boost::mt19937&, boost::uniform_real<float> > die(rand_gen, rand_dist);
+
+        for (scm::size_t i = 0; i < stream_count * 6; ++i) {
+            _data[i] = die();
+        }
+        // box maxima above the minima
+        for (scm::size_t i = 0; i < stream_count * 3; ++i) {
+            _data[stream_count * 3 + i] = _data[i] + 1.0f;
+        }
+
+        _transform.m12 = 10.0f;
+    }
+
+    scm::math::const_vec3f_stream   in_points() const   { return scm::math::const_vec3f_stream(&_data[0], &_data[stream_count], &_data[stream_count * 2]); }
+    scm::math::const_box3f_stream   in_boxes() const    { return scm::math::const_box3f_stream(in_points(), scm::math::const_vec3f_stream(&_data[stream_count * 3], &_data[stream_count * 4], &_data[stream_count * 5])); }
+    scm::math::vec3f_stream         out_points()        { return scm::math::vec3f_stream(&_data[stream_count * 6], &_data[stream_count * 7], &_data[stream_count * 8]); }
+    scm::math::box3f_stream         out_boxes()         { return scm::math::box3f_stream(out_points(), scm::math::vec3f_stream(&_data[stream_count * 9], &_data[stream_count * 10], &_data[stream_count * 11])); }
+
+    std::vector<float>              _data;
+    scm::math::mat4f                _transform;
+    scm::shared_ptr<scm::thread_pool> _pool;
+}; // struct stream_data
+
+typedef scm::shared_ptr<stream_data>    stream_data_ptr;
+
+scm::bench::benchmark_fixture
+stream_fixture(bool use_pool, const boost::function<void (stream_data&, scm::thread_pool*)>& k)
+{
+    return [use_pool, k]() -> scm::bench::benchmark_body {
+        stream_data_ptr d = scm::make_shared<stream_data>();
+        if (use_pool) {
+            d->_pool = scm::make_shared<scm::thread_pool>(0);
+        }
+        return [d, k]() {
+            k(*d, d->_pool.get());
+        };
+    };
+}
+
+} // namespace
+
+namespace scm {
+namespace bench {
+
+void
+register_math_benchmarks(benchmark_registry& r)
+{
+    using namespace scm::math;
+
+    r.add("math/mat4f_mul", []() -> benchmark_body {
+        math_data_ptr d = make_shared<math_data>();
+        return [d]() {
+            for (scm::size_t i = 0; i < element_count; ++i) {
+                d->_mat_r[i] = d->_mat_a[i] * d->_mat_b[i];
+            }
+            do_not_optimize(d->_mat_r.front());
+        };
+    }, element_count);
+
+    r.add("math/mat4f_mul_vec4f", []() -> benchmark_body {
+        math_data_ptr d = make_shared<math_data>();
+        return [d]() {
+            for (scm::size_t i = 0; i < element_count; ++i) {
+                d->_vec_r[i] = d->_mat_a[i] * d->_vec_a[i];
+            }
+            do_not_optimize(d->_vec_r.front());
+        };
+    }, element_count);
+
+    r.add("math/mat4f_transpose", []() -> benchmark_body {
+        math_data_ptr d = make_shared<math_data>();
+        return [d]() {
+            for (scm::size_t i = 0; i < element_count; ++i) {
+                d->_mat_r[i] = transpose(d->_mat_a[i]);
+            }
+            do_not_optimize(d->_mat_r.front());
+        };
+    }, element_count);
+
+    r.add("math/mat4f_inverse", []() -> benchmark_body {
+        math_data_ptr d = make_shared<math_data>();
+        return [d]() {
+            for (scm::size_t i = 0; i < element_count; ++i) {
+                d->_mat_r[i] = inverse(d->_mat_a[i]);
+            }
+            do_not_optimize(d->_mat_r.front());
+        };
+    }, element_count);
+
+    r.add("math/vec3f_normalize", []() -> benchmark_body {
+        math_data_ptr d = make_shared<math_data>();
+        return [d]() {
+            for (scm::size_t i = 0; i < element_count; ++i) {
+                d->_vec3_r[i] = normalize(d->_vec3_a[i]);
+            }
+            do_not_optimize(d->_vec3_r.front());
+        };
+    }, element_count);
+
+    r.add("math/vec3f_cross_dot", []() -> benchmark_body {
+        math_data_ptr d = make_shared<math_data>();
+        return [d]() {
+            float s = 0.0f;
+            for (scm::size_t i = 1; i < element_count; ++i) {
+                s += dot(cross(d->_vec3_a[i - 1], d->_vec3_a[i]), d->_vec3_a[i]);
+            }
+            do_not_optimize(s);
+        };
+    }, element_count - 1);
+
+    r.add("math/quatf_mul", []() -> benchmark_body {
+        math_data_ptr d = make_shared<math_data>();
+        return [d]() {
+            for (scm::size_t i = 0; i < element_count; ++i) {
+                d->_quat_r[i] = d->_quat_a[i] * d->_quat_b[i];
+            }
+            do_not_optimize(d->_quat_r.front());
+        };
+    }, element_count);
+
+    r.add("math/quatf_rotate_vec3f", []() -> benchmark_body {
+        math_data_ptr d = make_shared<math_data>();
+        return [d]() {
+            for (scm::size_t i = 0; i < element_count; ++i) {
+                d->_vec3_r[i] = d->_quat_a[i] * d->_vec3_a[i];
+            }
+            do_not_optimize(d->_vec3_r.front());
+        };
+    }, element_count);
+
+    r.add("math/quatf_slerp", []() -> benchmark_body {
+        math_data_ptr d = make_shared<math_data>();
+        return [d]() {
+            for (scm::size_t i = 0; i < element_count; ++i) {
+                d->_quat_r[i] = slerp(d->_quat_a[i], d->_quat_b[i], 0.3f);
+            }
+            do_not_optimize(d->_quat_r.front());
+        };
+    }, element_count);
+
+    r.add("math/quatf_to_matrix", []() -> benchmark_body {
+        math_data_ptr d = make_shared<math_data>();
+        return [d]() {
+            for (scm::size_t i = 0; i < element_count; ++i) {
+                d->_mat_r[i] = d->_quat_a[i].to_matrix();
+            }
+            do_not_optimize(d->_mat_r.front());
+        };
+    }, element_count);
+
+    // structure of arrays batch kernels
+    for (int p = 0; p < 2; ++p) {
+        const std::string suffix = p ? "_pool" : "";
+
+        r.add("math/batch_transform_points_1m" + suffix, stream_fixture(p != 0, [](stream_data& d, thread_pool* tp) {
+            transform_points(d._transform, d.in_points(), d.out_points(), stream_count, tp);
+        }), stream_count, stream_count * 3 * sizeof(float));
+
+        r.add("math/batch_transform_boxes_1m" + suffix, stream_fixture(p != 0, [](stream_data& d, thread_pool* tp) {
+            transform_boxes(d._transform, d.in_boxes(), d.out_boxes(), stream_count, tp);
+        }), stream_count, stream_count * 6 * sizeof(float));
+
+        r.add("math/batch_normalize_1m" + suffix, stream_fixture(p != 0, [](stream_data& d, thread_pool* tp) {
+            normalize(d.in_points(), d.out_points(), stream_count, tp);
+        }), stream_count, stream_count * 3 * sizeof(float));
+
+        r.add("math/batch_min_max_1m" + suffix, stream_fixture(p != 0, [](stream_data& d, thread_pool* tp) {
+            vec3f bmin, bmax;
+            min_max(d.in_points(), stream_count, bmin, bmax, tp);
+            do_not_optimize(bmin);
+        }), stream_count, stream_count * 3 * sizeof(float));
+    }
+}
+
+} // namespace bench
+} // namespace scm
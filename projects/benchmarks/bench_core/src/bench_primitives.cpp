@@ -0,0 +1,185 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include "bench_cases.h"
+
+#include <vector>
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_real.hpp>
+#include <boost/random/variate_generator.hpp>
+
+#include <scm/core/math.h>
+#include <scm/core/memory.h>
+
+#include <scm/gl_core/math.h>
+#include <scm/gl_core/primitives/box.h>
+#include <scm/gl_core/primitives/frustum.h>
+#include <scm/gl_core/primitives/frustum_culler.h>
+
+#include <scm/gl_util/primitives/loose_octree.h>
+#include <scm/gl_util/utilities/occlusion_culler.h>
+
+#include "benchmark.h"
+
+namespace {
+
+const scm::size_t box_count = 16384;
+
+struct culling_data
+{
+    culling_data()
+      : _box_streams(box_count * 6)
+    {
+        using namespace scm::math;
+
+        boost::mt19937                      rand_gen(5489u);
+        boost::uniform_real<float>          rand_dist(-50.0f, 50.0f);
+        boost::variate_generator<boost::mt19937&, boost::uniform_real<float> > die(rand_gen, rand_dist);
+
+        _boxes.reserve(box_count);
+        for (scm::size_t i = 0; i < box_count; ++i) {
+            const vec3f c(die(), die(), die());
+            const vec3f e(0.5f + 0.02f * (die() + 50.0f));
+            _boxes.push_back(scm::gl::boxf(c - e, c + e));
+
+            for (unsigned a = 0; a < 3; ++a) {
+                _box_streams[ a      * box_count + i] = _boxes.back().min_vertex()[a];
+                _box_streams[(a + 3) * box_count + i] = _boxes.back().max_vertex()[a];
+            }
+        }
+
+        _view_projection =   make_perspective_matrix(60.0f, 16.0f / 9.0f, 0.1f, 100.0f)
+                           * make_look_at_matrix(vec3f(0.0f, 0.0f, 0.0f), vec3f(0.0f, 0.0f, -1.0f), vec3f(0.0f, 1.0f, 0.0f));
+        _frustum.update(_view_projection);
+        _culler.update(_frustum);
+    }
+
+    scm::math::const_box3f_stream box_streams() const {
+        using scm::math::const_vec3f_stream;
+        return scm::math::const_box3f_stream(const_vec3f_stream(&_box_streams[0],             &_box_streams[box_count],     &_box_streams[box_count * 2]),
+                                             const_vec3f_stream(&_box_streams[box_count * 3], &_box_streams[box_count * 4], &_box_streams[box_count * 5]));
+    }
+
+    std::vector<scm::gl::boxf>  _boxes;
+    scm::math::mat4f            _view_projection;
+    scm::gl::frustumf           _frustum;
+
+    std::vector<float>                          _box_streams;
+    scm::gl::frustum_culler                     _culler;
+    scm::gl::frustum_culler::plane_cache        _plane_cache;
+    scm::gl::frustum_culler::index_array        _visible;
+}; // struct culling_data
+
+typedef scm::shared_ptr<culling_data>   culling_data_ptr;
+
+} // namespace
+
+namespace scm {
+namespace bench {
+
+void
+register_primitive_benchmarks(benchmark_registry& r)
+{
+    r.add("primitives/frustumf_classify_boxf", []() -> benchmark_body {
+        culling_data_ptr d = make_shared<culling_data>();
+        return [d]() {
+            unsigned visible = 0;
+            for (scm::size_t i = 0; i < box_count; ++i) {
+                if (d->_frustum.classify(d->_boxes[i]) != gl::frustumf::outside) {
+                    ++visible;
+                }
+            }
+            do_not_optimize(visible);
+        };
+    }, box_count);
+
+    r.add("primitives/frustum_culler_cull", []() -> benchmark_body {
+        culling_data_ptr d = make_shared<culling_data>();
+        return [d]() {
+            do_not_optimize(d->_culler.cull(d->box_streams(), box_count, d->_visible));
+        };
+    }, box_count);
+
+    r.add("primitives/frustum_culler_cull_coherent", []() -> benchmark_body {
+        culling_data_ptr d = make_shared<culling_data>();
+        return [d]() {
+            do_not_optimize(d->_culler.cull(d->box_streams(), box_count, d->_plane_cache, d->_visible));
+        };
+    }, box_count);
+
+    r.add("primitives/occlusion_culler_frame", []() -> benchmark_body {
+        culling_data_ptr                        d  = make_shared<culling_data>();
+        shared_ptr<gl::occlusion_culler>        oc = make_shared<gl::occlusion_culler>();
+        shared_ptr<gl::occlusion_culler::index_array> candidates = make_shared<gl::occlusion_culler::index_array>();
+        d->_culler.cull(d->box_streams(), box_count, *candidates);
+        return [d, oc, candidates]() {
+            // a wall of four quads in front of the camera
+            static const math::vec3f  wall[] = { math::vec3f(-20.0f, -10.0f, 0.0f), math::vec3f(20.0f, -10.0f, 0.0f),
+                                                 math::vec3f( 20.0f,  10.0f, 0.0f), math::vec3f(-20.0f, 10.0f, 0.0f) };
+            static const scm::uint32  wall_indices[] = { 0, 1, 2, 0, 2, 3 };
+
+            oc->begin_frame(d->_view_projection);
+            for (int w = 0; w < 4; ++w) {
+                oc->add_occluder(math::make_translation(-30.0f + 20.0f * w, 0.0f, -15.0f - 5.0f * w), wall, 4, wall_indices, 2);
+            }
+            oc->end_occluders();
+            do_not_optimize(oc->cull(d->box_streams(), *candidates, d->_visible));
+        };
+    }, box_count);
+
+    r.add("primitives/loose_octree_query_frustum", []() -> benchmark_body {
+        culling_data_ptr                d  = make_shared<culling_data>();
+        shared_ptr<gl::loose_octree>    lo = make_shared<gl::loose_octree>(gl::boxf(math::vec3f(-52.0f), math::vec3f(52.0f)));
+        for (scm::size_t i = 0; i < box_count; ++i) {
+            lo->insert(d->_boxes[i]);
+        }
+        return [d, lo]() {
+            lo->query(d->_frustum, d->_visible);
+            do_not_optimize(d->_visible);
+        };
+    }, box_count);
+
+    r.add("primitives/loose_octree_update_tracked", []() -> benchmark_body {
+        // objects moving a little every frame, as tracked targets do
+        culling_data_ptr                d  = make_shared<culling_data>();
+        shared_ptr<gl::loose_octree>    lo = make_shared<gl::loose_octree>(gl::boxf(math::vec3f(-52.0f), math::vec3f(52.0f)));
+        for (scm::size_t i = 0; i < box_count; ++i) {
+            lo->insert(d->_boxes[i]);
+        }
+        shared_ptr<unsigned>            frame = make_shared<unsigned>(0u);
+        return [d, lo, frame]() {
+            const math::vec3f offset(0.01f * static_cast<float>((*frame)++ % 64));
+            for (scm::size_t i = 0; i < box_count; ++i) {
+                lo->update(static_cast<gl::loose_octree::object_id>(i),
+                           gl::boxf(d->_boxes[i].min_vertex() + offset, d->_boxes[i].max_vertex() + offset));
+            }
+        };
+    }, box_count);
+
+    r.add("primitives/frustumf_update", []() -> benchmark_body {
+        culling_data_ptr d = make_shared<culling_data>();
+        return [d]() {
+            d->_frustum.update(d->_view_projection);
+            do_not_optimize(d->_frustum);
+        };
+    });
+
+    r.add("primitives/boxf_classify_boxf", []() -> benchmark_body {
+        culling_data_ptr d = make_shared<culling_data>();
+        return [d]() {
+            const gl::boxf  query(math::vec3f(-10.0f), math::vec3f(10.0f));
+            unsigned        overlaps = 0;
+            for (scm::size_t i = 0; i < box_count; ++i) {
+                if (query.classify(d->_boxes[i]) != gl::boxf::outside) {
+                    ++overlaps;
+                }
+            }
+            do_not_optimize(overlaps);
+        };
+    }, box_count);
+}
+
+} // namespace bench
+} // namespace scm
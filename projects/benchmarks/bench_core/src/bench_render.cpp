@@ -0,0 +1,428 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include "bench_cases.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/assign/list_of.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int.hpp>
+#include <boost/random/variate_generator.hpp>
+
+#include <scm/core/memory.h>
+
+#include <scm/gl_core/buffer_objects.h>
+#include <scm/gl_core/buffer_objects/uniform_buffer_adaptor.h>
+#include <scm/gl_core/render_device.h>
+#include <scm/gl_core/shader_objects.h>
+#include <scm/gl_core/state_objects.h>
+#include <scm/gl_core/texture_objects.h>
+#include <scm/gl_core/render_device/opengl/gl_null_backend.h>
+
+#include <scm/gl_util/primitives/static_geometry_batch.h>
+#include <scm/gl_util/utilities/render_queue.h>
+
+#include "benchmark.h"
+
+namespace {
+
+const unsigned draw_count    = 1024;
+const unsigned texture_count = 8;
+
+// render_device on the null backend, measures the CPU side of draw submission
+struct render_data
+{
+    render_data()
+      : _device(new scm::gl::render_device(scm::gl::render_device::BACKEND_NULL))
+    {
+        using namespace scm::gl;
+        using boost::assign::list_of;
+
+        _context = _device->main_context();
+        _program = _device->create_program(list_of(_device->create_shader(STAGE_VERTEX_SHADER,   "#version 450 core\nvoid main() {}\n"))
+                                                  (_device->create_shader(STAGE_FRAGMENT_SHADER, "#version 450 core\nvoid main() {}\n")));
+        _sampler = _device->create_sampler_state(FILTER_MIN_MAG_LINEAR, WRAP_CLAMP_TO_EDGE);
+        for (unsigned t = 0; t < texture_count; ++t) {
+            _textures.push_back(_device->create_texture_2d(scm::math::vec2ui(64, 64), FORMAT_RGBA_8));
+        }
+        _command_buffer.reset(new command_buffer());
+    }
+    ~render_data() {
+        _command_buffer.reset();
+        _textures.clear();
+        _sampler.reset();
+        _program.reset();
+        _context.reset();
+        _device.reset();
+    }
+
+    scm::gl::render_device_ptr          _device;
+    scm::gl::render_context_ptr         _context;
+    scm::gl::program_ptr                _program;
+    scm::gl::sampler_state_ptr          _sampler;
+    std::vector<scm::gl::texture_2d_ptr> _textures;
+    scm::gl::command_buffer_ptr         _command_buffer;
+}; // struct render_data
+
+typedef scm::shared_ptr<render_data>    render_data_ptr;
+
+const unsigned queue_program_count  = 4;
+const unsigned queue_material_count = 32;
+const unsigned queue_vertex_array_count = 8;
+
+// draws over a few programs, materials and vertex arrays in random order
+struct render_queue_data : render_data
+{
+    render_queue_data()
+    {
+        using namespace scm::gl;
+        using boost::assign::list_of;
+
+        for (unsigned p = 0; p < queue_program_count; ++p) {
+            _programs.push_back(_device->create_program(list_of(_device->create_shader(STAGE_VERTEX_SHADER,   "#version 450 core\nvoid main() {}\n"))
+                                                               (_device->create_shader(STAGE_FRAGMENT_SHADER, "#version 450 core\nvoid main() {}\n"))));
+        }
+        for (unsigned m = 0; m < queue_material_count; ++m) {
+            _materials.push_back(scm::make_shared<render_queue::material>());
+            render_queue::texture_binding t;
+            t._texture       = _textures[m % texture_count];
+            t._sampler_state = _sampler;
+            t._unit          = 0;
+            _materials.back()->_textures.push_back(t);
+        }
+        _buffer = _device->create_buffer(BIND_VERTEX_BUFFER, USAGE_STATIC_DRAW, 3 * sizeof(scm::math::vec3f), 0);
+        for (unsigned v = 0; v < queue_vertex_array_count; ++v) {
+            _vertex_arrays.push_back(_device->create_vertex_array(vertex_format(0, 0, TYPE_VEC3F, sizeof(scm::math::vec3f)), list_of(_buffer)));
+        }
+
+        boost::mt19937                  rand_gen(5489u);
+        boost::uniform_int<unsigned>    rand_dist(0, 1u << 16);
+        boost::variate_generator<boost::mt19937&, boost::uniform_int<unsigned> > die(rand_gen, rand_dist);
+
+        for (unsigned i = 0; i < draw_count; ++i) {
+            render_queue::draw_item d;
+            d._pass         = die() % 2;
+            d._depth        = static_cast<float>(die()) / 256.0f;
+            d._program      = _programs[die() % queue_program_count];
+            d._material     = _materials[die() % queue_material_count];
+            d._vertex_array = _vertex_arrays[die() % queue_vertex_array_count];
+            d._count        = 3;
+            _draws.push_back(d);
+        }
+    }
+    ~render_queue_data() {
+        _draws.clear();
+        _vertex_arrays.clear();
+        _buffer.reset();
+        _materials.clear();
+        _programs.clear();
+    }
+
+    std::vector<scm::gl::program_ptr>                   _programs;
+    std::vector<scm::gl::render_queue::material_ptr>    _materials;
+    scm::gl::buffer_ptr                                 _buffer;
+    std::vector<scm::gl::vertex_array_ptr>              _vertex_arrays;
+    std::vector<scm::gl::render_queue::draw_item>       _draws;
+    scm::gl::render_queue                               _queue;
+}; // struct render_queue_data
+
+typedef scm::shared_ptr<render_queue_data>  render_queue_data_ptr;
+
+const unsigned batch_mesh_count   = 64;
+const unsigned batch_bucket_count = 8;
+
+// small meshes in one static batch, each visible reference is its own instance
+struct static_batch_data : render_data
+{
+    static_batch_data()
+      : _builder(sizeof(scm::math::vec3f))
+    {
+        using namespace scm::gl;
+
+        const scm::math::vec3f  v[3] = { scm::math::vec3f(0.0f), scm::math::vec3f(1.0f, 0.0f, 0.0f), scm::math::vec3f(0.0f, 1.0f, 0.0f) };
+        const scm::uint32       i[3] = { 0, 1, 2 };
+        for (unsigned m = 0; m < batch_mesh_count; ++m) {
+            _builder.add_mesh(v, 3, i, 3);
+        }
+        _batch.reset(new static_geometry_batch(_device, _builder, vertex_format(0, 0, TYPE_VEC3F, sizeof(scm::math::vec3f))));
+
+        for (unsigned d = 0; d < draw_count; ++d) {
+            static_batch_builder::draw_reference r;
+            r._mesh     = (d * 7) % batch_mesh_count;
+            r._bucket   = (d * 3) % batch_bucket_count;
+            r._instance = d;
+            _visible.push_back(r);
+        }
+    }
+    ~static_batch_data() {
+        _batch.reset();
+    }
+
+    scm::gl::static_batch_builder                       _builder;
+    scm::gl::static_geometry_batch_ptr                  _batch;
+    scm::gl::static_batch_builder::draw_reference_array _visible;
+    scm::gl::static_batch_builder::draw_command_array   _commands;
+    scm::gl::static_batch_builder::bucket_range_array   _buckets;
+}; // struct static_batch_data
+
+typedef scm::shared_ptr<static_batch_data>  static_batch_data_ptr;
+
+struct object_block
+{
+    scm::math::mat4f    _model_matrix;
+    scm::math::vec4f    _color;
+}; // struct object_block
+
+// per object uniform updates, dedicated block buffer against frame ring sub-allocation
+struct uniform_update_data : render_data
+{
+    uniform_update_data()
+      : _ring(new scm::gl::frame_ring_buffer(_device, draw_count * 256 * 2))
+      , _mapped_block(_device)
+      , _ring_block(_ring)
+    {
+    }
+    ~uniform_update_data() {
+        _ring_block.reset();
+        _mapped_block.reset();
+        _ring.reset();
+    }
+
+    scm::gl::frame_ring_buffer_ptr              _ring;
+    scm::gl::uniform_block<object_block>        _mapped_block;
+    scm::gl::uniform_block<object_block>        _ring_block;
+}; // struct uniform_update_data
+
+typedef scm::shared_ptr<uniform_update_data>    uniform_update_data_ptr;
+
+const unsigned uber_uniform_count = 128;
+
+// program declaring many uniforms of which a few change per draw
+struct uber_program_data : render_data
+{
+    uber_program_data()
+    {
+        using namespace scm::gl;
+        using boost::assign::list_of;
+
+        std::ostringstream src;
+        src << "#version 450 core\n";
+        for (unsigned u = 0; u < uber_uniform_count; ++u) {
+            src << "uniform vec4 u" << u << ";\n";
+        }
+        src << "void main() {}\n";
+
+        _uber_program = _device->create_program(list_of(_device->create_shader(STAGE_VERTEX_SHADER,   src.str()))
+                                                       (_device->create_shader(STAGE_FRAGMENT_SHADER, "#version 450 core\nvoid main() {}\n")));
+        for (unsigned u = 0; u < uber_uniform_count; ++u) {
+            std::ostringstream n;
+            n << "u" << u;
+            _names.push_back(n.str());
+            _handles.push_back(_uber_program->uniform_handle<scm::math::vec4f>(_names.back()));
+            _uber_program->uniform(_names.back(), scm::math::vec4f(0.0f));
+        }
+    }
+    ~uber_program_data() {
+        _uber_program.reset();
+    }
+
+    scm::gl::program_ptr            _uber_program;
+    std::vector<std::string>        _names;
+    std::vector<scm::gl::uniform_handle<scm::math::vec4f> > _handles;
+}; // struct uber_program_data
+
+typedef scm::shared_ptr<uber_program_data>  uber_program_data_ptr;
+
+const unsigned shader_permutation_count = 16;
+
+// shader permutations of one source sharing an include, created once per iteration
+struct shader_permutation_data : render_data
+{
+    shader_permutation_data()
+    {
+        std::ostringstream inc;
+        for (unsigned f = 0; f < 32; ++f) {
+            inc << "// helper " << f << "\n"
+                << "vec3 helper" << f << "(in vec3 n, in vec3 l) {\n"
+                << "    return max(dot(n, l), 0.0) * vec3(" << f << ".0);\n"
+                << "}\n";
+        }
+        _device->add_include_string("/common/helpers.glslh", inc.str());
+
+        std::ostringstream src;
+        src << "/*\n * permutation test shader\n */\n"
+            << "#version 450 core\n"
+            << "#extension GL_ARB_shading_language_include : require\n"
+            << "#include </common/helpers.glslh>\n";
+        for (unsigned l = 0; l < 64; ++l) {
+            src << "// line " << l << "\n"
+                << "float value" << l << " = " << l << ".0;\n";
+        }
+        src << "void main() {}\n";
+        _source = src.str();
+
+        for (unsigned p = 0; p < shader_permutation_count; ++p) {
+            std::ostringstream v;
+            v << p;
+            _macros.push_back(scm::gl::shader_macro_array("PERMUTATION", v.str())("USE_HELPERS", "1"));
+        }
+    }
+
+    std::string                             _source;
+    std::vector<scm::gl::shader_macro_array> _macros;
+}; // struct shader_permutation_data
+
+typedef scm::shared_ptr<shader_permutation_data>    shader_permutation_data_ptr;
+
+} // namespace
+
+namespace scm {
+namespace bench {
+
+void
+register_render_benchmarks(benchmark_registry& r)
+{
+    // two texture units switched per draw, every other draw rebinds the same texture
+    r.add("render/null_draw_submission", []() -> benchmark_body {
+        render_data_ptr d = make_shared<render_data>();
+        return [d]() {
+            d->_context->bind_program(d->_program);
+            for (unsigned i = 0; i < draw_count; ++i) {
+                d->_context->bind_texture(d->_textures[(i / 2) % texture_count], d->_sampler, i % 2);
+                d->_context->apply();
+                d->_context->draw_arrays(gl::PRIMITIVE_TRIANGLE_LIST, 0, 3);
+            }
+        };
+    }, draw_count);
+
+    // the same draws in insertion order and through the render_queue
+    r.add("render/null_unsorted_submission", []() -> benchmark_body {
+        render_queue_data_ptr d = make_shared<render_queue_data>();
+        return [d]() {
+            for (unsigned i = 0; i < draw_count; ++i) {
+                const gl::render_queue::draw_item& di = d->_draws[i];
+                d->_context->bind_program(di._program);
+                d->_context->bind_texture(di._material->_textures[0]._texture, di._material->_textures[0]._sampler_state, 0);
+                d->_context->bind_vertex_array(di._vertex_array);
+                d->_context->apply();
+                d->_context->draw_arrays(gl::PRIMITIVE_TRIANGLE_LIST, di._first, di._count);
+            }
+        };
+    }, draw_count);
+
+    r.add("render/null_render_queue_submission", []() -> benchmark_body {
+        render_queue_data_ptr d = make_shared<render_queue_data>();
+        return [d]() {
+            for (unsigned i = 0; i < draw_count; ++i) {
+                d->_queue.push(d->_draws[i]);
+            }
+            d->_queue.submit(d->_context);
+        };
+    }, draw_count);
+
+    // the same meshes drawn one by one and through one multi draw indirect per bucket
+    r.add("render/null_static_batch_single_draws", []() -> benchmark_body {
+        static_batch_data_ptr d = make_shared<static_batch_data>();
+        return [d]() {
+            d->_context->bind_program(d->_program);
+            d->_context->bind_vertex_array(d->_batch->vertex_array());
+            d->_context->bind_index_buffer(d->_batch->index_buffer(), gl::PRIMITIVE_TRIANGLE_LIST, gl::TYPE_UINT);
+            for (unsigned i = 0; i < draw_count; ++i) {
+                const gl::static_batch_builder::mesh_range& m = d->_builder.mesh(d->_visible[i]._mesh);
+                d->_context->apply();
+                d->_context->draw_elements(m._index_count, m._first_index, m._base_vertex);
+            }
+        };
+    }, draw_count);
+
+    r.add("render/null_static_batch_multi_draw_indirect", []() -> benchmark_body {
+        static_batch_data_ptr d = make_shared<static_batch_data>();
+        return [d]() {
+            d->_context->bind_program(d->_program);
+            d->_builder.build_commands(d->_visible, d->_commands, d->_buckets);
+            d->_batch->draw(d->_context, d->_commands, d->_buckets);
+        };
+    }, draw_count);
+
+    r.add("render/null_uniform_block_map_update", []() -> benchmark_body {
+        uniform_update_data_ptr d = make_shared<uniform_update_data>();
+        return [d]() {
+            for (unsigned i = 0; i < draw_count; ++i) {
+                d->_mapped_block.begin_manipulation(d->_context);
+                d->_mapped_block->_color.x = static_cast<float>(i);
+                d->_mapped_block.end_manipulation();
+                d->_mapped_block.bind(d->_context, 0);
+            }
+        };
+    }, draw_count);
+
+    r.add("render/null_uniform_block_ring_update", []() -> benchmark_body {
+        uniform_update_data_ptr d = make_shared<uniform_update_data>();
+        return [d]() {
+            for (unsigned i = 0; i < draw_count; ++i) {
+                d->_ring_block.begin_manipulation(d->_context);
+                d->_ring_block->_color.x = static_cast<float>(i);
+                d->_ring_block.end_manipulation();
+                d->_ring_block.bind(d->_context, 0);
+            }
+            d->_ring->end_frame(d->_context);
+        };
+    }, draw_count);
+
+    r.add("render/null_uber_program_uniform_updates", []() -> benchmark_body {
+        uber_program_data_ptr d = make_shared<uber_program_data>();
+        return [d]() {
+            d->_context->bind_program(d->_uber_program);
+            for (unsigned i = 0; i < draw_count; ++i) {
+                for (unsigned c = 0; c < 3; ++c) {
+                    d->_uber_program->uniform(d->_names[(i * 3 + c) % uber_uniform_count], scm::math::vec4f(static_cast<float>(i)));
+                }
+                d->_context->apply();
+                d->_context->draw_arrays(gl::PRIMITIVE_TRIANGLE_LIST, 0, 3);
+            }
+        };
+    }, draw_count);
+
+    r.add("render/null_uber_program_uniform_handle_updates", []() -> benchmark_body {
+        uber_program_data_ptr d = make_shared<uber_program_data>();
+        return [d]() {
+            d->_context->bind_program(d->_uber_program);
+            for (unsigned i = 0; i < draw_count; ++i) {
+                for (unsigned c = 0; c < 3; ++c) {
+                    d->_uber_program->uniform(d->_handles[(i * 3 + c) % uber_uniform_count], scm::math::vec4f(static_cast<float>(i)));
+                }
+                d->_context->apply();
+                d->_context->draw_arrays(gl::PRIMITIVE_TRIANGLE_LIST, 0, 3);
+            }
+        };
+    }, draw_count);
+
+    r.add("render/null_shader_permutations", []() -> benchmark_body {
+        shader_permutation_data_ptr d = make_shared<shader_permutation_data>();
+        return [d]() {
+            for (unsigned p = 0; p < shader_permutation_count; ++p) {
+                d->_device->create_shader(gl::STAGE_FRAGMENT_SHADER, d->_source, d->_macros[p], "permutation.glsl");
+            }
+        };
+    }, shader_permutation_count);
+
+    r.add("render/null_command_buffer_record_replay", []() -> benchmark_body {
+        render_data_ptr d = make_shared<render_data>();
+        return [d]() {
+            d->_command_buffer->reset();
+            d->_command_buffer->bind_program(d->_program);
+            for (unsigned i = 0; i < draw_count; ++i) {
+                d->_command_buffer->bind_texture(d->_textures[(i / 2) % texture_count], d->_sampler, i % 2);
+                d->_command_buffer->draw_arrays(gl::PRIMITIVE_TRIANGLE_LIST, 0, 3);
+            }
+            d->_context->execute(*d->_command_buffer);
+        };
+    }, draw_count);
+}
+
+} // namespace bench
+} // namespace scm
@@ -0,0 +1,258 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include "benchmark.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+#include <stdexcept>
+
+#include <boost/io/ios_state.hpp>
+
+#include <scm/core/version.h>
+#include <scm/core/time/high_res_timer.h>
+
+namespace {
+
+scm::time::nanosec_type
+elapsed_nanoseconds(const scm::time::high_res_timer& t)
+{
+    return static_cast<scm::time::nanosec_type>(t.get_time().total_nanoseconds());
+}
+
+void
+write_json_string(std::ostream& os, const std::string& s)
+{
+    os << '"';
+    for (std::string::const_iterator c = s.begin(); c != s.end(); ++c) {
+        switch (*c) {
+            case '"':  os << "\\\""; break;
+            case '\\': os << "\\\\"; break;
+            default:   os << *c;
+        }
+    }
+    os << '"';
+}
+
+} // namespace
+
+namespace scm {
+namespace bench {
+
+namespace detail {
+
+void
+use_pointer(const volatile void*)
+{
+}
+
+} // namespace detail
+
+benchmark_result::benchmark_result()
+  : _iterations(0)
+  , _batch_size(0)
+  , _mean(0)
+  , _items_per_second(0.0)
+  , _bytes_per_second(0.0)
+{
+}
+
+run_options::run_options()
+  : _min_time(0.5)
+  , _min_batches(10)
+  , _max_batches(100000)
+  , _batch_time(0.001)
+{
+}
+
+benchmark_registry::benchmark_registry()
+{
+}
+
+void
+benchmark_registry::add(const std::string&          name,
+                        const benchmark_fixture&    fixture,
+                        scm::uint64                 items_per_iteration,
+                        scm::uint64                 bytes_per_iteration)
+{
+    benchmark_case c;
+    c._name                = name;
+    c._fixture             = fixture;
+    c._items_per_iteration = items_per_iteration;
+    c._bytes_per_iteration = bytes_per_iteration;
+
+    _cases.push_back(c);
+}
+
+const benchmark_registry::case_container&
+benchmark_registry::cases() const
+{
+    return _cases;
+}
+
+void
+benchmark_registry::run(const run_options&  opt,
+                        result_container&   results) const
+{
+    for (case_container::const_iterator c = _cases.begin(); c != _cases.end(); ++c) {
+        if (   opt._filter.empty()
+            || c->_name.find(opt._filter) != std::string::npos) {
+            results.push_back(run_case(*c, opt));
+        }
+    }
+}
+
+benchmark_result
+benchmark_registry::run_case(const benchmark_case&  c,
+                             const run_options&     opt) const
+{
+    using time::nanosec_type;
+
+    benchmark_body body = c._fixture();
+    if (!body) {
+        throw std::runtime_error("benchmark_registry::run_case(): fixture returned no body for benchmark: " + c._name);
+    }
+
+    time::high_res_timer    timer(time::timer_interface::nano_seconds);
+    const nanosec_type      batch_target = static_cast<nanosec_type>(opt._batch_time * 1.0e9);
+    const nanosec_type      min_time     = static_cast<nanosec_type>(opt._min_time * 1.0e9);
+
+    // warm up caches and lazy initializations
+    body();
+
+    // grow the batch until a single batch is long enough to be measured reliably
+    scm::uint64 batch_size = 1;
+    for (;;) {
+        timer.start();
+        for (scm::uint64 i = 0; i < batch_size; ++i) {
+            body();
+        }
+        timer.stop();
+
+        const nanosec_type t = elapsed_nanoseconds(timer);
+        if (t >= batch_target || batch_size >= (scm::uint64(1) << 30)) {
+            break;
+        }
+        const scm::uint64 estimate = (t > 0) ? static_cast<scm::uint64>(batch_size * (1.2 * batch_target / t)) : 0;
+        batch_size = std::max(batch_size * 2, std::min(estimate, batch_size * 100));
+    }
+
+    time::time_histogram    histogram;
+    scm::uint64             batches    = 0;
+    nanosec_type            total_time = 0;
+
+    while (   batches < opt._max_batches
+           && (total_time < min_time || batches < opt._min_batches)) {
+        timer.start();
+        for (scm::uint64 i = 0; i < batch_size; ++i) {
+            body();
+        }
+        timer.stop();
+
+        const nanosec_type t = elapsed_nanoseconds(timer);
+        histogram.record(t / static_cast<nanosec_type>(batch_size));
+        total_time += t;
+        ++batches;
+    }
+
+    benchmark_result r;
+    r._name       = c._name;
+    r._batch_size = batch_size;
+    r._iterations = batches * batch_size;
+    r._mean       = total_time / static_cast<nanosec_type>(r._iterations);
+    r._statistics = histogram.statistics();
+
+    if (total_time > 0) {
+        const double s = static_cast<double>(total_time) * 1.0e-9;
+        r._items_per_second = static_cast<double>(c._items_per_iteration * r._iterations) / s;
+        r._bytes_per_second = static_cast<double>(c._bytes_per_iteration * r._iterations) / s;
+    }
+
+    return r;
+}
+
+void
+write_results_text(std::ostream& os, const benchmark_registry::result_container& r)
+{
+    boost::io::ios_all_saver saved_state(os);
+
+    os << std::left  << std::setw(48) << "benchmark"
+       << std::right << std::setw(12) << "mean ns"
+                     << std::setw(12) << "p50 ns"
+                     << std::setw(12) << "p95 ns"
+                     << std::setw(12) << "p99 ns"
+                     << std::setw(14) << "items/s"
+                     << std::setw(14) << "MiB/s" << std::endl;
+
+    for (benchmark_registry::result_container::const_iterator b = r.begin(); b != r.end(); ++b) {
+        os << std::left  << std::setw(48) << b->_name
+           << std::right << std::setw(12) << b->_mean
+                         << std::setw(12) << b->_statistics._p50
+                         << std::setw(12) << b->_statistics._p95
+                         << std::setw(12) << b->_statistics._p99
+                         << std::setw(14) << std::scientific << std::setprecision(3) << b->_items_per_second
+                         << std::setw(14) << std::fixed      << std::setprecision(1) << b->_bytes_per_second / (1024.0 * 1024.0)
+                         << std::endl;
+    }
+}
+
+void
+write_results_csv(std::ostream& os, const benchmark_registry::result_container& r)
+{
+    boost::io::ios_all_saver saved_state(os);
+
+    os << "name,iterations,batch_size,mean_ns,min_ns,p50_ns,p95_ns,p99_ns,max_ns,items_per_second,bytes_per_second" << std::endl;
+    os << std::fixed << std::setprecision(1);
+    for (benchmark_registry::result_container::const_iterator b = r.begin(); b != r.end(); ++b) {
+        os << b->_name << ","
+           << b->_iterations << ","
+           << b->_batch_size << ","
+           << b->_mean << ","
+           << b->_statistics._min << ","
+           << b->_statistics._p50 << ","
+           << b->_statistics._p95 << ","
+           << b->_statistics._p99 << ","
+           << b->_statistics._max << ","
+           << b->_items_per_second << ","
+           << b->_bytes_per_second << std::endl;
+    }
+}
+
+void
+write_results_json(std::ostream& os, const benchmark_registry::result_container& r)
+{
+    boost::io::ios_all_saver saved_state(os);
+
+    os << std::fixed << std::setprecision(1)
+       << "{" << std::endl
+       << "  \"schism_version\": \"" << VERSION_MAJOR << "." << VERSION_MINOR << "." << VERSION_REVISION
+                                     << "-" << VERSION_TAG << "\"," << std::endl
+       << "  \"build\": \"" << VERSION_BUILD_TAG << "\"," << std::endl
+       << "  \"architecture\": \"" << VERSION_ARCH_TAG << "\"," << std::endl
+       << "  \"benchmarks\": [";
+
+    for (benchmark_registry::result_container::const_iterator b = r.begin(); b != r.end(); ++b) {
+        os << ((b == r.begin()) ? "" : ",") << std::endl
+           << "    {\"name\": ";
+        write_json_string(os, b->_name);
+        os << ", \"iterations\": "       << b->_iterations
+           << ", \"batch_size\": "       << b->_batch_size
+           << ", \"mean_ns\": "          << b->_mean
+           << ", \"min_ns\": "           << b->_statistics._min
+           << ", \"p50_ns\": "           << b->_statistics._p50
+           << ", \"p95_ns\": "           << b->_statistics._p95
+           << ", \"p99_ns\": "           << b->_statistics._p99
+           << ", \"max_ns\": "           << b->_statistics._max
+           << ", \"items_per_second\": " << b->_items_per_second
+           << ", \"bytes_per_second\": " << b->_bytes_per_second
+           << "}";
+    }
+    os << std::endl
+       << "  ]" << std::endl
+       << "}" << std::endl;
+}
+
+} // namespace bench
+} // namespace scm
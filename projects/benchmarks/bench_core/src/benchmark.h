@@ -0,0 +1,113 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_BENCH_BENCHMARK_H_INCLUDED
+#define SCM_BENCH_BENCHMARK_H_INCLUDED
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include <boost/function.hpp>
+
+#include <scm/core/numeric_types.h>
+#include <scm/core/platform/platform.h>
+#include <scm/core/time/time_histogram.h>
+#include <scm/core/time/time_types.h>
+
+namespace scm {
+namespace bench {
+
+namespace detail {
+
+void use_pointer(const volatile void* p);
+
+} // namespace detail
+
+// keep the compiler from eliding computations whose results are never used
+template<typename T>
+inline void
+do_not_optimize(const T& v)
+{
+#if SCM_COMPILER == SCM_COMPILER_GNUC
+    asm volatile("" : : "g"(&v) : "memory");
+#else
+    detail::use_pointer(&v);
+#endif
+}
+
+// a benchmark body executes one iteration of the measured operation
+typedef boost::function<void ()>            benchmark_body;
+// a fixture is only invoked for selected benchmarks, it prepares the data
+// and returns the body capturing it
+typedef boost::function<benchmark_body ()>  benchmark_fixture;
+
+struct benchmark_case
+{
+    std::string             _name;
+    benchmark_fixture       _fixture;
+    scm::uint64             _items_per_iteration;
+    scm::uint64             _bytes_per_iteration;
+}; // struct benchmark_case
+
+struct benchmark_result
+{
+    benchmark_result();
+
+    std::string             _name;
+    scm::uint64             _iterations;
+    scm::uint64             _batch_size;
+    time::nanosec_type      _mean;          // per iteration
+    time::time_statistics   _statistics;    // per iteration, sampled per batch
+    double                  _items_per_second;
+    double                  _bytes_per_second;
+}; // struct benchmark_result
+
+struct run_options
+{
+    run_options();
+
+    std::string             _filter;        // substring match on the case names
+    double                  _min_time;      // seconds per case
+    scm::uint64             _min_batches;
+    scm::uint64             _max_batches;
+    double                  _batch_time;    // target seconds per timed batch
+}; // struct run_options
+
+class benchmark_registry
+{
+public:
+    typedef std::vector<benchmark_case>     case_container;
+    typedef std::vector<benchmark_result>   result_container;
+
+public:
+    benchmark_registry();
+
+    void                    add(const std::string&          name,
+                                const benchmark_fixture&    fixture,
+                                scm::uint64                 items_per_iteration = 1,
+                                scm::uint64                 bytes_per_iteration = 0);
+
+    const case_container&   cases() const;
+
+    void                    run(const run_options&  opt,
+                                result_container&   results) const;
+
+protected:
+    benchmark_result        run_case(const benchmark_case&  c,
+                                     const run_options&     opt) const;
+
+protected:
+    case_container          _cases;
+
+}; // class benchmark_registry
+
+void write_results_text(std::ostream& os, const benchmark_registry::result_container& r);
+void write_results_csv(std::ostream& os, const benchmark_registry::result_container& r);
+void write_results_json(std::ostream& os, const benchmark_registry::result_container& r);
+
+} // namespace bench
+} // namespace scm
+
+#endif // SCM_BENCH_BENCHMARK_H_INCLUDED
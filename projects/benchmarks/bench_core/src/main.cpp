@@ -0,0 +1,134 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/program_options.hpp>
+
+#include <scm/core.h>
+#include <scm/log.h>
+#include <scm/core/module/initializer.h>
+
+#include "benchmark.h"
+#include "bench_cases.h"
+
+namespace {
+
+std::string     bench_filter;
+std::string     bench_format;
+std::string     bench_output;
+std::string     bench_data_dir;
+double          bench_min_time  = 0.5;
+bool            bench_list      = false;
+
+} // namespace
+
+static const std::string    scm_application_name = "schism benchmarks: core";
+
+static bool initialize_cmd_line(scm::core& c)
+{
+    using boost::program_options::options_description;
+    using boost::program_options::value;
+
+    options_description  cmd_options("program options");
+
+    cmd_options.add_options()
+        ("filter,f",    value<std::string>(&bench_filter),                                  "run only benchmarks containing this string")
+        ("min_time,t",  value<double>(&bench_min_time)->default_value(0.5),                 "minimum measuring time per benchmark in seconds")
+        ("format",      value<std::string>(&bench_format)->default_value("json"),           "result file format (json, csv, text)")
+        ("output,o",    value<std::string>(&bench_output),                                  "result file, '-' for standard output")
+        ("data_dir,d",  value<std::string>(&bench_data_dir),                                "directory for generated input files (default: system temp directory)")
+        ("list,l",      value<bool>(&bench_list)->zero_tokens(),                            "list the available benchmarks");
+
+    c.add_command_line_options(cmd_options, scm_application_name);
+
+    return (true);
+}
+
+static void init_module()
+{
+    scm::module::initializer::add_pre_core_init_function(initialize_cmd_line);
+}
+
+static scm::module::static_initializer  static_initialize(init_module);
+
+int main(int argc, char **argv)
+{
+    using namespace scm::bench;
+
+    std::ios_base::sync_with_stdio(false);
+
+    try {
+        scm::shared_ptr<scm::core>      scm_core(new scm::core(argc, argv));
+
+        if (bench_data_dir.empty()) {
+            bench_data_dir = boost::filesystem::temp_directory_path().string();
+        }
+
+        benchmark_registry  registry;
+        register_math_benchmarks(registry);
+        register_primitive_benchmarks(registry);
+        register_render_benchmarks(registry);
+        register_imaging_benchmarks(registry);
+        register_volume_benchmarks(registry, bench_data_dir);
+        register_wavefront_obj_benchmarks(registry, bench_data_dir);
+        register_byte_swap_benchmarks(registry);
+        register_log_benchmarks(registry);
+
+        if (bench_list) {
+            for (benchmark_registry::case_container::const_iterator c = registry.cases().begin();
+                 c != registry.cases().end(); ++c) {
+                std::cout << c->_name << std::endl;
+            }
+            return 0;
+        }
+
+        run_options opt;
+        opt._filter   = bench_filter;
+        opt._min_time = bench_min_time;
+
+        benchmark_registry::result_container results;
+        registry.run(opt, results);
+
+        write_results_text(std::cout, results);
+
+        if (!bench_output.empty()) {
+            std::ofstream   out_file;
+            std::ostream*   out = &std::cout;
+
+            if (bench_output != "-") {
+                out_file.open(bench_output.c_str(), std::ios_base::out | std::ios_base::trunc);
+                if (!out_file) {
+                    std::cerr << "unable to open result file: " << bench_output << std::endl;
+                    return -1;
+                }
+                out = &out_file;
+            }
+
+            if (bench_format == "json") {
+                write_results_json(*out, results);
+            }
+            else if (bench_format == "csv") {
+                write_results_csv(*out, results);
+            }
+            else if (bench_format == "text") {
+                write_results_text(*out, results);
+            }
+            else {
+                std::cerr << "unknown result format: " << bench_format << std::endl;
+                return -1;
+            }
+        }
+    }
+    catch (std::exception& e) {
+        std::cerr << "benchmark error: " << e.what() << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
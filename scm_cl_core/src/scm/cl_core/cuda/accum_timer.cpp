@@ -114,6 +114,7 @@ accum_timer::collect()
             _detailed_accumulated_time.user   += _detailed_last_time.user;
             _detailed_accumulated_time.system += _detailed_last_time.system;
 
+            record_statistics(_last_time);
             ++_accumulation_count;
             _cu_event_finished  = true;
             _cu_event_srecorded = false;
@@ -154,6 +155,7 @@ accum_timer::force_collect()
         _detailed_accumulated_time.user   += _detailed_last_time.user;
         _detailed_accumulated_time.system += _detailed_last_time.system;
 
+        record_statistics(_last_time);
         ++_accumulation_count;
         _cu_event_finished  = true;
         _cu_event_srecorded = false;
@@ -170,6 +172,7 @@ accum_timer::update(int interval)
         _update_interval = 0;
 
         _average_time = (_accumulation_count > 0) ? _accumulated_time / _accumulation_count : 0;
+        update_statistics();
 
         _detailed_average_time.cuda =
         _detailed_average_time.wall =
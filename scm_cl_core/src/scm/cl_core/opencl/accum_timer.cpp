@@ -88,6 +88,7 @@ accum_timer::collect()
         _detailed_accumulated_time.user   += _detailed_last_time.user;
         _detailed_accumulated_time.system += _detailed_last_time.system;
 
+        record_statistics(_last_time);
         ++_accumulation_count;
         _cl_event_finished = true;
     }
@@ -119,6 +120,7 @@ accum_timer::force_collect()
     _detailed_accumulated_time.user   += _detailed_last_time.user;
     _detailed_accumulated_time.system += _detailed_last_time.system;
 
+    record_statistics(_last_time);
     ++_accumulation_count;
     _cl_event_finished = true;
 }
@@ -132,6 +134,7 @@ accum_timer::update(int interval)
         _update_interval = 0;
 
         _average_time = (_accumulation_count > 0) ? _accumulated_time / _accumulation_count : 0;
+        update_statistics();
 
         _detailed_average_time.cl =
         _detailed_average_time.wall =
@@ -0,0 +1,10 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_CORE_CONFIG_H
+#define SCM_CORE_CONFIG_H
+
+#define SCM_ENABLE_CUDA_CL_SUPPORT 0
+
+#endif  // SCM_CORE_CONFIG_H
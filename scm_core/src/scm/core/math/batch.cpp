@@ -0,0 +1,326 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include "batch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <scm/core/utilities/boost_warning_disable.h>
+#include <boost/thread/mutex.hpp>
+#include <scm/core/utilities/boost_warning_enable.h>
+
+#include <scm/core/utilities/thread_pool.h>
+
+#if SCM_CORE_MATH_SIMD == SCM_CORE_MATH_SIMD_SSE
+#include <xmmintrin.h>
+#endif // SCM_CORE_MATH_SIMD == SCM_CORE_MATH_SIMD_SSE
+
+namespace {
+
+using scm::math::const_vec3f_stream;
+using scm::math::vec3f_stream;
+using scm::math::const_box3f_stream;
+using scm::math::box3f_stream;
+
+// smaller batches are not worth the synchronization with the pool threads
+const scm::size_t parallel_grain = 16 * 1024;
+
+template<typename range_kernel>
+void
+dispatch(scm::thread_pool* pool, scm::size_t n, const range_kernel& k)
+{
+    if (pool) {
+        pool->parallel_for(0, n, parallel_grain, k);
+    }
+    else {
+        k(0, n);
+    }
+}
+
+// affine 3x4 part of a column major matrix, w selects points (1) or vectors (0)
+void
+transform_range(const float*              m,
+                float                     w,
+                const const_vec3f_stream& in,
+                const vec3f_stream&       out,
+                scm::size_t               b,
+                scm::size_t               e)
+{
+    scm::size_t i = b;
+#if SCM_CORE_MATH_SIMD == SCM_CORE_MATH_SIMD_SSE
+    const __m128 m0 = _mm_set1_ps(m[0]), m1 = _mm_set1_ps(m[1]), m2  = _mm_set1_ps(m[2]);
+    const __m128 m4 = _mm_set1_ps(m[4]), m5 = _mm_set1_ps(m[5]), m6  = _mm_set1_ps(m[6]);
+    const __m128 m8 = _mm_set1_ps(m[8]), m9 = _mm_set1_ps(m[9]), m10 = _mm_set1_ps(m[10]);
+    const __m128 tx = _mm_set1_ps(m[12] * w);
+    const __m128 ty = _mm_set1_ps(m[13] * w);
+    const __m128 tz = _mm_set1_ps(m[14] * w);
+
+    for (; i + 4 <= e; i += 4) {
+        const __m128 x = _mm_loadu_ps(in.x + i);
+        const __m128 y = _mm_loadu_ps(in.y + i);
+        const __m128 z = _mm_loadu_ps(in.z + i);
+
+        _mm_storeu_ps(out.x + i, _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m0, x), _mm_mul_ps(m4, y)), _mm_mul_ps(m8,  z)), tx));
+        _mm_storeu_ps(out.y + i, _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m1, x), _mm_mul_ps(m5, y)), _mm_mul_ps(m9,  z)), ty));
+        _mm_storeu_ps(out.z + i, _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m2, x), _mm_mul_ps(m6, y)), _mm_mul_ps(m10, z)), tz));
+    }
+#endif // SCM_CORE_MATH_SIMD == SCM_CORE_MATH_SIMD_SSE
+    for (; i < e; ++i) {
+        const float x = in.x[i];
+        const float y = in.y[i];
+        const float z = in.z[i];
+
+        out.x[i] = m[0] * x + m[4] * y + m[ 8] * z + m[12] * w;
+        out.y[i] = m[1] * x + m[5] * y + m[ 9] * z + m[13] * w;
+        out.z[i] = m[2] * x + m[6] * y + m[10] * z + m[14] * w;
+    }
+}
+
+void
+normalize_range(const const_vec3f_stream& in,
+                const vec3f_stream&       out,
+                scm::size_t               b,
+                scm::size_t               e)
+{
+    scm::size_t i = b;
+#if SCM_CORE_MATH_SIMD == SCM_CORE_MATH_SIMD_SSE
+    for (; i + 4 <= e; i += 4) {
+        const __m128 x = _mm_loadu_ps(in.x + i);
+        const __m128 y = _mm_loadu_ps(in.y + i);
+        const __m128 z = _mm_loadu_ps(in.z + i);
+        const __m128 l = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+
+        _mm_storeu_ps(out.x + i, _mm_div_ps(x, l));
+        _mm_storeu_ps(out.y + i, _mm_div_ps(y, l));
+        _mm_storeu_ps(out.z + i, _mm_div_ps(z, l));
+    }
+#endif // SCM_CORE_MATH_SIMD == SCM_CORE_MATH_SIMD_SSE
+    for (; i < e; ++i) {
+        const float x = in.x[i];
+        const float y = in.y[i];
+        const float z = in.z[i];
+        const float l = std::sqrt(x * x + y * y + z * z);
+
+        out.x[i] = x / l;
+        out.y[i] = y / l;
+        out.z[i] = z / l;
+    }
+}
+
+// transformed center plus the extent projected by the absolute matrix (arvo)
+void
+transform_boxes_range(const float*              m,
+                      const const_box3f_stream& in,
+                      const box3f_stream&       out,
+                      scm::size_t               b,
+                      scm::size_t               e)
+{
+    float a[12];
+    for (unsigned c = 0; c < 3; ++c) {
+        for (unsigned r = 0; r < 3; ++r) {
+            a[c * 4 + r] = std::fabs(m[c * 4 + r]);
+        }
+    }
+
+    scm::size_t i = b;
+#if SCM_CORE_MATH_SIMD == SCM_CORE_MATH_SIMD_SSE
+    const __m128 m0 = _mm_set1_ps(m[0]), m1 = _mm_set1_ps(m[1]), m2  = _mm_set1_ps(m[2]);
+    const __m128 m4 = _mm_set1_ps(m[4]), m5 = _mm_set1_ps(m[5]), m6  = _mm_set1_ps(m[6]);
+    const __m128 m8 = _mm_set1_ps(m[8]), m9 = _mm_set1_ps(m[9]), m10 = _mm_set1_ps(m[10]);
+    const __m128 tx = _mm_set1_ps(m[12]), ty = _mm_set1_ps(m[13]), tz = _mm_set1_ps(m[14]);
+    const __m128 a0 = _mm_set1_ps(a[0]), a1 = _mm_set1_ps(a[1]), a2  = _mm_set1_ps(a[2]);
+    const __m128 a4 = _mm_set1_ps(a[4]), a5 = _mm_set1_ps(a[5]), a6  = _mm_set1_ps(a[6]);
+    const __m128 a8 = _mm_set1_ps(a[8]), a9 = _mm_set1_ps(a[9]), a10 = _mm_set1_ps(a[10]);
+    const __m128 half = _mm_set1_ps(0.5f);
+
+    for (; i + 4 <= e; i += 4) {
+        const __m128 lx = _mm_loadu_ps(in.min.x + i);
+        const __m128 ly = _mm_loadu_ps(in.min.y + i);
+        const __m128 lz = _mm_loadu_ps(in.min.z + i);
+        const __m128 ux = _mm_loadu_ps(in.max.x + i);
+        const __m128 uy = _mm_loadu_ps(in.max.y + i);
+        const __m128 uz = _mm_loadu_ps(in.max.z + i);
+
+        const __m128 cx = _mm_mul_ps(_mm_add_ps(lx, ux), half);
+        const __m128 cy = _mm_mul_ps(_mm_add_ps(ly, uy), half);
+        const __m128 cz = _mm_mul_ps(_mm_add_ps(lz, uz), half);
+        const __m128 ex = _mm_mul_ps(_mm_sub_ps(ux, lx), half);
+        const __m128 ey = _mm_mul_ps(_mm_sub_ps(uy, ly), half);
+        const __m128 ez = _mm_mul_ps(_mm_sub_ps(uz, lz), half);
+
+        const __m128 ncx = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m0, cx), _mm_mul_ps(m4, cy)), _mm_mul_ps(m8,  cz)), tx);
+        const __m128 ncy = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m1, cx), _mm_mul_ps(m5, cy)), _mm_mul_ps(m9,  cz)), ty);
+        const __m128 ncz = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m2, cx), _mm_mul_ps(m6, cy)), _mm_mul_ps(m10, cz)), tz);
+        const __m128 nex = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a0, ex), _mm_mul_ps(a4, ey)), _mm_mul_ps(a8,  ez));
+        const __m128 ney = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a1, ex), _mm_mul_ps(a5, ey)), _mm_mul_ps(a9,  ez));
+        const __m128 nez = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a2, ex), _mm_mul_ps(a6, ey)), _mm_mul_ps(a10, ez));
+
+        _mm_storeu_ps(out.min.x + i, _mm_sub_ps(ncx, nex));
+        _mm_storeu_ps(out.min.y + i, _mm_sub_ps(ncy, ney));
+        _mm_storeu_ps(out.min.z + i, _mm_sub_ps(ncz, nez));
+        _mm_storeu_ps(out.max.x + i, _mm_add_ps(ncx, nex));
+        _mm_storeu_ps(out.max.y + i, _mm_add_ps(ncy, ney));
+        _mm_storeu_ps(out.max.z + i, _mm_add_ps(ncz, nez));
+    }
+#endif // SCM_CORE_MATH_SIMD == SCM_CORE_MATH_SIMD_SSE
+    for (; i < e; ++i) {
+        const float cx = (in.min.x[i] + in.max.x[i]) * 0.5f;
+        const float cy = (in.min.y[i] + in.max.y[i]) * 0.5f;
+        const float cz = (in.min.z[i] + in.max.z[i]) * 0.5f;
+        const float ex = (in.max.x[i] - in.min.x[i]) * 0.5f;
+        const float ey = (in.max.y[i] - in.min.y[i]) * 0.5f;
+        const float ez = (in.max.z[i] - in.min.z[i]) * 0.5f;
+
+        const float ncx = m[0] * cx + m[4] * cy + m[ 8] * cz + m[12];
+        const float ncy = m[1] * cx + m[5] * cy + m[ 9] * cz + m[13];
+        const float ncz = m[2] * cx + m[6] * cy + m[10] * cz + m[14];
+        const float nex = a[0] * ex + a[4] * ey + a[ 8] * ez;
+        const float ney = a[1] * ex + a[5] * ey + a[ 9] * ez;
+        const float nez = a[2] * ex + a[6] * ey + a[10] * ez;
+
+        out.min.x[i] = ncx - nex;
+        out.min.y[i] = ncy - ney;
+        out.min.z[i] = ncz - nez;
+        out.max.x[i] = ncx + nex;
+        out.max.y[i] = ncy + ney;
+        out.max.z[i] = ncz + nez;
+    }
+}
+
+void
+min_max_range(const const_vec3f_stream& in,
+              scm::size_t               b,
+              scm::size_t               e,
+              float*                    rmin,
+              float*                    rmax)
+{
+    scm::size_t i = b;
+#if SCM_CORE_MATH_SIMD == SCM_CORE_MATH_SIMD_SSE
+    if (i + 4 <= e) {
+        __m128 nx = _mm_loadu_ps(in.x + i), xx = nx;
+        __m128 ny = _mm_loadu_ps(in.y + i), xy = ny;
+        __m128 nz = _mm_loadu_ps(in.z + i), xz = nz;
+
+        for (i += 4; i + 4 <= e; i += 4) {
+            const __m128 x = _mm_loadu_ps(in.x + i);
+            const __m128 y = _mm_loadu_ps(in.y + i);
+            const __m128 z = _mm_loadu_ps(in.z + i);
+            nx = _mm_min_ps(nx, x); xx = _mm_max_ps(xx, x);
+            ny = _mm_min_ps(ny, y); xy = _mm_max_ps(xy, y);
+            nz = _mm_min_ps(nz, z); xz = _mm_max_ps(xz, z);
+        }
+
+        float l[4];
+        _mm_storeu_ps(l, nx); rmin[0] = std::min(rmin[0], std::min(std::min(l[0], l[1]), std::min(l[2], l[3])));
+        _mm_storeu_ps(l, ny); rmin[1] = std::min(rmin[1], std::min(std::min(l[0], l[1]), std::min(l[2], l[3])));
+        _mm_storeu_ps(l, nz); rmin[2] = std::min(rmin[2], std::min(std::min(l[0], l[1]), std::min(l[2], l[3])));
+        _mm_storeu_ps(l, xx); rmax[0] = std::max(rmax[0], std::max(std::max(l[0], l[1]), std::max(l[2], l[3])));
+        _mm_storeu_ps(l, xy); rmax[1] = std::max(rmax[1], std::max(std::max(l[0], l[1]), std::max(l[2], l[3])));
+        _mm_storeu_ps(l, xz); rmax[2] = std::max(rmax[2], std::max(std::max(l[0], l[1]), std::max(l[2], l[3])));
+    }
+#endif // SCM_CORE_MATH_SIMD == SCM_CORE_MATH_SIMD_SSE
+    for (; i < e; ++i) {
+        rmin[0] = std::min(rmin[0], in.x[i]); rmax[0] = std::max(rmax[0], in.x[i]);
+        rmin[1] = std::min(rmin[1], in.y[i]); rmax[1] = std::max(rmax[1], in.y[i]);
+        rmin[2] = std::min(rmin[2], in.z[i]); rmax[2] = std::max(rmax[2], in.z[i]);
+    }
+}
+
+} // namespace
+
+namespace scm {
+namespace math {
+
+void
+transform_points(const mat<float, 4, 4>&  m,
+                 const const_vec3f_stream& in,
+                 const vec3f_stream&       out,
+                 scm::size_t               n,
+                 thread_pool*              pool)
+{
+    dispatch(pool, n, [&m, &in, &out](scm::size_t b, scm::size_t e) {
+        transform_range(m.data_array, 1.0f, in, out, b, e);
+    });
+}
+
+void
+transform_vectors(const mat<float, 4, 4>&  m,
+                  const const_vec3f_stream& in,
+                  const vec3f_stream&       out,
+                  scm::size_t               n,
+                  thread_pool*              pool)
+{
+    dispatch(pool, n, [&m, &in, &out](scm::size_t b, scm::size_t e) {
+        transform_range(m.data_array, 0.0f, in, out, b, e);
+    });
+}
+
+void
+transform_normals(const mat<float, 4, 4>&  m,
+                  const const_vec3f_stream& in,
+                  const vec3f_stream&       out,
+                  scm::size_t               n,
+                  thread_pool*              pool)
+{
+    const mat<float, 4, 4> nm = transpose(inverse(m));
+
+    dispatch(pool, n, [&nm, &in, &out](scm::size_t b, scm::size_t e) {
+        transform_range(nm.data_array, 0.0f, in, out, b, e);
+        normalize_range(out, out, b, e);
+    });
+}
+
+void
+transform_boxes(const mat<float, 4, 4>&  m,
+                const const_box3f_stream& in,
+                const box3f_stream&       out,
+                scm::size_t               n,
+                thread_pool*              pool)
+{
+    dispatch(pool, n, [&m, &in, &out](scm::size_t b, scm::size_t e) {
+        transform_boxes_range(m.data_array, in, out, b, e);
+    });
+}
+
+void
+normalize(const const_vec3f_stream& in,
+          const vec3f_stream&       out,
+          scm::size_t               n,
+          thread_pool*              pool)
+{
+    dispatch(pool, n, [&in, &out](scm::size_t b, scm::size_t e) {
+        normalize_range(in, out, b, e);
+    });
+}
+
+void
+min_max(const const_vec3f_stream& in,
+        scm::size_t               n,
+        vec<float, 3>&            out_min,
+        vec<float, 3>&            out_max,
+        thread_pool*              pool)
+{
+    out_min = vec<float, 3>( (std::numeric_limits<float>::max)());
+    out_max = vec<float, 3>(-(std::numeric_limits<float>::max)());
+
+    boost::mutex    result_mutex;
+
+    dispatch(pool, n, [&in, &out_min, &out_max, &result_mutex](scm::size_t b, scm::size_t e) {
+        float rmin[3] = { (std::numeric_limits<float>::max)(),  (std::numeric_limits<float>::max)(),  (std::numeric_limits<float>::max)()};
+        float rmax[3] = {-(std::numeric_limits<float>::max)(), -(std::numeric_limits<float>::max)(), -(std::numeric_limits<float>::max)()};
+
+        min_max_range(in, b, e, rmin, rmax);
+
+        boost::mutex::scoped_lock lock(result_mutex);
+        for (unsigned c = 0; c < 3; ++c) {
+            out_min[c] = std::min(out_min[c], rmin[c]);
+            out_max[c] = std::max(out_max[c], rmax[c]);
+        }
+    });
+}
+
+} // namespace math
+} // namespace scm
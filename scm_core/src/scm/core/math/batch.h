@@ -0,0 +1,97 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_CORE_MATH_BATCH_H_INCLUDED
+#define SCM_CORE_MATH_BATCH_H_INCLUDED
+
+#include <scm/core/numeric_types.h>
+#include <scm/core/math.h>
+
+#include <scm/core/platform/platform.h>
+#include <scm/core/utilities/platform_warning_disable.h>
+
+namespace scm {
+
+class thread_pool;
+
+namespace math {
+
+// structure of arrays view onto n three component vectors
+template<typename scal_type>
+struct vec3_stream
+{
+    vec3_stream(scal_type* sx, scal_type* sy, scal_type* sz) : x(sx), y(sy), z(sz) {}
+    template<typename rhs_scal_t>
+    vec3_stream(const vec3_stream<rhs_scal_t>& s) : x(s.x), y(s.y), z(s.z) {}
+
+    scal_type*  x;
+    scal_type*  y;
+    scal_type*  z;
+}; // struct vec3_stream
+
+// structure of arrays view onto n axis aligned boxes
+template<typename scal_type>
+struct box3_stream
+{
+    box3_stream(const vec3_stream<scal_type>& bmin, const vec3_stream<scal_type>& bmax) : min(bmin), max(bmax) {}
+    template<typename rhs_scal_t>
+    box3_stream(const box3_stream<rhs_scal_t>& s) : min(s.min), max(s.max) {}
+
+    vec3_stream<scal_type>  min;
+    vec3_stream<scal_type>  max;
+}; // struct box3_stream
+
+typedef vec3_stream<float>          vec3f_stream;
+typedef vec3_stream<const float>    const_vec3f_stream;
+typedef box3_stream<float>          box3f_stream;
+typedef box3_stream<const float>    const_box3f_stream;
+
+// batch kernels over n elements
+//  - output streams may be identical to the input streams (in place operation)
+//  - with a thread pool large batches are split across the pool threads
+__scm_export(core) void transform_points(const mat<float, 4, 4>&  m,
+                                         const const_vec3f_stream& in,
+                                         const vec3f_stream&       out,
+                                         scm::size_t               n,
+                                         thread_pool*              pool = 0);
+
+// directions, ignores the translation
+__scm_export(core) void transform_vectors(const mat<float, 4, 4>&  m,
+                                          const const_vec3f_stream& in,
+                                          const vec3f_stream&       out,
+                                          scm::size_t               n,
+                                          thread_pool*              pool = 0);
+
+// uses the inverse transpose of m and normalizes the results
+__scm_export(core) void transform_normals(const mat<float, 4, 4>&  m,
+                                          const const_vec3f_stream& in,
+                                          const vec3f_stream&       out,
+                                          scm::size_t               n,
+                                          thread_pool*              pool = 0);
+
+// axis aligned bounds of the transformed boxes
+__scm_export(core) void transform_boxes(const mat<float, 4, 4>&  m,
+                                        const const_box3f_stream& in,
+                                        const box3f_stream&       out,
+                                        scm::size_t               n,
+                                        thread_pool*              pool = 0);
+
+__scm_export(core) void normalize(const const_vec3f_stream& in,
+                                  const vec3f_stream&       out,
+                                  scm::size_t               n,
+                                  thread_pool*              pool = 0);
+
+// component wise minimum and maximum, an empty stream results in an inverted box (min > max)
+__scm_export(core) void min_max(const const_vec3f_stream& in,
+                                scm::size_t               n,
+                                vec<float, 3>&            out_min,
+                                vec<float, 3>&            out_max,
+                                thread_pool*              pool = 0);
+
+} // namespace math
+} // namespace scm
+
+#include <scm/core/utilities/platform_warning_enable.h>
+
+#endif // SCM_CORE_MATH_BATCH_H_INCLUDED
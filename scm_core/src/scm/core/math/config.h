@@ -12,4 +12,20 @@
 
 #define SCM_CORE_MATH_FP_PRECISION  SCM_CORE_MATH_FP_PRECISION_SINGLE
 
+// vector instruction set used for the vec<float, 4> and mat<float, 4, 4> specializations
+//  - SCM_CORE_MATH_SIMD overrides the detection, SCM_CORE_MATH_SIMD_NONE selects the
+//    generic scalar templates, the value changes the class layouts and must be set
+//    project wide (compiler definition) to the value scm_core was built with
+#define SCM_CORE_MATH_SIMD_NONE     0x00
+#define SCM_CORE_MATH_SIMD_SSE      0x01
+
+#ifndef SCM_CORE_MATH_SIMD
+#   if    defined(__SSE2__) || defined(_M_X64) \
+       || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#       define SCM_CORE_MATH_SIMD   SCM_CORE_MATH_SIMD_SSE
+#   else
+#       define SCM_CORE_MATH_SIMD   SCM_CORE_MATH_SIMD_NONE
+#   endif
+#endif // SCM_CORE_MATH_SIMD
+
 #endif // SCM_CORE_MATH_CONFIG_H_INCLUDED
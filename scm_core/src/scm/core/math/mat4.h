@@ -95,5 +95,6 @@ public:
 } // namespace scm
 
 #include "mat4.inl"
+#include "mat4_simd.inl"
 
 #endif // MATH_MAT4_H_INCLUDED
@@ -0,0 +1,260 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include <scm/core/math/config.h>
+
+#if SCM_CORE_MATH_SIMD == SCM_CORE_MATH_SIMD_SSE
+
+#include <xmmintrin.h>
+
+#include <scm/core/math/vec4.h>
+
+#define SCM_MATH_SSE_SWIZZLE(v, x, y, z, w)  _mm_shuffle_ps((v), (v), _MM_SHUFFLE((w), (z), (y), (x)))
+#define SCM_MATH_SSE_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps((a), (b), _MM_SHUFFLE((w), (z), (y), (x)))
+
+namespace scm {
+namespace math {
+namespace detail {
+
+// column major, c[i] holds column i
+struct mat4f_columns
+{
+    __m128  c[4];
+}; // struct mat4f_columns
+
+inline
+mat4f_columns
+load_mat4f(const mat<float, 4, 4>& m)
+{
+    mat4f_columns r;
+    r.c[0] = _mm_loadu_ps(m.data_array);
+    r.c[1] = _mm_loadu_ps(m.data_array + 4);
+    r.c[2] = _mm_loadu_ps(m.data_array + 8);
+    r.c[3] = _mm_loadu_ps(m.data_array + 12);
+    return (r);
+}
+
+inline
+void
+store_mat4f(mat<float, 4, 4>& m, const mat4f_columns& r)
+{
+    _mm_storeu_ps(m.data_array,      r.c[0]);
+    _mm_storeu_ps(m.data_array + 4,  r.c[1]);
+    _mm_storeu_ps(m.data_array + 8,  r.c[2]);
+    _mm_storeu_ps(m.data_array + 12, r.c[3]);
+}
+
+// linear combination of the columns of a, same summation order as the scalar loops
+inline
+__m128
+mat4f_mul_vec4f(const mat4f_columns& a, __m128 v)
+{
+    __m128 r =          _mm_mul_ps(a.c[0], SCM_MATH_SSE_SWIZZLE(v, 0, 0, 0, 0));
+    r = _mm_add_ps(r,   _mm_mul_ps(a.c[1], SCM_MATH_SSE_SWIZZLE(v, 1, 1, 1, 1)));
+    r = _mm_add_ps(r,   _mm_mul_ps(a.c[2], SCM_MATH_SSE_SWIZZLE(v, 2, 2, 2, 2)));
+    r = _mm_add_ps(r,   _mm_mul_ps(a.c[3], SCM_MATH_SSE_SWIZZLE(v, 3, 3, 3, 3)));
+    return (r);
+}
+
+inline
+void
+mat4f_mul(const mat<float, 4, 4>& lhs, const mat<float, 4, 4>& rhs, mat<float, 4, 4>& dst)
+{
+    // all inputs are loaded before the store, dst may alias lhs or rhs
+    const mat4f_columns a = load_mat4f(lhs);
+    const mat4f_columns b = load_mat4f(rhs);
+
+    mat4f_columns r;
+    r.c[0] = mat4f_mul_vec4f(a, b.c[0]);
+    r.c[1] = mat4f_mul_vec4f(a, b.c[1]);
+    r.c[2] = mat4f_mul_vec4f(a, b.c[2]);
+    r.c[3] = mat4f_mul_vec4f(a, b.c[3]);
+
+    store_mat4f(dst, r);
+}
+
+// 2x2 block helpers for the inverse, a 2x2 matrix is stored as (m00, m01, m10, m11)
+inline
+__m128
+mat2f_mul(__m128 a, __m128 b)
+{
+    return _mm_add_ps(_mm_mul_ps(a, SCM_MATH_SSE_SWIZZLE(b, 0, 3, 0, 3)),
+                      _mm_mul_ps(SCM_MATH_SSE_SWIZZLE(a, 1, 0, 3, 2), SCM_MATH_SSE_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+// adj(a) * b
+inline
+__m128
+mat2f_adj_mul(__m128 a, __m128 b)
+{
+    return _mm_sub_ps(_mm_mul_ps(SCM_MATH_SSE_SWIZZLE(a, 3, 3, 0, 0), b),
+                      _mm_mul_ps(SCM_MATH_SSE_SWIZZLE(a, 1, 1, 2, 2), SCM_MATH_SSE_SWIZZLE(b, 2, 3, 0, 1)));
+}
+
+// a * adj(b)
+inline
+__m128
+mat2f_mul_adj(__m128 a, __m128 b)
+{
+    return _mm_sub_ps(_mm_mul_ps(a, SCM_MATH_SSE_SWIZZLE(b, 3, 0, 3, 0)),
+                      _mm_mul_ps(SCM_MATH_SSE_SWIZZLE(a, 1, 0, 3, 2), SCM_MATH_SSE_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+} // namespace detail
+
+template<>
+inline
+mat<float, 4, 4>&
+operator*=(      mat<float, 4, 4>& lhs,
+           const mat<float, 4, 4>& rhs)
+{
+    detail::mat4f_mul(lhs, rhs, lhs);
+    return (lhs);
+}
+
+template<>
+inline
+const mat<float, 4, 4>
+operator*(const mat<float, 4, 4>& lhs,
+          const mat<float, 4, 4>& rhs)
+{
+    mat<float, 4, 4> r;
+    detail::mat4f_mul(lhs, rhs, r);
+    return (r);
+}
+
+template<>
+inline
+const vec<float, 4>
+operator*(const mat<float, 4, 4>& lhs,
+          const vec<float, 4>&    rhs)
+{
+    vec<float, 4> r;
+    _mm_storeu_ps(r.data_array, detail::mat4f_mul_vec4f(detail::load_mat4f(lhs), _mm_loadu_ps(rhs.data_array)));
+    return (r);
+}
+
+template<>
+inline
+const vec<float, 4>
+operator*(const vec<float, 4>&    lhs,
+          const mat<float, 4, 4>& rhs)
+{
+    // v * M == transpose(M) * v
+    detail::mat4f_columns m = detail::load_mat4f(rhs);
+    _MM_TRANSPOSE4_PS(m.c[0], m.c[1], m.c[2], m.c[3]);
+
+    vec<float, 4> r;
+    _mm_storeu_ps(r.data_array, detail::mat4f_mul_vec4f(m, _mm_loadu_ps(lhs.data_array)));
+    return (r);
+}
+
+template<>
+inline
+const mat<float, 4, 4>
+transpose(const mat<float, 4, 4>& lhs)
+{
+    detail::mat4f_columns m = detail::load_mat4f(lhs);
+    _MM_TRANSPOSE4_PS(m.c[0], m.c[1], m.c[2], m.c[3]);
+
+    mat<float, 4, 4> r;
+    detail::store_mat4f(r, m);
+    return (r);
+}
+
+template<>
+inline
+float
+determinant(const mat<float, 4, 4>& lhs)
+{
+    // laplace expansion along the 2x2 minors of the first two columns,
+    // det(M) == det(transpose(M)) so the storage order does not matter here
+    const float* a = lhs.data_array;
+
+    const float s0 = a[0] * a[5] - a[4] * a[1];
+    const float s1 = a[0] * a[6] - a[4] * a[2];
+    const float s2 = a[0] * a[7] - a[4] * a[3];
+    const float s3 = a[1] * a[6] - a[5] * a[2];
+    const float s4 = a[1] * a[7] - a[5] * a[3];
+    const float s5 = a[2] * a[7] - a[6] * a[3];
+
+    const float c5 = a[10] * a[15] - a[14] * a[11];
+    const float c4 = a[ 9] * a[15] - a[13] * a[11];
+    const float c3 = a[ 9] * a[14] - a[13] * a[10];
+    const float c2 = a[ 8] * a[15] - a[12] * a[11];
+    const float c1 = a[ 8] * a[14] - a[12] * a[10];
+    const float c0 = a[ 8] * a[13] - a[12] * a[ 9];
+
+    return (s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0);
+}
+
+template<>
+inline
+const mat<float, 4, 4>
+inverse(const mat<float, 4, 4>& lhs)
+{
+    // block wise inversion using 2x2 adjugates, the blocks are formed from the
+    // columns, inverse(transpose(M)) == transpose(inverse(M)) keeps this valid
+    // for the column major storage
+    const detail::mat4f_columns m = detail::load_mat4f(lhs);
+
+    const __m128 a = _mm_movelh_ps(m.c[0], m.c[1]);
+    const __m128 b = _mm_movehl_ps(m.c[1], m.c[0]);
+    const __m128 c = _mm_movelh_ps(m.c[2], m.c[3]);
+    const __m128 d = _mm_movehl_ps(m.c[3], m.c[2]);
+
+    // (|A|, |B|, |C|, |D|)
+    const __m128 det_sub = _mm_sub_ps(_mm_mul_ps(SCM_MATH_SSE_SHUFFLE(m.c[0], m.c[2], 0, 2, 0, 2), SCM_MATH_SSE_SHUFFLE(m.c[1], m.c[3], 1, 3, 1, 3)),
+                                      _mm_mul_ps(SCM_MATH_SSE_SHUFFLE(m.c[0], m.c[2], 1, 3, 1, 3), SCM_MATH_SSE_SHUFFLE(m.c[1], m.c[3], 0, 2, 0, 2)));
+    const __m128 det_a = SCM_MATH_SSE_SWIZZLE(det_sub, 0, 0, 0, 0);
+    const __m128 det_b = SCM_MATH_SSE_SWIZZLE(det_sub, 1, 1, 1, 1);
+    const __m128 det_c = SCM_MATH_SSE_SWIZZLE(det_sub, 2, 2, 2, 2);
+    const __m128 det_d = SCM_MATH_SSE_SWIZZLE(det_sub, 3, 3, 3, 3);
+
+    const __m128 d_c = detail::mat2f_adj_mul(d, c);
+    const __m128 a_b = detail::mat2f_adj_mul(a, b);
+
+    __m128 x = _mm_sub_ps(_mm_mul_ps(det_d, a), detail::mat2f_mul(b, d_c));
+    __m128 w = _mm_sub_ps(_mm_mul_ps(det_a, d), detail::mat2f_mul(c, a_b));
+    __m128 y = _mm_sub_ps(_mm_mul_ps(det_b, c), detail::mat2f_mul_adj(d, a_b));
+    __m128 z = _mm_sub_ps(_mm_mul_ps(det_c, b), detail::mat2f_mul_adj(a, d_c));
+
+    // |M| = |A||D| + |B||C| - tr((A#B)(D#C))
+    __m128 tr = _mm_mul_ps(a_b, SCM_MATH_SSE_SWIZZLE(d_c, 0, 2, 1, 3));
+    tr = _mm_add_ps(tr, _mm_movehl_ps(tr, tr));
+    tr = _mm_add_ps(tr, SCM_MATH_SSE_SWIZZLE(tr, 1, 1, 1, 1));
+    tr = SCM_MATH_SSE_SWIZZLE(tr, 0, 0, 0, 0);
+
+    const __m128 det_m = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(det_a, det_d), _mm_mul_ps(det_b, det_c)), tr);
+
+    mat<float, 4, 4> r(mat<float, 4, 4>::zero());
+
+    // ATTENTION!!!! float equal test, same as the generic implementation
+    if (_mm_cvtss_f32(det_m) != 0.0f) {
+        const __m128 r_det_m = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det_m);
+
+        x = _mm_mul_ps(x, r_det_m);
+        y = _mm_mul_ps(y, r_det_m);
+        z = _mm_mul_ps(z, r_det_m);
+        w = _mm_mul_ps(w, r_det_m);
+
+        detail::mat4f_columns inv;
+        inv.c[0] = SCM_MATH_SSE_SHUFFLE(x, y, 3, 1, 3, 1);
+        inv.c[1] = SCM_MATH_SSE_SHUFFLE(x, y, 2, 0, 2, 0);
+        inv.c[2] = SCM_MATH_SSE_SHUFFLE(z, w, 3, 1, 3, 1);
+        inv.c[3] = SCM_MATH_SSE_SHUFFLE(z, w, 2, 0, 2, 0);
+
+        detail::store_mat4f(r, inv);
+    }
+
+    return (r);
+}
+
+} // namespace math
+} // namespace scm
+
+#undef SCM_MATH_SSE_SWIZZLE
+#undef SCM_MATH_SSE_SHUFFLE
+
+#endif // SCM_CORE_MATH_SIMD == SCM_CORE_MATH_SIMD_SSE
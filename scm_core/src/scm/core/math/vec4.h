@@ -115,5 +115,6 @@ template<typename scal_type> const vec<scal_type, 4>        fract(const vec<scal
 } // namespace scm
 
 #include "vec4.inl"
+#include "vec4_simd.inl"
 
 #endif // MATH_VEC4_H_INCLUDED
@@ -0,0 +1,118 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include <scm/core/math/config.h>
+
+#if SCM_CORE_MATH_SIMD == SCM_CORE_MATH_SIMD_SSE
+
+#include <xmmintrin.h>
+
+namespace scm {
+namespace math {
+namespace detail {
+
+// vec<float, 4> is only 4 byte aligned (GL data layouts), so all accesses are unaligned
+inline __m128 load_vec4f(const vec<float, 4>& v)         { return _mm_loadu_ps(v.data_array); }
+inline void   store_vec4f(vec<float, 4>& v, __m128 r)    { _mm_storeu_ps(v.data_array, r); }
+
+} // namespace detail
+
+template<>
+inline
+vec<float, 4>&
+vec<float, 4>::operator+=(const float s)
+{
+    detail::store_vec4f(*this, _mm_add_ps(detail::load_vec4f(*this), _mm_set1_ps(s)));
+    return (*this);
+}
+
+template<>
+inline
+vec<float, 4>&
+vec<float, 4>::operator+=(const vec<float, 4>& v)
+{
+    detail::store_vec4f(*this, _mm_add_ps(detail::load_vec4f(*this), detail::load_vec4f(v)));
+    return (*this);
+}
+
+template<>
+inline
+vec<float, 4>&
+vec<float, 4>::operator-=(const float s)
+{
+    detail::store_vec4f(*this, _mm_sub_ps(detail::load_vec4f(*this), _mm_set1_ps(s)));
+    return (*this);
+}
+
+template<>
+inline
+vec<float, 4>&
+vec<float, 4>::operator-=(const vec<float, 4>& v)
+{
+    detail::store_vec4f(*this, _mm_sub_ps(detail::load_vec4f(*this), detail::load_vec4f(v)));
+    return (*this);
+}
+
+template<>
+inline
+vec<float, 4>&
+vec<float, 4>::operator*=(const float s)
+{
+    detail::store_vec4f(*this, _mm_mul_ps(detail::load_vec4f(*this), _mm_set1_ps(s)));
+    return (*this);
+}
+
+template<>
+inline
+vec<float, 4>&
+vec<float, 4>::operator*=(const vec<float, 4>& v)
+{
+    detail::store_vec4f(*this, _mm_mul_ps(detail::load_vec4f(*this), detail::load_vec4f(v)));
+    return (*this);
+}
+
+template<>
+inline
+vec<float, 4>&
+vec<float, 4>::operator/=(const float s)
+{
+    detail::store_vec4f(*this, _mm_div_ps(detail::load_vec4f(*this), _mm_set1_ps(s)));
+    return (*this);
+}
+
+template<>
+inline
+vec<float, 4>&
+vec<float, 4>::operator/=(const vec<float, 4>& v)
+{
+    detail::store_vec4f(*this, _mm_div_ps(detail::load_vec4f(*this), detail::load_vec4f(v)));
+    return (*this);
+}
+
+template<>
+inline
+const vec<float, 4>
+min(const vec<float, 4>& a,
+    const vec<float, 4>& b)
+{
+    vec<float, 4> r;
+    detail::store_vec4f(r, _mm_min_ps(detail::load_vec4f(a), detail::load_vec4f(b)));
+    return (r);
+}
+
+template<>
+inline
+const vec<float, 4>
+max(const vec<float, 4>& a,
+    const vec<float, 4>& b)
+{
+    vec<float, 4> r;
+    detail::store_vec4f(r, _mm_max_ps(detail::load_vec4f(a), detail::load_vec4f(b)));
+    return (r);
+}
+
+} // namespace math
+} // namespace scm
+
+#endif // SCM_CORE_MATH_SIMD == SCM_CORE_MATH_SIMD_SSE
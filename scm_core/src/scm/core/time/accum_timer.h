@@ -7,6 +7,7 @@
 
 #include <scm/core/memory.h>
 #include <scm/core/time/time_types.h>
+#include <scm/core/time/time_histogram.h>
 
 namespace scm {
 namespace time {
@@ -102,11 +103,33 @@ protected:
 
 }; // class accum_timer_base_deprecated
 
-template<class timer_t>
+// statistics policies for accum_timer
+struct no_statistics
+{
+    void                    record(const time_duration& /*d*/) {}
+    void                    reset() {}
+}; // struct no_statistics
+
+class histogram_statistics
+{
+public:
+    void                    record(const time_duration& d)  { _histogram.record(d.total_nanoseconds()); }
+    void                    reset()                         { _histogram.reset(); }
+
+    const time_histogram&   histogram() const               { return _histogram; }
+    time_statistics         statistics() const              { return _histogram.statistics(); }
+
+protected:
+    time_histogram          _histogram;
+
+}; // class histogram_statistics
+
+template<class timer_t, class statistics_t = no_statistics>
 class accum_timer : public accum_timer_base_deprecated
 {
 public:
     typedef timer_t         timer_type;
+    typedef statistics_t    statistics_type;
 
 public:
     accum_timer();
@@ -116,9 +139,13 @@ public:
     void                    stop();
     void                    collect();
     void                    force_collect();
+    void                    reset();
+
+    const statistics_type&  statistics() const;
 
 protected:
     timer_type              _timer;
+    statistics_type         _statistics;
 
 }; // class accum_timer
 
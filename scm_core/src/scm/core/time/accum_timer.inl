@@ -5,47 +5,64 @@
 namespace scm {
 namespace time {
 
-template<class timer_t>
-accum_timer<timer_t>::accum_timer()
+template<class timer_t, class statistics_t>
+accum_timer<timer_t, statistics_t>::accum_timer()
   : accum_timer_base_deprecated()
 {
     _timer.start();
     _timer.stop();
 }
 
-template<class timer_t>
-accum_timer<timer_t>::~accum_timer()
+template<class timer_t, class statistics_t>
+accum_timer<timer_t, statistics_t>::~accum_timer()
 {
 }
 
-template<class timer_t>
+template<class timer_t, class statistics_t>
 void
-accum_timer<timer_t>::start()
+accum_timer<timer_t, statistics_t>::start()
 {
     _timer.start();
 }
 
-template<class timer_t>
+template<class timer_t, class statistics_t>
 void
-accum_timer<timer_t>::stop()
+accum_timer<timer_t, statistics_t>::stop()
 {
     _timer.stop();
 
     _last_duration         = _timer.get_time();
     _accumulated_duration += _last_duration;
     ++_accumulation_count;
+
+    _statistics.record(_last_duration);
+}
+
+template<class timer_t, class statistics_t>
+void
+accum_timer<timer_t, statistics_t>::collect()
+{
 }
 
-template<class timer_t>
+template<class timer_t, class statistics_t>
 void
-accum_timer<timer_t>::collect()
+accum_timer<timer_t, statistics_t>::force_collect()
 {
 }
 
-template<class timer_t>
+template<class timer_t, class statistics_t>
 void
-accum_timer<timer_t>::force_collect()
+accum_timer<timer_t, statistics_t>::reset()
+{
+    accum_timer_base_deprecated::reset();
+    _statistics.reset();
+}
+
+template<class timer_t, class statistics_t>
+const typename accum_timer<timer_t, statistics_t>::statistics_type&
+accum_timer<timer_t, statistics_t>::statistics() const
 {
+    return _statistics;
 }
 
 } // namespace time
@@ -29,6 +29,7 @@ accum_timer_base::update(int interval)
         _update_interval = 0;
 
         _average_time = (_accumulation_count > 0) ? _accumulated_time / _accumulation_count : 0;
+        update_statistics();
 
         reset();
     }
@@ -40,6 +41,10 @@ accum_timer_base::reset()
     _last_time          = 0;
     _accumulated_time   = 0;
     _accumulation_count = 0u;
+
+    if (_histogram) {
+        _histogram->reset();
+    }
 }
 
 accum_timer_base::nanosec_type
@@ -84,5 +89,45 @@ accum_timer_base::average_time(time_io::time_unit tu) const
     return time_io::to_time_unit(tu, average_time());
 }
 
+void
+accum_timer_base::statistics_enabled(bool e)
+{
+    if (e && !_histogram) {
+        _histogram.reset(new time_histogram());
+    }
+    else if (!e) {
+        _histogram.reset();
+        _statistics = time_statistics();
+    }
+}
+
+bool
+accum_timer_base::statistics_enabled() const
+{
+    return 0 != _histogram.get();
+}
+
+const time_statistics&
+accum_timer_base::statistics() const
+{
+    return _statistics;
+}
+
+void
+accum_timer_base::record_statistics(nanosec_type t)
+{
+    if (_histogram) {
+        _histogram->record(t);
+    }
+}
+
+void
+accum_timer_base::update_statistics()
+{
+    if (_histogram) {
+        _statistics = _histogram->statistics();
+    }
+}
+
 } // namespace time
 } // namespace scm
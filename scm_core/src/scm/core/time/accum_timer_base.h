@@ -5,7 +5,9 @@
 #ifndef SCM_CORE_TIME_ACCUM_TIMER_BASE_H_INCLUDED
 #define SCM_CORE_TIME_ACCUM_TIMER_BASE_H_INCLUDED
 
+#include <scm/core/memory.h>
 #include <scm/core/time/timer_base.h>
+#include <scm/core/time/time_histogram.h>
 
 #include <scm/core/platform/platform.h>
 
@@ -37,11 +39,20 @@ public:
     double                          accumulated_time(time_io::time_unit tu) const;
     double                          average_time(time_io::time_unit tu) const;
 
+    // optional duration histogram, snapshot published on update alongside the average time
+    void                            statistics_enabled(bool e);
+    bool                            statistics_enabled() const;
+    const time_statistics&          statistics() const;
+
     virtual void                    report(std::ostream& os,               time_io unit = time_io(time_io::msec))                 const = 0;
     virtual void                    report(std::ostream& os, size_t dsize, time_io unit = time_io(time_io::msec, time_io::MiBps)) const = 0;
     virtual void                    detailed_report(std::ostream& os,               time_io unit  = time_io(time_io::msec))                 const = 0;
     virtual void                    detailed_report(std::ostream& os, size_t dsize, time_io unit  = time_io(time_io::msec, time_io::MiBps)) const = 0;
 
+protected:
+    void                            record_statistics(nanosec_type t);
+    void                            update_statistics();
+
 protected:
     nanosec_type                    _last_time;
     nanosec_type                    _accumulated_time;
@@ -49,6 +60,9 @@ protected:
     unsigned                        _accumulation_count;
     int                             _update_interval;
 
+    scoped_ptr<time_histogram>      _histogram;
+    time_statistics                 _statistics;
+
 }; // class accum_timer_base
 
 } // namespace time
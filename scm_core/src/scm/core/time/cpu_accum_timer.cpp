@@ -55,6 +55,7 @@ cpu_accum_timer::stop()
     _detailed_accumulated_time.user   += _detailed_last_time.user;
     _detailed_accumulated_time.system += _detailed_last_time.system;
 
+    record_statistics(_last_time);
     ++_accumulation_count;
 }
 
@@ -77,6 +78,7 @@ cpu_accum_timer::update(int interval)
         _update_interval = 0;
 
         _average_time = (_accumulation_count > 0) ? _accumulated_time / _accumulation_count : 0;
+        update_statistics();
 
         _detailed_average_time.wall =
         _detailed_average_time.user =
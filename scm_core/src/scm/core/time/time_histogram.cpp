@@ -0,0 +1,205 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include "time_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <ostream>
+#include <iomanip>
+
+#include <boost/io/ios_state.hpp>
+
+namespace {
+
+unsigned
+floor_log2(scm::uint64 v)
+{
+    unsigned r = 0;
+    if (v >= (scm::uint64(1) << 32)) { v >>= 32; r += 32; }
+    if (v >= (scm::uint64(1) << 16)) { v >>= 16; r += 16; }
+    if (v >= (scm::uint64(1) <<  8)) { v >>=  8; r +=  8; }
+    if (v >= (scm::uint64(1) <<  4)) { v >>=  4; r +=  4; }
+    if (v >= (scm::uint64(1) <<  2)) { v >>=  2; r +=  2; }
+    if (v >= (scm::uint64(1) <<  1)) {           r +=  1; }
+    return r;
+}
+
+} // namespace
+
+namespace scm {
+namespace time {
+
+const unsigned time_histogram::sub_bucket_bits;
+const unsigned time_histogram::sub_bucket_count;
+const unsigned time_histogram::magnitude_bits;
+const unsigned time_histogram::bucket_count;
+
+time_statistics::time_statistics()
+  : _count(0)
+  , _min(0)
+  , _max(0)
+  , _p50(0)
+  , _p95(0)
+  , _p99(0)
+{
+}
+
+void
+time_statistics::report(std::ostream& os, time_io unit) const
+{
+    std::ostream::sentry const  out_sentry(os);
+
+    if (os) {
+        boost::io::ios_all_saver saved_state(os);
+
+        const std::string us = time_io::time_unit_string(unit._t_unit);
+
+        os << std::fixed << std::setprecision(unit._t_dec_places)
+           << "p50 " << time_io::to_time_unit(unit._t_unit, _p50) << us << ", "
+           << "p95 " << time_io::to_time_unit(unit._t_unit, _p95) << us << ", "
+           << "p99 " << time_io::to_time_unit(unit._t_unit, _p99) << us << ", "
+           << "max " << time_io::to_time_unit(unit._t_unit, _max) << us;
+    }
+}
+
+time_histogram::time_histogram()
+{
+    reset();
+}
+
+void
+time_histogram::record(nanosec_type t)
+{
+    t = std::max<nanosec_type>(t, 0);
+
+    ++_buckets[bucket_index(t)];
+
+    if (0 == _count) {
+        _min = _max = t;
+    }
+    else {
+        _min = std::min(_min, t);
+        _max = std::max(_max, t);
+    }
+    ++_count;
+}
+
+void
+time_histogram::merge(const time_histogram& h)
+{
+    if (0 == h._count) {
+        return;
+    }
+    for (unsigned b = 0; b < bucket_count; ++b) {
+        _buckets[b] += h._buckets[b];
+    }
+    _min    = (0 == _count) ? h._min : std::min(_min, h._min);
+    _max    = (0 == _count) ? h._max : std::max(_max, h._max);
+    _count += h._count;
+}
+
+void
+time_histogram::reset()
+{
+    _buckets.assign(0);
+    _count = 0;
+    _min   = 0;
+    _max   = 0;
+}
+
+scm::uint64
+time_histogram::count() const
+{
+    return _count;
+}
+
+nanosec_type
+time_histogram::min() const
+{
+    return _min;
+}
+
+nanosec_type
+time_histogram::max() const
+{
+    return _max;
+}
+
+nanosec_type
+time_histogram::percentile(double p) const
+{
+    if (0 == _count) {
+        return 0;
+    }
+
+    p = std::min(std::max(p, 0.0), 100.0);
+
+    scm::uint64 rank = static_cast<scm::uint64>(std::ceil(p / 100.0 * static_cast<double>(_count)));
+    rank = std::min(std::max<scm::uint64>(rank, 1), _count);
+
+    scm::uint64 accum = 0;
+    for (unsigned b = 0; b < bucket_count; ++b) {
+        accum += _buckets[b];
+        if (accum >= rank) {
+            // report the highest value equivalent to the bucket, but never beyond the recorded range
+            return std::min(std::max(bucket_upper_bound(b), _min), _max);
+        }
+    }
+
+    return _max;
+}
+
+time_statistics
+time_histogram::statistics() const
+{
+    time_statistics s;
+
+    s._count = _count;
+    s._min   = _min;
+    s._max   = _max;
+    s._p50   = percentile(50.0);
+    s._p95   = percentile(95.0);
+    s._p99   = percentile(99.0);
+
+    return s;
+}
+
+nanosec_type
+time_histogram::max_trackable_time()
+{
+    return static_cast<nanosec_type>((scm::uint64(1) << magnitude_bits) - 1);
+}
+
+unsigned
+time_histogram::bucket_index(nanosec_type t)
+{
+    scm::uint64 v = static_cast<scm::uint64>(std::min(std::max<nanosec_type>(t, 0), max_trackable_time()));
+
+    if (v < sub_bucket_count) {
+        return static_cast<unsigned>(v);
+    }
+    else {
+        unsigned e = floor_log2(v) - sub_bucket_bits;
+        return   sub_bucket_count * (e + 1)
+               + static_cast<unsigned>((v >> e) - sub_bucket_count);
+    }
+}
+
+nanosec_type
+time_histogram::bucket_upper_bound(unsigned b)
+{
+    if (b < sub_bucket_count) {
+        return static_cast<nanosec_type>(b);
+    }
+    else {
+        unsigned    e = b / sub_bucket_count - 1;
+        scm::uint64 l = static_cast<scm::uint64>(sub_bucket_count + b % sub_bucket_count) << e;
+        return static_cast<nanosec_type>(l + (scm::uint64(1) << e) - 1);
+    }
+}
+
+} // namespace time
+} // namespace scm
@@ -0,0 +1,81 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_CORE_TIME_TIME_HISTOGRAM_H_INCLUDED
+#define SCM_CORE_TIME_TIME_HISTOGRAM_H_INCLUDED
+
+#include <iosfwd>
+
+#include <scm/core/memory.h>
+#include <scm/core/numeric_types.h>
+#include <scm/core/time/timer_base.h>
+
+#include <scm/core/platform/platform.h>
+#include <scm/core/utilities/platform_warning_disable.h>
+
+namespace scm {
+namespace time {
+
+struct __scm_export(core) time_statistics
+{
+    time_statistics();
+
+    void                report(std::ostream& os, time_io unit = time_io(time_io::msec)) const;
+
+    scm::uint64         _count;
+    nanosec_type        _min;
+    nanosec_type        _max;
+    nanosec_type        _p50;
+    nanosec_type        _p95;
+    nanosec_type        _p99;
+}; // struct time_statistics
+
+// fixed-memory log-linear (HDR style) histogram of durations
+//  - durations below sub_bucket_count nanoseconds are recorded exactly
+//  - every following power-of-two range is split into sub_bucket_count
+//    linear buckets, bounding the relative error to 1/sub_bucket_count
+//  - durations beyond max_trackable_time are clamped into the last bucket,
+//    the exact minimum and maximum are tracked separately
+class __scm_export(core) time_histogram
+{
+public:
+    static const unsigned       sub_bucket_bits  = 6;
+    static const unsigned       sub_bucket_count = 1u << sub_bucket_bits;
+    static const unsigned       magnitude_bits   = 42; // ~73min in nanoseconds
+    static const unsigned       bucket_count     = sub_bucket_count * (magnitude_bits - sub_bucket_bits + 1);
+
+    typedef scm::uint32         count_type;
+
+public:
+    time_histogram();
+
+    void                        record(nanosec_type t);
+    void                        merge(const time_histogram& h);
+    void                        reset();
+
+    scm::uint64                 count() const;
+    nanosec_type                min() const;
+    nanosec_type                max() const;
+    nanosec_type                percentile(double p) const;
+
+    time_statistics             statistics() const;
+
+    static nanosec_type         max_trackable_time();
+    static unsigned             bucket_index(nanosec_type t);
+    static nanosec_type         bucket_upper_bound(unsigned b);
+
+protected:
+    scm::array<count_type, bucket_count>    _buckets;
+    scm::uint64                             _count;
+    nanosec_type                            _min;
+    nanosec_type                            _max;
+
+}; // class time_histogram
+
+} // namespace time
+} // namespace scm
+
+#include <scm/core/utilities/platform_warning_enable.h>
+
+#endif // SCM_CORE_TIME_TIME_HISTOGRAM_H_INCLUDED
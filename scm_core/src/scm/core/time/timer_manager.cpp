@@ -0,0 +1,333 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include "timer_manager.h"
+
+#include <exception>
+#include <sstream>
+#include <stdexcept>
+
+#include <scm/core/utilities/boost_warning_disable.h>
+#include <boost/thread/thread.hpp>
+#include <scm/core/utilities/boost_warning_enable.h>
+
+#include <scm/log.h>
+#include <scm/core/time/high_res_timer.h>
+#include <scm/core/time/time_system.h>
+#include <scm/core/time/timer_report_sink.h>
+
+namespace scm {
+namespace time {
+
+struct timer_manager::timer_entry
+{
+    timer_entry()
+      : _active(false)
+      , _count(0)
+      , _total_count(0)
+      , _last(0)
+      , _accumulated(0)
+      , _max(0)
+    {}
+
+    void reset() {
+        _count.store(0, boost::memory_order_relaxed);
+        _total_count.store(0, boost::memory_order_relaxed);
+        _last.store(0, boost::memory_order_relaxed);
+        _accumulated.store(0, boost::memory_order_relaxed);
+        _max.store(0, boost::memory_order_relaxed);
+    }
+
+    // written once during registration, constant afterwards
+    std::string                     _name;
+    timer_ptr                       _timer;
+
+    boost::atomic<bool>             _active;
+    boost::atomic<scm::uint64>      _count;
+    boost::atomic<scm::uint64>      _total_count;
+    boost::atomic<nanosec_type>     _last;
+    boost::atomic<nanosec_type>     _accumulated;
+    boost::atomic<nanosec_type>     _max;
+}; // struct timer_manager::timer_entry
+
+const timer_manager::timer_handle timer_manager::invalid_handle = 0xffffffffu;
+
+timer_snapshot::timer_snapshot()
+  : _count(0)
+  , _total_count(0)
+  , _last(0)
+  , _accumulated(0)
+  , _average(0)
+  , _max(0)
+{
+}
+
+timer_manager::timer_manager(scm::size_t max_timers)
+  : _entries(new timer_entry[max_timers])
+  , _max_timers(max_timers)
+  , _timer_count(0)
+  , _report_stop(false)
+{
+}
+
+timer_manager::~timer_manager()
+{
+    stop_reporting();
+}
+
+timer_manager::timer_ptr
+timer_manager::add_timer(const std::string& name)
+{
+    return timer(register_timer(name));
+}
+
+timer_manager::timer_ptr
+timer_manager::get_timer(const std::string& name)
+{
+    return timer(find_timer(name));
+}
+
+timer_manager::timer_ptr
+timer_manager::del_timer(const std::string& name)
+{
+    boost::mutex::scoped_lock lock(_handles_mutex);
+
+    handle_map::const_iterator h = _handles.find(name);
+    if (h != _handles.end()) {
+        timer_entry& e = _entries[h->second];
+        if (e._active.exchange(false, boost::memory_order_acq_rel)) {
+            return e._timer;
+        }
+    }
+
+    return timer_ptr();
+}
+
+timer_manager::timer_handle
+timer_manager::register_timer(const std::string& name)
+{
+    boost::mutex::scoped_lock lock(_handles_mutex);
+
+    handle_map::const_iterator h = _handles.find(name);
+    if (h != _handles.end()) {
+        // slots are never reused, re-adding a deleted timer revives its old handle
+        timer_entry& e = _entries[h->second];
+        if (!e._active.load(boost::memory_order_acquire)) {
+            e.reset();
+            e._active.store(true, boost::memory_order_release);
+        }
+        return h->second;
+    }
+
+    timer_handle nh = _timer_count.load(boost::memory_order_relaxed);
+    if (nh >= _max_timers) {
+        std::ostringstream s;
+        s << "timer_manager::register_timer(): "
+          << "unable to register timer '" << name << "', maximum number of timers (" << _max_timers << ") reached.";
+        throw std::runtime_error(s.str());
+    }
+
+    timer_entry& e = _entries[nh];
+    e._name  = name;
+    e._timer.reset(new high_res_timer(timer_interface::nano_seconds));
+    e.reset();
+    e._active.store(true, boost::memory_order_relaxed);
+
+    _handles.insert(handle_map::value_type(name, nh));
+
+    // publish the fully constructed entry to the lock-free readers
+    _timer_count.store(nh + 1, boost::memory_order_release);
+
+    return nh;
+}
+
+timer_manager::timer_handle
+timer_manager::find_timer(const std::string& name) const
+{
+    boost::mutex::scoped_lock lock(_handles_mutex);
+
+    handle_map::const_iterator h = _handles.find(name);
+    if (   h != _handles.end()
+        && _entries[h->second]._active.load(boost::memory_order_acquire)) {
+        return h->second;
+    }
+
+    return invalid_handle;
+}
+
+bool
+timer_manager::valid(timer_handle h) const
+{
+    return 0 != entry(h);
+}
+
+timer_manager::timer_ptr
+timer_manager::timer(timer_handle h) const
+{
+    if (timer_entry* e = entry(h)) {
+        return e->_timer;
+    }
+
+    return timer_ptr();
+}
+
+void
+timer_manager::start(timer_handle h)
+{
+    if (timer_entry* e = entry(h)) {
+        e->_timer->start();
+    }
+}
+
+void
+timer_manager::stop(timer_handle h)
+{
+    if (timer_entry* e = entry(h)) {
+        e->_timer->stop();
+        record(h, static_cast<nanosec_type>(e->_timer->get_time().total_nanoseconds()));
+    }
+}
+
+void
+timer_manager::record(timer_handle h, nanosec_type t)
+{
+    if (timer_entry* e = entry(h)) {
+        e->_last.store(t, boost::memory_order_relaxed);
+        e->_accumulated.fetch_add(t, boost::memory_order_relaxed);
+        e->_count.fetch_add(1, boost::memory_order_relaxed);
+        e->_total_count.fetch_add(1, boost::memory_order_relaxed);
+
+        nanosec_type m = e->_max.load(boost::memory_order_relaxed);
+        while (   t > m
+               && !e->_max.compare_exchange_weak(m, t, boost::memory_order_relaxed)) {
+        }
+    }
+}
+
+void
+timer_manager::snapshot(snapshot_type& s, bool restart_interval)
+{
+    const timer_handle tc = _timer_count.load(boost::memory_order_acquire);
+
+    s.clear();
+    s.reserve(tc);
+
+    for (timer_handle h = 0; h < tc; ++h) {
+        timer_entry& e = _entries[h];
+
+        if (!e._active.load(boost::memory_order_acquire)) {
+            continue;
+        }
+
+        timer_snapshot ts;
+        ts._name        = e._name;
+        ts._total_count = e._total_count.load(boost::memory_order_relaxed);
+        ts._last        = e._last.load(boost::memory_order_relaxed);
+
+        // samples recorded concurrently with a restart may be attributed to either interval
+        if (restart_interval) {
+            ts._count       = e._count.exchange(0, boost::memory_order_relaxed);
+            ts._accumulated = e._accumulated.exchange(0, boost::memory_order_relaxed);
+            ts._max         = e._max.exchange(0, boost::memory_order_relaxed);
+        }
+        else {
+            ts._count       = e._count.load(boost::memory_order_relaxed);
+            ts._accumulated = e._accumulated.load(boost::memory_order_relaxed);
+            ts._max         = e._max.load(boost::memory_order_relaxed);
+        }
+        ts._average = (ts._count > 0) ? ts._accumulated / static_cast<nanosec_type>(ts._count) : 0;
+
+        s.push_back(ts);
+    }
+}
+
+void
+timer_manager::start_reporting(const timer_report_sink_ptr& sink,
+                               const time_duration&         interval)
+{
+    if (!sink) {
+        throw std::invalid_argument("timer_manager::start_reporting(): invalid report sink.");
+    }
+
+    stop_reporting();
+
+    {
+        boost::mutex::scoped_lock lock(_report_mutex);
+        _report_stop = false;
+    }
+    _report_thread.reset(new boost::thread([this, sink, interval]() -> void {
+        report_loop(sink, interval);
+    }));
+}
+
+void
+timer_manager::stop_reporting()
+{
+    if (_report_thread) {
+        {
+            boost::mutex::scoped_lock lock(_report_mutex);
+            _report_stop = true;
+        }
+        _report_condition.notify_all();
+
+        _report_thread->join();
+        _report_thread.reset();
+    }
+}
+
+bool
+timer_manager::reporting() const
+{
+    return 0 != _report_thread.get();
+}
+
+timer_manager::timer_entry*
+timer_manager::entry(timer_handle h) const
+{
+    if (h < _timer_count.load(boost::memory_order_acquire)) {
+        timer_entry* e = &_entries[h];
+        if (e->_active.load(boost::memory_order_acquire)) {
+            return e;
+        }
+    }
+
+    return 0;
+}
+
+void
+timer_manager::report_loop(timer_report_sink_ptr sink,
+                           time_duration         interval)
+{
+    snapshot_type   s;
+    ptime           next_report = boost::posix_time::microsec_clock::universal_time() + interval;
+
+    for (;;) {
+        {
+            boost::mutex::scoped_lock lock(_report_mutex);
+            while (!_report_stop) {
+                if (!_report_condition.timed_wait(lock, next_report)) {
+                    break;
+                }
+            }
+            if (_report_stop) {
+                return;
+            }
+        }
+        next_report += interval;
+
+        snapshot(s, true);
+
+        try {
+            sink->report(local_time(), s);
+        }
+        catch (const std::exception& e) {
+            scm::err() << log::error
+                       << "timer_manager::report_loop(): "
+                       << "error writing timer report (" << e.what() << ")." << log::end;
+        }
+    }
+}
+
+} // namespace time
+} // namespace scm
@@ -5,28 +5,109 @@
 #ifndef SCM_CORE_TIME_TIMER_MANAGER_H_INCLUDED
 #define SCM_CORE_TIME_TIMER_MANAGER_H_INCLUDED
 
+#include <map>
+#include <string>
+#include <vector>
+
+#include <scm/core/utilities/boost_warning_disable.h>
+#include <boost/atomic.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <scm/core/utilities/boost_warning_enable.h>
+
+#include <scm/core/memory.h>
+#include <scm/core/numeric_types.h>
+#include <scm/core/time/timer_base.h>
 #include <scm/core/time/timer_interface.h>
 
 #include <scm/core/platform/platform.h>
 #include <scm/core/utilities/platform_warning_disable.h>
 
+namespace boost {
+class thread;
+} // namespace boost
+
 namespace scm {
 namespace time {
 
-class __scm_export(core) timer_manager
+class timer_report_sink;
+typedef shared_ptr<timer_report_sink>   timer_report_sink_ptr;
+
+struct __scm_export(core) timer_snapshot
+{
+    timer_snapshot();
+
+    std::string         _name;
+    scm::uint64         _count;         // samples since the last interval restart
+    scm::uint64         _total_count;   // samples since registration
+    nanosec_type        _last;
+    nanosec_type        _accumulated;
+    nanosec_type        _average;
+    nanosec_type        _max;
+}; // struct timer_snapshot
+
+// named timer registry
+//  - registration and lookups by name are serialized through a mutex
+//  - timer handles are stable indices into a fixed capacity entry array,
+//    start/stop/record and snapshots through handles do not lock
+//  - a timer is owned by a single thread for start/stop, the accumulated
+//    values can be read concurrently by snapshots and the reporter thread
+class __scm_export(core) timer_manager : boost::noncopyable
 {
 public:
     typedef boost::shared_ptr<scm::time::timer_interface>   timer_ptr;
+    typedef scm::uint32                                     timer_handle;
+    typedef std::vector<timer_snapshot>                     snapshot_type;
+
+    static const timer_handle   invalid_handle;
+
+protected:
+    struct timer_entry;
+    typedef std::map<std::string, timer_handle>             handle_map;
 
 public:
+    timer_manager(scm::size_t max_timers = 256);
+    virtual ~timer_manager();
+
+    timer_ptr                   add_timer(const std::string& name);
+    timer_ptr                   get_timer(const std::string& name);
+    timer_ptr                   del_timer(const std::string& name);
+
+    timer_handle                register_timer(const std::string& name);
+    timer_handle                find_timer(const std::string& name) const;
+
+    bool                        valid(timer_handle h) const;
+    timer_ptr                   timer(timer_handle h) const;
+
+    void                        start(timer_handle h);
+    void                        stop(timer_handle h);
+    void                        record(timer_handle h, nanosec_type t);
 
-    timer_ptr           add_timer(const std::string& name);
-    timer_ptr           get_timer(const std::string& name);
-    timer_ptr           del_timer(const std::string& name);
+    void                        snapshot(snapshot_type& s, bool restart_interval = false);
+
+    void                        start_reporting(const timer_report_sink_ptr& sink,
+                                                const time_duration&         interval);
+    void                        stop_reporting();
+    bool                        reporting() const;
+
+protected:
+    timer_entry*                entry(timer_handle h) const;
+    void                        report_loop(timer_report_sink_ptr sink,
+                                            time_duration         interval);
 
 protected:
+    scoped_array<timer_entry>   _entries;
+    scm::size_t                 _max_timers;
+    boost::atomic<scm::uint32>  _timer_count;
+
+    handle_map                  _handles;
+    mutable boost::mutex        _handles_mutex;
 
-private:
+    scoped_ptr<boost::thread>   _report_thread;
+    bool                        _report_stop;
+    boost::mutex                _report_mutex;
+    boost::condition_variable   _report_condition;
 
 }; // class timer_manager
 
@@ -0,0 +1,181 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include "timer_report_sink.h"
+
+#include <exception>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+
+#include <scm/log.h>
+
+namespace {
+
+void
+write_json_string(std::ostream& os, const std::string& s)
+{
+    os << '"';
+    for (std::string::const_iterator c = s.begin(); c != s.end(); ++c) {
+        switch (*c) {
+            case '"':  os << "\\\""; break;
+            case '\\': os << "\\\\"; break;
+            case '\n': os << "\\n"; break;
+            case '\r': os << "\\r"; break;
+            case '\t': os << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(*c) < 0x20) {
+                    os << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                       << static_cast<int>(*c) << std::dec << std::setfill(' ');
+                }
+                else {
+                    os << *c;
+                }
+        }
+    }
+    os << '"';
+}
+
+} // namespace
+
+namespace scm {
+namespace time {
+
+timer_report_sink::timer_report_sink()
+{
+}
+
+timer_report_sink::~timer_report_sink()
+{
+}
+
+// timer_log_sink /////////////////////////////////////////////////////////////////////////////////
+timer_log_sink::timer_log_sink(time_io unit)
+  : _unit(unit)
+{
+}
+
+timer_log_sink::~timer_log_sink()
+{
+}
+
+void
+timer_log_sink::report(const ptime& t, const snapshot_type& s)
+{
+    const std::string us = time_io::time_unit_string(_unit._t_unit);
+
+    std::ostringstream os;
+    os << "timer report " << boost::posix_time::to_simple_string(t) << ":";
+    for (snapshot_type::const_iterator ts = s.begin(); ts != s.end(); ++ts) {
+        os << std::endl << std::fixed << std::setprecision(_unit._t_dec_places)
+           << "  " << ts->_name << ": "
+           << "avg " << time_io::to_time_unit(_unit._t_unit, ts->_average) << us << ", "
+           << "max " << time_io::to_time_unit(_unit._t_unit, ts->_max) << us << ", "
+           << "last " << time_io::to_time_unit(_unit._t_unit, ts->_last) << us << ", "
+           << "samples " << ts->_count << " (" << ts->_total_count << " total)";
+    }
+
+    scm::out() << log::info << os.str() << log::end;
+}
+
+// timer_csv_sink /////////////////////////////////////////////////////////////////////////////////
+timer_csv_sink::timer_csv_sink(const std::string& file_name,
+                               time_io            unit)
+  : _out(file_name.c_str(), std::ios_base::out | std::ios_base::trunc)
+  , _unit(unit)
+{
+    if (!_out) {
+        throw std::runtime_error("timer_csv_sink::timer_csv_sink(): unable to open file: " + file_name);
+    }
+
+    const std::string us = time_io::time_unit_string(_unit._t_unit);
+
+    _out << "time,name,count,total_count,"
+         << "average_" << us << ",max_" << us << ",last_" << us << ",accumulated_" << us << std::endl;
+}
+
+timer_csv_sink::~timer_csv_sink()
+{
+    _out.close();
+}
+
+void
+timer_csv_sink::report(const ptime& t, const snapshot_type& s)
+{
+    const std::string ts_string = boost::posix_time::to_iso_extended_string(t);
+
+    _out << std::fixed << std::setprecision(_unit._t_dec_places);
+    for (snapshot_type::const_iterator ts = s.begin(); ts != s.end(); ++ts) {
+        std::string name = ts->_name;
+        if (name.find_first_of(",\"\n") != std::string::npos) {
+            std::string quoted("\"");
+            for (std::string::const_iterator c = name.begin(); c != name.end(); ++c) {
+                quoted += (*c == '"') ? std::string("\"\"") : std::string(1, *c);
+            }
+            name = quoted + "\"";
+        }
+
+        _out << ts_string << ","
+             << name << ","
+             << ts->_count << ","
+             << ts->_total_count << ","
+             << time_io::to_time_unit(_unit._t_unit, ts->_average) << ","
+             << time_io::to_time_unit(_unit._t_unit, ts->_max) << ","
+             << time_io::to_time_unit(_unit._t_unit, ts->_last) << ","
+             << time_io::to_time_unit(_unit._t_unit, ts->_accumulated) << "\n";
+    }
+    _out.flush();
+
+    if (!_out) {
+        throw std::runtime_error("timer_csv_sink::report(): error writing to output file.");
+    }
+}
+
+// timer_json_sink ////////////////////////////////////////////////////////////////////////////////
+timer_json_sink::timer_json_sink(const std::string& file_name,
+                                 time_io            unit)
+  : _out(file_name.c_str(), std::ios_base::out | std::ios_base::trunc)
+  , _unit(unit)
+{
+    if (!_out) {
+        throw std::runtime_error("timer_json_sink::timer_json_sink(): unable to open file: " + file_name);
+    }
+}
+
+timer_json_sink::~timer_json_sink()
+{
+    _out.close();
+}
+
+void
+timer_json_sink::report(const ptime& t, const snapshot_type& s)
+{
+    _out << std::fixed << std::setprecision(_unit._t_dec_places)
+         << "{\"time\":\"" << boost::posix_time::to_iso_extended_string(t) << "\","
+         << "\"unit\":\"" << time_io::time_unit_string(_unit._t_unit) << "\","
+         << "\"timers\":[";
+    for (snapshot_type::const_iterator ts = s.begin(); ts != s.end(); ++ts) {
+        if (ts != s.begin()) {
+            _out << ",";
+        }
+        _out << "{\"name\":";
+        write_json_string(_out, ts->_name);
+        _out << ",\"count\":"       << ts->_count
+             << ",\"total_count\":" << ts->_total_count
+             << ",\"average\":"     << time_io::to_time_unit(_unit._t_unit, ts->_average)
+             << ",\"max\":"         << time_io::to_time_unit(_unit._t_unit, ts->_max)
+             << ",\"last\":"        << time_io::to_time_unit(_unit._t_unit, ts->_last)
+             << ",\"accumulated\":" << time_io::to_time_unit(_unit._t_unit, ts->_accumulated)
+             << "}";
+    }
+    _out << "]}" << std::endl;
+
+    if (!_out) {
+        throw std::runtime_error("timer_json_sink::report(): error writing to output file.");
+    }
+}
+
+} // namespace time
+} // namespace scm
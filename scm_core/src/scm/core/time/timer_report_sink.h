@@ -0,0 +1,86 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_CORE_TIME_TIMER_REPORT_SINK_H_INCLUDED
+#define SCM_CORE_TIME_TIMER_REPORT_SINK_H_INCLUDED
+
+#include <fstream>
+#include <string>
+
+#include <scm/core/time/time_types.h>
+#include <scm/core/time/timer_base.h>
+#include <scm/core/time/timer_manager.h>
+
+#include <scm/core/platform/platform.h>
+#include <scm/core/utilities/platform_warning_disable.h>
+
+namespace scm {
+namespace time {
+
+// receives the periodic snapshots of the timer_manager reporter thread
+class __scm_export(core) timer_report_sink
+{
+public:
+    typedef timer_manager::snapshot_type    snapshot_type;
+
+public:
+    timer_report_sink();
+    virtual ~timer_report_sink();
+
+    virtual void        report(const ptime& t, const snapshot_type& s) = 0;
+
+}; // class timer_report_sink
+
+// one info message per report to the scm::out() log, one line per timer
+class __scm_export(core) timer_log_sink : public timer_report_sink
+{
+public:
+    timer_log_sink(time_io unit = time_io(time_io::msec, 3));
+    virtual ~timer_log_sink();
+
+    void                report(const ptime& t, const snapshot_type& s);
+
+protected:
+    time_io             _unit;
+
+}; // class timer_log_sink
+
+// comma separated values, one row per timer and report
+class __scm_export(core) timer_csv_sink : public timer_report_sink
+{
+public:
+    timer_csv_sink(const std::string& file_name,
+                   time_io            unit = time_io(time_io::msec, 6));
+    virtual ~timer_csv_sink();
+
+    void                report(const ptime& t, const snapshot_type& s);
+
+protected:
+    std::ofstream       _out;
+    time_io             _unit;
+
+}; // class timer_csv_sink
+
+// JSON lines, one object per report holding an array of all timers
+class __scm_export(core) timer_json_sink : public timer_report_sink
+{
+public:
+    timer_json_sink(const std::string& file_name,
+                    time_io            unit = time_io(time_io::msec, 6));
+    virtual ~timer_json_sink();
+
+    void                report(const ptime& t, const snapshot_type& s);
+
+protected:
+    std::ofstream       _out;
+    time_io             _unit;
+
+}; // class timer_json_sink
+
+} // namespace time
+} // namespace scm
+
+#include <scm/core/utilities/platform_warning_enable.h>
+
+#endif // SCM_CORE_TIME_TIMER_REPORT_SINK_H_INCLUDED
@@ -0,0 +1,213 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <exception>
+
+#include <scm/core/utilities/boost_warning_disable.h>
+#include <boost/thread/thread.hpp>
+#include <scm/core/utilities/boost_warning_enable.h>
+
+#include <scm/log.h>
+
+namespace {
+
+// completion state of one parallel_for call
+struct range_latch
+{
+    range_latch(scm::size_t c) : _pending(c) {}
+
+    void done(std::exception_ptr e) {
+        boost::mutex::scoped_lock lock(_mutex);
+        if (e && !_exception) {
+            _exception = e;
+        }
+        if (0 == --_pending) {
+            _condition.notify_all();
+        }
+    }
+    void wait() {
+        boost::mutex::scoped_lock lock(_mutex);
+        while (_pending > 0) {
+            _condition.wait(lock);
+        }
+    }
+
+    scm::size_t                 _pending;
+    std::exception_ptr          _exception;
+    boost::mutex                _mutex;
+    boost::condition_variable   _condition;
+}; // struct range_latch
+
+} // namespace
+
+namespace scm {
+
+thread_pool::thread_pool(unsigned thread_count)
+  : _active_tasks(0)
+  , _stop(false)
+{
+    if (0 == thread_count) {
+        thread_count = std::max(1u, boost::thread::hardware_concurrency());
+    }
+
+    _threads.reserve(thread_count);
+    for (unsigned t = 0; t < thread_count; ++t) {
+        _threads.push_back(make_shared<boost::thread>([this]() -> void {
+            worker_loop();
+        }));
+    }
+}
+
+thread_pool::~thread_pool()
+{
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        _stop = true;
+    }
+    _task_condition.notify_all();
+
+    for (std::size_t t = 0; t < _threads.size(); ++t) {
+        _threads[t]->join();
+    }
+}
+
+unsigned
+thread_pool::thread_count() const
+{
+    return static_cast<unsigned>(_threads.size());
+}
+
+void
+thread_pool::submit(const task_type& t)
+{
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        _tasks.push_back(t);
+    }
+    _task_condition.notify_one();
+}
+
+void
+thread_pool::wait_idle()
+{
+    boost::mutex::scoped_lock lock(_mutex);
+    while (!_tasks.empty() || _active_tasks > 0) {
+        _idle_condition.wait(lock);
+    }
+}
+
+void
+thread_pool::parallel_for(scm::size_t            begin,
+                          scm::size_t            end,
+                          scm::size_t            grain,
+                          const range_task_type& f)
+{
+    if (end <= begin) {
+        return;
+    }
+
+    const scm::size_t count  = end - begin;
+    const scm::size_t chunks = std::min<scm::size_t>(thread_count() + 1, std::max<scm::size_t>(1, count / std::max<scm::size_t>(1, grain)));
+
+    if (chunks < 2 || is_worker_thread()) {
+        f(begin, end);
+        return;
+    }
+
+    const scm::size_t           chunk_size = (count + chunks - 1) / chunks;
+    shared_ptr<range_latch>     latch      = make_shared<range_latch>(chunks - 1);
+
+    for (scm::size_t c = 1; c < chunks; ++c) {
+        const scm::size_t b = begin + c * chunk_size;
+        const scm::size_t e = std::min(end, b + chunk_size);
+        submit([f, b, e, latch]() -> void {
+            std::exception_ptr ex;
+            try {
+                if (b < e) {
+                    f(b, e);
+                }
+            }
+            catch (...) {
+                ex = std::current_exception();
+            }
+            latch->done(ex);
+        });
+    }
+
+    std::exception_ptr ex;
+    try {
+        f(begin, std::min(end, begin + chunk_size));
+    }
+    catch (...) {
+        ex = std::current_exception();
+    }
+    latch->wait();
+
+    if (ex) {
+        std::rethrow_exception(ex);
+    }
+    if (latch->_exception) {
+        std::rethrow_exception(latch->_exception);
+    }
+}
+
+bool
+thread_pool::is_worker_thread() const
+{
+    // the thread set is fixed after construction
+    const boost::thread::id self = boost::this_thread::get_id();
+    for (std::size_t t = 0; t < _threads.size(); ++t) {
+        if (_threads[t]->get_id() == self) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void
+thread_pool::worker_loop()
+{
+    for (;;) {
+        task_type t;
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            while (!_stop && _tasks.empty()) {
+                _task_condition.wait(lock);
+            }
+            if (_stop && _tasks.empty()) {
+                return;
+            }
+            t = _tasks.front();
+            _tasks.pop_front();
+            ++_active_tasks;
+        }
+
+        try {
+            t();
+        }
+        catch (const std::exception& e) {
+            scm::err() << log::error
+                       << "thread_pool::worker_loop(): "
+                       << "unhandled exception in task (" << e.what() << ")." << log::end;
+        }
+        catch (...) {
+            scm::err() << log::error
+                       << "thread_pool::worker_loop(): "
+                       << "unhandled unknown exception in task." << log::end;
+        }
+
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            --_active_tasks;
+            if (_tasks.empty() && 0 == _active_tasks) {
+                _idle_condition.notify_all();
+            }
+        }
+    }
+}
+
+} // namespace scm
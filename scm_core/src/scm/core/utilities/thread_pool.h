@@ -0,0 +1,80 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_CORE_UTILITIES_THREAD_POOL_H_INCLUDED
+#define SCM_CORE_UTILITIES_THREAD_POOL_H_INCLUDED
+
+#include <deque>
+#include <vector>
+
+#include <scm/core/utilities/boost_warning_disable.h>
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <scm/core/utilities/boost_warning_enable.h>
+
+#include <scm/core/memory.h>
+#include <scm/core/numeric_types.h>
+
+#include <scm/core/platform/platform.h>
+#include <scm/core/utilities/platform_warning_disable.h>
+
+namespace boost {
+class thread;
+} // namespace boost
+
+namespace scm {
+
+// fixed set of worker threads processing a shared task queue
+//  - tasks must not throw, exceptions escaping a task are logged and dropped
+//  - parallel_for blocks the caller, which works on one of the chunks itself,
+//    exceptions from any chunk are rethrown in the calling thread, called from a
+//    task of the same pool it runs the whole range inline instead of waiting on
+//    workers that may all be blocked
+class __scm_export(core) thread_pool : boost::noncopyable
+{
+public:
+    typedef boost::function<void ()>                            task_type;
+    typedef boost::function<void (scm::size_t, scm::size_t)>    range_task_type;
+
+public:
+    // thread_count == 0 uses the number of hardware threads
+    thread_pool(unsigned thread_count = 0);
+    virtual ~thread_pool();
+
+    unsigned                    thread_count() const;
+
+    void                        submit(const task_type& t);
+    void                        wait_idle();
+
+    // calls f(b, e) for consecutive sub ranges [b, e) of [begin, end), the
+    // range is split into at most thread_count() + 1 chunks of at least grain elements
+    void                        parallel_for(scm::size_t            begin,
+                                             scm::size_t            end,
+                                             scm::size_t            grain,
+                                             const range_task_type& f);
+
+protected:
+    void                        worker_loop();
+    bool                        is_worker_thread() const;
+
+protected:
+    std::vector<shared_ptr<boost::thread> > _threads;
+
+    std::deque<task_type>       _tasks;
+    scm::size_t                 _active_tasks;
+    bool                        _stop;
+
+    boost::mutex                _mutex;
+    boost::condition_variable   _task_condition;
+    boost::condition_variable   _idle_condition;
+
+}; // class thread_pool
+
+} // namespace scm
+
+#include <scm/core/utilities/platform_warning_enable.h>
+
+#endif // SCM_CORE_UTILITIES_THREAD_POOL_H_INCLUDED
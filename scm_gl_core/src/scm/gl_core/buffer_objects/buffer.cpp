@@ -245,7 +245,22 @@ buffer::buffer_data(const render_device& ren_dev,
         return false;
     }
 
-    if (SCM_GL_CORE_USE_EXT_DIRECT_STATE_ACCESS) {
+    if (in_desc._usage == USAGE_PERSISTENT_WRITE) {
+        // immutable storage can not be respecified
+        if (   !glcore.version_4_4_available
+            || USAGE_PERSISTENT_WRITE == _descriptor._usage) {
+            state().set(object_state::OS_ERROR_INVALID_OPERATION);
+            return false;
+        }
+        util::buffer_binding_guard save_guard(glcore, object_target(), object_binding());
+
+        glcore.glBindBuffer(object_target(), object_id());
+        glcore.glBufferStorage(object_target(),
+                               in_desc._size,
+                               initial_data,
+                               util::gl_buffer_storage_flags(in_desc._usage));
+    }
+    else if (SCM_GL_CORE_USE_EXT_DIRECT_STATE_ACCESS) {
         glcore.glNamedBufferDataEXT(object_id(),
                                     in_desc._size,
                                     initial_data,
@@ -0,0 +1,236 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include "frame_ring_buffer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+#include <scm/gl_core/log.h>
+#include <scm/gl_core/buffer_objects.h>
+#include <scm/gl_core/render_device.h>
+#include <scm/gl_core/sync_objects.h>
+#include <scm/gl_core/render_device/opengl/gl_core.h>
+
+namespace scm {
+namespace gl {
+
+frame_ring_buffer::allocation::allocation()
+  : _offset(0)
+  , _size(0)
+  , _data(0)
+{
+}
+
+frame_ring_buffer::frame_ring_buffer(const render_device_ptr& in_device,
+                                     const scm::size_t        in_capacity,
+                                     const buffer_binding     in_binding)
+  : _device(in_device)
+  , _mapped_data(0)
+  , _capacity(in_capacity)
+  , _alignment(16)
+  , _head(0)
+  , _used(0)
+  , _frame_used(0)
+  , _stall_count(0)
+{
+    const render_device::device_capabilities& caps = in_device->capabilities();
+
+    _alignment = (std::max)(_alignment, static_cast<scm::size_t>(caps._uniform_buffer_offset_alignment));
+    if (in_binding & BIND_STORAGE_BUFFER) {
+        _alignment = (std::max)(_alignment, static_cast<scm::size_t>(caps._shader_storage_buffer_offset_alignment));
+    }
+    _capacity = ((_capacity + _alignment - 1) / _alignment) * _alignment;
+
+    if (0 == _capacity) {
+        throw std::runtime_error("frame_ring_buffer::frame_ring_buffer(): invalid capacity.");
+    }
+
+    if (in_device->opengl_api().version_4_4_available) {
+        _buffer = in_device->create_buffer(in_binding, USAGE_PERSISTENT_WRITE, _capacity);
+        if (_buffer) {
+            _mapped_data = static_cast<scm::uint8*>(in_device->main_context()->map_buffer(_buffer, ACCESS_WRITE_PERSISTENT));
+            if (0 == _mapped_data) {
+                _buffer.reset();
+            }
+        }
+    }
+    if (!_buffer) {
+        _buffer = in_device->create_buffer(in_binding, USAGE_STREAM_DRAW, _capacity);
+    }
+    if (!_buffer) {
+        throw std::runtime_error("frame_ring_buffer::frame_ring_buffer(): unable to create ring buffer.");
+    }
+}
+
+frame_ring_buffer::~frame_ring_buffer()
+{
+    if (render_device_ptr device = _device.lock()) {
+        if (_mapped_data) {
+            device->main_context()->unmap_buffer(_buffer);
+        }
+    }
+    _frame_fences.clear();
+    _mapped_data = 0;
+    _buffer.reset();
+}
+
+frame_ring_buffer::allocation
+frame_ring_buffer::allocate(const render_context_ptr& in_context,
+                            const scm::size_t         in_size)
+{
+    allocation a;
+
+    if (0 == in_size) {
+        return a;
+    }
+    if (in_size > _capacity) {
+        glerr() << log::error
+                << "frame_ring_buffer::allocate(): "
+                << "allocation larger than the ring (size: " << in_size
+                << ", capacity: " << _capacity << ")." << log::end;
+        return a;
+    }
+
+    // padding to the alignment or the wrap around to the ring start is consumed as well
+    scm::size_t offset = ((_head + _alignment - 1) / _alignment) * _alignment;
+    if (offset + in_size > _capacity) {
+        offset = 0;
+    }
+    const scm::size_t consumed = (offset >= _head) ? (offset - _head + in_size)
+                                                   : (_capacity - _head + in_size);
+
+    if (!reclaim(in_context, consumed)) {
+        glerr() << log::error
+                << "frame_ring_buffer::allocate(): "
+                << "ring exhausted by the current frame (size: " << in_size
+                << ", capacity: " << _capacity << ")." << log::end;
+        return a;
+    }
+
+    if (_mapped_data) {
+        a._data = _mapped_data + offset;
+    }
+    else {
+        a._data = in_context->map_buffer_range(_buffer, offset, in_size, ACCESS_WRITE_UNSYNCHRONIZED);
+        if (0 == a._data) {
+            return a;
+        }
+    }
+    a._offset = offset;
+    a._size   = in_size;
+
+    _head        = (offset + in_size) % _capacity;
+    _used       += consumed;
+    _frame_used += consumed;
+
+    return a;
+}
+
+void
+frame_ring_buffer::commit(const render_context_ptr& in_context,
+                          const allocation&         in_allocation)
+{
+    // persistent mappings are coherent, nothing to flush
+    if (!_mapped_data && in_allocation._data) {
+        in_context->unmap_buffer(_buffer);
+    }
+}
+
+frame_ring_buffer::allocation
+frame_ring_buffer::upload(const render_context_ptr& in_context,
+                          const void*               in_data,
+                          const scm::size_t         in_size)
+{
+    allocation a = allocate(in_context, in_size);
+
+    if (a._data) {
+        std::memcpy(a._data, in_data, in_size);
+        commit(in_context, a);
+    }
+
+    return a;
+}
+
+void
+frame_ring_buffer::end_frame(const render_context_ptr& in_context)
+{
+    if (0 == _frame_used) {
+        return;
+    }
+
+    frame_fence f;
+    f._fence = in_context->insert_fence_sync();
+    f._size  = _frame_used;
+
+    _frame_fences.push_back(f);
+    _frame_used = 0;
+}
+
+const buffer_ptr&
+frame_ring_buffer::ring_buffer() const
+{
+    return _buffer;
+}
+
+scm::size_t
+frame_ring_buffer::capacity() const
+{
+    return _capacity;
+}
+
+scm::size_t
+frame_ring_buffer::alignment() const
+{
+    return _alignment;
+}
+
+bool
+frame_ring_buffer::persistent() const
+{
+    return 0 != _mapped_data;
+}
+
+scm::size_t
+frame_ring_buffer::frames_in_flight() const
+{
+    return _frame_fences.size();
+}
+
+scm::size_t
+frame_ring_buffer::stall_count() const
+{
+    return _stall_count;
+}
+
+bool
+frame_ring_buffer::reclaim(const render_context_ptr& in_context,
+                           const scm::size_t         in_size)
+{
+    // release finished frames, oldest first, until the requested bytes are free
+    while (_used + in_size > _capacity && !_frame_fences.empty()) {
+        const frame_fence& f = _frame_fences.front();
+
+        if (f._fence) {
+            const sync_wait_result r = in_context->sync_client_wait(f._fence);
+            if (SYNC_WAIT_CONDITION_SATISFIED == r) {
+                ++_stall_count;
+            }
+            else if (SYNC_WAIT_ALREADY_SIGNALED != r) {
+                glerr() << log::warning
+                        << "frame_ring_buffer::reclaim(): "
+                        << "waiting for frame fence failed." << log::end;
+            }
+        }
+        _used -= f._size;
+        _frame_fences.pop_front();
+    }
+
+    return _used + in_size <= _capacity;
+}
+
+} // namespace gl
+} // namespace scm
@@ -0,0 +1,98 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_GL_CORE_FRAME_RING_BUFFER_H_INCLUDED
+#define SCM_GL_CORE_FRAME_RING_BUFFER_H_INCLUDED
+
+#include <deque>
+
+#include <boost/noncopyable.hpp>
+
+#include <scm/core/numeric_types.h>
+#include <scm/core/memory.h>
+
+#include <scm/gl_core/constants.h>
+#include <scm/gl_core/gl_core_fwd.h>
+
+#include <scm/core/platform/platform.h>
+#include <scm/core/utilities/platform_warning_disable.h>
+
+namespace scm {
+namespace gl {
+
+// ring of streaming memory sub-allocated per frame
+//  - the buffer uses immutable storage mapped once for the lifetime of the ring where
+//    available (OpenGL 4.4), otherwise every allocation maps its range unsynchronized
+//    until commit
+//  - allocations are aligned to the uniform buffer offset alignment and stay valid until
+//    the end of the frame they were made in, end_frame fences the frame and the range is
+//    reused once the fence signaled
+//  - the ring only waits on a fence if the requested range is still in flight
+class __scm_export(gl_core) frame_ring_buffer : boost::noncopyable
+{
+public:
+    struct allocation {
+        allocation();
+
+        scm::size_t         _offset;
+        scm::size_t         _size;
+        void*               _data;      // null if the allocation failed
+    }; // struct allocation
+
+public:
+    frame_ring_buffer(const render_device_ptr& in_device,
+                      const scm::size_t        in_capacity,
+                      const buffer_binding     in_binding = BIND_UNIFORM_BUFFER);
+    virtual ~frame_ring_buffer();
+
+    // the data of an allocation is written until commit, without persistent mapping only
+    // one allocation can be pending at a time
+    allocation              allocate(const render_context_ptr& in_context,
+                                     const scm::size_t         in_size);
+    void                    commit(const render_context_ptr& in_context,
+                                   const allocation&         in_allocation);
+    allocation              upload(const render_context_ptr& in_context,
+                                   const void*               in_data,
+                                   const scm::size_t         in_size);
+
+    void                    end_frame(const render_context_ptr& in_context);
+
+    const buffer_ptr&       ring_buffer() const;
+    scm::size_t             capacity() const;
+    scm::size_t             alignment() const;
+    bool                    persistent() const;
+    scm::size_t             frames_in_flight() const;
+    scm::size_t             stall_count() const;
+
+protected:
+    struct frame_fence {
+        fence_sync_ptr      _fence;
+        scm::size_t         _size;      // bytes consumed by the frame including padding
+    }; // struct frame_fence
+
+    bool                    reclaim(const render_context_ptr& in_context,
+                                    const scm::size_t         in_size);
+
+protected:
+    render_device_wptr      _device;
+    buffer_ptr              _buffer;
+    scm::uint8*             _mapped_data;
+
+    scm::size_t             _capacity;
+    scm::size_t             _alignment;
+    scm::size_t             _head;
+    scm::size_t             _used;
+    scm::size_t             _frame_used;
+
+    std::deque<frame_fence> _frame_fences;
+    scm::size_t             _stall_count;
+
+}; // class frame_ring_buffer
+
+} // namespace gl
+} // namespace scm
+
+#include <scm/core/utilities/platform_warning_enable.h>
+
+#endif // SCM_GL_CORE_FRAME_RING_BUFFER_H_INCLUDED
@@ -14,6 +14,9 @@ namespace scm {
 namespace gl {
 
 // uniform_block //////////////////////////////////////////////////////////////////////////////////
+// blocks created on a frame_ring_buffer are sub-allocated from the ring on every
+// end_manipulation, the device block is only valid during the frame it was committed in and
+// has to be bound using block_offset and block_size
 template <class host_block_type>
 class uniform_block
 {
@@ -26,6 +29,8 @@ public:
     uniform_block();
     uniform_block(const render_device_ptr& in_device);
     uniform_block(const render_device_ptr& in_device, const host_block_type& in_block);
+    uniform_block(const frame_ring_buffer_ptr& in_ring);
+    uniform_block(const frame_ring_buffer_ptr& in_ring, const host_block_type& in_block);
     ~uniform_block();
 
     void                        reset();
@@ -38,6 +43,11 @@ public:
     block_type*                 get_block() const;
 
     const buffer_ptr&           block_buffer() const;
+    scm::size_t                 block_offset() const;
+    scm::size_t                 block_size() const;
+
+    void                        bind(const render_context_ptr& in_context,
+                                     const unsigned            in_bind_point) const;
 
 protected:
     void                        commit_block(const render_context_ptr& in_context);
@@ -45,6 +55,9 @@ protected:
 protected:
     shared_ptr<block_type>      _host_block;
     buffer_ptr                  _device_block;
+    frame_ring_buffer_ptr       _ring;
+    scm::size_t                 _block_offset;
+    scm::size_t                 _block_size;        // 0 binds the whole buffer
     render_context_ptr          _current_context;
 
 }; // class uniform_block
@@ -56,6 +69,10 @@ make_uniform_block(const render_device_ptr& in_device);
 template <class host_block_type>
 uniform_block<host_block_type>
 make_uniform_block(const render_device_ptr& in_device, const host_block_type& in_block);
+
+template <class host_block_type>
+uniform_block<host_block_type>
+make_uniform_block(const frame_ring_buffer_ptr& in_ring);
 // end uniform_block //////////////////////////////////////////////////////////////////////////////
 
 // uniform_block_array ////////////////////////////////////////////////////////////////////////////
@@ -70,6 +87,7 @@ public:
 public:
     uniform_block_array();
     uniform_block_array(const render_device_ptr& in_device, const scm::size_t in_array_size);
+    uniform_block_array(const frame_ring_buffer_ptr& in_ring, const scm::size_t in_array_size);
     ~uniform_block_array();
 
     void                        reset();
@@ -84,12 +102,18 @@ public:
     const buffer_ptr&           block_buffer() const;
     const scm::size_t           array_size() const;
 
+    void                        bind(const render_context_ptr& in_context,
+                                     const unsigned            in_bind_point,
+                                     const scm::size_t         in_index) const;
+
 protected:
     void                        commit_block(const render_context_ptr& in_context);
 
 protected:
     shared_array<block_type>    _host_block;
     buffer_ptr                  _device_block;
+    frame_ring_buffer_ptr       _ring;
+    scm::size_t                 _block_offset;
     scm::size_t                 _array_size;
     scm::size_t                 _array_element_alignment;
 
@@ -100,6 +124,10 @@ protected:
 template <class host_block_type>
 uniform_block_array<host_block_type>
 make_uniform_block_array(const render_device_ptr& in_device, const scm::size_t in_array_size);
+
+template <class host_block_type>
+uniform_block_array<host_block_type>
+make_uniform_block_array(const frame_ring_buffer_ptr& in_ring, const scm::size_t in_array_size);
 // end uniform_block_array ////////////////////////////////////////////////////////////////////////
 
 } // namespace gl
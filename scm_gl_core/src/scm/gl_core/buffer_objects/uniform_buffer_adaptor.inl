@@ -15,12 +15,16 @@ namespace gl {
 // uniform_block //////////////////////////////////////////////////////////////////////////////////
 template <class host_block_type>
 uniform_block<host_block_type>::uniform_block()
+  : _block_offset(0)
+  , _block_size(0)
 {
 }
 
 template <class host_block_type>
 uniform_block<host_block_type>::uniform_block(const render_device_ptr& in_device)
   : _host_block(new host_block_type())
+  , _block_offset(0)
+  , _block_size(0)
 {
     _device_block = in_device->create_buffer(BIND_UNIFORM_BUFFER, USAGE_STREAM_DRAW, sizeof(host_block_type));
 }
@@ -28,11 +32,34 @@ uniform_block<host_block_type>::uniform_block(const render_device_ptr& in_device
 template <class host_block_type>
 uniform_block<host_block_type>::uniform_block(const render_device_ptr& in_device, const host_block_type& in_block)
   : _host_block(new host_block_type(in_block))
+  , _block_offset(0)
+  , _block_size(0)
 {
     _device_block = in_device->create_buffer(BIND_UNIFORM_BUFFER, USAGE_STREAM_DRAW, sizeof(host_block_type));
     commit_block(in_device->main_context());
 }
 
+template <class host_block_type>
+uniform_block<host_block_type>::uniform_block(const frame_ring_buffer_ptr& in_ring)
+  : _host_block(new host_block_type())
+  , _device_block(in_ring->ring_buffer())
+  , _ring(in_ring)
+  , _block_offset(0)
+  , _block_size(0)
+{
+}
+
+// the block is uploaded on the first end_manipulation
+template <class host_block_type>
+uniform_block<host_block_type>::uniform_block(const frame_ring_buffer_ptr& in_ring, const host_block_type& in_block)
+  : _host_block(new host_block_type(in_block))
+  , _device_block(in_ring->ring_buffer())
+  , _ring(in_ring)
+  , _block_offset(0)
+  , _block_size(0)
+{
+}
+
 template <class host_block_type>
 uniform_block<host_block_type>::~uniform_block()
 {
@@ -44,6 +71,7 @@ void
 uniform_block<host_block_type>::reset()
 {
     _device_block.reset();
+    _ring.reset();
     _host_block.reset();
 }
 
@@ -96,6 +124,28 @@ uniform_block<host_block_type>::block_buffer() const
     return (_device_block);
 }
 
+template <class host_block_type>
+scm::size_t
+uniform_block<host_block_type>::block_offset() const
+{
+    return (_block_offset);
+}
+
+template <class host_block_type>
+scm::size_t
+uniform_block<host_block_type>::block_size() const
+{
+    return (_block_size);
+}
+
+template <class host_block_type>
+void
+uniform_block<host_block_type>::bind(const render_context_ptr& in_context,
+                                     const unsigned            in_bind_point) const
+{
+    in_context->bind_uniform_buffer(_device_block, in_bind_point, _block_offset, _block_size);
+}
+
 template <class host_block_type>
 void
 uniform_block<host_block_type>::commit_block(const render_context_ptr& in_context)
@@ -105,6 +155,17 @@ uniform_block<host_block_type>::commit_block(const render_context_ptr& in_contex
     assert(_device_block);
     assert(_host_block);
 
+    if (_ring) {
+        frame_ring_buffer::allocation a = _ring->upload(in_context, _host_block.get(), sizeof(block_type));
+        if (0 == a._data) {
+            std::cerr << "uniform_block<>::commit_block(): error allocating block from frame ring." << std::endl; 
+            return;
+        }
+        _block_offset = a._offset;
+        _block_size   = a._size;
+        return;
+    }
+
     block_type* gpu_block = reinterpret_cast<block_type*>(in_context->map_buffer(_device_block, ACCESS_WRITE_INVALIDATE_BUFFER));
 
     if (memcpy(gpu_block, _host_block.get(), sizeof(block_type)) != gpu_block) {
@@ -128,20 +189,29 @@ make_uniform_block(const render_device_ptr& in_device, const host_block_type& in
     return (uniform_block<host_block_type>(in_device, in_block));
 }
 
+template <class host_block_type>
+uniform_block<host_block_type>
+make_uniform_block(const frame_ring_buffer_ptr& in_ring)
+{
+    return (uniform_block<host_block_type>(in_ring));
+}
+
 // end uniform_block //////////////////////////////////////////////////////////////////////////////
 
 // uniform_block_array ////////////////////////////////////////////////////////////////////////////
 template <class host_block_type>
 uniform_block_array<host_block_type>::uniform_block_array()
-  : _array_size(0)
+  : _block_offset(0)
+  , _array_size(0)
+  , _array_element_alignment(0)
 {
 }
 
 template <class host_block_type>
 uniform_block_array<host_block_type>::uniform_block_array(const render_device_ptr& in_device, const scm::size_t in_array_size)
   : _host_block(new host_block_type[in_array_size])
+  , _block_offset(0)
   , _array_size(in_array_size)
-
 {
     //scm::size_t a = in_device->capabilities()._uniform_buffer_offset_alignment;
     scm::size_t a = 16;
@@ -153,6 +223,21 @@ uniform_block_array<host_block_type>::uniform_block_array(const render_device_pt
     commit_block(in_device->main_context());
 }
 
+// the elements are uploaded on the first end_manipulation
+template <class host_block_type>
+uniform_block_array<host_block_type>::uniform_block_array(const frame_ring_buffer_ptr& in_ring, const scm::size_t in_array_size)
+  : _host_block(new host_block_type[in_array_size])
+  , _device_block(in_ring->ring_buffer())
+  , _ring(in_ring)
+  , _block_offset(0)
+  , _array_size(in_array_size)
+{
+    scm::size_t a = in_ring->alignment();
+    scm::size_t s = sizeof(host_block_type);
+
+    _array_element_alignment = ((s / a) + (s % a > 0 ? 1 : 0)) * a;
+}
+
 template <class host_block_type>
 uniform_block_array<host_block_type>::~uniform_block_array()
 {
@@ -164,6 +249,7 @@ void
 uniform_block_array<host_block_type>::reset()
 {
     _device_block.reset();
+    _ring.reset();
     _host_block.reset();
 }
 
@@ -209,7 +295,7 @@ scm::size_t
 uniform_block_array<host_block_type>::block_offset(const scm::size_t in_index) const
 {
     assert(in_index < _array_size);
-    return (in_index * _array_element_alignment);
+    return (_block_offset + in_index * _array_element_alignment);
 }
 
 template <class host_block_type>
@@ -226,6 +312,15 @@ uniform_block_array<host_block_type>::array_size() const
   return _array_size;
 }
 
+template <class host_block_type>
+void
+uniform_block_array<host_block_type>::bind(const render_context_ptr& in_context,
+                                           const unsigned            in_bind_point,
+                                           const scm::size_t         in_index) const
+{
+    in_context->bind_uniform_buffer(_device_block, in_bind_point, block_offset(in_index), sizeof(block_type));
+}
+
 template <class host_block_type>
 void
 uniform_block_array<host_block_type>::commit_block(const render_context_ptr& in_context)
@@ -235,7 +330,21 @@ uniform_block_array<host_block_type>::commit_block(const render_context_ptr& in_
     assert(_device_block);
     assert(_host_block);
 
-    block_type* gpu_block = reinterpret_cast<block_type*>(in_context->map_buffer(_device_block, ACCESS_WRITE_INVALIDATE_BUFFER));
+    block_type* gpu_block = 0;
+    frame_ring_buffer::allocation ring_block;
+
+    if (_ring) {
+        ring_block = _ring->allocate(in_context, _array_size * _array_element_alignment);
+        if (0 == ring_block._data) {
+            std::cerr << "uniform_block_array<>::commit_block(): error allocating blocks from frame ring." << std::endl; 
+            return;
+        }
+        gpu_block     = reinterpret_cast<block_type*>(ring_block._data);
+        _block_offset = ring_block._offset;
+    }
+    else {
+        gpu_block = reinterpret_cast<block_type*>(in_context->map_buffer(_device_block, ACCESS_WRITE_INVALIDATE_BUFFER));
+    }
 
     for (scm::size_t i = 0; i < _array_size; ++i) {
         char* dst_ptr = reinterpret_cast<char*>(gpu_block) + i * _array_element_alignment;
@@ -244,7 +353,12 @@ uniform_block_array<host_block_type>::commit_block(const render_context_ptr& in_
         }
     }
 
-    in_context->unmap_buffer(_device_block);
+    if (_ring) {
+        _ring->commit(in_context, ring_block);
+    }
+    else {
+        in_context->unmap_buffer(_device_block);
+    }
 }
 
 template <class host_block_type>
@@ -253,6 +367,13 @@ make_uniform_block_array(const render_device_ptr& in_device, const scm::size_t i
 {
     return (uniform_block_array<host_block_type>(in_device, in_array_size));
 }
+
+template <class host_block_type>
+uniform_block_array<host_block_type>
+make_uniform_block_array(const frame_ring_buffer_ptr& in_ring, const scm::size_t in_array_size)
+{
+    return (uniform_block_array<host_block_type>(in_ring, in_array_size));
+}
 // end uniform_block_array ////////////////////////////////////////////////////////////////////////
 
 } // namespace gl
@@ -47,6 +47,8 @@ enum buffer_usage
     USAGE_DYNAMIC_DRAW,       // GPU r,  CPU w
     USAGE_DYNAMIC_READ,       // GPU w,  CPU r
     USAGE_DYNAMIC_COPY,       // GPU rw, CPU
+    // immutable storage, coherent persistent mapping
+    USAGE_PERSISTENT_WRITE,   // GPU r,  CPU w
 
     USAGE_COUNT
 }; // enum buffer_usage
@@ -59,6 +61,7 @@ enum access_mode
     ACCESS_WRITE_INVALIDATE_RANGE,
     ACCESS_WRITE_INVALIDATE_BUFFER,
     ACCESS_WRITE_UNSYNCHRONIZED,
+    ACCESS_WRITE_PERSISTENT,        // buffers with USAGE_PERSISTENT_WRITE only
 
     ACCESS_COUNT
 }; // enum access_mode
@@ -8,6 +8,7 @@
 #include <scm/gl_core/primitives/primitives_fwd.h>
 #include <scm/gl_core/primitives/box.h>
 #include <scm/gl_core/primitives/frustum.h>
+#include <scm/gl_core/primitives/frustum_culler.h>
 #include <scm/gl_core/primitives/plane.h>
 #include <scm/gl_core/primitives/ray.h>
 #include <scm/gl_core/primitives/rect.h>
@@ -0,0 +1,236 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include "frustum_culler.h"
+
+#include <algorithm>
+#include <utility>
+
+#include <scm/core/utilities/boost_warning_disable.h>
+#include <boost/thread/mutex.hpp>
+#include <scm/core/utilities/boost_warning_enable.h>
+
+#include <scm/core/utilities/thread_pool.h>
+
+#include <scm/gl_core/primitives/frustum.h>
+
+#if SCM_CORE_MATH_SIMD == SCM_CORE_MATH_SIMD_SSE
+#include <xmmintrin.h>
+#endif // SCM_CORE_MATH_SIMD == SCM_CORE_MATH_SIMD_SSE
+
+namespace {
+
+// smaller batches are not worth the synchronization with the pool threads
+const scm::size_t parallel_grain = 16 * 1024;
+
+// coordinate streams of the p-vertex of a plane, selected by the octant of the plane normal
+struct p_vertex_streams
+{
+    p_vertex_streams(const scm::math::const_box3f_stream& boxes, unsigned corner)
+      : x(corner & 1u ? boxes.max.x : boxes.min.x)
+      , y(corner & 2u ? boxes.max.y : boxes.min.y)
+      , z(corner & 4u ? boxes.max.z : boxes.min.z)
+    {}
+    p_vertex_streams() : x(0), y(0), z(0) {}
+
+    const float*    x;
+    const float*    y;
+    const float*    z;
+}; // struct p_vertex_streams
+
+inline bool
+outside(const p_vertex_streams& v, const float* plane, scm::size_t i)
+{
+    const float d =   v.x[i] * plane[0]
+                    + v.y[i] * plane[1]
+                    + v.z[i] * plane[2]
+                    + plane[3];
+
+    return d <= scm::gl::epsilon<float>::value();
+}
+
+} // namespace
+
+namespace scm {
+namespace gl {
+
+const scm::uint8 frustum_culler::no_plane;
+
+frustum_culler::frustum_culler()
+{
+    update(frustumf());
+}
+
+frustum_culler::frustum_culler(const frustumf& f)
+{
+    update(f);
+}
+
+void
+frustum_culler::update(const frustumf& f)
+{
+    for (unsigned p = 0; p < 6; ++p) {
+        const planef& pl = f.get_plane(p);
+        for (unsigned c = 0; c < 4; ++c) {
+            _planes[p][c] = pl.vector()[c];
+        }
+        _p_corners[p] = pl.p_corner();
+    }
+}
+
+scm::size_t
+frustum_culler::cull(const math::const_box3f_stream& boxes,
+                     scm::size_t                     n,
+                     index_array&                    visible,
+                     thread_pool*                    pool) const
+{
+    return cull_impl(boxes, n, 0, visible, pool);
+}
+
+scm::size_t
+frustum_culler::cull(const math::const_box3f_stream& boxes,
+                     scm::size_t                     n,
+                     plane_cache&                    cache,
+                     index_array&                    visible,
+                     thread_pool*                    pool) const
+{
+    if (cache.size() != n) {
+        cache.assign(n, no_plane);
+    }
+    return cull_impl(boxes, n, n > 0 ? &cache[0] : 0, visible, pool);
+}
+
+scm::size_t
+frustum_culler::cull_impl(const math::const_box3f_stream& boxes,
+                          scm::size_t                     n,
+                          scm::uint8*                     cache,
+                          index_array&                    visible,
+                          thread_pool*                    pool) const
+{
+    visible.clear();
+
+    if (!pool || n < 2 * parallel_grain) {
+        visible.reserve(n);
+        cull_range(boxes, cache, 0, n, visible);
+        return visible.size();
+    }
+
+    // per chunk index lists, concatenated in range order afterwards
+    typedef std::pair<scm::size_t, index_array> chunk_result;
+
+    std::vector<chunk_result>   chunks;
+    boost::mutex                chunks_mutex;
+
+    pool->parallel_for(0, n, parallel_grain, [&](scm::size_t b, scm::size_t e) {
+        index_array chunk_visible;
+        chunk_visible.reserve(e - b);
+        cull_range(boxes, cache, b, e, chunk_visible);
+
+        boost::mutex::scoped_lock lock(chunks_mutex);
+        chunks.push_back(chunk_result(b, index_array()));
+        chunks.back().second.swap(chunk_visible);
+    });
+
+    std::sort(chunks.begin(), chunks.end(),
+              [](const chunk_result& lhs, const chunk_result& rhs) { return lhs.first < rhs.first; });
+
+    scm::size_t visible_count = 0;
+    for (std::size_t c = 0; c < chunks.size(); ++c) {
+        visible_count += chunks[c].second.size();
+    }
+    visible.reserve(visible_count);
+    for (std::size_t c = 0; c < chunks.size(); ++c) {
+        visible.insert(visible.end(), chunks[c].second.begin(), chunks[c].second.end());
+    }
+
+    return visible.size();
+}
+
+void
+frustum_culler::cull_range(const math::const_box3f_stream& boxes,
+                           scm::uint8*                     cache,
+                           scm::size_t                     b,
+                           scm::size_t                     e,
+                           index_array&                    visible) const
+{
+    p_vertex_streams pv[6];
+    for (unsigned p = 0; p < 6; ++p) {
+        pv[p] = p_vertex_streams(boxes, _p_corners[p]);
+    }
+
+    scm::size_t i = b;
+#if SCM_CORE_MATH_SIMD == SCM_CORE_MATH_SIMD_SSE
+    const __m128 eps4 = _mm_set1_ps(epsilon<float>::value());
+
+    for (; i + 4 <= e; i += 4) {
+        unsigned rejected = 0;
+
+        // plane coherency, the cached plane rejects most boxes that stayed outside
+        if (cache) {
+            for (unsigned l = 0; l < 4; ++l) {
+                const scm::uint8 p = cache[i + l];
+                if (p != no_plane && outside(pv[p], _planes[p], i + l)) {
+                    rejected |= 1u << l;
+                }
+            }
+        }
+
+        for (unsigned p = 0; p < 6 && rejected != 0xf; ++p) {
+            const __m128   x = _mm_loadu_ps(pv[p].x + i);
+            const __m128   y = _mm_loadu_ps(pv[p].y + i);
+            const __m128   z = _mm_loadu_ps(pv[p].z + i);
+
+            const __m128   d = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(_planes[p][0])),
+                                                                _mm_mul_ps(y, _mm_set1_ps(_planes[p][1]))),
+                                                     _mm_mul_ps(z, _mm_set1_ps(_planes[p][2]))),
+                                          _mm_set1_ps(_planes[p][3]));
+
+            const unsigned m = static_cast<unsigned>(_mm_movemask_ps(_mm_cmple_ps(d, eps4))) & ~rejected;
+            if (m && cache) {
+                for (unsigned l = 0; l < 4; ++l) {
+                    if (m & (1u << l)) {
+                        cache[i + l] = static_cast<scm::uint8>(p);
+                    }
+                }
+            }
+            rejected |= m;
+        }
+
+        for (unsigned l = 0; l < 4; ++l) {
+            if (!(rejected & (1u << l))) {
+                visible.push_back(static_cast<scm::uint32>(i + l));
+                if (cache) {
+                    cache[i + l] = no_plane;
+                }
+            }
+        }
+    }
+#endif // SCM_CORE_MATH_SIMD == SCM_CORE_MATH_SIMD_SSE
+
+    for (; i < e; ++i) {
+        bool is_outside = false;
+
+        if (cache && cache[i] != no_plane) {
+            is_outside = outside(pv[cache[i]], _planes[cache[i]], i);
+        }
+        for (unsigned p = 0; p < 6 && !is_outside; ++p) {
+            if (outside(pv[p], _planes[p], i)) {
+                is_outside = true;
+                if (cache) {
+                    cache[i] = static_cast<scm::uint8>(p);
+                }
+            }
+        }
+
+        if (!is_outside) {
+            visible.push_back(static_cast<scm::uint32>(i));
+            if (cache) {
+                cache[i] = no_plane;
+            }
+        }
+    }
+}
+
+} // namespace gl
+} // namespace scm
@@ -0,0 +1,80 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_GL_CORE_PRIMITIVES_FRUSTUM_CULLER_H_INCLUDED
+#define SCM_GL_CORE_PRIMITIVES_FRUSTUM_CULLER_H_INCLUDED
+
+#include <vector>
+
+#include <scm/core/numeric_types.h>
+#include <scm/core/math/batch.h>
+
+#include <scm/gl_core/primitives/primitives_fwd.h>
+
+#include <scm/core/platform/platform.h>
+#include <scm/core/utilities/platform_warning_disable.h>
+
+namespace scm {
+
+class thread_pool;
+
+namespace gl {
+
+// bulk frustum culling of axis aligned boxes in structure of arrays layout
+//  - four boxes are tested against one plane at a time, only the p-vertex of each
+//    plane (the box corner furthest along the plane normal) is evaluated
+//  - same results as frustumf::classify(box) != frustumf::outside for every box
+//  - the plane cache keeps the last rejecting plane per box, it is tested first
+//    in the next call (plane coherency between frames)
+class __scm_export(gl_core) frustum_culler
+{
+public:
+    typedef std::vector<scm::uint32>    index_array;
+    typedef std::vector<scm::uint8>     plane_cache;
+
+    static const scm::uint8             no_plane = 0xff;
+
+public:
+    frustum_culler();
+    explicit frustum_culler(const frustumf& f);
+
+    void                    update(const frustumf& f);
+
+    // fills visible with the ascending indices of the boxes not outside the frustum,
+    // returns the number of visible boxes
+    scm::size_t             cull(const math::const_box3f_stream& boxes,
+                                 scm::size_t                     n,
+                                 index_array&                    visible,
+                                 thread_pool*                    pool = 0) const;
+    // cache is reset to no_plane if it does not hold n entries
+    scm::size_t             cull(const math::const_box3f_stream& boxes,
+                                 scm::size_t                     n,
+                                 plane_cache&                    cache,
+                                 index_array&                    visible,
+                                 thread_pool*                    pool = 0) const;
+
+protected:
+    scm::size_t             cull_impl(const math::const_box3f_stream& boxes,
+                                      scm::size_t                     n,
+                                      scm::uint8*                     cache,
+                                      index_array&                    visible,
+                                      thread_pool*                    pool) const;
+    void                    cull_range(const math::const_box3f_stream& boxes,
+                                       scm::uint8*                     cache,
+                                       scm::size_t                     b,
+                                       scm::size_t                     e,
+                                       index_array&                    visible) const;
+
+protected:
+    float                   _planes[6][4];
+    unsigned                _p_corners[6];
+
+}; // class frustum_culler
+
+} // namespace gl
+} // namespace scm
+
+#include <scm/core/utilities/platform_warning_enable.h>
+
+#endif // SCM_GL_CORE_PRIMITIVES_FRUSTUM_CULLER_H_INCLUDED
@@ -14,6 +14,8 @@ template<typename s> class plane_impl;
 template<typename s> class rect_impl;
 template<typename s> class ray_impl;
 
+class frustum_culler;
+
 typedef box_impl<float>         boxf;
 typedef box_impl<double>        boxd;
 
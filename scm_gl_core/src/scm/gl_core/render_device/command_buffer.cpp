@@ -0,0 +1,448 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include "command_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace scm {
+namespace gl {
+
+command_buffer::recorded_state::recorded_state()
+  : _known(0)
+  , _stencil_ref(0)
+  , _line_width(1.0f)
+  , _point_size(1.0f)
+  , _blend_color(math::vec4f(1.0f, 1.0f, 1.0f, 1.0f))
+  , _default_frame_buffer(FRAMEBUFFER_BACK)
+  , _viewport(math::vec2ui(0, 0), math::vec2ui(0, 0))
+{
+}
+
+void
+command_buffer::recorded_state::reset()
+{
+    _known = 0;
+    _program.reset();
+    _vertex_array.reset();
+    _index_buffer = render_context::index_buffer_binding();
+    _texture_units.clear();
+    _texture_units_known.clear();
+    _uniform_buffers.clear();
+    _uniform_buffers_known.clear();
+    _storage_buffers.clear();
+    _storage_buffers_known.clear();
+    _depth_stencil_state.reset();
+    _rasterizer_state.reset();
+    _blend_state.reset();
+    _frame_buffer.reset();
+}
+
+command_buffer::command_buffer()
+  : _command_count(0)
+  , _filtered_command_count(0)
+{
+}
+
+command_buffer::~command_buffer()
+{
+}
+
+void
+command_buffer::reset()
+{
+    _stream.clear();
+    _command_count          = 0;
+    _filtered_command_count = 0;
+
+    _programs.clear();
+    _uniforms.clear();
+    _vertex_arrays.clear();
+    _buffers.clear();
+    _textures.clear();
+    _sampler_states.clear();
+    _depth_stencil_states.clear();
+    _rasterizer_states.clear();
+    _blend_states.clear();
+    _frame_buffers.clear();
+
+    _recorded.reset();
+}
+
+bool
+command_buffer::empty() const
+{
+    return _command_count == 0;
+}
+
+scm::size_t
+command_buffer::command_count() const
+{
+    return _command_count;
+}
+
+scm::size_t
+command_buffer::filtered_command_count() const
+{
+    return _filtered_command_count;
+}
+
+scm::size_t
+command_buffer::stream_size() const
+{
+    return _stream.size() * sizeof(scm::uint64);
+}
+
+void
+command_buffer::command_types(std::vector<command_type>& out_types) const
+{
+    out_types.clear();
+    out_types.reserve(_command_count);
+
+    for (scm::size_t w = 0; w < _stream.size(); ) {
+        const command_header* h = reinterpret_cast<const command_header*>(&_stream[w]);
+        out_types.push_back(static_cast<command_type>(h->_type));
+        w += h->_size;
+    }
+}
+
+void
+command_buffer::bind_program(const program_ptr& in_program)
+{
+    if (known(SLOT_PROGRAM) && _recorded._program == in_program) {
+        ++_filtered_command_count;
+        return;
+    }
+    _recorded._program = in_program;
+
+    append_command(CMD_BIND_PROGRAM, static_cast<scm::uint32>(_programs.size()), 0);
+    _programs.push_back(in_program);
+}
+
+void
+command_buffer::bind_vertex_array(const vertex_array_ptr& in_vertex_array)
+{
+    if (known(SLOT_VERTEX_ARRAY) && _recorded._vertex_array == in_vertex_array) {
+        ++_filtered_command_count;
+        return;
+    }
+    _recorded._vertex_array = in_vertex_array;
+
+    append_command(CMD_BIND_VERTEX_ARRAY, static_cast<scm::uint32>(_vertex_arrays.size()), 0);
+    _vertex_arrays.push_back(in_vertex_array);
+}
+
+void
+command_buffer::bind_index_buffer(const buffer_ptr&        in_buffer,
+                                  const primitive_topology in_topology,
+                                  const data_type          in_index_type,
+                                  const scm::size_t        in_offset)
+{
+    render_context::index_buffer_binding ib;
+    ib._index_buffer       = in_buffer;
+    ib._primitive_topology = in_topology;
+    ib._index_data_type    = in_index_type;
+    ib._index_data_offset  = in_offset;
+
+    if (known(SLOT_INDEX_BUFFER) && _recorded._index_buffer == ib) {
+        ++_filtered_command_count;
+        return;
+    }
+    _recorded._index_buffer = ib;
+
+    index_buffer_args* a = append<index_buffer_args>(CMD_BIND_INDEX_BUFFER, static_cast<scm::uint32>(_buffers.size()));
+    a->_topology   = static_cast<scm::uint32>(in_topology);
+    a->_index_type = static_cast<scm::uint32>(in_index_type);
+    a->_offset     = static_cast<scm::uint64>(in_offset);
+    _buffers.push_back(in_buffer);
+}
+
+void
+command_buffer::bind_uniform_buffer(const buffer_ptr& in_buffer,
+                                    const unsigned    in_bind_point,
+                                    const scm::size_t in_offset,
+                                    const scm::size_t in_size)
+{
+    if (filter_buffer_range(_recorded._uniform_buffers, _recorded._uniform_buffers_known,
+                            in_buffer, in_bind_point, in_offset, in_size)) {
+        ++_filtered_command_count;
+        return;
+    }
+
+    buffer_range_args* a = append<buffer_range_args>(CMD_BIND_UNIFORM_BUFFER, static_cast<scm::uint32>(_buffers.size()));
+    a->_bind_point = in_bind_point;
+    a->_offset     = static_cast<scm::uint64>(in_offset);
+    a->_size       = static_cast<scm::uint64>(in_size);
+    _buffers.push_back(in_buffer);
+}
+
+void
+command_buffer::bind_storage_buffer(const buffer_ptr& in_buffer,
+                                    const unsigned    in_bind_point,
+                                    const scm::size_t in_offset,
+                                    const scm::size_t in_size)
+{
+    if (filter_buffer_range(_recorded._storage_buffers, _recorded._storage_buffers_known,
+                            in_buffer, in_bind_point, in_offset, in_size)) {
+        ++_filtered_command_count;
+        return;
+    }
+
+    buffer_range_args* a = append<buffer_range_args>(CMD_BIND_STORAGE_BUFFER, static_cast<scm::uint32>(_buffers.size()));
+    a->_bind_point = in_bind_point;
+    a->_offset     = static_cast<scm::uint64>(in_offset);
+    a->_size       = static_cast<scm::uint64>(in_size);
+    _buffers.push_back(in_buffer);
+}
+
+void
+command_buffer::bind_texture(const texture_ptr&       in_texture_image,
+                             const sampler_state_ptr& in_sampler_state,
+                             const unsigned           in_unit)
+{
+    if (in_unit >= _recorded._texture_units.size()) {
+        _recorded._texture_units.resize(in_unit + 1);
+        _recorded._texture_units_known.resize(in_unit + 1, false);
+    }
+
+    render_context::texture_unit_binding& tu = _recorded._texture_units[in_unit];
+    if (   _recorded._texture_units_known[in_unit]
+        && tu._texture_image == in_texture_image
+        && tu._sampler_state == in_sampler_state) {
+        ++_filtered_command_count;
+        return;
+    }
+    _recorded._texture_units_known[in_unit] = true;
+    tu._texture_image = in_texture_image;
+    tu._sampler_state = in_sampler_state;
+
+    texture_args* a = append<texture_args>(CMD_BIND_TEXTURE, static_cast<scm::uint32>(_textures.size()));
+    a->_sampler = static_cast<scm::uint32>(_sampler_states.size());
+    a->_unit    = in_unit;
+    _textures.push_back(in_texture_image);
+    _sampler_states.push_back(in_sampler_state);
+}
+
+void
+command_buffer::set_depth_stencil_state(const depth_stencil_state_ptr& in_ds_state, unsigned in_stencil_ref)
+{
+    if (   known(SLOT_DEPTH_STENCIL)
+        && _recorded._depth_stencil_state == in_ds_state
+        && _recorded._stencil_ref         == in_stencil_ref) {
+        ++_filtered_command_count;
+        return;
+    }
+    _recorded._depth_stencil_state = in_ds_state;
+    _recorded._stencil_ref         = in_stencil_ref;
+
+    depth_stencil_args* a = append<depth_stencil_args>(CMD_SET_DEPTH_STENCIL_STATE, static_cast<scm::uint32>(_depth_stencil_states.size()));
+    a->_stencil_ref = in_stencil_ref;
+    _depth_stencil_states.push_back(in_ds_state);
+}
+
+void
+command_buffer::set_rasterizer_state(const rasterizer_state_ptr& in_rs_state, float in_line_width, float in_point_size)
+{
+    if (   known(SLOT_RASTERIZER)
+        && _recorded._rasterizer_state == in_rs_state
+        && _recorded._line_width       == in_line_width
+        && _recorded._point_size       == in_point_size) {
+        ++_filtered_command_count;
+        return;
+    }
+    _recorded._rasterizer_state = in_rs_state;
+    _recorded._line_width       = in_line_width;
+    _recorded._point_size       = in_point_size;
+
+    rasterizer_args* a = append<rasterizer_args>(CMD_SET_RASTERIZER_STATE, static_cast<scm::uint32>(_rasterizer_states.size()));
+    a->_line_width = in_line_width;
+    a->_point_size = in_point_size;
+    _rasterizer_states.push_back(in_rs_state);
+}
+
+void
+command_buffer::set_blend_state(const blend_state_ptr& in_bl_state, const math::vec4f& in_blend_color)
+{
+    if (   known(SLOT_BLEND)
+        && _recorded._blend_state == in_bl_state
+        && _recorded._blend_color == in_blend_color) {
+        ++_filtered_command_count;
+        return;
+    }
+    _recorded._blend_state = in_bl_state;
+    _recorded._blend_color = in_blend_color;
+
+    blend_args* a = append<blend_args>(CMD_SET_BLEND_STATE, static_cast<scm::uint32>(_blend_states.size()));
+    for (unsigned c = 0; c < 4; ++c) {
+        a->_color[c] = in_blend_color[c];
+    }
+    _blend_states.push_back(in_bl_state);
+}
+
+void
+command_buffer::set_frame_buffer(const frame_buffer_ptr& in_frame_buffer)
+{
+    if (   known(SLOT_FRAME_BUFFER)
+        && _recorded._frame_buffer == in_frame_buffer
+        && in_frame_buffer) {
+        ++_filtered_command_count;
+        return;
+    }
+    _recorded._frame_buffer = in_frame_buffer;
+
+    append_command(CMD_SET_FRAME_BUFFER, static_cast<scm::uint32>(_frame_buffers.size()), 0);
+    _frame_buffers.push_back(in_frame_buffer);
+}
+
+void
+command_buffer::set_default_frame_buffer(const frame_buffer_target in_target)
+{
+    if (   known(SLOT_FRAME_BUFFER)
+        && !_recorded._frame_buffer
+        && _recorded._default_frame_buffer == in_target) {
+        ++_filtered_command_count;
+        return;
+    }
+    _recorded._frame_buffer.reset();
+    _recorded._default_frame_buffer = in_target;
+
+    default_frame_buffer_args* a = append<default_frame_buffer_args>(CMD_SET_DEFAULT_FRAME_BUFFER, 0);
+    a->_target = static_cast<scm::uint32>(in_target);
+}
+
+void
+command_buffer::set_viewport(const viewport& in_vp)
+{
+    if (known(SLOT_VIEWPORT) && _recorded._viewport == in_vp) {
+        ++_filtered_command_count;
+        return;
+    }
+    _recorded._viewport = in_vp;
+
+    viewport_args* a = append<viewport_args>(CMD_SET_VIEWPORT, 0);
+    for (unsigned c = 0; c < 2; ++c) {
+        a->_position[c]    = in_vp._position[c];
+        a->_dimensions[c]  = in_vp._dimensions[c];
+        a->_depth_range[c] = in_vp._depth_range[c];
+    }
+}
+
+void
+command_buffer::draw_arrays(const primitive_topology in_topology, const int in_first_index, const int in_count)
+{
+    draw_arrays_args* a = append<draw_arrays_args>(CMD_DRAW_ARRAYS, 0);
+    a->_topology       = static_cast<scm::uint32>(in_topology);
+    a->_first          = in_first_index;
+    a->_count          = in_count;
+    a->_instance_count = 1;
+}
+
+void
+command_buffer::draw_arrays_instanced(const primitive_topology in_topology, const int in_first_index, const int in_count, const int in_instance_count)
+{
+    draw_arrays_args* a = append<draw_arrays_args>(CMD_DRAW_ARRAYS_INSTANCED, 0);
+    a->_topology       = static_cast<scm::uint32>(in_topology);
+    a->_first          = in_first_index;
+    a->_count          = in_count;
+    a->_instance_count = in_instance_count;
+}
+
+void
+command_buffer::draw_elements(const int in_count, const int in_start_index, const int in_base_vertex)
+{
+    draw_elements_args* a = append<draw_elements_args>(CMD_DRAW_ELEMENTS, 0);
+    a->_count          = in_count;
+    a->_start_index    = in_start_index;
+    a->_instance_count = 1;
+    a->_base_vertex    = in_base_vertex;
+    a->_base_instance  = 0;
+}
+
+void
+command_buffer::draw_elements_instanced(const int in_count, const int in_start_index, const int in_instance_count, const int in_base_vertex, const int in_base_instance)
+{
+    draw_elements_args* a = append<draw_elements_args>(CMD_DRAW_ELEMENTS_INSTANCED, 0);
+    a->_count          = in_count;
+    a->_start_index    = in_start_index;
+    a->_instance_count = in_instance_count;
+    a->_base_vertex    = in_base_vertex;
+    a->_base_instance  = in_base_instance;
+}
+
+scm::uint64*
+command_buffer::append_command(command_type in_type, scm::uint32 in_object, scm::size_t in_args_size)
+{
+    const scm::size_t words = 1 + (in_args_size + 7) / 8;
+    const scm::size_t start = _stream.size();
+
+    assert(words <= 0xffffu);
+
+    _stream.resize(start + words);
+
+    command_header* h = reinterpret_cast<command_header*>(&_stream[start]);
+    h->_type   = static_cast<scm::uint16>(in_type);
+    h->_size   = static_cast<scm::uint16>(words);
+    h->_object = in_object;
+
+    ++_command_count;
+
+    return &_stream[start] + 1;
+}
+
+bool
+command_buffer::known(recorded_slot in_slot)
+{
+    const bool k = (_recorded._known & in_slot) != 0;
+    _recorded._known |= in_slot;
+    return k;
+}
+
+bool
+command_buffer::filter_buffer_range(render_context::buffer_binding_array& io_bindings,
+                                    std::vector<bool>&                    io_known,
+                                    const buffer_ptr&                     in_buffer,
+                                    const unsigned                        in_bind_point,
+                                    const scm::size_t                     in_offset,
+                                    const scm::size_t                     in_size)
+{
+    if (in_bind_point >= io_bindings.size()) {
+        io_bindings.resize(in_bind_point + 1);
+        io_known.resize(in_bind_point + 1, false);
+    }
+
+    render_context::buffer_binding& b = io_bindings[in_bind_point];
+    if (   io_known[in_bind_point]
+        && b._buffer == in_buffer
+        && b._offset == in_offset
+        && b._size   == in_size) {
+        return true;
+    }
+    io_known[in_bind_point] = true;
+    b._buffer = in_buffer;
+    b._offset = in_offset;
+    b._size   = in_size;
+
+    return false;
+}
+
+void
+command_buffer::append_uniform(const uniform_ptr& in_uniform,
+                               uniform_apply_func in_apply,
+                               int                in_element,
+                               const void*        in_value,
+                               scm::size_t        in_value_size)
+{
+    scm::uint64* args = append_command(CMD_UNIFORM, static_cast<scm::uint32>(_uniforms.size()), sizeof(uniform_args) + in_value_size);
+
+    uniform_args* a = new (args) uniform_args();
+    a->_apply   = in_apply;
+    a->_element = in_element;
+    std::memcpy(a + 1, in_value, in_value_size);
+
+    _uniforms.push_back(in_uniform);
+}
+
+} // namespace gl
+} // namespace scm
@@ -0,0 +1,278 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_GL_CORE_COMMAND_BUFFER_H_INCLUDED
+#define SCM_GL_CORE_COMMAND_BUFFER_H_INCLUDED
+
+#include <string>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <scm/core/math.h>
+#include <scm/core/numeric_types.h>
+
+#include <scm/gl_core/constants.h>
+#include <scm/gl_core/data_types.h>
+#include <scm/gl_core/gl_core_fwd.h>
+#include <scm/gl_core/frame_buffer_objects/viewport.h>
+#include <scm/gl_core/render_device/context.h>
+#include <scm/gl_core/shader_objects/program.h>
+#include <scm/gl_core/shader_objects/uniform.h>
+
+#include <scm/core/platform/platform.h>
+#include <scm/core/utilities/platform_warning_disable.h>
+
+namespace scm {
+namespace gl {
+
+// linear stream of recorded render_context commands
+//  - recording does not touch the GL and only needs the resources to be created,
+//    command buffers can be recorded on any thread, one thread per buffer
+//  - redundant binds (same object and parameters as the last recorded bind of
+//    the same slot) are filtered at record time, the context filters the remaining
+//    ones against its applied state on replay
+//  - draws apply the current context state before drawing
+//  - uniform values are written through target.apply_uniform on replay, the
+//    program uploads them when it is applied for the next draw
+//  - replay(target) calls the render_context interface on target in recording
+//    order, render_context::execute() replays into the context
+class __scm_export(gl_core) command_buffer : boost::noncopyable
+{
+public:
+    typedef enum {
+        CMD_BIND_PROGRAM            = 0x00,
+        CMD_UNIFORM,
+        CMD_BIND_VERTEX_ARRAY,
+        CMD_BIND_INDEX_BUFFER,
+        CMD_BIND_TEXTURE,
+        CMD_BIND_UNIFORM_BUFFER,
+        CMD_BIND_STORAGE_BUFFER,
+        CMD_SET_DEPTH_STENCIL_STATE,
+        CMD_SET_RASTERIZER_STATE,
+        CMD_SET_BLEND_STATE,
+        CMD_SET_FRAME_BUFFER,
+        CMD_SET_DEFAULT_FRAME_BUFFER,
+        CMD_SET_VIEWPORT,
+        CMD_DRAW_ARRAYS,
+        CMD_DRAW_ARRAYS_INSTANCED,
+        CMD_DRAW_ELEMENTS,
+        CMD_DRAW_ELEMENTS_INSTANCED,
+
+        CMD_COUNT
+    } command_type;
+
+public:
+    command_buffer();
+    virtual ~command_buffer();
+
+    // drops all commands and referenced objects, the stream memory is kept
+    void                        reset();
+
+    bool                        empty() const;
+    scm::size_t                 command_count() const;
+    scm::size_t                 filtered_command_count() const;
+    scm::size_t                 stream_size() const;            // in bytes
+    // command types in recording order
+    void                        command_types(std::vector<command_type>& out_types) const;
+
+    // shader api
+    void                        bind_program(const program_ptr& in_program);
+    // the uniform is looked up in the program at record time
+    template<typename T> void   uniform(const program_ptr& in_program, const std::string& in_name, const T& in_value);
+    template<typename T> void   uniform(const program_ptr& in_program, const std::string& in_name, int in_element, const T& in_value);
+
+    // vertex input
+    void                        bind_vertex_array(const vertex_array_ptr& in_vertex_array);
+    void                        bind_index_buffer(const buffer_ptr&        in_buffer,
+                                                  const primitive_topology in_topology,
+                                                  const data_type          in_index_type,
+                                                  const scm::size_t        in_offset = 0);
+    void                        bind_uniform_buffer(const buffer_ptr& in_buffer,
+                                                    const unsigned    in_bind_point,
+                                                    const scm::size_t in_offset = 0,
+                                                    const scm::size_t in_size = 0);
+    void                        bind_storage_buffer(const buffer_ptr& in_buffer,
+                                                    const unsigned    in_bind_point,
+                                                    const scm::size_t in_offset = 0,
+                                                    const scm::size_t in_size = 0);
+
+    // textures
+    void                        bind_texture(const texture_ptr&       in_texture_image,
+                                             const sampler_state_ptr& in_sampler_state,
+                                             const unsigned           in_unit);
+
+    // state objects
+    void                        set_depth_stencil_state(const depth_stencil_state_ptr& in_ds_state, unsigned in_stencil_ref = 0);
+    void                        set_rasterizer_state(const rasterizer_state_ptr& in_rs_state, float in_line_width = 1.0f, float in_point_size = 1.0f);
+    void                        set_blend_state(const blend_state_ptr& in_bl_state, const math::vec4f& in_blend_color = math::vec4f(1.0f, 1.0f, 1.0f, 1.0f));
+
+    // frame buffer
+    void                        set_frame_buffer(const frame_buffer_ptr& in_frame_buffer);
+    void                        set_default_frame_buffer(const frame_buffer_target in_target = FRAMEBUFFER_BACK);
+    void                        set_viewport(const viewport& in_vp);
+
+    // draws
+    void                        draw_arrays(const primitive_topology in_topology, const int in_first_index, const int in_count);
+    void                        draw_arrays_instanced(const primitive_topology in_topology, const int in_first_index, const int in_count, const int in_instance_count = 1);
+    void                        draw_elements(const int in_count, const int in_start_index = 0, const int in_base_vertex = 0);
+    void                        draw_elements_instanced(const int in_count, const int in_start_index = 0, const int in_instance_count = 1, const int in_base_vertex = 0, const int in_base_instance = 0);
+
+    // target provides the render_context binding, state and draw interface used above
+    template<typename target>
+    void                        replay(target& t) const;
+
+protected:
+    typedef render_context::uniform_apply_func  uniform_apply_func;
+
+    // every command starts with a header, the stream is made of 8 byte words
+    struct command_header {
+        scm::uint16             _type;
+        scm::uint16             _size;      // in words including the header
+        scm::uint32             _object;    // index into the object array of the command type
+    }; // struct command_header
+    struct index_buffer_args {
+        scm::uint32             _topology;
+        scm::uint32             _index_type;
+        scm::uint64             _offset;
+    }; // struct index_buffer_args
+    struct buffer_range_args {
+        scm::uint32             _bind_point;
+        scm::uint32             _padding;
+        scm::uint64             _offset;
+        scm::uint64             _size;
+    }; // struct buffer_range_args
+    struct texture_args {
+        scm::uint32             _sampler;
+        scm::uint32             _unit;
+    }; // struct texture_args
+    struct depth_stencil_args {
+        scm::uint32             _stencil_ref;
+        scm::uint32             _padding;
+    }; // struct depth_stencil_args
+    struct rasterizer_args {
+        float                   _line_width;
+        float                   _point_size;
+    }; // struct rasterizer_args
+    struct blend_args {
+        float                   _color[4];
+    }; // struct blend_args
+    struct default_frame_buffer_args {
+        scm::uint32             _target;
+        scm::uint32             _padding;
+    }; // struct default_frame_buffer_args
+    struct viewport_args {
+        float                   _position[2];
+        float                   _dimensions[2];
+        float                   _depth_range[2];
+    }; // struct viewport_args
+    struct uniform_args {
+        uniform_apply_func      _apply;
+        scm::int32              _element;
+        scm::uint32             _padding;
+    }; // struct uniform_args                     followed by the value
+    struct draw_arrays_args {
+        scm::uint32             _topology;
+        scm::int32              _first;
+        scm::int32              _count;
+        scm::int32              _instance_count;
+    }; // struct draw_arrays_args
+    struct draw_elements_args {
+        scm::int32              _count;
+        scm::int32              _start_index;
+        scm::int32              _instance_count;
+        scm::int32              _base_vertex;
+        scm::int32              _base_instance;
+        scm::int32              _padding;
+    }; // struct draw_elements_args
+
+    // what was last recorded for each binding slot, unknown until first recorded
+    struct recorded_state {
+        recorded_state();
+        void                    reset();
+
+        scm::uint32             _known;     // bit per recorded_slot
+        program_ptr             _program;
+        vertex_array_ptr        _vertex_array;
+        render_context::index_buffer_binding    _index_buffer;
+        render_context::texture_unit_array      _texture_units;
+        std::vector<bool>                       _texture_units_known;
+        render_context::buffer_binding_array    _uniform_buffers;
+        std::vector<bool>                       _uniform_buffers_known;
+        render_context::buffer_binding_array    _storage_buffers;
+        std::vector<bool>                       _storage_buffers_known;
+        depth_stencil_state_ptr _depth_stencil_state;
+        unsigned                _stencil_ref;
+        rasterizer_state_ptr    _rasterizer_state;
+        float                   _line_width;
+        float                   _point_size;
+        blend_state_ptr         _blend_state;
+        math::vec4f             _blend_color;
+        frame_buffer_ptr        _frame_buffer;      // null after set_default_frame_buffer
+        frame_buffer_target     _default_frame_buffer;
+        viewport                _viewport;
+    }; // struct recorded_state
+
+    typedef enum {
+        SLOT_PROGRAM            = 0x01,
+        SLOT_VERTEX_ARRAY       = 0x02,
+        SLOT_INDEX_BUFFER       = 0x04,
+        SLOT_DEPTH_STENCIL      = 0x08,
+        SLOT_RASTERIZER         = 0x10,
+        SLOT_BLEND              = 0x20,
+        SLOT_FRAME_BUFFER       = 0x40,
+        SLOT_VIEWPORT           = 0x80
+    } recorded_slot;
+
+    scm::uint64*                append_command(command_type in_type, scm::uint32 in_object, scm::size_t in_args_size);
+    template<typename args_type>
+    args_type*                  append(command_type in_type, scm::uint32 in_object);
+    // true if the slot was recorded before, marks it recorded
+    bool                        known(recorded_slot in_slot);
+    bool                        filter_buffer_range(render_context::buffer_binding_array& io_bindings,
+                                                    std::vector<bool>&                    io_known,
+                                                    const buffer_ptr&                     in_buffer,
+                                                    const unsigned                        in_bind_point,
+                                                    const scm::size_t                     in_offset,
+                                                    const scm::size_t                     in_size);
+    void                        append_uniform(const uniform_ptr& in_uniform,
+                                               uniform_apply_func in_apply,
+                                               int                in_element,
+                                               const void*        in_value,
+                                               scm::size_t        in_value_size);
+
+    template<typename T>
+    static void                 apply_uniform_value(uniform_base& u, int element, const void* value);
+
+    template<typename args_type>
+    static const args_type&     arguments(const command_header* in_command);
+
+protected:
+    std::vector<scm::uint64>                _stream;
+    scm::size_t                             _command_count;
+    scm::size_t                             _filtered_command_count;
+
+    std::vector<program_ptr>                _programs;
+    std::vector<uniform_ptr>                _uniforms;
+    std::vector<vertex_array_ptr>           _vertex_arrays;
+    std::vector<buffer_ptr>                 _buffers;
+    std::vector<texture_ptr>                _textures;
+    std::vector<sampler_state_ptr>          _sampler_states;
+    std::vector<depth_stencil_state_ptr>    _depth_stencil_states;
+    std::vector<rasterizer_state_ptr>       _rasterizer_states;
+    std::vector<blend_state_ptr>            _blend_states;
+    std::vector<frame_buffer_ptr>           _frame_buffers;
+
+    recorded_state                          _recorded;
+
+}; // class command_buffer
+
+} // namespace gl
+} // namespace scm
+
+#include "command_buffer.inl"
+
+#include <scm/core/utilities/platform_warning_enable.h>
+
+#endif // SCM_GL_CORE_COMMAND_BUFFER_H_INCLUDED
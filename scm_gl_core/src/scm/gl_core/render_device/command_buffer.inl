@@ -0,0 +1,163 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include <cassert>
+#include <new>
+
+#include <scm/gl_core/log.h>
+
+namespace scm {
+namespace gl {
+
+template<typename args_type>
+inline
+args_type*
+command_buffer::append(command_type in_type, scm::uint32 in_object)
+{
+    return new (append_command(in_type, in_object, sizeof(args_type))) args_type();
+}
+
+template<typename args_type>
+inline
+const args_type&
+command_buffer::arguments(const command_header* in_command)
+{
+    return *reinterpret_cast<const args_type*>(reinterpret_cast<const scm::uint64*>(in_command) + 1);
+}
+
+template<typename T>
+inline
+void
+command_buffer::apply_uniform_value(uniform_base& u, int element, const void* value)
+{
+    typedef typename scm::gl::uniform_type<T>::type cur_uniform_type;
+    static_cast<cur_uniform_type&>(u).set_value(element, *reinterpret_cast<const T*>(value));
+}
+
+template<typename T>
+inline
+void
+command_buffer::uniform(const program_ptr& in_program, const std::string& in_name, const T& in_value)
+{
+    uniform(in_program, in_name, 0, in_value);
+}
+
+template<typename T>
+inline
+void
+command_buffer::uniform(const program_ptr& in_program, const std::string& in_name, int in_element, const T& in_value)
+{
+    typedef typename scm::gl::uniform_type<T>::type cur_uniform_type;
+
+    const uniform_ptr u = in_program ? in_program->uniform_raw(in_name) : uniform_ptr();
+    if (!u) {
+        SCM_GL_DGB("command_buffer::uniform(): unable to find uniform ('" << in_name << "').");
+        return;
+    }
+    if (!dynamic_pointer_cast<cur_uniform_type>(u)) {
+        SCM_GL_DGB("command_buffer::uniform(): found non matching uniform type '" << type_string(uniform_data_type<T>::type)
+                                                                                << "' ('uniform: " << in_name << ", " << type_string(u->type()) << ").");
+        return;
+    }
+
+    append_uniform(u, &command_buffer::apply_uniform_value<T>, in_element, &in_value, sizeof(T));
+}
+
+template<typename target>
+inline
+void
+command_buffer::replay(target& t) const
+{
+    const scm::uint64* cur = _stream.empty() ? 0 : &_stream[0];
+    const scm::uint64* end = cur + _stream.size();
+
+    while (cur < end) {
+        const command_header* h = reinterpret_cast<const command_header*>(cur);
+
+        switch (h->_type) {
+            case CMD_BIND_PROGRAM:
+                t.bind_program(_programs[h->_object]);
+                break;
+            case CMD_UNIFORM: {
+                    const uniform_args& a = arguments<uniform_args>(h);
+                    t.apply_uniform(_uniforms[h->_object], a._apply, a._element, &a + 1);
+                } break;
+            case CMD_BIND_VERTEX_ARRAY:
+                t.bind_vertex_array(_vertex_arrays[h->_object]);
+                break;
+            case CMD_BIND_INDEX_BUFFER: {
+                    const index_buffer_args& a = arguments<index_buffer_args>(h);
+                    t.bind_index_buffer(_buffers[h->_object],
+                                        static_cast<primitive_topology>(a._topology),
+                                        static_cast<data_type>(a._index_type),
+                                        static_cast<scm::size_t>(a._offset));
+                } break;
+            case CMD_BIND_TEXTURE: {
+                    const texture_args& a = arguments<texture_args>(h);
+                    t.bind_texture(_textures[h->_object], _sampler_states[a._sampler], a._unit);
+                } break;
+            case CMD_BIND_UNIFORM_BUFFER: {
+                    const buffer_range_args& a = arguments<buffer_range_args>(h);
+                    t.bind_uniform_buffer(_buffers[h->_object], a._bind_point,
+                                          static_cast<scm::size_t>(a._offset), static_cast<scm::size_t>(a._size));
+                } break;
+            case CMD_BIND_STORAGE_BUFFER: {
+                    const buffer_range_args& a = arguments<buffer_range_args>(h);
+                    t.bind_storage_buffer(_buffers[h->_object], a._bind_point,
+                                          static_cast<scm::size_t>(a._offset), static_cast<scm::size_t>(a._size));
+                } break;
+            case CMD_SET_DEPTH_STENCIL_STATE:
+                t.set_depth_stencil_state(_depth_stencil_states[h->_object],
+                                          arguments<depth_stencil_args>(h)._stencil_ref);
+                break;
+            case CMD_SET_RASTERIZER_STATE: {
+                    const rasterizer_args& a = arguments<rasterizer_args>(h);
+                    t.set_rasterizer_state(_rasterizer_states[h->_object], a._line_width, a._point_size);
+                } break;
+            case CMD_SET_BLEND_STATE: {
+                    const blend_args& a = arguments<blend_args>(h);
+                    t.set_blend_state(_blend_states[h->_object], math::vec4f(a._color[0], a._color[1], a._color[2], a._color[3]));
+                } break;
+            case CMD_SET_FRAME_BUFFER:
+                t.set_frame_buffer(_frame_buffers[h->_object]);
+                break;
+            case CMD_SET_DEFAULT_FRAME_BUFFER:
+                t.set_default_frame_buffer(static_cast<frame_buffer_target>(arguments<default_frame_buffer_args>(h)._target));
+                break;
+            case CMD_SET_VIEWPORT: {
+                    const viewport_args& a = arguments<viewport_args>(h);
+                    t.set_viewport(viewport(math::vec2f(a._position[0],    a._position[1]),
+                                            math::vec2f(a._dimensions[0],  a._dimensions[1]),
+                                            math::vec2f(a._depth_range[0], a._depth_range[1])));
+                } break;
+            case CMD_DRAW_ARRAYS: {
+                    const draw_arrays_args& a = arguments<draw_arrays_args>(h);
+                    t.apply();
+                    t.draw_arrays(static_cast<primitive_topology>(a._topology), a._first, a._count);
+                } break;
+            case CMD_DRAW_ARRAYS_INSTANCED: {
+                    const draw_arrays_args& a = arguments<draw_arrays_args>(h);
+                    t.apply();
+                    t.draw_arrays_instanced(static_cast<primitive_topology>(a._topology), a._first, a._count, a._instance_count);
+                } break;
+            case CMD_DRAW_ELEMENTS: {
+                    const draw_elements_args& a = arguments<draw_elements_args>(h);
+                    t.apply();
+                    t.draw_elements(a._count, a._start_index, a._base_vertex);
+                } break;
+            case CMD_DRAW_ELEMENTS_INSTANCED: {
+                    const draw_elements_args& a = arguments<draw_elements_args>(h);
+                    t.apply();
+                    t.draw_elements_instanced(a._count, a._start_index, a._instance_count, a._base_vertex, a._base_instance);
+                } break;
+            default:
+                assert(0);
+        }
+
+        cur += h->_size;
+    }
+}
+
+} // namespace gl
+} // namespace scm
@@ -15,6 +15,7 @@
 #include <scm/gl_core/state_objects.h>
 #include <scm/gl_core/sync_objects.h>
 #include <scm/gl_core/texture_objects.h>
+#include <scm/gl_core/render_device/command_buffer.h>
 #include <scm/gl_core/render_device/device.h>
 #include <scm/gl_core/render_device/opengl/gl_core.h>
 #include <scm/gl_core/render_device/opengl/util/assert.h>
@@ -58,6 +59,20 @@ render_context::index_buffer_binding::operator!=(const index_buffer_binding& rhs
            || (_index_data_offset  != rhs._index_data_offset);
 }
 
+bool
+render_context::texture_unit_binding::operator==(const texture_unit_binding& rhs) const
+{
+    return    (_texture_image == rhs._texture_image)
+           && (_sampler_state == rhs._sampler_state);
+}
+
+bool
+render_context::texture_unit_binding::operator!=(const texture_unit_binding& rhs) const
+{
+    return    (_texture_image != rhs._texture_image)
+           || (_sampler_state != rhs._sampler_state);
+}
+
 bool
 render_context::buffer_binding::operator==(const buffer_binding& rhs) const
 {
@@ -113,6 +128,100 @@ render_context::binding_state_type::binding_state_type()
 {
 }
 
+render_context::binding_dirty_mask::binding_dirty_mask()
+  : _size(0)
+  , _begin(0)
+  , _end(0)
+{
+}
+
+void
+render_context::binding_dirty_mask::resize(unsigned in_size)
+{
+    _size = in_size;
+    _bits.assign((in_size + 63) / 64, 0u);
+    _begin = _end = 0;
+}
+
+void
+render_context::binding_dirty_mask::set(unsigned in_slot)
+{
+    assert(in_slot < _size);
+
+    _bits[in_slot >> 6] |= scm::uint64(1) << (in_slot & 63u);
+    if (_begin < _end) {
+        _begin = (std::min)(_begin, in_slot);
+        _end   = (std::max)(_end,   in_slot + 1);
+    }
+    else {
+        _begin = in_slot;
+        _end   = in_slot + 1;
+    }
+}
+
+void
+render_context::binding_dirty_mask::clear()
+{
+    if (_begin < _end) {
+        std::fill(_bits.begin() + (_begin >> 6), _bits.begin() + ((_end + 63) >> 6), 0u);
+    }
+    _begin = _end = 0;
+}
+
+bool
+render_context::binding_dirty_mask::any() const
+{
+    return _begin < _end;
+}
+
+template<typename func>
+void
+render_context::binding_dirty_mask::for_each(func f) const
+{
+    // only the words of the dirty range are visited
+    const unsigned word_end = (_end + 63) >> 6;
+    for (unsigned w = _begin >> 6; w < word_end; ++w) {
+        scm::uint64 bits = _bits[w];
+        for (unsigned s = w << 6; bits != 0; ++s, bits >>= 1) {
+            if (bits & 1u) {
+                f(s);
+            }
+        }
+    }
+}
+
+template<typename binding_type>
+void
+render_context::assign_bindings(const std::vector<binding_type>& in_bindings,
+                                std::vector<binding_type>&       out_bindings,
+                                binding_dirty_mask&              out_dirty)
+{
+    // element wise, the binding arrays keep their size and storage
+    assert(in_bindings.size() == out_bindings.size());
+
+    const scm::size_t count = (std::min)(in_bindings.size(), out_bindings.size());
+    for (scm::size_t i = 0; i < count; ++i) {
+        if (out_bindings[i] != in_bindings[i]) {
+            out_bindings[i] = in_bindings[i];
+            out_dirty.set(static_cast<unsigned>(i));
+        }
+    }
+}
+
+template<typename binding_type>
+void
+render_context::fill_bindings(const binding_type&        in_binding,
+                              std::vector<binding_type>& out_bindings,
+                              binding_dirty_mask&        out_dirty)
+{
+    for (scm::size_t i = 0; i < out_bindings.size(); ++i) {
+        if (out_bindings[i] != in_binding) {
+            out_bindings[i] = in_binding;
+            out_dirty.set(static_cast<unsigned>(i));
+        }
+    }
+}
+
 render_context::render_context(render_device& in_device)
   : render_device_child(in_device)
   , _opengl_api_core(in_device.opengl_api())
@@ -134,22 +243,32 @@ render_context::render_context(render_device& in_device)
     _current_state._blend_state = _default_blend_state;
     _applied_state._blend_state = _default_blend_state;
 
+    // the binding arrays are sized once here, the set_* functions only assign elements
     _current_state._texture_units.resize(in_device.capabilities()._max_texture_image_units);
     _applied_state._texture_units.resize(in_device.capabilities()._max_texture_image_units);
+    _dirty_texture_units.resize(in_device.capabilities()._max_texture_image_units);
+#if SCM_GL_CORE_OPENGL_CORE_VERSION >= SCM_GL_CORE_OPENGL_CORE_VERSION_440
+    _texture_unit_object_ids.resize(in_device.capabilities()._max_texture_image_units, 0u);
+    _texture_unit_sampler_ids.resize(in_device.capabilities()._max_texture_image_units, 0u);
+#endif // SCM_GL_CORE_OPENGL_CORE_VERSION >= SCM_GL_CORE_OPENGL_CORE_VERSION_440
     if (   glapi.extension_EXT_shader_image_load_store
         && in_device.capabilities()._max_image_units > 0) {
         _current_state._image_units.resize(in_device.capabilities()._max_image_units);
         _applied_state._image_units.resize(in_device.capabilities()._max_image_units);
+        _dirty_image_units.resize(in_device.capabilities()._max_image_units);
     }
 
     _current_state._active_uniform_buffers.resize(in_device.capabilities()._max_uniform_buffer_bindings);
     _applied_state._active_uniform_buffers.resize(in_device.capabilities()._max_uniform_buffer_bindings);
+    _dirty_uniform_buffers.resize(in_device.capabilities()._max_uniform_buffer_bindings);
 
     _current_state._active_atomic_counter_buffers.resize(in_device.capabilities()._max_atomic_counter_buffer_bindings);
     _applied_state._active_atomic_counter_buffers.resize(in_device.capabilities()._max_atomic_counter_buffer_bindings);
+    _dirty_atomic_counter_buffers.resize(in_device.capabilities()._max_atomic_counter_buffer_bindings);
 
     _current_state._active_storage_buffers.resize(in_device.capabilities()._max_shader_storage_block_bindings);
     _applied_state._active_storage_buffers.resize(in_device.capabilities()._max_shader_storage_block_bindings);
+    _dirty_storage_buffers.resize(in_device.capabilities()._max_shader_storage_block_bindings);
 
     glapi.glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
     glapi.glPixelStorei(GL_PACK_ALIGNMENT, 1);
@@ -206,6 +325,16 @@ render_context::reset()
     reset_program();
 }
 
+void
+render_context::execute(const command_buffer& in_commands)
+{
+    gl_assert(opengl_api(), entering render_context::execute());
+
+    in_commands.replay(*this);
+
+    gl_assert(opengl_api(), leaving render_context::execute());
+}
+
 void
 render_context::flush()
 {
@@ -649,6 +778,7 @@ render_context::bind_uniform_buffer(const buffer_ptr& in_buffer,
         _current_state._active_uniform_buffers[in_bind_point]._buffer = in_buffer;
         _current_state._active_uniform_buffers[in_bind_point]._offset = in_offset;
         _current_state._active_uniform_buffers[in_bind_point]._size   = in_size;
+        _dirty_uniform_buffers.set(in_bind_point);
     }
     else {
         glerr() << log::error
@@ -663,7 +793,7 @@ render_context::bind_uniform_buffer(const buffer_ptr& in_buffer,
 void
 render_context::set_uniform_buffers(const buffer_binding_array& in_buffers)
 {
-    _current_state._active_uniform_buffers = in_buffers;
+    assign_bindings(in_buffers, _current_state._active_uniform_buffers, _dirty_uniform_buffers);
 }
 
 const render_context::buffer_binding_array&
@@ -675,9 +805,7 @@ render_context::current_uniform_buffers() const
 void
 render_context::reset_uniform_buffers()
 {
-    std::fill(_current_state._active_uniform_buffers.begin(),
-              _current_state._active_uniform_buffers.end(),
-              buffer_binding());
+    fill_bindings(buffer_binding(), _current_state._active_uniform_buffers, _dirty_uniform_buffers);
 }
 
 void
@@ -690,6 +818,7 @@ render_context::bind_atomic_counter_buffer(const buffer_ptr& in_buffer,
         _current_state._active_atomic_counter_buffers[in_bind_point]._buffer = in_buffer;
         _current_state._active_atomic_counter_buffers[in_bind_point]._offset = in_offset;
         _current_state._active_atomic_counter_buffers[in_bind_point]._size   = in_size;
+        _dirty_atomic_counter_buffers.set(in_bind_point);
     }
     else {
         glerr() << log::error
@@ -704,7 +833,7 @@ render_context::bind_atomic_counter_buffer(const buffer_ptr& in_buffer,
 void
 render_context::set_atomic_counter_buffers(const buffer_binding_array& in_buffers)
 {
-    _current_state._active_atomic_counter_buffers = in_buffers;
+    assign_bindings(in_buffers, _current_state._active_atomic_counter_buffers, _dirty_atomic_counter_buffers);
 }
 
 const render_context::buffer_binding_array&
@@ -716,9 +845,7 @@ render_context::current_atomic_counter_buffers() const
 void
 render_context::reset_atomic_counter_buffers()
 {
-    std::fill(_current_state._active_atomic_counter_buffers.begin(),
-              _current_state._active_atomic_counter_buffers.end(),
-              buffer_binding());
+    fill_bindings(buffer_binding(), _current_state._active_atomic_counter_buffers, _dirty_atomic_counter_buffers);
 }
 
 void
@@ -731,6 +858,7 @@ render_context::bind_storage_buffer(const buffer_ptr& in_buffer,
         _current_state._active_storage_buffers[in_bind_point]._buffer = in_buffer;
         _current_state._active_storage_buffers[in_bind_point]._offset = in_offset;
         _current_state._active_storage_buffers[in_bind_point]._size   = in_size;
+        _dirty_storage_buffers.set(in_bind_point);
     }
     else {
         glerr() << log::error
@@ -745,7 +873,7 @@ render_context::bind_storage_buffer(const buffer_ptr& in_buffer,
 void
 render_context::set_storage_buffers(const buffer_binding_array& in_buffers)
 {
-    _current_state._active_storage_buffers = in_buffers;
+    assign_bindings(in_buffers, _current_state._active_storage_buffers, _dirty_storage_buffers);
 }
 
 const render_context::buffer_binding_array&
@@ -757,9 +885,7 @@ render_context::current_storage_buffers() const
 void
 render_context::reset_storage_buffers()
 {
-    std::fill(_current_state._active_storage_buffers.begin(),
-              _current_state._active_storage_buffers.end(),
-              buffer_binding());
+    fill_bindings(buffer_binding(), _current_state._active_storage_buffers, _dirty_storage_buffers);
 }
 
 void
@@ -782,6 +908,26 @@ render_context::current_unpack_buffer() const
     return _unpack_buffer;
 }
 
+void
+render_context::bind_indirect_buffer(const buffer_ptr& in_buffer)
+{
+    if (_indirect_buffer != in_buffer) {
+        if (in_buffer) {
+            in_buffer->bind(*this, BIND_INDIRECT_BUFFER);
+        }
+        else {
+            _indirect_buffer->unbind(*this, BIND_INDIRECT_BUFFER);
+        }
+        _indirect_buffer = in_buffer;
+    }
+}
+
+const buffer_ptr&
+render_context::current_indirect_buffer() const
+{
+    return _indirect_buffer;
+}
+
 void
 render_context::bind_vertex_array(const vertex_array_ptr& in_vertex_array)
 {
@@ -1066,6 +1212,41 @@ render_context::draw_elements_instanced(const int in_count, const int in_start_i
     gl_assert(glapi, leaving render_context::draw_elements_instanced());
 }
 
+void
+render_context::multi_draw_elements_indirect(const int in_draw_count, const scm::size_t in_offset, const int in_stride)
+{
+    const opengl::gl_core& glapi = opengl_api();
+
+    if (!util::is_vaild_index_type(_applied_state._index_buffer_binding._index_data_type)) {
+        state().set(object_state::OS_ERROR_INVALID_ENUM);
+        return;
+    }
+    if (   (0 > in_draw_count)
+        || (0 > in_stride)) {
+        state().set(object_state::OS_ERROR_INVALID_VALUE);
+        SCM_GL_DGB("render_context::multi_draw_elements_indirect(): error invalid draw count or stride (< 0) " << "('" << state().state_string() << "')");
+        return;
+    }
+    if (!_indirect_buffer) {
+        state().set(object_state::OS_ERROR_INVALID_OPERATION);
+        SCM_GL_DGB("render_context::multi_draw_elements_indirect(): error no indirect buffer bound " << "('" << state().state_string() << "')");
+        return;
+    }
+
+    pre_draw_setup();
+
+    glapi.glMultiDrawElementsIndirect(
+        util::gl_primitive_topology(_applied_state._index_buffer_binding._primitive_topology),
+        util::gl_base_type(_applied_state._index_buffer_binding._index_data_type),
+        (char*)0 + in_offset,
+        in_draw_count,
+        in_stride);
+
+    post_draw_setup();
+
+    gl_assert(glapi, leaving render_context::multi_draw_elements_indirect());
+}
+
 
 
 bool
@@ -1171,7 +1352,11 @@ render_context::apply_vertex_input()
 void
 render_context::apply_uniform_buffer_bindings()
 {
-    for (int i = 0; i < _current_state._active_uniform_buffers.size(); ++i) {
+    if (!_dirty_uniform_buffers.any()) {
+        return;
+    }
+
+    _dirty_uniform_buffers.for_each([this](unsigned i) {
         const buffer_binding&   cubb = _current_state._active_uniform_buffers[i];
         buffer_binding&         aubb = _applied_state._active_uniform_buffers[i];
 
@@ -1185,13 +1370,18 @@ render_context::apply_uniform_buffer_bindings()
             }
             aubb = cubb;
         }
-    }
+    });
+    _dirty_uniform_buffers.clear();
 }
 
 void
 render_context::apply_atomic_counter_bindings()
 {
-    for (int i = 0; i < _current_state._active_atomic_counter_buffers.size(); ++i) {
+    if (!_dirty_atomic_counter_buffers.any()) {
+        return;
+    }
+
+    _dirty_atomic_counter_buffers.for_each([this](unsigned i) {
         const buffer_binding&   cubb = _current_state._active_atomic_counter_buffers[i];
         buffer_binding&         aubb = _applied_state._active_atomic_counter_buffers[i];
 
@@ -1205,13 +1395,18 @@ render_context::apply_atomic_counter_bindings()
             }
             aubb = cubb;
         }
-    }
+    });
+    _dirty_atomic_counter_buffers.clear();
 }
 
 void
 render_context::apply_storage_buffer_bindings()
 {
-    for (int i = 0; i < _current_state._active_storage_buffers.size(); ++i) {
+    if (!_dirty_storage_buffers.any()) {
+        return;
+    }
+
+    _dirty_storage_buffers.for_each([this](unsigned i) {
         const buffer_binding&   csbb = _current_state._active_storage_buffers[i];
         buffer_binding&         asbb = _applied_state._active_storage_buffers[i];
 
@@ -1221,11 +1416,12 @@ render_context::apply_storage_buffer_bindings()
                 assert(csbb._buffer->ok());
             }
             else {
-                csbb._buffer->unbind_range(*this, BIND_STORAGE_BUFFER, i);
+                asbb._buffer->unbind_range(*this, BIND_STORAGE_BUFFER, i);
             }
             asbb = csbb;
         }
-    }
+    });
+    _dirty_storage_buffers.clear();
 }
 
 // shader api /////////////////////////////////////////////////////////////////////////////////
@@ -1241,6 +1437,17 @@ render_context::current_program() const
     return _current_state._program;
 }
 
+void
+render_context::apply_uniform(const uniform_ptr& in_uniform,
+                              uniform_apply_func in_apply,
+                              int                in_element,
+                              const void*        in_value)
+{
+    if (in_uniform && in_apply) {
+        in_apply(*in_uniform, in_element, in_value);
+    }
+}
+
 void
 render_context::reset_program()
 {
@@ -1286,12 +1493,13 @@ render_context::bind_texture(const texture_ptr&       in_texture_image,
 
     _current_state._texture_units[in_unit]._texture_image = in_texture_image;
     _current_state._texture_units[in_unit]._sampler_state = in_sampler_state;
+    _dirty_texture_units.set(in_unit);
 }
 
 void
 render_context::set_texture_unit_state(const texture_unit_array& in_texture_units)
 {
-    _current_state._texture_units = in_texture_units;
+    assign_bindings(in_texture_units, _current_state._texture_units, _dirty_texture_units);
 }
 
 const render_context::texture_unit_array&
@@ -1303,9 +1511,7 @@ render_context::current_texture_unit_state() const
 void
 render_context::reset_texture_units()
 {
-    std::fill(_current_state._texture_units.begin(),
-              _current_state._texture_units.end(),
-              texture_unit_binding());
+    fill_bindings(texture_unit_binding(), _current_state._texture_units, _dirty_texture_units);
 }
 
 void
@@ -1326,6 +1532,7 @@ render_context::bind_image(const texture_ptr&       in_texture_image,
         cur_binding._access        = in_access;
         cur_binding._level         = in_level;
         cur_binding._layer         = in_layer;
+        _dirty_image_units.set(in_unit);
     }
     else {
         if (SCM_GL_DEBUG) {
@@ -1341,7 +1548,7 @@ void
 render_context::set_image_unit_state(const image_unit_array& in_imageunits)
 {
     assert(in_imageunits.size() == _current_state._image_units.size());
-    _current_state._image_units = in_imageunits;
+    assign_bindings(in_imageunits, _current_state._image_units, _dirty_image_units);
 }
 
 const render_context::image_unit_array&
@@ -1353,9 +1560,7 @@ render_context::current_image_unit_state() const
 void
 render_context::reset_image_units()
 {
-    std::fill(_current_state._image_units.begin(),
-              _current_state._image_units.end(),
-              image_unit_binding());
+    fill_bindings(image_unit_binding(), _current_state._image_units, _dirty_image_units);
 }
 
 bool
@@ -1486,20 +1691,14 @@ render_context::make_non_resident(const texture_ptr&       in_texture)
 void
 render_context::apply_texture_units()
 {
-#if SCM_GL_CORE_OPENGL_CORE_VERSION >= SCM_GL_CORE_OPENGL_CORE_VERSION_440
-    std::vector<uint32> texture_obj_ids;
-    std::vector<uint32> sampler_obj_ids;
-
-    const uint32 nb_tex_units = static_cast<uint32>(_current_state._texture_units.size());
-    texture_obj_ids.resize(nb_tex_units, 0u);
-    sampler_obj_ids.resize(nb_tex_units, 0u);
-#endif // SCM_GL_CORE_OPENGL_CORE_VERSION < SCM_GL_CORE_OPENGL_CORE_VERSION_440
+    if (!_dirty_texture_units.any()) {
+        return;
+    }
 
-    for (int u = 0; u < _current_state._texture_units.size(); ++u) {
+#if SCM_GL_CORE_OPENGL_CORE_VERSION < SCM_GL_CORE_OPENGL_CORE_VERSION_440
+    _dirty_texture_units.for_each([this](unsigned u) {
         texture_ptr&        cti = _current_state._texture_units[u]._texture_image;
         texture_ptr&        ati = _applied_state._texture_units[u]._texture_image;
-
-#if SCM_GL_CORE_OPENGL_CORE_VERSION < SCM_GL_CORE_OPENGL_CORE_VERSION_440
         if (cti != ati) {
             if (cti) {
                 cti->bind(*this, u);
@@ -1509,16 +1708,9 @@ render_context::apply_texture_units()
             }
             ati = cti;
         }
-#else // SCM_GL_CORE_OPENGL_CORE_VERSION < SCM_GL_CORE_OPENGL_CORE_VERSION_440
-        if (cti) {
-            texture_obj_ids[u] = cti->object_id();
-        }
-        ati = cti;
-#endif // SCM_GL_CORE_OPENGL_CORE_VERSION < SCM_GL_CORE_OPENGL_CORE_VERSION_440
 
         sampler_state_ptr&  css = _current_state._texture_units[u]._sampler_state;
         sampler_state_ptr&  ass = _applied_state._texture_units[u]._sampler_state;
-#if SCM_GL_CORE_OPENGL_CORE_VERSION < SCM_GL_CORE_OPENGL_CORE_VERSION_440
         if (css != ass) {
             if (css) {
                 css->bind(*this, u);
@@ -1528,28 +1720,55 @@ render_context::apply_texture_units()
             }
             ass = css;
         }
+    });
 #else // SCM_GL_CORE_OPENGL_CORE_VERSION < SCM_GL_CORE_OPENGL_CORE_VERSION_440
-        if (css) {
-            sampler_obj_ids[u] = css->sampler_id();
-        }
-        ass = css;
-#endif // SCM_GL_CORE_OPENGL_CORE_VERSION < SCM_GL_CORE_OPENGL_CORE_VERSION_440
-    }
+    // the object ids of all units are kept up to date, the units actually changed
+    // are rebound in one glBindTextures/glBindSamplers call per contiguous range
+    unsigned tex_begin = _dirty_texture_units._end;
+    unsigned tex_end   = 0;
+    unsigned smp_begin = _dirty_texture_units._end;
+    unsigned smp_end   = 0;
+
+    _dirty_texture_units.for_each([&](unsigned u) {
+        const texture_unit_binding& ctu = _current_state._texture_units[u];
+        texture_unit_binding&       atu = _applied_state._texture_units[u];
+
+        if (ctu._texture_image != atu._texture_image) {
+            _texture_unit_object_ids[u] = ctu._texture_image ? ctu._texture_image->object_id() : 0u;
+            tex_begin = (std::min)(tex_begin, u);
+            tex_end   = u + 1;
+        }
+        if (ctu._sampler_state != atu._sampler_state) {
+            _texture_unit_sampler_ids[u] = ctu._sampler_state ? ctu._sampler_state->sampler_id() : 0u;
+            smp_begin = (std::min)(smp_begin, u);
+            smp_end   = u + 1;
+        }
+        atu = ctu;
+    });
 
-#if SCM_GL_CORE_OPENGL_CORE_VERSION >= SCM_GL_CORE_OPENGL_CORE_VERSION_440
     const opengl::gl_core& glapi = opengl_api();
 
-    glapi.glBindTextures(0, nb_tex_units, &(texture_obj_ids[0]));
-    glapi.glBindSamplers(0, nb_tex_units, &(sampler_obj_ids[0]));
+    if (tex_begin < tex_end) {
+        glapi.glBindTextures(tex_begin, tex_end - tex_begin, &(_texture_unit_object_ids[tex_begin]));
+    }
+    if (smp_begin < smp_end) {
+        glapi.glBindSamplers(smp_begin, smp_end - smp_begin, &(_texture_unit_sampler_ids[smp_begin]));
+    }
 #endif // SCM_GL_CORE_OPENGL_CORE_VERSION < SCM_GL_CORE_OPENGL_CORE_VERSION_440
 
+    _dirty_texture_units.clear();
+
     gl_assert(opengl_api(), leaving render_context::apply_texture_units());
 }
 
 void
 render_context::apply_image_units()
 {
-    for (int u = 0; u < _current_state._image_units.size(); ++u) {
+    if (!_dirty_image_units.any()) {
+        return;
+    }
+
+    _dirty_image_units.for_each([this](unsigned u) {
         const image_unit_binding& cub = _current_state._image_units[u];
         image_unit_binding&       aub = _applied_state._image_units[u];
 
@@ -1560,9 +1779,10 @@ render_context::apply_image_units()
             else {
                 aub._texture_image->unbind_image(*this, u);
             }
+            aub = cub;
         }
-        aub = cub;
-    }
+    });
+    _dirty_image_units.clear();
 
     gl_assert(opengl_api(), leaving render_context::apply_image_units());
 }
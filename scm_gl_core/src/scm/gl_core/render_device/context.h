@@ -70,6 +70,8 @@ public:
         scm::size_t         _index_data_offset;
     }; // struct index_buffer_binding
     struct texture_unit_binding {
+        bool                operator==(const texture_unit_binding& rhs) const;
+        bool                operator!=(const texture_unit_binding& rhs) const;
         texture_ptr         _texture_image;
         sampler_state_ptr   _sampler_state;
     }; // struct texture_unit_binding
@@ -126,6 +128,30 @@ private:
         frame_buffer_target                 _default_framebuffer_target;
         viewport_array                      _viewports;
     }; // struct binding_state_type
+    // slots of an indexed binding array changed since the last apply, the changed
+    // slots are kept in a bit mask and the range [_begin, _end) enclosing them
+    struct binding_dirty_mask {
+        binding_dirty_mask();
+        void                        resize(unsigned in_size);
+        void                        set(unsigned in_slot);
+        void                        clear();
+        bool                        any() const;
+        template<typename func>
+        void                        for_each(func f) const;
+        std::vector<scm::uint64>    _bits;
+        unsigned                    _size;
+        unsigned                    _begin;
+        unsigned                    _end;
+    }; // struct binding_dirty_mask
+
+    template<typename binding_type>
+    static void                     assign_bindings(const std::vector<binding_type>& in_bindings,
+                                                    std::vector<binding_type>&       out_bindings,
+                                                    binding_dirty_mask&              out_dirty);
+    template<typename binding_type>
+    static void                     fill_bindings(const binding_type&        in_binding,
+                                                  std::vector<binding_type>& out_bindings,
+                                                  binding_dirty_mask&        out_dirty);
 
 ////// methods ////////////////////////////////////////////////////////////////////////////////////
 public:
@@ -136,6 +162,9 @@ public:
 
     void                        reset();
 
+    // replays the recorded commands, the context state is left as set by the last command
+    void                        execute(const command_buffer& in_commands);
+
     void                        flush();
     void                        sync();
 
@@ -217,6 +246,10 @@ public:
     void                        bind_unpack_buffer(const buffer_ptr& in_buffer);
     const buffer_ptr&           current_unpack_buffer() const;
 
+    // source of the indirect draw commands
+    void                        bind_indirect_buffer(const buffer_ptr& in_buffer);
+    const buffer_ptr&           current_indirect_buffer() const;
+
     void                        reset_uniform_buffers();
     void                        reset_atomic_counter_buffers();
     void                        reset_storage_buffers();
@@ -240,10 +273,13 @@ public:
     void                        draw_arrays(const primitive_topology in_topology, const int in_first_index, const int in_count);
     void                        draw_arrays_instanced(const primitive_topology in_topology, const int in_first_index, const int in_count, const int in_instance_count = 1);
     void                        multi_draw_arrays(const primitive_topology in_topology, const int* in_first_indices, const int* in_counts, unsigned int draw_count);
-    void                        multi_draw_arrays_indirect(const primitive_topology in_topology, const int draw_count); //does not interact correctly with the indirect buffer yet
+    // draw commands are read from the bound indirect buffer
+    void                        multi_draw_arrays_indirect(const primitive_topology in_topology, const int draw_count);
 
     void                        draw_elements(const int in_count, const int in_start_index = 0, const int in_base_vertex = 0);
     void                        draw_elements_instanced(const int in_count, const int in_start_index = 0, const int in_instance_count = 1, const int in_base_vertex = 0, const int in_base_instance = 0);
+    // DrawElementsIndirectCommand structures starting at in_offset of the bound indirect buffer
+    void                        multi_draw_elements_indirect(const int in_draw_count, const scm::size_t in_offset = 0, const int in_stride = 0);
 
     bool                        make_resident(const buffer_ptr&     in_buffer,
                                               const access_mode     in_access);
@@ -265,6 +301,14 @@ public:
     void                        bind_program(const program_ptr& in_program);
     const program_ptr&          current_program() const;
 
+    // writes a value to the uniform through the typed setter in_apply, the program
+    // uploads it when it is applied for the next draw
+    typedef void (*uniform_apply_func)(uniform_base& u, int element, const void* value);
+    void                        apply_uniform(const uniform_ptr& in_uniform,
+                                              uniform_apply_func in_apply,
+                                              int                in_element,
+                                              const void*        in_value);
+
     void                        reset_program();
     void                        apply_program();
 
@@ -435,7 +479,18 @@ private:
     binding_state_type          _current_state;
     binding_state_type          _applied_state;
 
+    binding_dirty_mask          _dirty_texture_units;
+    binding_dirty_mask          _dirty_image_units;
+    binding_dirty_mask          _dirty_uniform_buffers;
+    binding_dirty_mask          _dirty_atomic_counter_buffers;
+    binding_dirty_mask          _dirty_storage_buffers;
+#if SCM_GL_CORE_OPENGL_CORE_VERSION >= SCM_GL_CORE_OPENGL_CORE_VERSION_440
+    std::vector<uint32>         _texture_unit_object_ids;   // glBindTextures/glBindSamplers arguments
+    std::vector<uint32>         _texture_unit_sampler_ids;
+#endif // SCM_GL_CORE_OPENGL_CORE_VERSION >= SCM_GL_CORE_OPENGL_CORE_VERSION_440
+
     buffer_ptr                  _unpack_buffer;
+    buffer_ptr                  _indirect_buffer;
 
     boost::unordered_set<debug_output_ptr>      _debug_outputs;
     bool                                        _debug_synchronous_reporting;
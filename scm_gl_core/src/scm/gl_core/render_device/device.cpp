@@ -30,7 +30,9 @@
 #include <scm/gl_core/render_device/opengl/util/assert.h>
 #include <scm/gl_core/render_device/opengl/util/error_helper.h>
 #include <scm/gl_core/shader_objects/program.h>
+#include <scm/gl_core/shader_objects/program_binary_cache.h>
 #include <scm/gl_core/shader_objects/shader.h>
+#include <scm/gl_core/shader_objects/shader_preprocessor.h>
 #include <scm/gl_core/shader_objects/stream_capture.h>
 #include <scm/gl_core/state_objects/depth_stencil_state.h>
 #include <scm/gl_core/state_objects/rasterizer_state.h>
@@ -50,10 +52,10 @@ struct render_device::mutex_impl
     boost::mutex    _mutex;
 };
 
-render_device::render_device()
+render_device::render_device(const backend_type in_backend)
   : _mutex_impl(new mutex_impl)
 {
-    _opengl_api_core.reset(new opengl::gl_core());
+    _opengl_api_core.reset(new opengl::gl_core(in_backend == BACKEND_NULL));
 
     if (!_opengl_api_core->initialize()) {
         std::ostringstream s;
@@ -97,6 +99,13 @@ render_device::render_device()
 
     init_capabilities();
 
+    _shader_preprocessor.reset(new shader_preprocessor(_opengl_api_core->extension_ARB_shading_language_include));
+
+    if (_opengl_api_core->extension_KHR_parallel_shader_compile) {
+        // let the implementation choose the number of compiler threads
+        _opengl_api_core->glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+    }
+
     // setup main rendering context
     try {
         _main_context.reset(new render_context(*this));
@@ -131,6 +140,12 @@ render_device::main_context() const
     return _main_context;
 }
 
+const shader_preprocessor_ptr&
+render_device::preprocessor() const
+{
+    return _shader_preprocessor;
+}
+
 render_context_ptr
 render_device::create_context()
 {
@@ -598,18 +613,20 @@ render_device::add_include_string_internal(const std::string& in_path,
         const opengl::gl_core& glcore = opengl_api();
         util::gl_error          glerror(glcore);
 
-        if (!glcore.extension_ARB_shading_language_include) {
-            glout() << log::warning << "render_device::add_include_string(): "
-                    << "shader includes not supported (GL_ARB_shading_language_include unsupported), ignoring include string." << log::end;
-            return false;
-        }
-
-        if (in_path[0] != '/') {
+        if (in_path.empty() || in_path[0] != '/') {
             glerr() << log::error << "render_device::add_include_string(): "
                     << "<error> path not starting with '/'." << log::end;
             return false;
         }
 
+        // includes are expanded by the preprocessor, the named strings only serve
+        // includes the preprocessor does not resolve
+        _shader_preprocessor->add_include_string(in_path, in_source_string);
+
+        if (!glcore.extension_ARB_shading_language_include) {
+            return true;
+        }
+
         glcore.glNamedStringARB(GL_SHADER_INCLUDE_ARB,
                                 static_cast<int>(in_path.length()),          in_path.c_str(),
                                 static_cast<int>(in_source_string.length()), in_source_string.c_str());
@@ -706,6 +723,17 @@ render_device::create_shader(shader_stage                    in_stage,
                              const shader_macro_array&       in_macros,
                              const shader_include_path_list& in_inc_paths,
                              const std::string&              in_source_name)
+{
+    return create_shader_internal(in_stage, in_source, in_macros, in_inc_paths, in_source_name, false);
+}
+
+shader_ptr
+render_device::create_shader_internal(shader_stage                    in_stage,
+                                      const std::string&              in_source,
+                                      const shader_macro_array&       in_macros,
+                                      const shader_include_path_list& in_inc_paths,
+                                      const std::string&              in_source_name,
+                                      bool                            in_async_compile)
 {
     // combine macro definitions
     shader_macro_array  macro_array(in_macros);
@@ -740,7 +768,8 @@ render_device::create_shader(shader_stage                    in_stage,
                                      in_source,
                                      in_source_name,
                                      macro_array,
-                                     include_paths));
+                                     include_paths,
+                                     in_async_compile));
     if (new_shader->fail()) {
         if (new_shader->bad()) {
             glerr() << "render_device::create_shader(): unable to create shader object ("
@@ -828,30 +857,145 @@ render_device::create_program(const shader_list&          in_shaders,
                               const std::string&          in_program_name)
 {
     program_ptr new_program(new program(*this, in_shaders, in_capture, in_rasterization_discard));
+
+    report_program_state(new_program, in_program_name, "create_program");
+
     if (new_program->fail()) {
-        if (new_program->bad()) {
-            glerr() << "render_device::create_program(): unable to create shader object ("
+        return program_ptr();
+    }
+    else {
+        return new_program;
+    }
+}
+
+shader_ptr
+render_device::create_shader_async(shader_stage                    in_stage,
+                                   const std::string&              in_source,
+                                   const shader_macro_array&       in_macros,
+                                   const shader_include_path_list& in_inc_paths,
+                                   const std::string&              in_source_name)
+{
+    return create_shader_internal(in_stage, in_source, in_macros, in_inc_paths, in_source_name, true);
+}
+
+program_ptr
+render_device::create_program_async(const shader_list& in_shaders,
+                                    const std::string& in_program_name)
+{
+    program_ptr new_program(new program(*this, in_shaders, stream_capture_array(), false,
+                                        program::named_location_list(), program::named_location_list(), true));
+
+    if (new_program->link_pending()) {
+        boost::mutex::scoped_lock lock(_mutex_impl->_mutex);
+
+        _pending_programs.push_back(std::make_pair(program_wtr(new_program), in_program_name));
+    }
+    else {
+        // failed before the link was submitted or loaded from the binary cache
+        report_program_state(new_program, in_program_name, "create_program_async");
+
+        if (new_program->fail()) {
+            return program_ptr();
+        }
+    }
+
+    return new_program;
+}
+
+scm::size_t
+render_device::poll_pending_programs()
+{
+    boost::mutex::scoped_lock lock(_mutex_impl->_mutex);
+
+    pending_program_list::iterator p = _pending_programs.begin();
+    while (p != _pending_programs.end()) {
+        program_ptr pending_program = p->first.lock();
+        if (!pending_program) {
+            p = _pending_programs.erase(p);
+        }
+        else if (pending_program->link_completed()) {
+            report_program_state(pending_program, p->second, "poll_pending_programs");
+            p = _pending_programs.erase(p);
+        }
+        else {
+            ++p;
+        }
+    }
+
+    return _pending_programs.size();
+}
+
+void
+render_device::report_program_state(const program_ptr& in_program,
+                                    const std::string& in_program_name,
+                                    const std::string& in_func_name) const
+{
+    if (in_program->fail()) {
+        if (in_program->bad()) {
+            glerr() << "render_device::" << in_func_name << "(): unable to create shader object ("
                     << "name: " << in_program_name << ", "
-                    << new_program->state().state_string() << ")." << log::end;
+                    << in_program->state().state_string() << ")." << log::end;
         }
         else {
-            glerr() << "render_device::create_program(): error during link operation ("
+            glerr() << "render_device::" << in_func_name << "(): error during link operation ("
                     << "name: " << in_program_name << ", "
-                    << new_program->state().state_string() << "):" << log::nline
-                    << new_program->info_log() << log::end;
+                    << in_program->state().state_string() << "):" << log::nline
+                    << in_program->info_log() << log::end;
         }
-        return program_ptr();
     }
-    else {
-        if (!new_program->info_log().empty()) {
-            glout() << log::info << "render_device::create_program(): linker info ("
-                    << "name: " << in_program_name << ")" << log::nline
-                    << new_program->info_log() << log::end;
-        }
-        return new_program;
+    else if (!in_program->info_log().empty()) {
+        glout() << log::info << "render_device::" << in_func_name << "(): linker info ("
+                << "name: " << in_program_name << ")" << log::nline
+                << in_program->info_log() << log::end;
     }
 }
 
+bool
+render_device::enable_program_binary_cache(const std::string& in_directory,
+                                           scm::size_t        in_max_size)
+{
+    if (   0 == _capabilities._num_program_binary_formats
+        || !opengl_api().version_4_1_available) {
+        glout() << log::warning << "render_device::enable_program_binary_cache(): "
+                << "program binaries not supported (no program binary formats available)." << log::end;
+        return false;
+    }
+
+    program_binary_cache_ptr cache;
+    try {
+        cache.reset(new program_binary_cache(in_directory, in_max_size));
+    }
+    catch (const std::exception& e) {
+        glerr() << log::error << "render_device::enable_program_binary_cache(): "
+                << e.what() << log::end;
+        return false;
+    }
+
+    { // protect this function from multiple thread access
+        boost::mutex::scoped_lock lock(_mutex_impl->_mutex);
+
+        _program_binary_cache = cache;
+    }
+
+    return true;
+}
+
+void
+render_device::disable_program_binary_cache()
+{
+    { // protect this function from multiple thread access
+        boost::mutex::scoped_lock lock(_mutex_impl->_mutex);
+
+        _program_binary_cache.reset();
+    }
+}
+
+const program_binary_cache_ptr&
+render_device::binary_cache() const
+{
+    return _program_binary_cache;
+}
+
 // texture api ////////////////////////////////////////////////////////////////////////////////////
 texture_1d_ptr
 render_device::create_texture_1d(const texture_1d_desc&   in_desc)
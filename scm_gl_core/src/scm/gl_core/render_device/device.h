@@ -113,6 +113,11 @@ public:
         int64           _shader_storage_buffer_offset_alignment;
     }; // struct device_capabilities
 
+    typedef enum {
+        BACKEND_OPENGL      = 0x00,
+        BACKEND_NULL                    // stub backend without a GL context, see opengl::gl_null_backend
+    } backend_type;
+
 protected:
     typedef boost::unordered_set<render_device_resource*>   resource_ptr_set;
 
@@ -123,14 +128,18 @@ protected:
 
     typedef std::vector<buffer_ptr>                         buffer_array;
 
+    typedef std::vector<std::pair<program_wtr, std::string> > pending_program_list;
+
 ////// methods ////////////////////////////////////////////////////////////////////////////////////
 public:
-    render_device();
+    render_device(const backend_type in_backend = BACKEND_OPENGL);
     virtual ~render_device();
 
     // device /////////////////////////////////////////////////////////////////////////////////////
     const opengl::gl_core&          opengl_api() const;
     render_context_ptr              main_context() const;
+    // shader source preprocessing and cache shared by all shaders of the device
+    const shader_preprocessor_ptr&  preprocessor() const;
     render_context_ptr              create_context();
     const device_capabilities&      capabilities() const;
 
@@ -212,10 +221,42 @@ public:
                                                    bool                        in_rasterization_discard = false,
                                                    const std::string&          in_program_name = "");
 
+    // asynchronous shader and program creation, the compile and link is only submitted to
+    // the driver and finished by poll_pending_programs (or program::link_completed) once the
+    // driver reports completion through GL_KHR_parallel_shader_compile, without the extension
+    // the first poll waits for the link
+    //  - compile errors of asynchronous shaders are reported when the program link finished
+    //  - poll_pending_programs reports failed programs, returns the number still pending
+    shader_ptr                      create_shader_async(shader_stage                    in_stage,
+                                                        const std::string&              in_source,
+                                                        const shader_macro_array&       in_macros     = shader_macro_array(),
+                                                        const shader_include_path_list& in_inc_paths  = shader_include_path_list(),
+                                                        const std::string&              in_source_name = "");
+    program_ptr                     create_program_async(const shader_list& in_shaders,
+                                                         const std::string& in_program_name = "");
+    scm::size_t                     poll_pending_programs();
+
+    // linked programs are stored to and loaded from the cache directory, shaders created
+    // while the cache is enabled are compiled at the creation of a program missing in the
+    // cache, their compile errors are reported by create_program
+    bool                            enable_program_binary_cache(const std::string& in_directory,
+                                                                scm::size_t        in_max_size = 256 * 1024 * 1024);
+    void                            disable_program_binary_cache();
+    const program_binary_cache_ptr& binary_cache() const;
+
 protected:
     bool                            add_include_string_internal(const std::string& in_path,
                                                                 const std::string& in_source_string,
                                                                       bool         lock_thread);
+    shader_ptr                      create_shader_internal(shader_stage                    in_stage,
+                                                           const std::string&              in_source,
+                                                           const shader_macro_array&       in_macros,
+                                                           const shader_include_path_list& in_inc_paths,
+                                                           const std::string&              in_source_name,
+                                                           bool                            in_async_compile);
+    void                            report_program_state(const program_ptr& in_program,
+                                                         const std::string& in_program_name,
+                                                         const std::string& in_func_name) const;
 
     // texture api ////////////////////////////////////////////////////////////////////////////////
 public:
@@ -394,6 +435,9 @@ protected:
     // shader api /////////////////////////////////////////////////////////////////////////////////
     shader_macro_map                _default_macro_defines;
     string_set                      _default_include_paths;
+    shader_preprocessor_ptr         _shader_preprocessor;
+    program_binary_cache_ptr        _program_binary_cache;
+    pending_program_list            _pending_programs;
 
     device_capabilities             _capabilities;
     resource_ptr_set                _registered_resources;
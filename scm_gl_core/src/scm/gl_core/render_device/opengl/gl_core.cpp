@@ -26,6 +26,7 @@
 
 #include <scm/gl_core/log.h>
 #include <scm/gl_core/config.h>
+#include <scm/gl_core/render_device/opengl/gl_null_backend.h>
 
 namespace  {
 
@@ -66,6 +67,12 @@ gl_core::is_initialized() const
     return (_initialized);
 }
 
+bool
+gl_core::null_backend() const
+{
+    return (_null_backend);
+}
+
 bool
 gl_core::is_supported(const std::string& ext) const
 {
@@ -94,9 +101,10 @@ gl_core::context_information() const
     return (_context_info);
 }
 
-gl_core::gl_core()
+gl_core::gl_core(bool in_null_backend)
 {
-    _initialized = false;
+    _initialized  = false;
+    _null_backend = in_null_backend;
 
     version_1_0_available   = false;
     version_1_1_available   = false;
@@ -127,6 +135,8 @@ gl_core::gl_core()
     extension_ARB_sparse_texture                = false;
     extension_ARB_texture_compression_bptc      = false;
 
+    extension_KHR_parallel_shader_compile       = false;
+
     extension_EXT_direct_state_access_available = false;
     extension_EXT_shader_image_load_store       = false;
     extension_EXT_texture_compression_s3tc      = false;
@@ -276,6 +286,7 @@ gl_core::initialize()
     extension_ARB_debug_output              = extension_ARB_debug_output              && is_supported("GL_ARB_debug_output");
     extension_ARB_robustness                = extension_ARB_robustness                && is_supported("GL_ARB_robustness");
     extension_EXT_shader_image_load_store   = extension_EXT_shader_image_load_store   && is_supported("GL_EXT_shader_image_load_store");
+    extension_KHR_parallel_shader_compile   = extension_KHR_parallel_shader_compile   && is_supported("GL_KHR_parallel_shader_compile");
 
     extension_ARB_map_buffer_alignment      = is_supported("GL_ARB_map_buffer_alignment");
     extension_EXT_texture_compression_s3tc  = is_supported("GL_EXT_texture_compression_s3tc");
@@ -349,7 +360,10 @@ gl_core::init_entry_points()
     */
 
 #define SCM_INIT_GL_ENTRY(PFN, fun, ctx_str, errflag)                                                                            \
-    if (0 == (fun = gl_proc_address<PFN>(#fun))) {                                                                               \
+    if (_null_backend) {                                                                                                         \
+        fun = detail::null_entry_point<PFN, __LINE__>(#fun);                                                                     \
+    }                                                                                                                            \
+    else if (0 == (fun = gl_proc_address<PFN>(#fun))) {                                                                          \
         errflag = false;                                                                                                         \
         glout() << log::warning << "- missing entry point (source: " << (ctx_str) << ", function: " << #fun << ")." << log::end; \
     }
@@ -1079,6 +1093,11 @@ gl_core::init_entry_points()
     version_4_5_available = version_4_5_available && init_success;
 
 
+    // KHR_parallel_shader_compile ////////////////////////////////////////////////////////////////
+    init_success = true;
+    SCM_INIT_GL_ENTRY(PFNGLMAXSHADERCOMPILERTHREADSKHRPROC, glMaxShaderCompilerThreadsKHR, "KHR_parallel_shader_compile", init_success);
+    extension_KHR_parallel_shader_compile = init_success;
+
     // GL_ARB_shading_language_include
     init_success = true;
     SCM_INIT_GL_ENTRY(PFNGLNAMEDSTRINGARBPROC, glNamedStringARB, "GL_ARB_shading_language_include", init_success);
@@ -52,9 +52,11 @@ private:
     typedef std::set<std::string>   string_set;
 
 public:
-    gl_core();
+    // a null backend replaces all entry points with stubs, see gl_null_backend
+    gl_core(bool in_null_backend = false);
 
     bool                    initialize();
+    bool                    null_backend() const;
     const context_info&     context_information() const;
     bool                    is_initialized() const;
     bool                    is_supported(const std::string& ext) const;
@@ -66,6 +68,7 @@ private:
 private:
     string_set      _extensions;
     bool            _initialized;
+    bool            _null_backend;
     context_info    _context_info;
 
     friend std::ostream& operator<<(std::ostream& out_stream, const gl_core& c);
@@ -100,6 +103,8 @@ public:
     bool extension_ARB_sparse_texture;
     bool extension_ARB_texture_compression_bptc;
 
+    bool extension_KHR_parallel_shader_compile;
+
     bool extension_EXT_direct_state_access_available;
     bool extension_EXT_shader_image_load_store;
     bool extension_EXT_texture_compression_s3tc;
@@ -802,6 +807,9 @@ public:
     // ARB_texture_stencil8 (no entry points)
     // ARB_vertex_type_10f_11f_11f_rev (no entry points)
 
+    // KHR_parallel_shader_compile
+    PFNGLMAXSHADERCOMPILERTHREADSKHRPROC            glMaxShaderCompilerThreadsKHR;
+
     // GL_ARB_shading_language_include
     PFNGLNAMEDSTRINGARBPROC                         glNamedStringARB;
     PFNGLDELETENAMEDSTRINGARBPROC                   glDeleteNamedStringARB;
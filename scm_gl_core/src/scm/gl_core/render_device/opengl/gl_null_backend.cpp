@@ -0,0 +1,1049 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include "gl_null_backend.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+
+namespace scm {
+namespace gl {
+namespace opengl {
+namespace {
+
+struct null_state
+{
+    typedef boost::unordered_map<std::string, unsigned>             entry_index_map;
+    typedef boost::unordered_map<std::string, void*>                entry_point_map;
+    typedef boost::unordered_map<GLuint, std::vector<scm::uint8> >  buffer_storage_map;
+    typedef boost::unordered_map<GLenum, GLuint>                    buffer_binding_map;
+
+    struct uniform_info {
+        std::string     _name;
+        GLenum          _type;
+        GLint           _size;
+    }; // struct uniform_info
+    typedef boost::unordered_map<GLuint, std::string>                   shader_source_map;
+    typedef boost::unordered_map<GLuint, std::vector<GLuint> >          program_shader_map;
+    typedef boost::unordered_map<GLuint, std::vector<uniform_info> >    program_uniform_map;
+    typedef boost::unordered_map<GLuint, std::string>                   program_binary_map;
+    typedef boost::unordered_map<GLuint, GLint>                         program_status_map;
+    typedef boost::unordered_map<GLuint, unsigned>                      pending_poll_map;
+
+    null_state() : _next_name(1), _completion_latency(0) {}
+
+    std::vector<std::string>    _entry_names;
+    std::vector<scm::uint64>    _entry_calls;
+    entry_index_map             _entry_indices;
+    entry_point_map             _entry_points;
+
+    GLuint                      _next_name;
+    boost::unordered_set<GLuint> _live_names;
+    buffer_storage_map          _buffer_storage;
+    buffer_binding_map          _buffer_bindings;
+
+    shader_source_map           _shader_sources;
+    program_shader_map          _program_shaders;
+    program_uniform_map         _program_uniforms;
+    program_binary_map          _program_binaries;      // linked shader sources
+    program_status_map          _program_link_status;
+
+    unsigned                    _completion_latency;
+    pending_poll_map            _pending_polls;         // completion polls left per shader or program
+}; // struct null_state
+
+// program binaries are the linked shader sources behind a magic string
+const GLenum        null_program_binary_format = 0x4e554c4c;
+const char          null_program_binary_magic[] = "scm_null_program_binary";
+
+null_state&
+state()
+{
+    static null_state s;
+    return s;
+}
+
+#define SCM_NULL_RECORD_CALL(fun)                                                   \
+    static const unsigned scm_null_entry = gl_null_backend::register_entry(#fun);   \
+    gl_null_backend::record(scm_null_entry);
+
+// names, all object types share one name space
+void
+generate_names(GLsizei n, GLuint* names)
+{
+    null_state& s = state();
+    for (GLsizei i = 0; i < n; ++i) {
+        names[i] = s._next_name++;
+        s._live_names.insert(names[i]);
+    }
+}
+
+GLuint
+generate_name()
+{
+    GLuint n = 0;
+    generate_names(1, &n);
+    return n;
+}
+
+void
+release_names(GLsizei n, const GLuint* names)
+{
+    null_state& s = state();
+    for (GLsizei i = 0; i < n; ++i) {
+        s._live_names.erase(names[i]);
+        s._buffer_storage.erase(names[i]);
+        s._shader_sources.erase(names[i]);
+        s._program_shaders.erase(names[i]);
+        s._program_uniforms.erase(names[i]);
+        s._program_binaries.erase(names[i]);
+        s._program_link_status.erase(names[i]);
+        s._pending_polls.erase(names[i]);
+    }
+}
+
+#define SCM_NULL_GEN_FUNC(fun)                                          \
+    void APIENTRY null_##fun(GLsizei n, GLuint* names) {                \
+        SCM_NULL_RECORD_CALL(fun);                                      \
+        generate_names(n, names);                                       \
+    }
+#define SCM_NULL_CREATE_TARGET_FUNC(fun)                                \
+    void APIENTRY null_##fun(GLenum, GLsizei n, GLuint* names) {        \
+        SCM_NULL_RECORD_CALL(fun);                                      \
+        generate_names(n, names);                                       \
+    }
+#define SCM_NULL_DELETE_FUNC(fun)                                       \
+    void APIENTRY null_##fun(GLsizei n, const GLuint* names) {          \
+        SCM_NULL_RECORD_CALL(fun);                                      \
+        release_names(n, names);                                        \
+    }
+
+SCM_NULL_GEN_FUNC(glGenBuffers)
+SCM_NULL_GEN_FUNC(glGenTextures)
+SCM_NULL_GEN_FUNC(glGenSamplers)
+SCM_NULL_GEN_FUNC(glGenVertexArrays)
+SCM_NULL_GEN_FUNC(glGenFramebuffers)
+SCM_NULL_GEN_FUNC(glGenRenderbuffers)
+SCM_NULL_GEN_FUNC(glGenQueries)
+SCM_NULL_GEN_FUNC(glGenTransformFeedbacks)
+SCM_NULL_GEN_FUNC(glGenProgramPipelines)
+SCM_NULL_GEN_FUNC(glCreateBuffers)
+SCM_NULL_GEN_FUNC(glCreateSamplers)
+SCM_NULL_GEN_FUNC(glCreateVertexArrays)
+SCM_NULL_GEN_FUNC(glCreateFramebuffers)
+SCM_NULL_GEN_FUNC(glCreateRenderbuffers)
+SCM_NULL_GEN_FUNC(glCreateTransformFeedbacks)
+SCM_NULL_GEN_FUNC(glCreateProgramPipelines)
+SCM_NULL_CREATE_TARGET_FUNC(glCreateTextures)
+SCM_NULL_CREATE_TARGET_FUNC(glCreateQueries)
+SCM_NULL_DELETE_FUNC(glDeleteBuffers)
+SCM_NULL_DELETE_FUNC(glDeleteTextures)
+SCM_NULL_DELETE_FUNC(glDeleteSamplers)
+SCM_NULL_DELETE_FUNC(glDeleteVertexArrays)
+SCM_NULL_DELETE_FUNC(glDeleteFramebuffers)
+SCM_NULL_DELETE_FUNC(glDeleteRenderbuffers)
+SCM_NULL_DELETE_FUNC(glDeleteQueries)
+SCM_NULL_DELETE_FUNC(glDeleteTransformFeedbacks)
+SCM_NULL_DELETE_FUNC(glDeleteProgramPipelines)
+
+GLuint APIENTRY
+null_glCreateShader(GLenum)
+{
+    SCM_NULL_RECORD_CALL(glCreateShader);
+    return generate_name();
+}
+
+GLuint APIENTRY
+null_glCreateProgram()
+{
+    SCM_NULL_RECORD_CALL(glCreateProgram);
+    return generate_name();
+}
+
+void APIENTRY
+null_glDeleteShader(GLuint shader)
+{
+    SCM_NULL_RECORD_CALL(glDeleteShader);
+    release_names(shader != 0 ? 1 : 0, &shader);
+}
+
+void APIENTRY
+null_glDeleteProgram(GLuint program)
+{
+    SCM_NULL_RECORD_CALL(glDeleteProgram);
+    release_names(program != 0 ? 1 : 0, &program);
+}
+
+// sync objects
+GLsync APIENTRY
+null_glFenceSync(GLenum, GLbitfield)
+{
+    SCM_NULL_RECORD_CALL(glFenceSync);
+    return reinterpret_cast<GLsync>(static_cast<scm::size_t>(generate_name()));
+}
+
+void APIENTRY
+null_glDeleteSync(GLsync sync)
+{
+    SCM_NULL_RECORD_CALL(glDeleteSync);
+    const GLuint name = static_cast<GLuint>(reinterpret_cast<scm::size_t>(sync));
+    release_names(name != 0 ? 1 : 0, &name);
+}
+
+GLenum APIENTRY
+null_glClientWaitSync(GLsync, GLbitfield, GLuint64)
+{
+    SCM_NULL_RECORD_CALL(glClientWaitSync);
+    return GL_ALREADY_SIGNALED;
+}
+
+void APIENTRY
+null_glGetSynciv(GLsync, GLenum pname, GLsizei count, GLsizei* length, GLint* values)
+{
+    SCM_NULL_RECORD_CALL(glGetSynciv);
+    if (count > 0) {
+        values[0] = (pname == GL_SYNC_STATUS) ? GL_SIGNALED : 0;
+    }
+    if (length) {
+        *length = count > 0 ? 1 : 0;
+    }
+}
+
+// context queries
+const GLubyte* APIENTRY
+null_glGetString(GLenum name)
+{
+    SCM_NULL_RECORD_CALL(glGetString);
+    switch (name) {
+        case GL_VERSION:                    return reinterpret_cast<const GLubyte*>("4.6.0 null backend");
+        case GL_VENDOR:                     return reinterpret_cast<const GLubyte*>("scm");
+        case GL_RENDERER:                   return reinterpret_cast<const GLubyte*>("scm_gl_core null backend");
+        case GL_SHADING_LANGUAGE_VERSION:   return reinterpret_cast<const GLubyte*>("4.60 null backend");
+        default:                            return reinterpret_cast<const GLubyte*>("");
+    }
+}
+
+const char* null_extensions[] = {
+    "GL_EXT_direct_state_access",
+    "GL_KHR_parallel_shader_compile"
+};
+
+const GLubyte* APIENTRY
+null_glGetStringi(GLenum name, GLuint index)
+{
+    SCM_NULL_RECORD_CALL(glGetStringi);
+    if (   name == GL_EXTENSIONS
+        && index < sizeof(null_extensions) / sizeof(null_extensions[0])) {
+        return reinterpret_cast<const GLubyte*>(null_extensions[index]);
+    }
+    return reinterpret_cast<const GLubyte*>("");
+}
+
+// limits resemble a current desktop implementation, unlisted queries return zero
+scm::int64
+integer_value(GLenum pname)
+{
+    switch (pname) {
+        case GL_MAJOR_VERSION:                              return 4;
+        case GL_MINOR_VERSION:                              return 6;
+        case GL_CONTEXT_PROFILE_MASK:                       return GL_CONTEXT_CORE_PROFILE_BIT;
+        case GL_NUM_EXTENSIONS:                             return sizeof(null_extensions) / sizeof(null_extensions[0]);
+        case GL_ACTIVE_TEXTURE:                             return GL_TEXTURE0;
+        case GL_MAX_VERTEX_ATTRIBS:                         return 16;
+        case GL_MAX_DRAW_BUFFERS:                           return 8;
+        case GL_MAX_DUAL_SOURCE_DRAW_BUFFERS:               return 1;
+        case GL_MAX_TEXTURE_SIZE:                           return 32768;
+        case GL_MAX_3D_TEXTURE_SIZE:                        return 16384;
+        case GL_MAX_ARRAY_TEXTURE_LAYERS:                   return 2048;
+        case GL_MAX_SAMPLES:                                return 32;
+        case GL_MAX_DEPTH_TEXTURE_SAMPLES:                  return 32;
+        case GL_MAX_COLOR_TEXTURE_SAMPLES:                  return 32;
+        case GL_MAX_INTEGER_SAMPLES:                        return 32;
+        case GL_MAX_TEXTURE_IMAGE_UNITS:                    return 32;
+        case GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS:           return 192;
+        case GL_MAX_TEXTURE_BUFFER_SIZE:                    return 134217728;
+        case GL_MAX_COLOR_ATTACHMENTS:                      return 8;
+        case GL_MAX_VERTEX_UNIFORM_BLOCKS:                  return 14;
+        case GL_MAX_GEOMETRY_UNIFORM_BLOCKS:                return 14;
+        case GL_MAX_FRAGMENT_UNIFORM_BLOCKS:                return 14;
+        case GL_MAX_COMBINED_UNIFORM_BLOCKS:                return 84;
+        case GL_MAX_COMBINED_VERTEX_UNIFORM_COMPONENTS:     return 233472;
+        case GL_MAX_COMBINED_GEOMETRY_UNIFORM_COMPONENTS:   return 233472;
+        case GL_MAX_COMBINED_FRAGMENT_UNIFORM_COMPONENTS:   return 233472;
+        case GL_MAX_UNIFORM_BUFFER_BINDINGS:                return 84;
+        case GL_MAX_UNIFORM_BLOCK_SIZE:                     return 65536;
+        case GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT:            return 256;
+        case GL_MAX_VIEWPORTS:                              return 16;
+        case GL_MAX_TRANSFORM_FEEDBACK_SEPARATE_ATTRIBS:    return 4;
+        case GL_MAX_TRANSFORM_FEEDBACK_BUFFERS:             return 4;
+        case GL_MAX_VERTEX_STREAMS:                         return 4;
+        case GL_MAX_IMAGE_UNITS:                            return 8;
+        case GL_MAX_VERTEX_ATOMIC_COUNTERS:                 return 16384;
+        case GL_MAX_GEOMETRY_ATOMIC_COUNTERS:               return 16384;
+        case GL_MAX_FRAGMENT_ATOMIC_COUNTERS:               return 16384;
+        case GL_MAX_COMBINED_ATOMIC_COUNTERS:               return 16384;
+        case GL_MAX_ATOMIC_COUNTER_BUFFER_BINDINGS:         return 8;
+        case GL_MIN_MAP_BUFFER_ALIGNMENT:                   return 64;
+        case GL_MAX_SHADER_STORAGE_BUFFER_BINDINGS:         return 96;
+        case GL_MAX_SHADER_STORAGE_BLOCK_SIZE:              return 134217728;
+        case GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT:     return 32;
+        case GL_MAX_DEBUG_MESSAGE_LENGTH:                   return 1024;
+        case GL_NUM_PROGRAM_BINARY_FORMATS:                 return 1;
+        case GL_PROGRAM_BINARY_FORMATS:                     return null_program_binary_format;
+        default:                                            return 0;
+    }
+}
+
+// returns the number of values written
+template<typename T>
+int
+get_values(GLenum pname, T* data)
+{
+    switch (pname) {
+        case GL_VIEWPORT:
+        case GL_SCISSOR_BOX:
+        case GL_COLOR_WRITEMASK:
+        case GL_COLOR_CLEAR_VALUE:
+        case GL_BLEND_COLOR:
+            data[0] = data[1] = data[2] = data[3] = T(0);
+            return 4;
+        case GL_DEPTH_RANGE:
+            data[0] = T(0);
+            data[1] = T(1);
+            return 2;
+        case GL_MAX_VIEWPORT_DIMS:
+            data[0] = data[1] = T(32768);
+            return 2;
+        default:
+            data[0] = static_cast<T>(integer_value(pname));
+            return 1;
+    }
+}
+
+void APIENTRY
+null_glGetIntegerv(GLenum pname, GLint* data)
+{
+    SCM_NULL_RECORD_CALL(glGetIntegerv);
+    get_values(pname, data);
+}
+
+void APIENTRY
+null_glGetInteger64v(GLenum pname, GLint64* data)
+{
+    SCM_NULL_RECORD_CALL(glGetInteger64v);
+    get_values(pname, data);
+}
+
+void APIENTRY
+null_glGetFloatv(GLenum pname, GLfloat* data)
+{
+    SCM_NULL_RECORD_CALL(glGetFloatv);
+    get_values(pname, data);
+}
+
+void APIENTRY
+null_glGetDoublev(GLenum pname, GLdouble* data)
+{
+    SCM_NULL_RECORD_CALL(glGetDoublev);
+    get_values(pname, data);
+}
+
+void APIENTRY
+null_glGetBooleanv(GLenum pname, GLboolean* data)
+{
+    SCM_NULL_RECORD_CALL(glGetBooleanv);
+    GLint     v[4];
+    const int n = get_values(pname, v);
+    for (int i = 0; i < n; ++i) {
+        data[i] = v[i] != 0 ? GL_TRUE : GL_FALSE;
+    }
+}
+
+// shaders and programs
+//  - default block uniforms declared as 'uniform <type> <name>[<size>];' in the shader
+//    sources are reported as active uniforms, locations are their index
+GLenum
+uniform_type(const std::string& t)
+{
+    static const struct { const char* _name; GLenum _type; } types[] = {
+        { "float", GL_FLOAT },          { "vec2", GL_FLOAT_VEC2 },      { "vec3", GL_FLOAT_VEC3 },      { "vec4", GL_FLOAT_VEC4 },
+        { "mat2", GL_FLOAT_MAT2 },      { "mat3", GL_FLOAT_MAT3 },      { "mat4", GL_FLOAT_MAT4 },
+        { "int", GL_INT },              { "ivec2", GL_INT_VEC2 },       { "ivec3", GL_INT_VEC3 },       { "ivec4", GL_INT_VEC4 },
+        { "uint", GL_UNSIGNED_INT },    { "uvec2", GL_UNSIGNED_INT_VEC2 }, { "uvec3", GL_UNSIGNED_INT_VEC3 }, { "uvec4", GL_UNSIGNED_INT_VEC4 },
+        { "bool", GL_BOOL },
+        { "sampler2D", GL_SAMPLER_2D }, { "sampler3D", GL_SAMPLER_3D }, { "samplerCube", GL_SAMPLER_CUBE }, { "sampler2DArray", GL_SAMPLER_2D_ARRAY }
+    };
+    for (unsigned i = 0; i < sizeof(types) / sizeof(types[0]); ++i) {
+        if (t == types[i]._name) {
+            return types[i]._type;
+        }
+    }
+    return GL_NONE;
+}
+
+void
+parse_uniforms(const std::string& src, std::vector<null_state::uniform_info>& uniforms)
+{
+    std::istringstream  lines(src);
+    std::string         line;
+    while (std::getline(lines, line)) {
+        std::istringstream  tokens(line);
+        std::string         qualifier;
+        std::string         type;
+        std::string         name;
+        if (!(tokens >> qualifier >> type >> name) || qualifier != "uniform") {
+            continue;
+        }
+        null_state::uniform_info u;
+        u._type = uniform_type(type);
+        u._size = 1;
+        name    = name.substr(0, name.find(';'));
+        const std::string::size_type b = name.find('[');
+        if (b != std::string::npos) {
+            u._size = std::max(1, std::atoi(name.c_str() + b + 1));
+            name    = name.substr(0, b);
+        }
+        u._name = name;
+        if (u._type == GL_NONE || name.empty()) {
+            continue;
+        }
+        bool known = false;
+        for (scm::size_t i = 0; i < uniforms.size(); ++i) {
+            known = known || uniforms[i]._name == u._name;
+        }
+        if (!known) {
+            uniforms.push_back(u);
+        }
+    }
+}
+
+const std::vector<null_state::uniform_info>&
+program_uniforms(GLuint program)
+{
+    return state()._program_uniforms[program];
+}
+
+void APIENTRY
+null_glShaderSource(GLuint shader, GLsizei count, const GLchar* const* strings, const GLint* lengths)
+{
+    SCM_NULL_RECORD_CALL(glShaderSource);
+    std::string& src = state()._shader_sources[shader];
+    src.clear();
+    for (GLsizei i = 0; i < count; ++i) {
+        if (lengths && lengths[i] >= 0) {
+            src.append(strings[i], lengths[i]);
+        }
+        else {
+            src.append(strings[i]);
+        }
+    }
+}
+
+void APIENTRY
+null_glCompileShader(GLuint shader)
+{
+    SCM_NULL_RECORD_CALL(glCompileShader);
+    state()._pending_polls[shader] = state()._completion_latency;
+}
+
+// true once the object received its completion polls, a status query completes it
+bool
+poll_completion(GLuint object, bool complete)
+{
+    null_state::pending_poll_map&           p = state()._pending_polls;
+    null_state::pending_poll_map::iterator  i = p.find(object);
+    if (i == p.end() || 0 == i->second || complete) {
+        if (i != p.end()) {
+            p.erase(i);
+        }
+        return true;
+    }
+    --i->second;
+    return false;
+}
+
+void APIENTRY
+null_glAttachShader(GLuint program, GLuint shader)
+{
+    SCM_NULL_RECORD_CALL(glAttachShader);
+    state()._program_shaders[program].push_back(shader);
+}
+
+void APIENTRY
+null_glLinkProgram(GLuint program)
+{
+    SCM_NULL_RECORD_CALL(glLinkProgram);
+    null_state&                             s = state();
+    const std::vector<GLuint>&              shaders  = s._program_shaders[program];
+    std::vector<null_state::uniform_info>&  uniforms = s._program_uniforms[program];
+    std::string&                            binary   = s._program_binaries[program];
+    GLint                                   linked   = GL_TRUE;
+    uniforms.clear();
+    binary.assign(null_program_binary_magic);
+    for (scm::size_t i = 0; i < shaders.size(); ++i) {
+        parse_uniforms(s._shader_sources[shaders[i]], uniforms);
+        binary.append(s._shader_sources[shaders[i]]);
+        if (s._shader_sources[shaders[i]].find("#error") != std::string::npos) {
+            linked = GL_FALSE;
+        }
+    }
+    s._program_link_status[program] = linked;
+    s._pending_polls[program]       = s._completion_latency;
+}
+
+void APIENTRY
+null_glGetProgramBinary(GLuint program, GLsizei size, GLsizei* length, GLenum* format, void* binary)
+{
+    SCM_NULL_RECORD_CALL(glGetProgramBinary);
+    const std::string& b = state()._program_binaries[program];
+    const GLsizei      l = std::min(size, static_cast<GLsizei>(b.size()));
+    std::memcpy(binary, b.data(), l);
+    if (length) *length = l;
+    *format = null_program_binary_format;
+}
+
+// binaries of other formats or without the magic string are rejected
+void APIENTRY
+null_glProgramBinary(GLuint program, GLenum format, const void* binary, GLsizei length)
+{
+    SCM_NULL_RECORD_CALL(glProgramBinary);
+    null_state&         s     = state();
+    const std::string   b(static_cast<const char*>(binary), length);
+    const bool          valid =    format == null_program_binary_format
+                                && 0 == b.compare(0, sizeof(null_program_binary_magic) - 1, null_program_binary_magic);
+
+    s._program_uniforms[program].clear();
+    s._program_binaries[program].clear();
+    s._program_link_status[program] = valid ? GL_TRUE : GL_FALSE;
+    if (valid) {
+        parse_uniforms(b.substr(sizeof(null_program_binary_magic) - 1), s._program_uniforms[program]);
+        s._program_binaries[program] = b;
+    }
+}
+
+void APIENTRY
+null_glGetActiveUniform(GLuint program, GLuint index, GLsizei size, GLsizei* length, GLint* usize, GLenum* type, GLchar* name)
+{
+    SCM_NULL_RECORD_CALL(glGetActiveUniform);
+    const std::vector<null_state::uniform_info>& uniforms = program_uniforms(program);
+    if (index >= uniforms.size() || size <= 0) {
+        return;
+    }
+    const null_state::uniform_info& u = uniforms[index];
+    const std::string               n = u._size > 1 ? u._name + "[0]" : u._name;
+    const GLsizei                   l = std::min(size - 1, static_cast<GLsizei>(n.size()));
+    std::memcpy(name, n.c_str(), l);
+    name[l] = 0;
+    if (length) *length = l;
+    *usize = u._size;
+    *type  = u._type;
+}
+
+void APIENTRY
+null_glGetShaderiv(GLuint shader, GLenum pname, GLint* params)
+{
+    SCM_NULL_RECORD_CALL(glGetShaderiv);
+    switch (pname) {
+        case GL_COMPILE_STATUS:
+            poll_completion(shader, true);
+            *params = (state()._shader_sources[shader].find("#error") == std::string::npos) ? GL_TRUE : GL_FALSE;
+            break;
+        case GL_COMPLETION_STATUS_KHR:      *params = poll_completion(shader, false) ? GL_TRUE : GL_FALSE; break;
+        default:                            *params = 0;
+    }
+}
+
+void APIENTRY
+null_glGetProgramiv(GLuint program, GLenum pname, GLint* params)
+{
+    SCM_NULL_RECORD_CALL(glGetProgramiv);
+    const std::vector<null_state::uniform_info>& uniforms = program_uniforms(program);
+    const null_state::program_status_map&        status   = state()._program_link_status;
+    switch (pname) {
+        case GL_LINK_STATUS:
+            poll_completion(program, true);
+            *params = (status.find(program) != status.end()) ? status.find(program)->second : GL_TRUE;
+            break;
+        case GL_COMPLETION_STATUS_KHR:      *params = poll_completion(program, false) ? GL_TRUE : GL_FALSE; break;
+        case GL_VALIDATE_STATUS:            *params = GL_TRUE; break;
+        case GL_PROGRAM_BINARY_LENGTH:      *params = static_cast<GLint>(state()._program_binaries[program].size()); break;
+        case GL_ACTIVE_UNIFORMS:            *params = static_cast<GLint>(uniforms.size()); break;
+        case GL_ACTIVE_UNIFORM_MAX_LENGTH:
+            *params = 0;
+            for (scm::size_t i = 0; i < uniforms.size(); ++i) {
+                *params = std::max(*params, static_cast<GLint>(uniforms[i]._name.size() + 4)); // [0] and null termination
+            }
+            break;
+        default:                            *params = 0;
+    }
+}
+
+void APIENTRY
+null_glGetShaderInfoLog(GLuint, GLsizei size, GLsizei* length, GLchar* log)
+{
+    SCM_NULL_RECORD_CALL(glGetShaderInfoLog);
+    if (length)   *length = 0;
+    if (size > 0) log[0]  = 0;
+}
+
+void APIENTRY
+null_glGetProgramInfoLog(GLuint, GLsizei size, GLsizei* length, GLchar* log)
+{
+    SCM_NULL_RECORD_CALL(glGetProgramInfoLog);
+    if (length)   *length = 0;
+    if (size > 0) log[0]  = 0;
+}
+
+void APIENTRY
+null_glGetProgramInterfaceiv(GLuint, GLenum, GLenum, GLint* params)
+{
+    SCM_NULL_RECORD_CALL(glGetProgramInterfaceiv);
+    *params = 0;
+}
+
+void APIENTRY
+null_glGetProgramStageiv(GLuint, GLenum, GLenum, GLint* values)
+{
+    SCM_NULL_RECORD_CALL(glGetProgramStageiv);
+    *values = 0;
+}
+
+void APIENTRY
+null_glGetActiveSubroutineUniformiv(GLuint, GLenum, GLuint, GLenum, GLint* values)
+{
+    SCM_NULL_RECORD_CALL(glGetActiveSubroutineUniformiv);
+    *values = 0;
+}
+
+GLint APIENTRY
+null_glGetUniformLocation(GLuint program, const GLchar* name)
+{
+    SCM_NULL_RECORD_CALL(glGetUniformLocation);
+    const std::vector<null_state::uniform_info>& uniforms = program_uniforms(program);
+    for (scm::size_t i = 0; i < uniforms.size(); ++i) {
+        if (uniforms[i]._name == name) {
+            return static_cast<GLint>(i);
+        }
+    }
+    return -1;
+}
+
+GLint APIENTRY
+null_glGetAttribLocation(GLuint, const GLchar*)
+{
+    SCM_NULL_RECORD_CALL(glGetAttribLocation);
+    return -1;
+}
+
+GLuint APIENTRY
+null_glGetUniformBlockIndex(GLuint, const GLchar*)
+{
+    SCM_NULL_RECORD_CALL(glGetUniformBlockIndex);
+    return GL_INVALID_INDEX;
+}
+
+GLuint APIENTRY
+null_glGetProgramResourceIndex(GLuint, GLenum, const GLchar*)
+{
+    SCM_NULL_RECORD_CALL(glGetProgramResourceIndex);
+    return GL_INVALID_INDEX;
+}
+
+// queries
+void APIENTRY
+null_glGetQueryObjectiv(GLuint, GLenum pname, GLint* params)
+{
+    SCM_NULL_RECORD_CALL(glGetQueryObjectiv);
+    *params = (pname == GL_QUERY_RESULT_AVAILABLE) ? GL_TRUE : 0;
+}
+
+void APIENTRY
+null_glGetQueryObjectuiv(GLuint, GLenum pname, GLuint* params)
+{
+    SCM_NULL_RECORD_CALL(glGetQueryObjectuiv);
+    *params = (pname == GL_QUERY_RESULT_AVAILABLE) ? GL_TRUE : 0;
+}
+
+void APIENTRY
+null_glGetQueryObjecti64v(GLuint, GLenum, GLint64* params)
+{
+    SCM_NULL_RECORD_CALL(glGetQueryObjecti64v);
+    *params = 0;
+}
+
+void APIENTRY
+null_glGetQueryObjectui64v(GLuint, GLenum, GLuint64* params)
+{
+    SCM_NULL_RECORD_CALL(glGetQueryObjectui64v);
+    *params = 0;
+}
+
+// frame buffers
+GLenum APIENTRY
+null_glCheckFramebufferStatus(GLenum)
+{
+    SCM_NULL_RECORD_CALL(glCheckFramebufferStatus);
+    return GL_FRAMEBUFFER_COMPLETE;
+}
+
+GLenum APIENTRY
+null_glCheckNamedFramebufferStatus(GLuint, GLenum)
+{
+    SCM_NULL_RECORD_CALL(glCheckNamedFramebufferStatus);
+    return GL_FRAMEBUFFER_COMPLETE;
+}
+
+GLenum APIENTRY
+null_glCheckNamedFramebufferStatusEXT(GLuint, GLenum)
+{
+    SCM_NULL_RECORD_CALL(glCheckNamedFramebufferStatusEXT);
+    return GL_FRAMEBUFFER_COMPLETE;
+}
+
+// buffers, storage is kept in system memory
+std::vector<scm::uint8>&
+buffer_storage(GLuint buffer)
+{
+    return state()._buffer_storage[buffer];
+}
+
+GLuint
+bound_buffer(GLenum target)
+{
+    null_state::buffer_binding_map::const_iterator b = state()._buffer_bindings.find(target);
+    return b != state()._buffer_bindings.end() ? b->second : 0;
+}
+
+void
+buffer_data(GLuint buffer, GLsizeiptr size, const void* data)
+{
+    std::vector<scm::uint8>& s = buffer_storage(buffer);
+    s.assign(static_cast<scm::size_t>(size), 0);
+    if (data && size > 0) {
+        std::memcpy(&s[0], data, static_cast<scm::size_t>(size));
+    }
+}
+
+void
+buffer_sub_data(GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data)
+{
+    std::vector<scm::uint8>& s = buffer_storage(buffer);
+    if (data && size > 0 && static_cast<scm::size_t>(offset + size) <= s.size()) {
+        std::memcpy(&s[offset], data, static_cast<scm::size_t>(size));
+    }
+}
+
+void
+get_buffer_sub_data(GLuint buffer, GLintptr offset, GLsizeiptr size, void* data)
+{
+    std::vector<scm::uint8>& s = buffer_storage(buffer);
+    if (data && size > 0 && static_cast<scm::size_t>(offset + size) <= s.size()) {
+        std::memcpy(data, &s[offset], static_cast<scm::size_t>(size));
+    }
+}
+
+void*
+map_buffer_range(GLuint buffer, GLintptr offset, GLsizeiptr length)
+{
+    std::vector<scm::uint8>& s = buffer_storage(buffer);
+    if (length <= 0 || static_cast<scm::size_t>(offset + length) > s.size()) {
+        return 0;
+    }
+    return &s[offset];
+}
+
+void APIENTRY
+null_glBindBuffer(GLenum target, GLuint buffer)
+{
+    SCM_NULL_RECORD_CALL(glBindBuffer);
+    state()._buffer_bindings[target] = buffer;
+}
+
+void APIENTRY
+null_glBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum)
+{
+    SCM_NULL_RECORD_CALL(glBufferData);
+    buffer_data(bound_buffer(target), size, data);
+}
+
+void APIENTRY
+null_glNamedBufferDataEXT(GLuint buffer, GLsizeiptr size, const void* data, GLenum)
+{
+    SCM_NULL_RECORD_CALL(glNamedBufferDataEXT);
+    buffer_data(buffer, size, data);
+}
+
+void APIENTRY
+null_glBufferStorage(GLenum target, GLsizeiptr size, const void* data, GLbitfield)
+{
+    SCM_NULL_RECORD_CALL(glBufferStorage);
+    buffer_data(bound_buffer(target), size, data);
+}
+
+void APIENTRY
+null_glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+{
+    SCM_NULL_RECORD_CALL(glBufferSubData);
+    buffer_sub_data(bound_buffer(target), offset, size, data);
+}
+
+void APIENTRY
+null_glNamedBufferSubDataEXT(GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data)
+{
+    SCM_NULL_RECORD_CALL(glNamedBufferSubDataEXT);
+    buffer_sub_data(buffer, offset, size, data);
+}
+
+void APIENTRY
+null_glGetBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, void* data)
+{
+    SCM_NULL_RECORD_CALL(glGetBufferSubData);
+    get_buffer_sub_data(bound_buffer(target), offset, size, data);
+}
+
+void APIENTRY
+null_glGetNamedBufferSubDataEXT(GLuint buffer, GLintptr offset, GLsizeiptr size, void* data)
+{
+    SCM_NULL_RECORD_CALL(glGetNamedBufferSubDataEXT);
+    get_buffer_sub_data(buffer, offset, size, data);
+}
+
+void* APIENTRY
+null_glMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield)
+{
+    SCM_NULL_RECORD_CALL(glMapBufferRange);
+    return map_buffer_range(bound_buffer(target), offset, length);
+}
+
+void* APIENTRY
+null_glMapNamedBufferRangeEXT(GLuint buffer, GLintptr offset, GLsizeiptr length, GLbitfield)
+{
+    SCM_NULL_RECORD_CALL(glMapNamedBufferRangeEXT);
+    return map_buffer_range(buffer, offset, length);
+}
+
+GLboolean APIENTRY
+null_glUnmapBuffer(GLenum)
+{
+    SCM_NULL_RECORD_CALL(glUnmapBuffer);
+    return GL_TRUE;
+}
+
+GLboolean APIENTRY
+null_glUnmapNamedBufferEXT(GLuint)
+{
+    SCM_NULL_RECORD_CALL(glUnmapNamedBufferEXT);
+    return GL_TRUE;
+}
+
+#undef SCM_NULL_GEN_FUNC
+#undef SCM_NULL_CREATE_TARGET_FUNC
+#undef SCM_NULL_DELETE_FUNC
+#undef SCM_NULL_RECORD_CALL
+
+void
+register_entry_points(null_state::entry_point_map& m)
+{
+#define SCM_NULL_ENTRY(fun) m[#fun] = reinterpret_cast<void*>(&null_##fun)
+
+    SCM_NULL_ENTRY(glGenBuffers);
+    SCM_NULL_ENTRY(glGenTextures);
+    SCM_NULL_ENTRY(glGenSamplers);
+    SCM_NULL_ENTRY(glGenVertexArrays);
+    SCM_NULL_ENTRY(glGenFramebuffers);
+    SCM_NULL_ENTRY(glGenRenderbuffers);
+    SCM_NULL_ENTRY(glGenQueries);
+    SCM_NULL_ENTRY(glGenTransformFeedbacks);
+    SCM_NULL_ENTRY(glGenProgramPipelines);
+    SCM_NULL_ENTRY(glCreateBuffers);
+    SCM_NULL_ENTRY(glCreateSamplers);
+    SCM_NULL_ENTRY(glCreateVertexArrays);
+    SCM_NULL_ENTRY(glCreateFramebuffers);
+    SCM_NULL_ENTRY(glCreateRenderbuffers);
+    SCM_NULL_ENTRY(glCreateTransformFeedbacks);
+    SCM_NULL_ENTRY(glCreateProgramPipelines);
+    SCM_NULL_ENTRY(glCreateTextures);
+    SCM_NULL_ENTRY(glCreateQueries);
+    SCM_NULL_ENTRY(glDeleteBuffers);
+    SCM_NULL_ENTRY(glDeleteTextures);
+    SCM_NULL_ENTRY(glDeleteSamplers);
+    SCM_NULL_ENTRY(glDeleteVertexArrays);
+    SCM_NULL_ENTRY(glDeleteFramebuffers);
+    SCM_NULL_ENTRY(glDeleteRenderbuffers);
+    SCM_NULL_ENTRY(glDeleteQueries);
+    SCM_NULL_ENTRY(glDeleteTransformFeedbacks);
+    SCM_NULL_ENTRY(glDeleteProgramPipelines);
+    SCM_NULL_ENTRY(glCreateShader);
+    SCM_NULL_ENTRY(glCreateProgram);
+    SCM_NULL_ENTRY(glDeleteShader);
+    SCM_NULL_ENTRY(glDeleteProgram);
+
+    SCM_NULL_ENTRY(glFenceSync);
+    SCM_NULL_ENTRY(glDeleteSync);
+    SCM_NULL_ENTRY(glClientWaitSync);
+    SCM_NULL_ENTRY(glGetSynciv);
+
+    SCM_NULL_ENTRY(glGetString);
+    SCM_NULL_ENTRY(glGetStringi);
+    SCM_NULL_ENTRY(glGetIntegerv);
+    SCM_NULL_ENTRY(glGetInteger64v);
+    SCM_NULL_ENTRY(glGetFloatv);
+    SCM_NULL_ENTRY(glGetDoublev);
+    SCM_NULL_ENTRY(glGetBooleanv);
+
+    SCM_NULL_ENTRY(glShaderSource);
+    SCM_NULL_ENTRY(glCompileShader);
+    SCM_NULL_ENTRY(glAttachShader);
+    SCM_NULL_ENTRY(glLinkProgram);
+    SCM_NULL_ENTRY(glGetProgramBinary);
+    SCM_NULL_ENTRY(glProgramBinary);
+    SCM_NULL_ENTRY(glGetActiveUniform);
+    SCM_NULL_ENTRY(glGetShaderiv);
+    SCM_NULL_ENTRY(glGetProgramiv);
+    SCM_NULL_ENTRY(glGetShaderInfoLog);
+    SCM_NULL_ENTRY(glGetProgramInfoLog);
+    SCM_NULL_ENTRY(glGetProgramInterfaceiv);
+    SCM_NULL_ENTRY(glGetProgramStageiv);
+    SCM_NULL_ENTRY(glGetActiveSubroutineUniformiv);
+    SCM_NULL_ENTRY(glGetUniformLocation);
+    SCM_NULL_ENTRY(glGetAttribLocation);
+    SCM_NULL_ENTRY(glGetUniformBlockIndex);
+    SCM_NULL_ENTRY(glGetProgramResourceIndex);
+
+    SCM_NULL_ENTRY(glGetQueryObjectiv);
+    SCM_NULL_ENTRY(glGetQueryObjectuiv);
+    SCM_NULL_ENTRY(glGetQueryObjecti64v);
+    SCM_NULL_ENTRY(glGetQueryObjectui64v);
+
+    SCM_NULL_ENTRY(glCheckFramebufferStatus);
+    SCM_NULL_ENTRY(glCheckNamedFramebufferStatus);
+    SCM_NULL_ENTRY(glCheckNamedFramebufferStatusEXT);
+
+    SCM_NULL_ENTRY(glBindBuffer);
+    SCM_NULL_ENTRY(glBufferData);
+    SCM_NULL_ENTRY(glNamedBufferDataEXT);
+    SCM_NULL_ENTRY(glBufferStorage);
+    SCM_NULL_ENTRY(glBufferSubData);
+    SCM_NULL_ENTRY(glNamedBufferSubDataEXT);
+    SCM_NULL_ENTRY(glGetBufferSubData);
+    SCM_NULL_ENTRY(glGetNamedBufferSubDataEXT);
+    SCM_NULL_ENTRY(glMapBufferRange);
+    SCM_NULL_ENTRY(glMapNamedBufferRangeEXT);
+    SCM_NULL_ENTRY(glUnmapBuffer);
+    SCM_NULL_ENTRY(glUnmapNamedBufferEXT);
+
+#undef SCM_NULL_ENTRY
+}
+
+bool
+greater_count(const gl_null_backend::call_count_entry& lhs,
+              const gl_null_backend::call_count_entry& rhs)
+{
+    return lhs.second > rhs.second;
+}
+
+} // namespace
+
+void
+gl_null_backend::reset_recording()
+{
+    std::fill(state()._entry_calls.begin(), state()._entry_calls.end(), 0);
+}
+
+scm::uint64
+gl_null_backend::call_count(const std::string& in_function)
+{
+    null_state::entry_index_map::const_iterator e = state()._entry_indices.find(in_function);
+    return e != state()._entry_indices.end() ? state()._entry_calls[e->second] : 0;
+}
+
+scm::uint64
+gl_null_backend::total_call_count()
+{
+    scm::uint64 c = 0;
+    for (scm::size_t i = 0; i < state()._entry_calls.size(); ++i) {
+        c += state()._entry_calls[i];
+    }
+    return c;
+}
+
+void
+gl_null_backend::call_counts(call_count_array& out_counts)
+{
+    const null_state& s = state();
+
+    out_counts.clear();
+    for (scm::size_t i = 0; i < s._entry_calls.size(); ++i) {
+        if (s._entry_calls[i] > 0) {
+            out_counts.push_back(call_count_entry(s._entry_names[i], s._entry_calls[i]));
+        }
+    }
+    std::stable_sort(out_counts.begin(), out_counts.end(), greater_count);
+}
+
+scm::size_t
+gl_null_backend::live_object_count()
+{
+    return state()._live_names.size();
+}
+
+scm::size_t
+gl_null_backend::buffer_memory_size()
+{
+    scm::size_t s = 0;
+    null_state::buffer_storage_map::const_iterator b = state()._buffer_storage.begin();
+    for (; b != state()._buffer_storage.end(); ++b) {
+        s += b->second.size();
+    }
+    return s;
+}
+
+void
+gl_null_backend::completion_latency(unsigned in_polls)
+{
+    state()._completion_latency = in_polls;
+}
+
+unsigned
+gl_null_backend::register_entry(const char* in_function)
+{
+    null_state& s = state();
+
+    std::pair<null_state::entry_index_map::iterator, bool> e =
+        s._entry_indices.insert(null_state::entry_index_map::value_type(in_function, static_cast<unsigned>(s._entry_names.size())));
+    if (e.second) {
+        s._entry_names.push_back(in_function);
+        s._entry_calls.push_back(0);
+    }
+    return e.first->second;
+}
+
+void*
+gl_null_backend::entry_point(const char* in_function)
+{
+    null_state& s = state();
+
+    if (s._entry_points.empty()) {
+        register_entry_points(s._entry_points);
+    }
+    null_state::entry_point_map::const_iterator e = s._entry_points.find(in_function);
+    return e != s._entry_points.end() ? e->second : 0;
+}
+
+void
+gl_null_backend::record(unsigned in_entry)
+{
+    ++state()._entry_calls[in_entry];
+}
+
+} // namespace opengl
+} // namespace gl
+} // namespace scm
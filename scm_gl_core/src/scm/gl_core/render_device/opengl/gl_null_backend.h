@@ -0,0 +1,106 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_GL_CORE_OPENGL_GL_NULL_BACKEND_H_INCLUDED
+#define SCM_GL_CORE_OPENGL_GL_NULL_BACKEND_H_INCLUDED
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <scm/core/numeric_types.h>
+
+#include <scm/gl_core/render_device/opengl/GL/glcorearb.h>
+
+#include <scm/core/platform/platform.h>
+#include <scm/core/utilities/platform_warning_disable.h>
+
+namespace scm {
+namespace gl {
+namespace opengl {
+
+// stub backend for gl_core, runs scm_gl_core without a GL context
+//  - every entry point is replaced by a stub counting its calls, stubs of functions
+//    returning values return zero unless implemented below
+//  - object names are handed out from a running counter, buffer storage is backed by
+//    system memory so buffers can be mapped and read back
+//  - shaders compile and programs link, the only active resources are default block
+//    uniforms declared on a single line, sync objects and queries are always signaled,
+//    frame buffers are always complete
+//  - program binaries hold the linked shader sources in a single binary format
+//  - shaders containing #error fail to compile, GL_KHR_parallel_shader_compile is exposed
+//    with compiles and links completing after a configurable number of completion polls
+//  - reports an OpenGL 4.6 core profile context exposing GL_EXT_direct_state_access
+//  - the recording is process wide and not synchronized, use a single render thread
+class __scm_export(gl_core) gl_null_backend
+{
+public:
+    typedef std::pair<std::string, scm::uint64> call_count_entry;
+    typedef std::vector<call_count_entry>       call_count_array;
+
+public:
+    // clears the call counts, objects stay alive
+    static void             reset_recording();
+
+    static scm::uint64      call_count(const std::string& in_function);
+    static scm::uint64      total_call_count();
+    // called functions, most frequent first
+    static void             call_counts(call_count_array& out_counts);
+
+    static scm::size_t      live_object_count();
+    static scm::size_t      buffer_memory_size();               // in bytes
+
+    // GL_COMPLETION_STATUS_KHR queries answered with false before a compile or link
+    // completes, compile and link status queries complete immediately (default 0)
+    static void             completion_latency(unsigned in_polls);
+
+    // used by gl_core to build the entry point table
+    static unsigned         register_entry(const char* in_function);
+    static void*            entry_point(const char* in_function);   // 0 if not implemented specially
+    static void             record(unsigned in_entry);
+
+}; // class gl_null_backend
+
+namespace detail {
+
+template<typename pfn_type, int entry_id>
+struct null_entry;
+
+template<int entry_id, typename R, typename... A>
+struct null_entry<R (APIENTRY*)(A...), entry_id>
+{
+    static unsigned     _entry;
+
+    static R APIENTRY   call(A...) {
+        gl_null_backend::record(_entry);
+        return R();
+    }
+}; // struct null_entry
+
+template<int entry_id, typename R, typename... A>
+unsigned null_entry<R (APIENTRY*)(A...), entry_id>::_entry = 0;
+
+// entry_id has to be unique for every entry point
+template<typename pfn_type, int entry_id>
+inline
+pfn_type
+null_entry_point(const char* in_function)
+{
+    if (void* p = gl_null_backend::entry_point(in_function)) {
+        return reinterpret_cast<pfn_type>(p);
+    }
+    null_entry<pfn_type, entry_id>::_entry = gl_null_backend::register_entry(in_function);
+
+    return &null_entry<pfn_type, entry_id>::call;
+}
+
+} // namespace detail
+
+} // namespace opengl
+} // namespace gl
+} // namespace scm
+
+#include <scm/core/utilities/platform_warning_enable.h>
+
+#endif // SCM_GL_CORE_OPENGL_GL_NULL_BACKEND_H_INCLUDED
@@ -14,6 +14,7 @@ namespace util {
 unsigned gl_buffer_targets(const buffer_binding b);
 unsigned gl_buffer_bindings(const buffer_binding b);
 int      gl_usage_flags(const buffer_usage b);
+unsigned gl_buffer_storage_flags(const buffer_usage b);
 unsigned gl_buffer_access_mode(const access_mode a);
 unsigned gl_image_access_mode(const access_mode a);
 unsigned gl_primitive_type(const primitive_type p);
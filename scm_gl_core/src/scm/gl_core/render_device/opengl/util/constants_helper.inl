@@ -68,7 +68,9 @@ gl_usage_flags(const buffer_usage b)
         // high write frequency
         GL_DYNAMIC_DRAW,    // GPU r,  CPU w
         GL_DYNAMIC_READ,    // GPU w,  CPU r
-        GL_DYNAMIC_COPY     // GPU rw, CPU
+        GL_DYNAMIC_COPY,    // GPU rw, CPU
+        // immutable storage
+        GL_STREAM_DRAW      // GPU r,  CPU w
     };
 
     BOOST_STATIC_ASSERT((sizeof(glbufu) / sizeof(int)) == USAGE_COUNT);
@@ -79,6 +81,18 @@ gl_usage_flags(const buffer_usage b)
     return glbufu[b];
 }
 
+inline
+unsigned
+gl_buffer_storage_flags(const buffer_usage b)
+{
+    assert(USAGE_STATIC_DRAW <= b && b < USAGE_COUNT);
+
+    switch (b) {
+        case USAGE_PERSISTENT_WRITE:            return GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT | GL_DYNAMIC_STORAGE_BIT;
+        default:                                return 0;
+    }
+}
+
 inline
 unsigned
 gl_buffer_access_mode(const access_mode a)
@@ -92,6 +106,7 @@ gl_buffer_access_mode(const access_mode a)
         case ACCESS_WRITE_INVALIDATE_RANGE:     return GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
         case ACCESS_WRITE_INVALIDATE_BUFFER:    return GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT;
         case ACCESS_WRITE_UNSYNCHRONIZED:       return GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+        case ACCESS_WRITE_PERSISTENT:           return GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
         default:                                return 0;                       
     }
 }
@@ -7,8 +7,10 @@
 
 #include <scm/gl_core/shader_objects/shader_objects_fwd.h>
 #include <scm/gl_core/shader_objects/shader_macro.h>
+#include <scm/gl_core/shader_objects/shader_preprocessor.h>
 #include <scm/gl_core/shader_objects/shader.h>
 #include <scm/gl_core/shader_objects/stream_capture.h>
 #include <scm/gl_core/shader_objects/program.h>
+#include <scm/gl_core/shader_objects/program_binary_cache.h>
 
 #endif // SCM_GL_CORE_SHADER_OBJECTS_H_INCLUDED
@@ -7,12 +7,17 @@
 #include <cassert>
 #include <cstring>
 #include <iostream>
+#include <sstream>
 #include <vector>
 
 #include <boost/lexical_cast.hpp>
 #include <boost/static_assert.hpp>
 #include <boost/algorithm/string/predicate.hpp>
 
+#include <scm/core/utilities/boost_warning_disable.h>
+#include <boost/atomic.hpp>
+#include <scm/core/utilities/boost_warning_enable.h>
+
 #include <scm/core/memory.h>
 #include <scm/core/utilities/foreach.h>
 
@@ -26,9 +31,16 @@
 #include <scm/gl_core/render_device/opengl/util/constants_helper.h>
 #include <scm/gl_core/render_device/opengl/util/data_type_helper.h>
 #include <scm/gl_core/render_device/opengl/util/error_helper.h>
+#include <scm/gl_core/shader_objects/program_binary_cache.h>
 #include <scm/gl_core/shader_objects/shader.h>
 #include <scm/gl_core/shader_objects/stream_capture.h>
 
+namespace {
+
+boost::atomic<scm::uint64>  program_serial_counter(0);  // 0 marks invalid uniform handles
+
+} // namespace
+
 namespace scm {
 namespace gl {
 namespace detail {
@@ -39,9 +51,12 @@ program::program(render_device&              in_device,
                  const stream_capture_array& in_capture,
                  bool                        in_rasterization_discard,
                  const named_location_list&  in_attribute_locations,
-                 const named_location_list&  in_fragment_locations)
+                 const named_location_list&  in_fragment_locations,
+                 bool                        in_async_link)
   : render_device_child(in_device)
   , _rasterization_discard(in_rasterization_discard)
+  , _link_pending(false)
+  , _serial(++program_serial_counter)
 {
     const opengl::gl_core& glapi = in_device.opengl_api();
     util::gl_error          glerror(glapi);
@@ -51,49 +66,74 @@ program::program(render_device&              in_device,
         state().set(object_state::OS_BAD);
     }
     else {
-        // attach all shaders
-        foreach(const shader_ptr& s, in_shaders) {
-            if (s) {
-                glapi.glAttachShader(_gl_program_obj, s->_gl_shader_obj);
-                if (!glerror) {
-                    _shaders.push_back(s);
+        const program_binary_cache_ptr cache     = in_device.binary_cache();
+        const std::string              cache_key = cache ? binary_cache_key(in_device, in_shaders, in_capture, in_rasterization_discard,
+                                                                            in_attribute_locations, in_fragment_locations)
+                                                         : std::string();
+
+        if (!cache_key.empty() && load_binary(in_device, *cache, cache_key)) {
+            _shaders = in_shaders;
+            retrieve_information(in_device);
+        }
+        else {
+            // compile shaders deferred for the binary cache, asynchronous compilations are
+            // checked when the link finished
+            foreach(const shader_ptr& s, in_shaders) {
+                if (s && in_async_link) {
+                    s->submit_compile(in_device);
+                }
+                else if (s && !s->compile(in_device)) {
+                    state().set(object_state::OS_ERROR_SHADER_COMPILE);
+                    _info_log = s->info_log();
+                    return;
+                }
+            }
+            // attach all shaders
+            foreach(const shader_ptr& s, in_shaders) {
+                if (s) {
+                    glapi.glAttachShader(_gl_program_obj, s->_gl_shader_obj);
+                    if (!glerror) {
+                        _shaders.push_back(s);
+                    }
+                    else {
+                        state().set(object_state::OS_ERROR_INVALID_VALUE);
+                    }
                 }
                 else {
                     state().set(object_state::OS_ERROR_INVALID_VALUE);
                 }
             }
-            else {
-                state().set(object_state::OS_ERROR_INVALID_VALUE);
+            gl_assert(glapi, program::program() attaching shader objects);
+            // set the captured transform feedback varyings
+            if (!in_capture.empty()) {
+                if (!apply_transform_feedback_varyings(in_device, in_capture)) {
+                    // error code set in function itself
+                    return;
+                }
             }
-        }
-        gl_assert(glapi, program::program() attaching shader objects);
-        // set the captured transform feedback varyings
-        if (!in_capture.empty()) {
-            if (!apply_transform_feedback_varyings(in_device, in_capture)) {
-                // error code set in function itself
-                return;
+            // set default attribute locations
+            foreach(const named_location& l, in_attribute_locations) {
+                glapi.glBindAttribLocation(_gl_program_obj, l.second, l.first.c_str());
+                gl_assert(glapi, program::program() binding attribute location);
+            }
+            // set default fragdata locations
+            foreach(const named_location& l, in_fragment_locations) {
+                glapi.glBindFragDataLocation(_gl_program_obj, l.second, l.first.c_str());
+                gl_assert(glapi, program::program() binding fragdata location);
+            }
+            // link program
+            if (!cache_key.empty()) {
+                glapi.glProgramParameteri(_gl_program_obj, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+            }
+            glapi.glLinkProgram(_gl_program_obj);
+            gl_assert(glapi, program::program() after glLinkProgram);
+
+            _link_pending     = true;
+            _binary_cache_key = cache_key;
+
+            if (!in_async_link) {
+                finish_link(in_device);
             }
-        }
-        // set default attribute locations
-        foreach(const named_location& l, in_attribute_locations) {
-            glapi.glBindAttribLocation(_gl_program_obj, l.second, l.first.c_str());
-            gl_assert(glapi, program::program() binding attribute location);
-        }
-        // set default fragdata locations
-        foreach(const named_location& l, in_fragment_locations) {
-            glapi.glBindFragDataLocation(_gl_program_obj, l.second, l.first.c_str());
-            gl_assert(glapi, program::program() binding fragdata location);
-        }
-        // link program
-        link(in_device);
-
-        // retrieve information
-        if (ok()) {
-            util::program_binding_guard save_guard(glapi);
-            glapi.glUseProgram(_gl_program_obj);
-            retrieve_attribute_information(in_device);
-            retrieve_fragdata_information(in_device);
-            retrieve_uniform_information(in_device);
         }
     }
     
@@ -104,6 +144,13 @@ program::~program()
 {
     const opengl::gl_core& glapi = parent_device().opengl_api();
 
+    // uniforms handed out may outlive the program
+    name_uniform_map::const_iterator u = _uniforms.begin();
+    name_uniform_map::const_iterator e = _uniforms.end();
+    for (; u != e; ++u) {
+        u->second->_dirty_list = 0;
+    }
+
     // TODO detach all shaders and remove them from _shaders;
 
     assert(0 != _gl_program_obj);
@@ -125,7 +172,71 @@ program::info_log() const
 }
 
 bool
-program::link(render_device& ren_dev)
+program::link_pending() const
+{
+    return _link_pending;
+}
+
+bool
+program::link_completed()
+{
+    if (!_link_pending) {
+        return true;
+    }
+
+    render_device&         device = parent_device();
+    const opengl::gl_core& glapi  = device.opengl_api();
+
+    // without GL_KHR_parallel_shader_compile the first poll waits for the link
+    if (glapi.extension_KHR_parallel_shader_compile) {
+        int completed = GL_FALSE;
+        glapi.glGetProgramiv(_gl_program_obj, GL_COMPLETION_STATUS_KHR, &completed);
+        if (GL_TRUE != completed) {
+            return false;
+        }
+    }
+    finish_link(device);
+
+    return true;
+}
+
+void
+program::complete_link()
+{
+    if (_link_pending) {
+        finish_link(parent_device());
+    }
+}
+
+void
+program::finish_link(render_device& in_device)
+{
+    assert(_link_pending);
+    _link_pending = false;
+
+    // compile errors of asynchronously compiled shaders
+    foreach(const shader_ptr& s, _shaders) {
+        if (!s->compile(in_device)) {
+            state().set(object_state::OS_ERROR_SHADER_COMPILE);
+            _info_log = s->info_log();
+            return;
+        }
+    }
+
+    query_link_status(in_device);
+
+    if (ok() && !_binary_cache_key.empty()) {
+        if (program_binary_cache_ptr cache = in_device.binary_cache()) {
+            store_binary(in_device, *cache, _binary_cache_key);
+        }
+    }
+    _binary_cache_key.clear();
+
+    retrieve_information(in_device);
+}
+
+bool
+program::query_link_status(render_device& ren_dev)
 {
     assert(_gl_program_obj != 0);
 
@@ -134,7 +245,6 @@ program::link(render_device& ren_dev)
 
     int link_state  = 0;
 
-    glapi.glLinkProgram(_gl_program_obj);
     glapi.glGetProgramiv(_gl_program_obj, GL_LINK_STATUS, &link_state);
 
     if (GL_TRUE != link_state) {
@@ -150,11 +260,134 @@ program::link(render_device& ren_dev)
         glapi.glGetProgramInfoLog(_gl_program_obj, info_len, NULL, &_info_log[0]);
     }
 
-    gl_assert(glapi, leaving program:link());
+    gl_assert(glapi, leaving program:query_link_status());
 
     return (GL_TRUE == link_state);
 }
 
+void
+program::retrieve_information(render_device& in_device)
+{
+    if (ok()) {
+        const opengl::gl_core& glapi = in_device.opengl_api();
+
+        util::program_binding_guard save_guard(glapi);
+        glapi.glUseProgram(_gl_program_obj);
+        retrieve_attribute_information(in_device);
+        retrieve_fragdata_information(in_device);
+        retrieve_uniform_information(in_device);
+    }
+}
+
+std::string
+program::binary_cache_key(const render_device&        in_device,
+                          const shader_list&          in_shaders,
+                          const stream_capture_array& in_capture,
+                          bool                        in_rasterization_discard,
+                          const named_location_list&  in_attribute_locations,
+                          const named_location_list&  in_fragment_locations) const
+{
+    const opengl::gl_core::context_info& ci = in_device.opengl_api().context_information();
+
+    const std::string driver_id = ci._vendor + "\n" + ci._renderer + "\n" + ci._version_info + "\n" + ci._glsl_version_info;
+
+    program_binary_cache::string_array inputs;
+    foreach(const shader_ptr& s, in_shaders) {
+        if (!s || s->_source.empty()) {
+            return std::string();
+        }
+        inputs.push_back(shader_stage_string(s->type()));
+        inputs.push_back(s->_source);
+    }
+
+    std::ostringstream link_setup;
+    link_setup << "discard " << in_rasterization_discard << "\n";
+    foreach(const named_location& l, in_attribute_locations) {
+        link_setup << "attribute " << l.first << " " << l.second << "\n";
+    }
+    foreach(const named_location& l, in_fragment_locations) {
+        link_setup << "fragdata " << l.first << " " << l.second << "\n";
+    }
+    link_setup << "capture " << in_capture.interleaved_streams() << "\n";
+    for (int stream = 0; stream < in_capture.used_streams(); ++stream) {
+        const stream_capture::captures_list& captures = in_capture.stream_captures(stream).captures();
+        link_setup << "stream " << stream << "\n";
+        foreach(const stream_capture::capture_element& c, captures) {
+            if (const std::string* n = boost::get<std::string>(&c)) {
+                link_setup << "varying " << *n << "\n";
+            }
+            else {
+                link_setup << "skip " << boost::get<stream_capture::skip_components_type>(c) << "\n";
+            }
+        }
+    }
+    inputs.push_back(link_setup.str());
+
+    return program_binary_cache::program_key(driver_id, inputs);
+}
+
+bool
+program::load_binary(render_device&          in_device,
+                     program_binary_cache&   in_cache,
+                     const std::string&      in_key)
+{
+    const opengl::gl_core& glapi = in_device.opengl_api();
+    util::gl_error          glerror(glapi);
+
+    program_binary_cache::program_binary b;
+    if (!in_cache.load(in_key, b)) {
+        return false;
+    }
+
+    glapi.glProgramBinary(_gl_program_obj, b._format, &b._data[0], static_cast<int>(b._data.size()));
+
+    int link_state = 0;
+    glapi.glGetProgramiv(_gl_program_obj, GL_LINK_STATUS, &link_state);
+
+    if (glerror || GL_TRUE != link_state) {
+        // binaries are rejected after driver updates, the program is linked from source
+        glout() << log::info << "program::load_binary(): "
+                << "program binary rejected by the driver, linking from source (key: " << in_key << ")." << log::end;
+        in_cache.remove(in_key);
+        return false;
+    }
+
+    gl_assert(glapi, leaving program::load_binary());
+
+    return true;
+}
+
+void
+program::store_binary(render_device&         in_device,
+                      program_binary_cache&  in_cache,
+                      const std::string&     in_key) const
+{
+    const opengl::gl_core& glapi = in_device.opengl_api();
+    util::gl_error          glerror(glapi);
+
+    int binary_length = 0;
+    glapi.glGetProgramiv(_gl_program_obj, GL_PROGRAM_BINARY_LENGTH, &binary_length);
+    if (binary_length <= 0) {
+        return;
+    }
+
+    program_binary_cache::program_binary b;
+    GLenum                               binary_format = 0;
+    b._data.resize(binary_length);
+
+    glapi.glGetProgramBinary(_gl_program_obj, binary_length, 0, &binary_format, &b._data[0]);
+    if (glerror) {
+        glerr() << log::warning << "program::store_binary(): "
+                << "unable to retrieve program binary (" << glerror.error_string() << ")." << log::end;
+        return;
+    }
+    b._format = binary_format;
+
+    in_cache.store(in_key, b);
+
+    gl_assert(glapi, leaving program::store_binary());
+}
+
 bool
 program::validate(render_context& ren_ctx)
 {
@@ -166,6 +399,7 @@ program::bind(render_context& ren_ctx) const
 {
     assert(_gl_program_obj != 0);
     assert(state().ok());
+    assert(!_link_pending);
 
     const opengl::gl_core& glapi = ren_ctx.opengl_api();
 
@@ -184,50 +418,32 @@ program::bind_uniforms(render_context& ren_ctx) const
     const opengl::gl_core& glapi = ren_ctx.opengl_api();
 
     { // uniforms
-        name_uniform_map::const_iterator u = _uniforms.begin();
-        name_uniform_map::const_iterator e = _uniforms.end();
-        for (; u != e; ++u) {
-            //std::cout << u->first << std::endl;
-            if (u->second->update_required()) {
-                u->second->apply_value(ren_ctx, *this);
-                u->second->_status._update_required = false;
-            }
-            //if (u->second._update_required) {
-                //std::cout << u->second._name << std::endl;
-//#if SCM_GL_CORE_USE_DIRECT_STATE_ACCESS
-//                boost::apply_visitor(detail::uniform_bind_dsa(glapi, _gl_program_obj, u->second), u->second._data);
-//#else
-//                boost::apply_visitor(detail::uniform_bind(glapi, u->second), u->second._data);
-//#endif // SCM_GL_CORE_USE_DIRECT_STATE_ACCESS
-            //    gl_assert(glapi, program::bind_uniforms() after apply uniform);
-
-            //    u->second._update_required = false;
-            //}
+        for (scm::size_t i = 0; i < _dirty_uniforms.size(); ++i) {
+            uniform_base* u = _dirty_uniforms[i];
+            u->apply_value(ren_ctx, *this);
+            u->_status._update_required = false;
         }
+        _dirty_uniforms.clear();
     }
     { // uniform buffers
-        name_uniform_block_map::const_iterator b = _uniform_blocks.begin();
-        name_uniform_block_map::const_iterator e = _uniform_blocks.end();
-        for (; b != e; ++b) {
-            if (b->second._update_required) {
-                glapi.glUniformBlockBinding(_gl_program_obj, b->second._block_index, b->second._binding);
-                b->second._update_required = false;
-
-                gl_assert(glapi, program::bind_uniforms() after glUniformBlockBinding());
-            }
+        for (scm::size_t i = 0; i < _dirty_uniform_blocks.size(); ++i) {
+            const uniform_block_type& b = *_dirty_uniform_blocks[i];
+            glapi.glUniformBlockBinding(_gl_program_obj, b._block_index, b._binding);
+            b._update_required = false;
+
+            gl_assert(glapi, program::bind_uniforms() after glUniformBlockBinding());
         }
+        _dirty_uniform_blocks.clear();
     }
     { // storage buffers
-        name_storage_buffer_map::const_iterator b = _storage_buffers.begin();
-        name_storage_buffer_map::const_iterator e = _storage_buffers.end();
-        for (; b != e; ++b) {
-            if (b->second._update_required) {
-                glapi.glShaderStorageBlockBinding(_gl_program_obj, b->second._index, b->second._binding);
-                b->second._update_required = false;
-
-                gl_assert(glapi, program::bind_uniforms() after glShaderStorageBlockBinding());
-            }
+        for (scm::size_t i = 0; i < _dirty_storage_buffers.size(); ++i) {
+            const storage_buffer_type& b = *_dirty_storage_buffers[i];
+            glapi.glShaderStorageBlockBinding(_gl_program_obj, b._index, b._binding);
+            b._update_required = false;
+
+            gl_assert(glapi, program::bind_uniforms() after glShaderStorageBlockBinding());
         }
+        _dirty_storage_buffers.clear();
     }
     { // subroutines
         for (int s = 0; s < SHADER_STAGE_COUNT; ++s) {
@@ -567,7 +783,10 @@ program::retrieve_uniform_information(render_device& in_device)
                 }
 
                 if (current_uniform) {
-                    _uniforms[actual_uniform_name] = current_uniform;
+                    current_uniform->_dirty_list = &_dirty_uniforms;
+                    if (_uniforms.insert(name_uniform_map::value_type(actual_uniform_name, current_uniform)).second) {
+                        _uniform_slots.push_back(current_uniform.get());
+                    }
                 }
             }
         }
@@ -753,7 +972,10 @@ program::uniform_buffer(const std::string& name, const unsigned binding)
     if (u != _uniform_blocks.end()) {
         if (u->second._binding != binding) {
             u->second._binding = binding;
-            u->second._update_required = true;
+            if (!u->second._update_required) {
+                u->second._update_required = true;
+                _dirty_uniform_blocks.push_back(&u->second);
+            }
         }
     }
     else {
@@ -790,7 +1012,10 @@ program::storage_buffer(const std::string& name, const unsigned binding)
     if (u != _storage_buffers.end()) {
         if (u->second._binding != binding) {
             u->second._binding = binding;
-            u->second._update_required = true;
+            if (!u->second._update_required) {
+                u->second._update_required = true;
+                _dirty_storage_buffers.push_back(&u->second);
+            }
 
             if (u->second._binding != u->second._static_binding) {
                 SCM_GL_DGB("program::storage_buffer(): overriding shader defined binding on storage buffer ('" << name << "').");
@@ -88,6 +88,10 @@ public:
     typedef boost::unordered_map<std::string, subroutine_type>          name_subroutine_map;
     typedef boost::unordered_map<std::string, storage_buffer_type>      name_storage_buffer_map;
 
+    typedef std::vector<uniform_base*>                                  uniform_dirty_list;
+    typedef std::vector<const uniform_block_type*>                      uniform_block_dirty_list;
+    typedef std::vector<const storage_buffer_type*>                     storage_buffer_dirty_list;
+
 public:
     virtual ~program();
 
@@ -99,6 +103,10 @@ public:
 
     uniform_ptr                 uniform_raw(const std::string& name) const;
 
+    template<typename T> scm::gl::uniform_handle<T> uniform_handle(const std::string& name) const;
+    template<typename T> void   uniform(const scm::gl::uniform_handle<T>& h, const T& v) const;
+    template<typename T> void   uniform(const scm::gl::uniform_handle<T>& h, int i, const T& v) const;
+
     uniform_sampler_ptr         uniform_sampler(const std::string& name) const;
     uniform_image_ptr           uniform_image(const std::string& name) const;
 
@@ -145,15 +153,24 @@ public:
 
     bool                        rasterization_discard() const;
 
+    // programs created through render_device::create_program_async are linked by the driver
+    // in the background, uniforms and attributes are available and the program can be bound
+    // once link_completed() returned true, check fail() afterwards
+    bool                        link_pending() const;
+    bool                        link_completed();   // does not block with GL_KHR_parallel_shader_compile
+    void                        complete_link();    // blocks until the link finished
+
 protected:
     program(render_device&              in_device,
             const shader_list&          in_shaders,
             const stream_capture_array& in_capture,
             bool                        in_rasterization_discard = false,
             const named_location_list&  in_attribute_locations = named_location_list(),
-            const named_location_list&  in_fragment_locations  = named_location_list());
+            const named_location_list&  in_fragment_locations  = named_location_list(),
+            bool                        in_async_link          = false);
 
-    bool                        link(render_device& ren_dev);
+    void                        finish_link(render_device& in_device);
+    bool                        query_link_status(render_device& ren_dev);
     bool                        validate(render_context& ren_ctx);
     
     void                        bind(render_context& ren_ctx) const;
@@ -161,6 +178,21 @@ protected:
 
     bool                        apply_transform_feedback_varyings(render_device& in_device, const stream_capture_array& in_capture); 
 
+    // empty if the program can not be cached
+    std::string                 binary_cache_key(const render_device&        in_device,
+                                                 const shader_list&          in_shaders,
+                                                 const stream_capture_array& in_capture,
+                                                 bool                        in_rasterization_discard,
+                                                 const named_location_list&  in_attribute_locations,
+                                                 const named_location_list&  in_fragment_locations) const;
+    bool                        load_binary(render_device&          in_device,
+                                            program_binary_cache&   in_cache,
+                                            const std::string&      in_key);
+    void                        store_binary(render_device&         in_device,
+                                             program_binary_cache&  in_cache,
+                                             const std::string&     in_key) const;
+
+    void                        retrieve_information(render_device& in_device);
     void                        retrieve_attribute_information(render_device& in_device);
     void                        retrieve_fragdata_information(render_device& in_device);
     void                        retrieve_uniform_information(render_device& in_device);
@@ -169,8 +201,11 @@ protected:
     shader_list                 _shaders;
 
     bool                        _rasterization_discard;
+    bool                        _link_pending;
+    std::string                 _binary_cache_key;  // store the binary when the pending link finished
 
     name_uniform_map            _uniforms;
+    std::vector<uniform_base*>  _uniform_slots;     // indexed by uniform handles
     name_uniform_block_map      _uniform_blocks;
     name_variable_map           _attributes;
     name_location_map           _samplers;
@@ -178,7 +213,13 @@ protected:
     name_subroutine_map         _subroutines[SHADER_STAGE_COUNT];
     name_storage_buffer_map     _storage_buffers;
 
+    // entries changed since the last bind_uniforms, only these are applied
+    mutable uniform_dirty_list          _dirty_uniforms;
+    mutable uniform_block_dirty_list    _dirty_uniform_blocks;
+    mutable storage_buffer_dirty_list   _dirty_storage_buffers;
+
     unsigned                    _gl_program_obj;
+    scm::uint64                 _serial;            // identifies the program in uniform handles
     std::string                 _info_log;
 
     friend class scm::gl::render_device;
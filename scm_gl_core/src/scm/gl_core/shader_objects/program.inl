@@ -2,6 +2,9 @@
 // Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
 // Distributed under the Modified BSD License, see license.txt.
 
+#include <algorithm>
+#include <cassert>
+
 #include <scm/gl_core/log.h>
 
 #include <boost/mpl/find.hpp>
@@ -42,6 +45,52 @@ program::uniform(const std::string& name, int i, const T& v) const {
     }
 }
 
+template<typename T>
+inline
+scm::gl::uniform_handle<T>
+program::uniform_handle(const std::string& name) const {
+    typedef typename scm::gl::uniform_type<T>::type cur_uniform_type;
+
+    scm::gl::uniform_handle<T> h;
+    const uniform_ptr u = uniform_raw(name);
+    if (u) {
+        if (dynamic_cast<cur_uniform_type*>(u.get())) {
+            const std::vector<uniform_base*>::const_iterator s = std::find(_uniform_slots.begin(), _uniform_slots.end(), u.get());
+            h._program_serial = _serial;
+            h._slot           = static_cast<unsigned>(s - _uniform_slots.begin());
+            h._type           = u->type();
+        }
+        else {
+            SCM_GL_DGB("program::uniform_handle(): found non matching uniform type '" << type_string(uniform_data_type<T>::type)
+                                                                                     << "' ('uniform: " << name << ", " << type_string(u->type()) << ").");
+        }
+    }
+    else {
+        SCM_GL_DGB("program::uniform_handle(): unable to find uniform ('" << name << "').");
+    }
+    return h;
+}
+
+template<typename T>
+inline
+void
+program::uniform(const scm::gl::uniform_handle<T>& h, const T& v) const {
+    uniform(h, 0, v);
+}
+
+template<typename T>
+inline
+void
+program::uniform(const scm::gl::uniform_handle<T>& h, int i, const T& v) const {
+    typedef typename scm::gl::uniform_type<T>::type cur_uniform_type;
+
+    if (   h._program_serial == _serial
+        && h._slot           <  _uniform_slots.size()
+        && h._type           == _uniform_slots[h._slot]->type()) {
+        static_cast<cur_uniform_type*>(_uniform_slots[h._slot])->set_value(i, v);
+    }
+}
+
 inline uniform_sampler_ptr
 program::uniform_sampler(const std::string& name) const {
     return (dynamic_pointer_cast<scm::gl::uniform_sampler>(uniform_raw(name)));
@@ -0,0 +1,360 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include "program_binary_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+#include <boost/filesystem.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <scm/core/utilities/foreach.h>
+
+#include <scm/gl_core/log.h>
+
+namespace  {
+
+const char          file_magic[8]      = { 'S', 'C', 'M', 'P', 'B', 'I', 'N', '\0' };
+const scm::uint32   file_version       = 1;
+const char*         file_extension     = ".scmpb";
+
+struct file_header {
+    char            _magic[8];
+    scm::uint32     _version;
+    scm::uint32     _format;
+    scm::uint64     _size;
+    scm::uint64     _checksum;
+}; // struct file_header
+
+// FNV-1a
+scm::uint64
+fnv_hash(const void* in_data, scm::size_t in_size, scm::uint64 in_hash = 0xcbf29ce484222325ull)
+{
+    const scm::uint8* d = static_cast<const scm::uint8*>(in_data);
+    for (scm::size_t i = 0; i < in_size; ++i) {
+        in_hash ^= d[i];
+        in_hash *= 0x100000001b3ull;
+    }
+    return in_hash;
+}
+
+// djb2, combined with FNV-1a into the 128 bit program key
+scm::uint64
+djb_hash(const void* in_data, scm::size_t in_size, scm::uint64 in_hash = 5381)
+{
+    const scm::uint8* d = static_cast<const scm::uint8*>(in_data);
+    for (scm::size_t i = 0; i < in_size; ++i) {
+        in_hash = (in_hash * 33) ^ d[i];
+    }
+    return in_hash;
+}
+
+} // namespace
+
+namespace scm {
+namespace gl {
+
+struct program_binary_cache::mutex_impl
+{
+    boost::mutex    _mutex;
+};
+
+program_binary_cache::program_binary::program_binary()
+  : _format(0)
+{
+}
+
+program_binary_cache::program_binary_cache(const std::string& in_directory,
+                                           scm::size_t        in_max_size)
+  : _mutex_impl(new mutex_impl)
+  , _directory(in_directory)
+  , _max_size(in_max_size)
+  , _cache_size(0)
+  , _hits(0)
+  , _misses(0)
+{
+    namespace bfs = boost::filesystem;
+
+    boost::system::error_code ec;
+    if (!bfs::is_directory(_directory, ec)) {
+        bfs::create_directories(_directory, ec);
+        if (ec || !bfs::is_directory(_directory, ec)) {
+            throw std::runtime_error("program_binary_cache::program_binary_cache(): unable to create cache directory " + _directory + ".");
+        }
+    }
+
+    _cache_size = scan_size_locked();
+}
+
+program_binary_cache::~program_binary_cache()
+{
+}
+
+std::string
+program_binary_cache::program_key(const std::string&  in_driver_id,
+                                  const string_array& in_program_inputs)
+{
+    // every part is prefixed with its size, moving characters between parts changes the key
+    scm::uint64 h0 = 0xcbf29ce484222325ull;
+    scm::uint64 h1 = 5381;
+
+    const scm::uint64 driver_size = in_driver_id.size();
+    h0 = fnv_hash(&driver_size, sizeof(driver_size), h0);
+    h1 = djb_hash(&driver_size, sizeof(driver_size), h1);
+    h0 = fnv_hash(in_driver_id.data(), in_driver_id.size(), h0);
+    h1 = djb_hash(in_driver_id.data(), in_driver_id.size(), h1);
+
+    foreach(const std::string& i, in_program_inputs) {
+        const scm::uint64 input_size = i.size();
+        h0 = fnv_hash(&input_size, sizeof(input_size), h0);
+        h1 = djb_hash(&input_size, sizeof(input_size), h1);
+        h0 = fnv_hash(i.data(), i.size(), h0);
+        h1 = djb_hash(i.data(), i.size(), h1);
+    }
+
+    std::ostringstream key;
+    key << std::hex << std::setfill('0') << std::setw(16) << h0 << std::setw(16) << h1;
+
+    return key.str();
+}
+
+bool
+program_binary_cache::load(const std::string& in_key,
+                           program_binary&    out_binary)
+{
+    namespace bfs = boost::filesystem;
+
+    boost::mutex::scoped_lock lock(_mutex_impl->_mutex);
+
+    const std::string   fname = file_name(in_key);
+    std::ifstream       file(fname.c_str(), std::ios::in | std::ios::binary);
+
+    if (!file) {
+        ++_misses;
+        return false;
+    }
+
+    file_header h;
+    bool        valid = false;
+
+    if (   file.read(reinterpret_cast<char*>(&h), sizeof(file_header))
+        && 0 == std::memcmp(h._magic, file_magic, sizeof(file_magic))
+        && h._version == file_version
+        && h._size    >  0
+        && h._size    <= _max_size) {
+        out_binary._format = h._format;
+        out_binary._data.resize(static_cast<scm::size_t>(h._size));
+        valid =    file.read(reinterpret_cast<char*>(&out_binary._data[0]), static_cast<std::streamsize>(h._size))
+                && fnv_hash(&out_binary._data[0], out_binary._data.size()) == h._checksum;
+    }
+    file.close();
+
+    boost::system::error_code ec;
+    if (!valid) {
+        glout() << log::warning << "program_binary_cache::load(): "
+                << "removing invalid cache file " << fname << "." << log::end;
+        const scm::size_t fsize = static_cast<scm::size_t>(bfs::file_size(fname, ec));
+        if (!ec && bfs::remove(fname, ec)) {
+            _cache_size -= (std::min)(_cache_size, fsize);
+        }
+        out_binary._format = 0;
+        out_binary._data.clear();
+        ++_misses;
+        return false;
+    }
+
+    // the modification time orders the files for trim
+    bfs::last_write_time(fname, std::time(0), ec);
+    ++_hits;
+
+    return true;
+}
+
+bool
+program_binary_cache::store(const std::string&    in_key,
+                            const program_binary& in_binary)
+{
+    namespace bfs = boost::filesystem;
+
+    if (in_binary._data.empty() || in_binary._data.size() > _max_size) {
+        return false;
+    }
+
+    boost::mutex::scoped_lock lock(_mutex_impl->_mutex);
+
+    const std::string fname = file_name(in_key);
+    const std::string tname = fname + ".tmp";
+
+    file_header h;
+    std::memcpy(h._magic, file_magic, sizeof(file_magic));
+    h._version  = file_version;
+    h._format   = in_binary._format;
+    h._size     = in_binary._data.size();
+    h._checksum = fnv_hash(&in_binary._data[0], in_binary._data.size());
+
+    {
+        std::ofstream file(tname.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+        if (   !file
+            || !file.write(reinterpret_cast<const char*>(&h), sizeof(file_header))
+            || !file.write(reinterpret_cast<const char*>(&in_binary._data[0]), static_cast<std::streamsize>(in_binary._data.size()))) {
+            glerr() << log::error << "program_binary_cache::store(): "
+                    << "unable to write cache file " << tname << "." << log::end;
+            file.close();
+            boost::system::error_code ec;
+            bfs::remove(tname, ec);
+            return false;
+        }
+    }
+
+    boost::system::error_code ec;
+    const scm::size_t         replaced_size = static_cast<scm::size_t>(bfs::file_size(fname, ec));
+    const bool                replaced      = !ec;
+
+    bfs::rename(tname, fname, ec);
+    if (ec) {
+        glerr() << log::error << "program_binary_cache::store(): "
+                << "unable to replace cache file " << fname << " (" << ec.message() << ")." << log::end;
+        bfs::remove(tname, ec);
+        return false;
+    }
+
+    if (replaced) {
+        _cache_size -= (std::min)(_cache_size, replaced_size);
+    }
+    _cache_size += sizeof(file_header) + in_binary._data.size();
+    if (_cache_size > _max_size) {
+        trim_locked(_max_size);
+    }
+
+    return true;
+}
+
+bool
+program_binary_cache::remove(const std::string& in_key)
+{
+    boost::mutex::scoped_lock lock(_mutex_impl->_mutex);
+
+    namespace bfs = boost::filesystem;
+
+    const std::string fname = file_name(in_key);
+
+    boost::system::error_code ec;
+    const scm::size_t fsize = static_cast<scm::size_t>(bfs::file_size(fname, ec));
+    if (ec || !bfs::remove(fname, ec)) {
+        return false;
+    }
+    _cache_size -= (std::min)(_cache_size, fsize);
+
+    return true;
+}
+
+void
+program_binary_cache::clear()
+{
+    trim(0);
+}
+
+void
+program_binary_cache::trim(scm::size_t in_max_size)
+{
+    boost::mutex::scoped_lock lock(_mutex_impl->_mutex);
+
+    trim_locked(in_max_size);
+}
+
+const std::string&
+program_binary_cache::directory() const
+{
+    return _directory;
+}
+
+scm::size_t
+program_binary_cache::max_size() const
+{
+    return _max_size;
+}
+
+scm::size_t
+program_binary_cache::size_on_disk() const
+{
+    boost::mutex::scoped_lock lock(_mutex_impl->_mutex);
+
+    return scan_size_locked();
+}
+
+scm::size_t
+program_binary_cache::hits() const
+{
+    return _hits;
+}
+
+scm::size_t
+program_binary_cache::misses() const
+{
+    return _misses;
+}
+
+std::string
+program_binary_cache::file_name(const std::string& in_key) const
+{
+    return (boost::filesystem::path(_directory) / (in_key + file_extension)).string();
+}
+
+scm::size_t
+program_binary_cache::scan_size_locked() const
+{
+    namespace bfs = boost::filesystem;
+
+    boost::system::error_code ec;
+    scm::size_t               size = 0;
+    for (bfs::directory_iterator f(_directory, ec), e; !ec && f != e; f.increment(ec)) {
+        if (f->path().extension() == file_extension) {
+            size += static_cast<scm::size_t>(bfs::file_size(f->path(), ec));
+        }
+    }
+
+    return size;
+}
+
+void
+program_binary_cache::trim_locked(scm::size_t in_max_size)
+{
+    namespace bfs = boost::filesystem;
+
+    typedef std::pair<std::time_t, std::pair<scm::size_t, bfs::path> > file_entry;
+
+    boost::system::error_code ec;
+    std::vector<file_entry>   files;
+    scm::size_t               size = 0;
+
+    for (bfs::directory_iterator f(_directory, ec), e; !ec && f != e; f.increment(ec)) {
+        if (f->path().extension() == file_extension) {
+            const scm::size_t s = static_cast<scm::size_t>(bfs::file_size(f->path(), ec));
+            files.push_back(file_entry(bfs::last_write_time(f->path(), ec), std::make_pair(s, f->path())));
+            size += s;
+        }
+    }
+    if (size > in_max_size) {
+        // oldest first
+        std::sort(files.begin(), files.end());
+        for (scm::size_t i = 0; i < files.size() && size > in_max_size; ++i) {
+            if (bfs::remove(files[i].second.second, ec)) {
+                size -= files[i].second.first;
+            }
+        }
+    }
+
+    // the scan also picks up changes made by other processes sharing the directory
+    _cache_size = size;
+}
+
+} // namespace gl
+} // namespace scm
@@ -0,0 +1,93 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_GL_CORE_PROGRAM_BINARY_CACHE_H_INCLUDED
+#define SCM_GL_CORE_PROGRAM_BINARY_CACHE_H_INCLUDED
+
+#include <string>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <scm/core/numeric_types.h>
+#include <scm/core/memory.h>
+
+#include <scm/gl_core/shader_objects/shader_objects_fwd.h>
+
+#include <scm/core/platform/platform.h>
+#include <scm/core/utilities/platform_warning_disable.h>
+
+namespace scm {
+namespace gl {
+
+// on-disk cache of linked program binaries, does not touch the GL
+//  - one file per program named by the program key, the key hashes the driver id and
+//    all program inputs so binaries of other drivers or sources are never looked up
+//  - file layout: magic "SCMPBIN", file version, binary format, binary size and a
+//    checksum of the binary followed by the binary, files failing the checks are deleted
+//  - stores replace the file atomically through a rename, the least recently used
+//    files are deleted once the cache exceeds its size limit, the cache size is kept
+//    as a running total so only then the directory is scanned
+class __scm_export(gl_core) program_binary_cache : boost::noncopyable
+{
+public:
+    typedef std::vector<std::string>    string_array;
+
+    struct program_binary {
+        program_binary();
+
+        unsigned                    _format;
+        std::vector<scm::uint8>     _data;
+    }; // struct program_binary
+
+public:
+    // creates the directory if necessary, throws if this is not possible
+    program_binary_cache(const std::string& in_directory,
+                         scm::size_t        in_max_size = 256 * 1024 * 1024);
+    virtual ~program_binary_cache();
+
+    // in_driver_id identifies the GL implementation (vendor, renderer, version), the
+    // program inputs are the stage and preprocessed source of every shader and the link
+    // setup (e.g. transform feedback varyings)
+    static std::string      program_key(const std::string&  in_driver_id,
+                                        const string_array& in_program_inputs);
+
+    bool                    load(const std::string& in_key,
+                                 program_binary&    out_binary);
+    bool                    store(const std::string&    in_key,
+                                  const program_binary& in_binary);
+    bool                    remove(const std::string& in_key);
+    void                    clear();
+    // deletes the least recently used binaries until the cache is below in_max_size bytes
+    void                    trim(scm::size_t in_max_size);
+
+    const std::string&      directory() const;
+    scm::size_t             max_size() const;
+    scm::size_t             size_on_disk() const;
+    scm::size_t             hits() const;
+    scm::size_t             misses() const;
+
+protected:
+    std::string             file_name(const std::string& in_key) const;
+    scm::size_t             scan_size_locked() const;
+    void                    trim_locked(scm::size_t in_max_size);
+
+protected:
+    struct mutex_impl;
+    shared_ptr<mutex_impl>  _mutex_impl;
+
+    std::string             _directory;
+    scm::size_t             _max_size;
+    scm::size_t             _cache_size;        // running total of the cache files
+    scm::size_t             _hits;
+    scm::size_t             _misses;
+
+}; // class program_binary_cache
+
+} // namespace gl
+} // namespace scm
+
+#include <scm/core/utilities/platform_warning_enable.h>
+
+#endif // SCM_GL_CORE_PROGRAM_BINARY_CACHE_H_INCLUDED
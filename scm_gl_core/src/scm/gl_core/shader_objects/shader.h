@@ -36,22 +36,29 @@ protected:
            const std::string&              in_src,
            const std::string&              in_src_name,
            const shader_macro_array&       in_macros,
-           const shader_include_path_list& in_inc_paths);
+           const shader_include_path_list& in_inc_paths,
+           bool                            in_async_compile = false);
 
-    bool   preprocess_source_string(      render_device&      ren_dev,
-                                    const std::string&        in_src,
-                                    const std::string&        in_src_name,
-                                    const shader_macro_array& in_macros,
-                                          std::string&        out_string);
-    bool   compile_source_string(      render_device&            ren_dev,
-                                 const std::string&              in_src,
-                                 const shader_include_path_list& in_inc_paths);
+    void   submit_source_string(      render_device&            ren_dev,
+                                const std::string&              in_src,
+                                const shader_include_path_list& in_inc_paths);
+    bool   query_compile_status(render_device& ren_dev);
 
+    // issues the compilation without waiting for the driver
+    void   submit_compile(render_device& ren_dev);
+    // compiles a shader deferred for the program binary cache or waits for a submitted
+    // compilation, no-op once the compile status is known
+    bool   compile(render_device& ren_dev);
 
 protected:
-    shader_stage    _type;
-    unsigned        _gl_shader_obj;
-    std::string     _info_log;
+    shader_stage                _type;
+    unsigned                    _gl_shader_obj;
+    std::string                 _info_log;
+
+    std::string                 _source;        // preprocessed, part of the program binary key
+    shader_include_path_list    _include_paths;
+    bool                        _compile_submitted;
+    bool                        _compiled;      // compile status queried
 
     friend class scm::gl::program;
     friend class scm::gl::render_device;
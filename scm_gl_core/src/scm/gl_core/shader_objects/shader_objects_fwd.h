@@ -16,9 +16,12 @@ namespace gl {
 class shader;
 class program;
 class uniform_base;
+template<typename T> class uniform_handle;
 
 class shader_macro;
 class shader_macro_array;
+class shader_preprocessor;
+class program_binary_cache;
 
 class stream_capture;
 class stream_capture_array;
@@ -34,6 +37,9 @@ typedef shared_ptr<const program>       program_cptr;
 typedef weak_ptr<program>               program_wtr;
 typedef weak_ptr<const program>         program_cwtr;
 
+typedef shared_ptr<shader_preprocessor> shader_preprocessor_ptr;
+typedef shared_ptr<program_binary_cache> program_binary_cache_ptr;
+
 typedef shared_ptr<uniform_base>        uniform_ptr;
 typedef shared_ptr<const uniform_base>  uniform_cptr;
 
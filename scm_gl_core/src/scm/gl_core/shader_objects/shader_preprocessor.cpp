@@ -0,0 +1,492 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include "shader_preprocessor.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include <boost/thread/mutex.hpp>
+
+#include <scm/core/utilities/foreach.h>
+
+#include <scm/gl_core/log.h>
+
+namespace  {
+
+const unsigned max_include_depth = 32;
+
+// counts and string sizes precede the data, no two input sets share a key
+void
+append_key_size(std::string& io_key, scm::uint64 in_size)
+{
+    io_key.append(reinterpret_cast<const char*>(&in_size), sizeof(in_size));
+}
+
+void
+append_key_field(std::string& io_key, const std::string& in_field)
+{
+    append_key_size(io_key, in_field.size());
+    io_key.append(in_field);
+}
+
+// strips the comments from a line, io_comment carries an open multi line comment to
+// the following lines, returns the code with leading white space removed
+void
+line_code(const std::string& in_line, bool& io_comment, std::string& out_code)
+{
+    out_code.clear();
+
+    const std::string::size_type n = in_line.size();
+    std::string::size_type       i = 0;
+
+    while (i < n) {
+        if (io_comment) {
+            const std::string::size_type e = in_line.find("*/", i);
+            if (e == std::string::npos) {
+                break;
+            }
+            io_comment = false;
+            i          = e + 2;
+        }
+        else if (in_line[i] == '/' && i + 1 < n && in_line[i + 1] == '/') {
+            break;
+        }
+        else if (in_line[i] == '/' && i + 1 < n && in_line[i + 1] == '*') {
+            io_comment = true;
+            i         += 2;
+            out_code.push_back(' ');
+        }
+        else {
+            if (!out_code.empty() || (in_line[i] != ' ' && in_line[i] != '\t' && in_line[i] != '\r')) {
+                out_code.push_back(in_line[i]);
+            }
+            ++i;
+        }
+    }
+}
+
+// matches '#' white space* directive and returns the position behind the directive name
+bool
+match_directive(const std::string& in_code, const char* in_directive, std::string::size_type& out_end)
+{
+    if (in_code.empty() || in_code[0] != '#') {
+        return false;
+    }
+    std::string::size_type p = in_code.find_first_not_of(" \t", 1);
+    if (p == std::string::npos) {
+        return false;
+    }
+    const std::string::size_type l = std::char_traits<char>::length(in_directive);
+    if (in_code.compare(p, l, in_directive) != 0) {
+        return false;
+    }
+    out_end = p + l;
+    return out_end == in_code.size() || in_code[out_end] == ' ' || in_code[out_end] == '\t'
+                                     || in_code[out_end] == '"' || in_code[out_end] == '<';
+}
+
+std::string
+parent_path(const std::string& in_path)
+{
+    const std::string::size_type e = in_path.find_last_of('/');
+    return (e == std::string::npos) ? std::string() : in_path.substr(0, e + 1);
+}
+
+} // namespace
+
+namespace scm {
+namespace gl {
+
+struct shader_preprocessor::mutex_impl
+{
+    boost::mutex    _mutex;
+};
+
+struct shader_preprocessor::expand_state
+{
+    expand_state(const shader_macro_array& m, const shader_include_path_list& p)
+      : _macros(m), _inc_paths(p), _include_count(0), _unresolved(false) {}
+
+    const shader_macro_array&       _macros;
+    const shader_include_path_list& _inc_paths;
+
+    std::ostringstream              _output;
+    std::string                     _info_log;
+    string_array                    _include_stack;
+    std::set<std::string>           _includes;
+    unsigned                        _include_count;
+    bool                            _unresolved;
+}; // struct shader_preprocessor::expand_state
+
+shader_preprocessor::shader_preprocessor(bool in_named_line_directives)
+  : _mutex_impl(new mutex_impl)
+  , _named_line_directives(in_named_line_directives)
+  , _cache_hits(0)
+  , _cache_misses(0)
+{
+}
+
+shader_preprocessor::~shader_preprocessor()
+{
+    _cache.clear();
+    _dependents.clear();
+    _includes.clear();
+}
+
+bool
+shader_preprocessor::add_include_string(const std::string& in_path,
+                                        const std::string& in_source_string)
+{
+    if (in_path.empty() || in_path[0] != '/') {
+        glerr() << log::error << "shader_preprocessor::add_include_string(): "
+                << "<error> path not starting with '/' (" << in_path << ")." << log::end;
+        return false;
+    }
+
+    boost::mutex::scoped_lock lock(_mutex_impl->_mutex);
+
+    include_map::iterator i = _includes.find(in_path);
+    if (i == _includes.end()) {
+        _includes.insert(include_map::value_type(in_path, in_source_string));
+        drop_unresolved_entries();
+    }
+    else if (i->second != in_source_string) {
+        i->second = in_source_string;
+        drop_dependent_entries(in_path);
+    }
+
+    return true;
+}
+
+bool
+shader_preprocessor::remove_include_string(const std::string& in_path)
+{
+    boost::mutex::scoped_lock lock(_mutex_impl->_mutex);
+
+    if (0 == _includes.erase(in_path)) {
+        return false;
+    }
+    drop_dependent_entries(in_path);
+
+    return true;
+}
+
+bool
+shader_preprocessor::has_include_string(const std::string& in_path) const
+{
+    boost::mutex::scoped_lock lock(_mutex_impl->_mutex);
+
+    return _includes.find(in_path) != _includes.end();
+}
+
+bool
+shader_preprocessor::preprocess(const std::string&              in_source,
+                                const std::string&              in_source_name,
+                                const shader_macro_array&       in_macros,
+                                const shader_include_path_list& in_inc_paths,
+                                      std::string&              out_source,
+                                      std::string&              out_info_log)
+{
+    // the key holds all inputs, the unordered_map looks it up by its content hash
+    std::string key;
+    {
+        const scm::size_t size_bytes = sizeof(scm::uint64);
+
+        scm::size_t key_size = in_source.size() + in_source_name.size() + 4 * size_bytes;
+        foreach(const shader_macro& m, in_macros.macros()) {
+            key_size += m._name.size() + m._value.size() + 2 * size_bytes;
+        }
+        foreach(const std::string& p, in_inc_paths) {
+            key_size += p.size() + size_bytes;
+        }
+        key.reserve(key_size);
+        append_key_field(key, in_source);
+        append_key_field(key, in_source_name);
+        append_key_size(key, in_macros.macros().size());
+        foreach(const shader_macro& m, in_macros.macros()) {
+            append_key_field(key, m._name);
+            append_key_field(key, m._value);
+        }
+        append_key_size(key, in_inc_paths.size());
+        foreach(const std::string& p, in_inc_paths) {
+            append_key_field(key, p);
+        }
+    }
+
+    boost::mutex::scoped_lock lock(_mutex_impl->_mutex);
+
+    cache_map::const_iterator c = _cache.find(key);
+    if (c != _cache.end()) {
+        ++_cache_hits;
+        out_source   = c->second._output;
+        out_info_log = c->second._info_log;
+        return c->second._success;
+    }
+    ++_cache_misses;
+
+    const std::string line_name = (in_source_name.empty() || !_named_line_directives) ? std::string("0")
+                                                                                      : "\"" + in_source_name + "\"";
+    expand_state state(in_macros, in_inc_paths);
+
+    cache_entry e;
+    e._source_name = in_source_name;
+    e._success     = expand(in_source, in_source_name.empty() ? std::string("0") : in_source_name, line_name, true, state);
+    e._output      = e._success ? state._output.str() : std::string();
+    e._info_log    = state._info_log;
+    e._includes.assign(state._includes.begin(), state._includes.end());
+    e._unresolved  = state._unresolved;
+
+    foreach(const std::string& i, e._includes) {
+        _dependents[i].insert(key);
+    }
+
+    out_source   = e._output;
+    out_info_log = e._info_log;
+    _cache.insert(cache_map::value_type(key, e));
+
+    return e._success;
+}
+
+void
+shader_preprocessor::dependent_sources(const std::string& in_path,
+                                             string_array& out_source_names) const
+{
+    boost::mutex::scoped_lock lock(_mutex_impl->_mutex);
+
+    out_source_names.clear();
+
+    dependency_map::const_iterator d = _dependents.find(in_path);
+    if (d != _dependents.end()) {
+        foreach(const std::string& k, d->second) {
+            cache_map::const_iterator c = _cache.find(k);
+            if (c != _cache.end()) {
+                out_source_names.push_back(c->second._source_name);
+            }
+        }
+    }
+}
+
+void
+shader_preprocessor::clear_cache()
+{
+    boost::mutex::scoped_lock lock(_mutex_impl->_mutex);
+
+    _cache.clear();
+    _dependents.clear();
+}
+
+scm::size_t
+shader_preprocessor::cache_size() const
+{
+    boost::mutex::scoped_lock lock(_mutex_impl->_mutex);
+
+    return _cache.size();
+}
+
+scm::size_t
+shader_preprocessor::cache_hits() const
+{
+    boost::mutex::scoped_lock lock(_mutex_impl->_mutex);
+
+    return _cache_hits;
+}
+
+scm::size_t
+shader_preprocessor::cache_misses() const
+{
+    boost::mutex::scoped_lock lock(_mutex_impl->_mutex);
+
+    return _cache_misses;
+}
+
+bool
+shader_preprocessor::named_line_directives() const
+{
+    return _named_line_directives;
+}
+
+bool
+shader_preprocessor::expand(const std::string&  in_source,
+                            const std::string&  in_source_name,
+                            const std::string&  in_line_name,
+                            bool                in_main_source,
+                            expand_state&       in_state) const
+{
+    std::ostream&       out = in_state._output;
+    std::istringstream  in_stream(in_source);
+    std::string         in_line;
+    std::string         code;
+    scm::size_t         line_number = 0;
+
+    bool version_line_found   = !in_main_source;
+    bool multi_line_comment   = false;
+    bool macro_lines_inserted = !in_main_source;
+
+    while (std::getline(in_stream, in_line)) {
+        ++line_number;
+        const bool line_in_comment = multi_line_comment;
+        line_code(in_line, multi_line_comment, code);
+
+        std::string::size_type d = 0;
+        if (!version_line_found) {
+            if (match_directive(code, "version", d)) {
+                version_line_found = true;
+            }
+            else if (code.find_first_not_of(" \t\r") != std::string::npos) {
+                in_state._info_log = in_source_name + std::string("(0) : error no #version statement found at beginning of source string.");
+                return false;
+            }
+        }
+        else if (!line_in_comment && match_directive(code, "include", d)) {
+            const std::string::size_type b = code.find_first_of("\"<", d);
+            const std::string::size_type e = (b == std::string::npos) ? b : code.find_first_of(code[b] == '"' ? "\"" : ">", b + 1);
+            if (b == std::string::npos || e == std::string::npos || e == b + 1) {
+                std::ostringstream log;
+                log << in_source_name << "(" << line_number << ") : error malformed #include directive.";
+                in_state._info_log = log.str();
+                return false;
+            }
+
+            const std::string inc_name(code, b + 1, e - b - 1);
+            const std::string including_path = in_main_source ? std::string() : in_source_name;
+            std::string       inc_path;
+
+            if (!resolve_include(inc_name, including_path, in_state._inc_paths, inc_path)) {
+                // left to the GL include mechanism
+                in_state._unresolved = true;
+                out << in_line << '\n';
+                continue;
+            }
+            if (   std::find(in_state._include_stack.begin(), in_state._include_stack.end(), inc_path) != in_state._include_stack.end()
+                || in_state._include_stack.size() >= max_include_depth) {
+                std::ostringstream log;
+                log << in_source_name << "(" << line_number << ") : error recursive #include of " << inc_path << ".";
+                in_state._info_log = log.str();
+                return false;
+            }
+
+            in_state._includes.insert(inc_path);
+            in_state._include_stack.push_back(inc_path);
+
+            std::ostringstream inc_line_name;
+            if (_named_line_directives) {
+                inc_line_name << "\"" << inc_path << "\"";
+            }
+            else {
+                inc_line_name << ++in_state._include_count;
+            }
+            out << "#line 1 " << inc_line_name.str() << '\n';
+            if (!expand(_includes.find(inc_path)->second, inc_path, inc_line_name.str(), false, in_state)) {
+                return false;
+            }
+            out << "#line " << (line_number + 1) << " " << in_line_name << '\n';
+
+            in_state._include_stack.pop_back();
+            continue;
+        }
+
+        out << in_line << '\n';
+
+        if (   !macro_lines_inserted
+            &&  version_line_found
+            && !multi_line_comment) {
+            // write macro definitions
+            foreach(const shader_macro& m, in_state._macros.macros()) {
+                out << "#define " << m._name << " " << m._value << '\n';
+            }
+            out << "#line " << (line_number + 1) << " " << in_line_name << '\n';
+
+            macro_lines_inserted = true;
+        }
+    }
+
+    if (!version_line_found) {
+        in_state._info_log = in_source_name + std::string("(0) : error no #version statement found at beginning of source string.");
+        return false;
+    }
+
+    return true;
+}
+
+bool
+shader_preprocessor::resolve_include(const std::string&              in_name,
+                                     const std::string&              in_including_path,
+                                     const shader_include_path_list& in_inc_paths,
+                                           std::string&              out_path) const
+{
+    if (in_name[0] == '/') {
+        out_path = in_name;
+        return _includes.find(out_path) != _includes.end();
+    }
+
+    if (!in_including_path.empty()) {
+        out_path = parent_path(in_including_path) + in_name;
+        if (_includes.find(out_path) != _includes.end()) {
+            return true;
+        }
+    }
+    foreach(const std::string& p, in_inc_paths) {
+        out_path = p;
+        if (out_path.empty() || out_path[out_path.size() - 1] != '/') {
+            out_path.push_back('/');
+        }
+        out_path.append(in_name);
+        if (_includes.find(out_path) != _includes.end()) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void
+shader_preprocessor::drop_entry(const std::string& in_key)
+{
+    cache_map::iterator c = _cache.find(in_key);
+    if (c == _cache.end()) {
+        return;
+    }
+    foreach(const std::string& i, c->second._includes) {
+        dependency_map::iterator d = _dependents.find(i);
+        if (d != _dependents.end()) {
+            d->second.erase(in_key);
+            if (d->second.empty()) {
+                _dependents.erase(d);
+            }
+        }
+    }
+    _cache.erase(c);
+}
+
+void
+shader_preprocessor::drop_dependent_entries(const std::string& in_path)
+{
+    dependency_map::iterator d = _dependents.find(in_path);
+    if (d == _dependents.end()) {
+        return;
+    }
+    // drop_entry modifies the dependency sets
+    const std::set<std::string> keys(d->second);
+    foreach(const std::string& k, keys) {
+        drop_entry(k);
+    }
+}
+
+void
+shader_preprocessor::drop_unresolved_entries()
+{
+    string_array keys;
+    for (cache_map::const_iterator c = _cache.begin(); c != _cache.end(); ++c) {
+        if (c->second._unresolved) {
+            keys.push_back(c->first);
+        }
+    }
+    foreach(const std::string& k, keys) {
+        drop_entry(k);
+    }
+}
+
+} // namespace gl
+} // namespace scm
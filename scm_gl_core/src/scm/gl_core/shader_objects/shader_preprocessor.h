@@ -0,0 +1,119 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_GL_CORE_SHADER_PREPROCESSOR_H_INCLUDED
+#define SCM_GL_CORE_SHADER_PREPROCESSOR_H_INCLUDED
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+#include <boost/unordered_map.hpp>
+
+#include <scm/core/numeric_types.h>
+#include <scm/core/memory.h>
+
+#include <scm/gl_core/shader_objects/shader_objects_fwd.h>
+#include <scm/gl_core/shader_objects/shader_macro.h>
+
+#include <scm/core/platform/platform.h>
+#include <scm/core/utilities/platform_warning_disable.h>
+
+namespace scm {
+namespace gl {
+
+// cpu side shader source preprocessing, does not touch the GL
+//  - checks for the leading #version statement, inserts the macro definitions behind it
+//    and expands #include "path" and #include <path> directives from the registered
+//    include strings, unknown includes are left in place for the GL
+//  - include paths starting with '/' are absolute, others are looked up relative to the
+//    including include string and then in the include search paths
+//  - results are cached by the source, source name, macros and search paths, every cache
+//    entry records the include strings it expanded so that changing an include string
+//    only drops the entries depending on it
+class __scm_export(gl_core) shader_preprocessor : boost::noncopyable
+{
+public:
+    typedef std::vector<std::string>    string_array;
+
+public:
+    // named line directives (#line n "file") require GL_ARB_shading_language_include,
+    // otherwise source string numbers are used, 0 for the source and 1..n for the includes
+    shader_preprocessor(bool in_named_line_directives = false);
+    virtual ~shader_preprocessor();
+
+    bool                    add_include_string(const std::string& in_path,
+                                               const std::string& in_source_string);
+    bool                    remove_include_string(const std::string& in_path);
+    bool                    has_include_string(const std::string& in_path) const;
+
+    bool                    preprocess(const std::string&              in_source,
+                                       const std::string&              in_source_name,
+                                       const shader_macro_array&       in_macros,
+                                       const shader_include_path_list& in_inc_paths,
+                                             std::string&              out_source,
+                                             std::string&              out_info_log);
+
+    // names of the cached sources expanding the include string directly or indirectly,
+    // query before changing the include to find the programs to rebuild
+    void                    dependent_sources(const std::string& in_path,
+                                                    string_array& out_source_names) const;
+
+    void                    clear_cache();
+    scm::size_t             cache_size() const;
+    scm::size_t             cache_hits() const;
+    scm::size_t             cache_misses() const;
+    bool                    named_line_directives() const;
+
+protected:
+    struct cache_entry {
+        std::string         _source_name;
+        std::string         _output;
+        std::string         _info_log;
+        bool                _success;
+        string_array        _includes;      // expanded include strings, direct and indirect
+        bool                _unresolved;    // an include was not found, dropped when includes are added
+    }; // struct cache_entry
+
+    struct expand_state;
+
+    typedef boost::unordered_map<std::string, std::string>              include_map;
+    typedef boost::unordered_map<std::string, cache_entry>              cache_map;
+    typedef boost::unordered_map<std::string, std::set<std::string> >  dependency_map;
+
+    bool                    expand(const std::string&  in_source,
+                                   const std::string&  in_source_name,
+                                   const std::string&  in_line_name,
+                                   bool                in_main_source,
+                                   expand_state&       in_state) const;
+    bool                    resolve_include(const std::string&              in_name,
+                                            const std::string&              in_including_path,
+                                            const shader_include_path_list& in_inc_paths,
+                                                  std::string&              out_path) const;
+
+    void                    drop_entry(const std::string& in_key);
+    void                    drop_dependent_entries(const std::string& in_path);
+    void                    drop_unresolved_entries();
+
+protected:
+    struct mutex_impl;
+    shared_ptr<mutex_impl>  _mutex_impl;
+
+    bool                    _named_line_directives;
+
+    include_map             _includes;
+    cache_map               _cache;
+    dependency_map          _dependents;    // include path to the keys of the entries expanding it
+    scm::size_t             _cache_hits;
+    scm::size_t             _cache_misses;
+
+}; // class shader_preprocessor
+
+} // namespace gl
+} // namespace scm
+
+#include <scm/core/utilities/platform_warning_enable.h>
+
+#endif // SCM_GL_CORE_SHADER_PREPROCESSOR_H_INCLUDED
@@ -5,6 +5,7 @@
 #include "uniform.h"
 
 #include <cassert>
+#include <cstring>
 
 #include <scm/gl_core/config.h>
 #include <scm/gl_core/render_device/device.h>
@@ -60,10 +61,11 @@ void
 uniform<T, D>::set_value(int i, value_param_type v)
 {
     assert(i < static_cast<int>(_elements));
-    if (!_status._initialized || v != _value[i]) {
+    // all uniform value types are plain arrays of scalars
+    if (!_status._initialized || 0 != std::memcmp(&v, &_value[i], sizeof(value_type))) {
         _value[i] = v;
-        _status._update_required = true;
         _status._initialized     = true;
+        mark_update_required();
     }
 }
 
@@ -120,6 +122,7 @@ uniform_base::uniform_base(const std::string& n, const int l, const unsigned e,
   , _location(l)
   , _elements(e)
   , _type(t)
+  , _dirty_list(0)
 {
     _status._initialized     = false;
     _status._update_required = false;
@@ -159,6 +162,17 @@ uniform_base::update_required() const
     return _status._update_required;
 }
 
+void
+uniform_base::mark_update_required()
+{
+    if (!_status._update_required) {
+        _status._update_required = true;
+        if (_dirty_list) {
+            _dirty_list->push_back(this);
+        }
+    }
+}
+
 // class uniform_image_sampler_base ///////////////////////////////////////////////////////////////
 uniform_image_sampler_base::uniform_image_sampler_base(const std::string& n, const int l, const unsigned e, const data_type t)
   : uniform_base(n, l, e, t)
@@ -183,8 +197,8 @@ uniform_image_sampler_base::bound_unit(scm::int32 v)
     if (!_status._initialized || v != _bound_unit) {
         _bound_unit              = v;
         _resident_handle         = 0ull;
-        _status._update_required = true;
         _status._initialized     = true;
+        mark_update_required();
     }
 }
 
@@ -200,8 +214,8 @@ uniform_image_sampler_base::resident_handle(scm::uint64 v)
     if (!_status._initialized || v != _resident_handle) {
         _bound_unit              = -1;
         _resident_handle         = v;
-        _status._update_required = true;
         _status._initialized     = true;
+        mark_update_required();
     }
 }
 
@@ -35,12 +35,18 @@ public:
     bool                    update_required() const;
     virtual void            apply_value(const render_context& context, const program& p) = 0;
 
+protected:
+    // queues the uniform on the dirty list of its program once until the next apply
+    void                    mark_update_required();
+
 protected:
     std::string             _name;
     int                     _location;
     unsigned                _elements;
     data_type               _type;
 
+    std::vector<uniform_base*>* _dirty_list;
+
     struct {
         bool                _update_required : 1;
         bool                _initialized     : 1;
@@ -139,6 +145,25 @@ SCM_UNIFORM_TYPE_DECLARE(scm::math::mat4d,  TYPE_MAT4D,  uniform_mat4d)
 template<> struct uniform_type<bool>      { typedef uniform_1i  type; };
 template<> struct uniform_data_type<bool> { static const data_type  type = TYPE_INT; };
 
+// uniform resolved once by name and type through program::uniform_handle, setting a
+// value through the handle skips the name lookup, default constructed handles, handles
+// of other programs and handles not matching the uniform in their slot are ignored
+template<typename T>
+class uniform_handle
+{
+public:
+    uniform_handle() : _program_serial(0), _slot(0), _type(TYPE_UNKNOWN) {}
+
+    bool                    valid() const { return 0 != _program_serial; }
+
+protected:
+    scm::uint64             _program_serial;    // unique per program, addresses are reused
+    unsigned                _slot;
+    data_type               _type;
+
+    friend class scm::gl::program;
+}; // class uniform_handle
+
 class uniform_image_sampler_base : public uniform_base
 {
 public:
@@ -0,0 +1,50 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_GL_UTIL_DETAIL_UTF8_H_INCLUDED
+#define SCM_GL_UTIL_DETAIL_UTF8_H_INCLUDED
+
+#include <string>
+
+#include <scm/core/numeric_types.h>
+
+namespace scm {
+namespace gl {
+namespace detail {
+
+// decodes the code point at c and advances c, invalid sequences yield the replacement character
+inline
+scm::uint32
+decode_utf8(std::string::const_iterator& c, const std::string::const_iterator& e)
+{
+    const scm::uint32 replacement_char = 0xfffdu;
+    const scm::uint32 lead             = static_cast<unsigned char>(*c++);
+
+    if (lead < 0x80u) {
+        return lead;
+    }
+
+    int         trail_bytes = 0;
+    scm::uint32 code_point  = 0;
+    if      ((lead & 0xe0u) == 0xc0u) { trail_bytes = 1; code_point = lead & 0x1fu; }
+    else if ((lead & 0xf0u) == 0xe0u) { trail_bytes = 2; code_point = lead & 0x0fu; }
+    else if ((lead & 0xf8u) == 0xf0u) { trail_bytes = 3; code_point = lead & 0x07u; }
+    else {
+        return replacement_char;
+    }
+    for (int i = 0; i < trail_bytes; ++i) {
+        if (c == e || (static_cast<unsigned char>(*c) & 0xc0u) != 0x80u) {
+            return replacement_char;
+        }
+        code_point = (code_point << 6) | (static_cast<unsigned char>(*c++) & 0x3fu);
+    }
+
+    return code_point;
+}
+
+} // namespace detail
+} // namespace gl
+} // namespace scm
+
+#endif // SCM_GL_UTIL_DETAIL_UTF8_H_INCLUDED
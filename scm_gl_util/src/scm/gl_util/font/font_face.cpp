@@ -4,6 +4,10 @@
 
 #include "font_face.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
 #include <iostream>
 #include <exception>
 #include <stdexcept>
@@ -14,9 +18,15 @@
 #include <boost/filesystem.hpp>
 #include <boost/assign/list_of.hpp>
 #include <boost/assign/std/vector.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
 //#include <boost/tuple/tuple.hpp>
 
+#include <scm/core/utilities/thread_pool.h>
+
 #include <scm/gl_core/log.h>
+#include <scm/gl_core/data_types.h>
 #include <scm/gl_core/render_device.h>
 #include <scm/gl_core/texture_objects.h>
 
@@ -169,27 +179,335 @@ available_72dpi_size(const std::string& file_name,
     return (font_size);
 }
 
+// copies the bitmap bottom up into the image, the glyph origin is the lower left corner
+void
+copy_glyph_bitmap(const FT_Bitmap&          in_bitmap,
+                  const scm::math::vec2i&   in_offset,
+                  unsigned                  in_image_width,
+                  int                       in_components,
+                  int                       in_bitmap_ycomp,
+                  unsigned char*            out_image)
+{
+    switch (in_bitmap.pixel_mode) {
+        case FT_PIXEL_MODE_GRAY:
+            for (unsigned dy = 0; dy < in_bitmap.rows; ++dy) {
+                unsigned src_off = dy * in_bitmap.pitch;
+                unsigned dst_off =    in_offset.x
+                                   + (in_offset.y + in_bitmap.rows - 1 - dy) * in_image_width;
+                for (unsigned dx = 0; dx < in_bitmap.width; ++dx) {
+                    out_image[(dst_off + dx) * in_components] = in_bitmap.buffer[src_off + dx];
+                }
+            }
+            break;
+        case FT_PIXEL_MODE_LCD:
+            for (unsigned dy = 0; dy < in_bitmap.rows; ++dy) {
+                unsigned src_off = dy * in_bitmap.pitch;
+                unsigned dst_off =    in_offset.x
+                                   + (in_offset.y + in_bitmap.rows - 1 - dy) * in_image_width;
+                for (unsigned dx = 0; dx < in_bitmap.width / in_bitmap_ycomp; ++dx) {
+                    out_image[(dst_off + dx) * in_components    ] = in_bitmap.buffer[src_off + dx * in_bitmap_ycomp];
+                    out_image[(dst_off + dx) * in_components + 1] = in_bitmap.buffer[src_off + dx * in_bitmap_ycomp + 1];
+                    out_image[(dst_off + dx) * in_components + 2] = in_bitmap.buffer[src_off + dx * in_bitmap_ycomp + 2];
+                }
+            }
+            break;
+        case FT_PIXEL_MODE_MONO:
+            for (unsigned dy = 0; dy < in_bitmap.rows; ++dy) {
+                for (int dx = 0; dx < in_bitmap.pitch; ++dx) {
+                    unsigned        src_off     = dx + dy * in_bitmap.pitch;
+                    unsigned char   src_byte    = in_bitmap.buffer[src_off];
+                    for (unsigned bx = 0; bx < 8 && dx * 8 + bx < in_bitmap.width; ++bx) {
+                        unsigned        dst_off =   (in_offset.x + dx * 8 + bx)
+                                                  + (in_offset.y + in_bitmap.rows - 1 - dy) * in_image_width;
+                        unsigned char   src_set = src_byte & (0x80 >> bx);
+                        for (int l = 0; l < in_components; ++l) {
+                            out_image[dst_off * in_components + l] = src_set ? 255u : 0u;
+                        }
+                    }
+                }
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+// squared euclidean distance transform of a sampled function (Felzenszwalb, Huttenlocher),
+// v and z are scratch arrays of n and n + 1 elements
+void
+distance_transform_1d(const float* f, float* d, int* v, float* z, int n)
+{
+    const float inf = 1e20f;
+    int         k   = 0;
+
+    v[0] = 0;
+    z[0] = -inf;
+    z[1] =  inf;
+    for (int q = 1; q < n; ++q) {
+        float s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+        while (s <= z[k]) {
+            --k;
+            s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+        }
+        ++k;
+        v[k]     = q;
+        z[k]     = s;
+        z[k + 1] = inf;
+    }
+    k = 0;
+    for (int q = 0; q < n; ++q) {
+        while (z[k + 1] < q) {
+            ++k;
+        }
+        d[q] = (q - v[k]) * (q - v[k]) + f[v[k]];
+    }
+}
+
+// in place, feature cells are 0, all others a large value
+void
+distance_transform_2d(std::vector<float>& io_grid, int w, int h)
+{
+    const int           n = (std::max)(w, h);
+    std::vector<float>  f(n);
+    std::vector<float>  d(n);
+    std::vector<float>  z(n + 1);
+    std::vector<int>    v(n);
+
+    for (int x = 0; x < w; ++x) {
+        for (int y = 0; y < h; ++y) {
+            f[y] = io_grid[x + y * w];
+        }
+        distance_transform_1d(&f[0], &d[0], &v[0], &z[0], h);
+        for (int y = 0; y < h; ++y) {
+            io_grid[x + y * w] = d[y];
+        }
+    }
+    for (int y = 0; y < h; ++y) {
+        distance_transform_1d(&io_grid[y * w], &d[0], &v[0], &z[0], w);
+        std::copy(d.begin(), d.begin() + w, io_grid.begin() + y * w);
+    }
+}
+
+// signed distance field of the bitmap placed at in_offset in a grid of in_field_size *
+// in_supersampling texels, the grid is averaged down to the field size and encoded bottom
+// up with 0.5 on the outline and 0 at in_spread field texels outside
+void
+generate_distance_field(const FT_Bitmap&        in_bitmap,
+                        const scm::math::vec2i& in_offset,
+                        const scm::math::vec2i& in_field_size,
+                        int                     in_supersampling,
+                        int                     in_spread,
+                        unsigned char*          out_field)
+{
+    const float inf = 1e20f;
+    const int   gw  = in_field_size.x * in_supersampling;
+    const int   gh  = in_field_size.y * in_supersampling;
+
+    std::vector<float> outside(gw * gh, inf);  // distance to the closest inside texel
+    std::vector<float> inside(gw * gh, 0.0f);  // distance to the closest outside texel
+
+    for (unsigned dy = 0; dy < in_bitmap.rows; ++dy) {
+        const unsigned char* src = in_bitmap.buffer + dy * in_bitmap.pitch;
+        const int            gy  = in_offset.y + in_bitmap.rows - 1 - dy;
+        for (unsigned dx = 0; dx < in_bitmap.width; ++dx) {
+            const bool set = (in_bitmap.pixel_mode == FT_PIXEL_MODE_MONO) ? (0 != (src[dx >> 3] & (0x80 >> (dx & 7))))
+                                                                           : (src[dx] >= 128);
+            if (set) {
+                outside[in_offset.x + dx + gy * gw] = 0.0f;
+                inside[in_offset.x + dx + gy * gw]  = inf;
+            }
+        }
+    }
+    distance_transform_2d(outside, gw, gh);
+    distance_transform_2d(inside,  gw, gh);
+
+    const float scale = 1.0f / (in_supersampling * in_supersampling * in_supersampling * 2.0f * in_spread);
+    for (int fy = 0; fy < in_field_size.y; ++fy) {
+        for (int fx = 0; fx < in_field_size.x; ++fx) {
+            float d = 0.0f; // sum of the signed distances of the block, positive outside
+            for (int y = fy * in_supersampling; y < (fy + 1) * in_supersampling; ++y) {
+                for (int x = fx * in_supersampling; x < (fx + 1) * in_supersampling; ++x) {
+                    const int i = x + y * gw;
+                    d += (outside[i] > 0.0f) ?   std::sqrt(outside[i]) - 0.5f
+                                             : -(std::sqrt(inside[i])  - 0.5f);
+                }
+            }
+            const float v = scm::math::clamp(0.5f - d * scale, 0.0f, 1.0f);
+            out_field[fx + fy * in_field_size.x] = static_cast<unsigned char>(v * 255.0f + 0.5f);
+        }
+    }
+}
+
+int
+floor_div(int a, int b)
+{
+    return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
 } // namesapce detail
 
+struct font_face::ft_context
+{
+    detail::ft_library                          _library;
+    std::vector<shared_ptr<detail::ft_face> >   _faces;
+    shared_ptr<detail::ft_stroker>              _stroker;
+
+    int                                         _components;
+    int                                         _bitmap_ycomp;
+    FT_Render_Mode                              _render_mode;
+    unsigned                                    _load_flags;
+    data_format                                 _texture_format;
+}; // struct font_face::ft_context
+
+struct font_face::df_context
+{
+    struct job {
+        job(scm::uint32 c, style_type s) : _code_point(c), _style(s), _done(false) {}
+
+        scm::uint32                 _code_point;
+        style_type                  _style;
+        bool                        _done;
+        glyph_info                  _glyph;
+        std::vector<unsigned char>  _field;
+        std::string                 _error;
+    }; // struct job
+    // FreeType is not thread safe, every worker uses its own library and faces
+    struct rasterizer {
+        rasterizer() : _faces(style_count) {}
+
+        detail::ft_library                          _library;
+        std::vector<shared_ptr<detail::ft_face> >   _faces;
+    }; // struct rasterizer
+    // shared with the queued jobs, which may outlive the font face
+    struct generator {
+        std::vector<std::string>                _style_files;
+        unsigned                                _font_size;
+        unsigned                                _dpi;
+        unsigned                                _spread;
+
+        boost::mutex                            _mutex;
+        boost::condition_variable               _job_done;
+        std::vector<shared_ptr<rasterizer> >    _idle_rasterizers;
+
+        void                                    run(const shared_ptr<job>& j);
+        void                                    generate(rasterizer& r, job& j) const;
+    }; // struct generator
+    typedef boost::unordered_map<glyph_key, shared_ptr<job> >   job_map;
+
+    shared_ptr<thread_pool>     _workers;
+    shared_ptr<generator>       _generator;
+    job_map                     _jobs;      // pending and unplaced jobs, only used by the face
+
+    // one pool for all distance field faces, alive as long as one of them
+    static shared_ptr<thread_pool> shared_workers()
+    {
+        static boost::mutex             workers_mutex;
+        static weak_ptr<thread_pool>    workers;
+
+        boost::mutex::scoped_lock   lock(workers_mutex);
+        shared_ptr<thread_pool>     w = workers.lock();
+        if (!w) {
+            w.reset(new thread_pool());
+            workers = w;
+        }
+        return (w);
+    }
+}; // struct font_face::df_context
+
+void
+font_face::df_context::generator::run(const shared_ptr<job>& j)
+{
+    shared_ptr<rasterizer> r;
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        if (!_idle_rasterizers.empty()) {
+            r = _idle_rasterizers.back();
+            _idle_rasterizers.pop_back();
+        }
+    }
+    try {
+        if (!r) {
+            r.reset(new rasterizer);
+        }
+        generate(*r, *j);
+    }
+    catch (const std::exception& e) {
+        j->_error = e.what();
+    }
+
+    boost::mutex::scoped_lock lock(_mutex);
+    if (r) {
+        _idle_rasterizers.push_back(r);
+    }
+    j->_done = true;
+    _job_done.notify_all();
+}
+
+void
+font_face::df_context::generator::generate(rasterizer& r, job& j) const
+{
+    using namespace scm::math;
+
+    const int ss = static_cast<int>(distance_field_supersampling);
+
+    if (!r._faces[j._style]) {
+        r._faces[j._style].reset(new detail::ft_face(r._library, _style_files[j._style]));
+        r._faces[j._style]->set_size(_font_size, _dpi * ss);
+    }
+    detail::ft_face& ft_font = *r._faces[j._style];
+
+    // unhinted outlines, the hinting of the supersampled size does not match the base size
+    ft_font.load_glyph(j._code_point, FT_LOAD_NO_HINTING);
+    if (FT_Render_Glyph(ft_font.get_glyph(), FT_RENDER_MODE_NORMAL)) {
+        throw std::runtime_error("error during FT_Render_Glyph");
+    }
+    const FT_Bitmap& bitmap = ft_font.get_glyph()->bitmap;
+
+    j._glyph._advance = static_cast<unsigned>(ceil(ft_font.get_glyph()->linearHoriAdvance / (65536.0f * ss)));
+
+    if (bitmap.width > 0 && bitmap.rows > 0) {
+        // field texels are aligned to the base size pixel grid, spread texels around the outline
+        const int   spread = static_cast<int>(_spread) * ss;
+        const vec2i bearing(ft_font.get_glyph()->bitmap_left,
+                            ft_font.get_glyph()->bitmap_top - static_cast<int>(bitmap.rows));
+        const vec2i field_origin(detail::floor_div(bearing.x - spread, ss),
+                                 detail::floor_div(bearing.y - spread, ss));
+        const vec2i field_end(-detail::floor_div(-(bearing.x + static_cast<int>(bitmap.width) + spread), ss),
+                              -detail::floor_div(-(bearing.y + static_cast<int>(bitmap.rows)  + spread), ss));
+
+        j._glyph._box_size = field_end - field_origin;
+        j._glyph._bearing  = field_origin;
+        j._field.resize(j._glyph._box_size.x * j._glyph._box_size.y);
+
+        detail::generate_distance_field(bitmap, bearing - field_origin * ss, j._glyph._box_size,
+                                        ss, _spread, &j._field[0]);
+    }
+}
+
 font_face::font_face(const render_device_ptr& device,
                      const std::string&       font_file,
                      unsigned                 point_size,
                      float                    border_size,
                      smooth_type              smooth_type,
-                     unsigned                 display_dpi)
-  : _font_styles(style_count)
+                     unsigned                 display_dpi,
+                     unsigned                 atlas_layers)
+  : _device(device)
+  , _font_styles(style_count)
   , _font_styles_available(style_count)
   , _font_smooth_style(smooth_type)
+  , _atlas_size(0u, 0u)
+  , _atlas_use_count(0)
+  , _atlas_generation(0)
   , _point_size(point_size)
   , _border_size(static_cast<unsigned>(math::floor(border_size * 64.0f)))
   , _dpi(display_dpi)
+  , _distance_field_spread(0)
 {
     using namespace scm::gl;
     using namespace scm::math;
 
     try {
-
-        detail::ft_library  ft_lib;
+        _ft_context.reset(new ft_context);
 
         if (!detail::check_file(font_file)) {
             std::ostringstream s;
@@ -213,49 +531,72 @@ font_face::font_face(const render_device_ptr& device,
         std::vector<std::string>    font_style_files;
         detail::find_font_style_files(font_file, font_style_files);
 
-        // fill font styles
+        ft_context& ft = *_ft_context;
+
+        ft._bitmap_ycomp = 1;
+        switch (smooth_type) {
+            case smooth_normal: ft._components     = 2;
+                                ft._render_mode    = FT_RENDER_MODE_NORMAL; //FT_RENDER_MODE_LIGHT; //
+                                ft._load_flags     = FT_LOAD_DEFAULT; //FT_LOAD_FORCE_AUTOHINT | FT_LOAD_TARGET_LIGHT; //
+                                ft._texture_format = FORMAT_RG_8;
+                                break;
+            case smooth_lcd:    ft._components     = 3;
+                                ft._bitmap_ycomp   = 3;
+                                ft._render_mode    = FT_RENDER_MODE_LCD;
+                                ft._load_flags     = FT_LOAD_TARGET_LCD;//FT_LOAD_FORCE_AUTOHINT | FT_LOAD_TARGET_LIGHT;
+                                ft._texture_format = FORMAT_RGB_8;
+                                FT_Library_SetLcdFilter(ft._library.get_lib(), FT_LCD_FILTER_LIGHT);
+                                break;
+            case smooth_distance_field:
+                                ft._components     = 1;
+                                ft._render_mode    = FT_RENDER_MODE_NORMAL;
+                                ft._load_flags     = FT_LOAD_NO_HINTING;
+                                ft._texture_format = FORMAT_R_8;
+                                _border_size       = 0; // outlines are drawn from the distance field
+                                // an eighth of the em size, a quarter for outlines and shadows
+                                _distance_field_spread = max(2u, (font_size * display_dpi / 72u + 4u) / 8u);
+                                break;
+            default:
+                std::ostringstream s;
+                s << "font_face::font_face(): unsupported smoothing style.";
+                throw(std::runtime_error(s.str()));
+        }
+        if (_border_size > 0) {
+            ft._stroker.reset(new detail::ft_stroker(ft._library, _border_size));
+        }
+
+        // open the font styles, the faces stay open for the glyph rasterization on first use
         math::vec2ui max_glyph_size(0u, 0u); // to store the maximal glyph size over all styles
         for (int i = 0; i < style_count; ++i) {
             _font_styles_available[i] = !font_style_files[i].empty();
 
-            std::string         cur_font_file = _font_styles_available[i] ? font_style_files[i] : font_style_files[0];
-            detail::ft_face     ft_font(ft_lib, cur_font_file);
+            std::string                 cur_font_file = _font_styles_available[i] ? font_style_files[i] : font_style_files[0];
+            shared_ptr<detail::ft_face> ft_font(new detail::ft_face(ft._library, cur_font_file));
 
-            ft_font.set_size(font_size, display_dpi);
-
-            // calculate kerning information
-            _font_styles[i]._kerning_table.resize(boost::extents[max_char][max_char]);
-            for (unsigned l = min_char; l < max_char; ++l) {
-                for (unsigned r = min_char; r < max_char; ++r) {
-                    //if (l == 'T' && r == 'e')
-                    //    std::cout << "kerning: " << int(ft_font.get_kerning(l, r)) << std::endl;
-                    _font_styles[i]._kerning_table[l][r] = ft_font.get_kerning(l, r);
-                }
-            }
+            ft_font->set_size(font_size, display_dpi);
+            ft._faces.push_back(ft_font);
 
             // retrieve the maximal bounding box of all glyphs in the face
             vec2f  font_bbox_x;
             vec2f  font_bbox_y;
 
-            if (ft_font.get_face()->face_flags & FT_FACE_FLAG_SCALABLE) {
-                float   em_size = 1.0f * ft_font.get_face()->units_per_EM;
-                float   x_scale = ft_font.get_face()->size->metrics.x_ppem / em_size;
-                float   y_scale = ft_font.get_face()->size->metrics.y_ppem / em_size;
-
-                font_bbox_x = vec2f(ft_font.get_face()->bbox.xMin * x_scale,
-                                    ft_font.get_face()->bbox.xMax * x_scale);
-                font_bbox_y = vec2f(ft_font.get_face()->bbox.yMin * y_scale,
-                                    ft_font.get_face()->bbox.yMax * y_scale);
-
-                _font_styles[i]._line_spacing        = static_cast<unsigned>(ceil(ft_font.get_face()->height * y_scale));
-                _font_styles[i]._underline_position  = static_cast<int>(round(ft_font.get_face()->underline_position * y_scale));
-                _font_styles[i]._underline_thickness = static_cast<unsigned>(round(ft_font.get_face()->underline_thickness * y_scale));
+            if (ft_font->get_face()->face_flags & FT_FACE_FLAG_SCALABLE) {
+                float   em_size = 1.0f * ft_font->get_face()->units_per_EM;
+                float   x_scale = ft_font->get_face()->size->metrics.x_ppem / em_size;
+                float   y_scale = ft_font->get_face()->size->metrics.y_ppem / em_size;
 
+                font_bbox_x = vec2f(ft_font->get_face()->bbox.xMin * x_scale,
+                                    ft_font->get_face()->bbox.xMax * x_scale);
+                font_bbox_y = vec2f(ft_font->get_face()->bbox.yMin * y_scale,
+                                    ft_font->get_face()->bbox.yMax * y_scale);
 
+                _font_styles[i]._line_spacing        = static_cast<unsigned>(ceil(ft_font->get_face()->height * y_scale));
+                _font_styles[i]._underline_position  = static_cast<int>(round(ft_font->get_face()->underline_position * y_scale));
+                _font_styles[i]._underline_thickness = static_cast<unsigned>(round(ft_font->get_face()->underline_thickness * y_scale));
             }
-            else if (ft_font.get_face()->face_flags & FT_FACE_FLAG_FIXED_SIZES) {
-                font_bbox_x = vec2f(0.0f, static_cast<float>(ft_font.get_face()->size->metrics.max_advance >> 6));
-                font_bbox_y = vec2f(0.0f, static_cast<float>(ft_font.get_face()->size->metrics.height >> 6));
+            else if (ft_font->get_face()->face_flags & FT_FACE_FLAG_FIXED_SIZES) {
+                font_bbox_x = vec2f(0.0f, static_cast<float>(ft_font->get_face()->size->metrics.max_advance >> 6));
+                font_bbox_y = vec2f(0.0f, static_cast<float>(ft_font->get_face()->size->metrics.height >> 6));
 
                 _font_styles[i]._line_spacing        = static_cast<int>(font_bbox_y.y);
                 _font_styles[i]._underline_position  = -1;
@@ -272,324 +613,71 @@ font_face::font_face(const render_device_ptr& device,
                                       static_cast<unsigned>(ceil(font_bbox_y.y) - floor(font_bbox_y.x)));
             max_glyph_size.x = max<unsigned>(max_glyph_size.x, font_size.x);
             max_glyph_size.y = max<unsigned>(max_glyph_size.y, font_size.y);
-
         }
         // end fill font styles
 
-        // generate texture image
-        int             glyph_components     = 0;
-        int             glyph_bitmap_ycomp   = 1;
-        FT_Render_Mode  glyph_render_mode    = FT_RENDER_MODE_NORMAL;
-        unsigned        glyph_load_flags     = FT_LOAD_DEFAULT;
-        data_format     glyph_texture_format = FORMAT_NULL;
-
-        switch (smooth_type) {
-            case smooth_normal: glyph_components     = 2;
-                                glyph_render_mode    = FT_RENDER_MODE_NORMAL; //FT_RENDER_MODE_LIGHT; //
-                                glyph_load_flags     = FT_LOAD_DEFAULT; //FT_LOAD_FORCE_AUTOHINT | FT_LOAD_TARGET_LIGHT; //
-                                glyph_texture_format = FORMAT_RG_8;
-                                break;
-            case smooth_lcd:    glyph_components     = 3;
-                                glyph_bitmap_ycomp   = 3;
-                                glyph_render_mode    = FT_RENDER_MODE_LCD;
-                                glyph_load_flags     = FT_LOAD_TARGET_LCD;//FT_LOAD_FORCE_AUTOHINT | FT_LOAD_TARGET_LIGHT;
-                                glyph_texture_format = FORMAT_RGB_8;
-                                FT_Library_SetLcdFilter(ft_lib.get_lib(), FT_LCD_FILTER_LIGHT);
-                                break;
-            default:
-                std::ostringstream s;
-                s << "font_face::font_face(): unsupported smoothing style.";
-                throw(std::runtime_error(s.str()));
-        }
-
-
-        for (int i = 0; i < style_count; ++i) {
-            _font_styles[i]._glyphs.resize(max_char);
-        }
-
-        //typedef vec<unsigned char, 2> glyph_texel; // 2 components (core, border... TO BE DONE!, currently only first used)
         max_glyph_size += math::vec2ui(1u) + 2 * (_border_size >> 6); // space of at least one texel around all glyphs
+        max_glyph_size += math::vec2ui(2 * _distance_field_spread);
 
-        int                           grid_size = static_cast<int>(ceil(math::sqrt(static_cast<double>(max_char - min_char))));
-        vec3ui                        glyph_texture_dim  = vec3ui(max_glyph_size * grid_size, style_count); // a 16x16 grid of 256 glyphs in 4 layers
-        size_t                        glyph_texture_size = static_cast<size_t>(glyph_texture_dim.x) * glyph_texture_dim.y * glyph_texture_dim.z;
-        scoped_array<unsigned char>   glyph_texture(new unsigned char[glyph_texture_size * glyph_components]);
-
-        if (_border_size > 0) { // border
-            memset(glyph_texture.get(), 0u, glyph_texture_size * glyph_components); // clear to black
-
-            for (int i = 0; i < style_count; ++i) {
-                std::string cur_font_file = _font_styles_available[i] ? font_style_files[i] : font_style_files[0];
-
-                detail::ft_face     ft_font(ft_lib, cur_font_file);
-                ft_font.set_size(font_size, display_dpi);
-                FT_Bitmap           bitmap;
-
-                for (unsigned c = min_char; c < max_char; ++c) {
-                    glyph_info& cur_glyph = _font_styles[i]._glyphs[c];
-                    FT_Glyph    ft_glyph;
-
-                    ft_font.load_glyph(c, glyph_load_flags);
-                    {
-                        detail::ft_stroker stroker(ft_lib, _border_size);
-                        FT_Error ft_err;
-
-                        ft_err = FT_Get_Glyph(ft_font.get_glyph(), &ft_glyph);
-                        if (ft_err) {
-                            throw std::runtime_error("font_face::font_face(): error during FT_Get_Glyph");
-                        }
-                        ft_err = FT_Glyph_Stroke(&ft_glyph, stroker.get_stroker(), true);
-                        if (ft_err) {
-                            throw std::runtime_error("font_face::font_face(): error during FT_Glyph_Stroke");
-                        }
-                        ft_err = FT_Glyph_To_Bitmap(&ft_glyph, glyph_render_mode, 0, true);
-                        if (ft_err) {
-                            throw std::runtime_error("font_face::font_face(): error during FT_Glyph_To_Bitmap");
-                        }
-                        FT_BitmapGlyph ft_bitmap_glyph = (FT_BitmapGlyph)ft_glyph;
-                        bitmap = ft_bitmap_glyph->bitmap;
-                    }
-
-                    // calculate the glyphs grid position in the font texture array
-                    vec3ui tex_array_dst;
-                    tex_array_dst.x = ((c - min_char) % grid_size) * max_glyph_size.x;
-                    tex_array_dst.y = glyph_texture_dim.y - (((c - min_char) / grid_size) + 1) * max_glyph_size.y;
-                    //tex_array_dst.x = (c & 0x0F) * max_glyph_size.x;
-                    //tex_array_dst.y = glyph_texture_dim.y - ((c >> 4) + 1) * max_glyph_size.y;
-                    tex_array_dst.z = i;
-
-                    FT_BitmapGlyph ft_bitmap_glyph = (FT_BitmapGlyph)ft_glyph;
-                    cur_glyph._box_size         = vec2i(bitmap.width / glyph_bitmap_ycomp, bitmap.rows);
-                    cur_glyph._border_bearing   = vec2i(ft_bitmap_glyph->left, ft_bitmap_glyph->top - ft_bitmap_glyph->bitmap.rows);
-                    cur_glyph._texture_origin   = vec2f(static_cast<float>(tex_array_dst.x) / glyph_texture_dim.x,
-                                                        static_cast<float>(tex_array_dst.y) / glyph_texture_dim.y);
-                    cur_glyph._texture_box_size = vec2f(static_cast<float>(cur_glyph._box_size.x) / glyph_texture_dim.x,
-                                                        static_cast<float>(cur_glyph._box_size.y) / glyph_texture_dim.y);
-
-                    if (ft_font.get_face()->face_flags & FT_FACE_FLAG_SCALABLE) {
-                        // linearHoriAdvance contains the 16.16 representation of the horizontal advance
-                        // horiAdvance contains only the rounded advance which can be off by 1 and
-                        // lead to sub styles beeing rendered to narrow
-                        cur_glyph._advance          =  FT_CeilFix(ft_font.get_face()->glyph->linearHoriAdvance) >> 16;
-                    }
-                    else if (ft_font.get_face()->face_flags & FT_FACE_FLAG_FIXED_SIZES) {
-                        cur_glyph._advance          = ft_font.get_face()->glyph->metrics.horiAdvance >> 6;
-                    }
-                    cur_glyph._bearing          = vec2i(   ft_font.get_face()->glyph->metrics.horiBearingX >> 6,
-                                                          (ft_font.get_face()->glyph->metrics.horiBearingY >> 6)
-                                                        - (ft_font.get_face()->glyph->metrics.height >> 6));
-                    FT_Face ff = ft_font.get_face();
-                    int ksks = ft_font.get_face()->glyph->lsb_delta;
-                    int ksds = ft_font.get_face()->glyph->rsb_delta;
-
-                    // fill texture
-                    switch (bitmap.pixel_mode) {
-                        case FT_PIXEL_MODE_GRAY:
-                            for (unsigned dy = 0; dy < bitmap.rows; ++dy) {
-                                unsigned src_off = dy * bitmap.pitch;
-                                unsigned dst_off =    tex_array_dst.x
-                                                   + (tex_array_dst.y + bitmap.rows - 1 - dy) * glyph_texture_dim.x
-                                                   + i * (glyph_texture_dim.x * glyph_texture_dim.y);
-                                for (unsigned dx = 0; dx < bitmap.width; ++dx) {
-                                    glyph_texture[(dst_off + dx) * glyph_components] = bitmap.buffer[src_off + dx];
-                                }
-                            }
-                            break;
-                        case FT_PIXEL_MODE_LCD:
-                            for (unsigned dy = 0; dy < bitmap.rows; ++dy) {
-                                unsigned src_off = dy * bitmap.pitch;
-                                unsigned dst_off =    tex_array_dst.x
-                                                   + (tex_array_dst.y + bitmap.rows - 1 - dy) * glyph_texture_dim.x
-                                                   + i * (glyph_texture_dim.x * glyph_texture_dim.y);
-                                for (unsigned dx = 0; dx < bitmap.width / glyph_bitmap_ycomp; ++dx) {
-                                    glyph_texture[(dst_off + dx) * glyph_components    ] = bitmap.buffer[src_off + dx * glyph_bitmap_ycomp];
-                                    glyph_texture[(dst_off + dx) * glyph_components + 1] = bitmap.buffer[src_off + dx * glyph_bitmap_ycomp + 1];
-                                    glyph_texture[(dst_off + dx) * glyph_components + 2] = bitmap.buffer[src_off + dx * glyph_bitmap_ycomp + 2];
-                                }
-                            }
-                            break;
-                        case FT_PIXEL_MODE_MONO:
-                            for (unsigned dy = 0; dy < bitmap.rows; ++dy) {
-                                for (int dx = 0; dx < bitmap.pitch; ++dx) {
-                                    unsigned        src_off     = dx + dy * bitmap.pitch;
-                                    unsigned char   src_byte    = bitmap.buffer[src_off];
-                                    for (int bx = 0; bx < 8; ++bx) {
-                                        unsigned        dst_off =   (tex_array_dst.x + dx * 8 + bx)
-                                                                  + (tex_array_dst.y + bitmap.rows - 1 - dy) * glyph_texture_dim.x
-                                                                  + i * (glyph_texture_dim.x * glyph_texture_dim.y);
-                                        unsigned char   src_set = src_byte & (0x80 >> bx);
-                                        unsigned char*  plah    = &src_byte;
-                                        for (int l = 0; l < glyph_components; ++l) {
-                                            glyph_texture[dst_off * glyph_components + l] = src_set ? 255u : 0u;
-                                        }
-                                    }
-                                }
-                            }
-                            break;
-                        default:
-                            continue;
-                    }
-                    FT_Done_Glyph(ft_glyph);
-                }
-            }
-            // end generate texture image
-            std::vector<void*> image_array_data_raw;
-            image_array_data_raw.push_back(glyph_texture.get());
+        // every atlas layer holds at least a 16x16 grid of the largest glyphs
+        const unsigned max_atlas_size = static_cast<unsigned>(device->capabilities()._max_texture_size);
+        const unsigned max_layers     = static_cast<unsigned>(device->capabilities()._max_array_texture_layers);
 
-            _font_styles_border_texture_array = device->create_texture_2d(vec2ui(glyph_texture_dim.x, glyph_texture_dim.y),
-                                                                   glyph_texture_format, 1, glyph_texture_dim.z, 1,
-                                                                   glyph_texture_format, image_array_data_raw);
+        _atlas_size.x = min(next_power_of_two(max_glyph_size.x * 16u), max_atlas_size);
+        _atlas_size.y = min(next_power_of_two(max_glyph_size.y * 16u), max_atlas_size);
+        atlas_layers  = clamp(atlas_layers, 1u, max(1u, max_layers));
 
+        _font_styles_texture_array = device->create_texture_2d(_atlas_size, ft._texture_format, 1, atlas_layers);
+        if (!_font_styles_texture_array) {
+            std::ostringstream s;
+            s << "font_face::font_face(): unable to create texture object.";
+            throw(std::runtime_error(s.str()));
+        }
+        if (_border_size > 0) {
+            _font_styles_border_texture_array = device->create_texture_2d(_atlas_size, ft._texture_format, 1, atlas_layers);
             if (!_font_styles_border_texture_array) {
                 std::ostringstream s;
                 s << "font_face::font_face(): unable to create texture object (border).";
                 throw(std::runtime_error(s.str()));
             }
-
-            image_array_data_raw.clear();
-        }
-        // TODO the bearing and box is not wrong!!! FIXME
-        { // core
-            memset(glyph_texture.get(), 0u, glyph_texture_size * glyph_components); // clear to black
-
-            for (int i = 0; i < style_count; ++i) {
-                std::string cur_font_file = _font_styles_available[i] ? font_style_files[i] : font_style_files[0];
-
-                detail::ft_face     ft_font(ft_lib, cur_font_file);
-                ft_font.set_size(font_size, display_dpi);
-                FT_Bitmap           bitmap;
-
-                for (unsigned c = min_char; c < max_char; ++c) {
-                    glyph_info&      cur_glyph = _font_styles[i]._glyphs[c];
-
-                    ft_font.load_glyph(c, glyph_load_flags);
-                    if (FT_Render_Glyph(ft_font.get_glyph(), glyph_render_mode)) {
-                        //glout() << static_cast<char>(c) << " afafaf";
-                        continue;
-                    }
-                    bitmap = ft_font.get_face()->glyph->bitmap;
-
-                    // calculate the glyphs grid position in the font texture array
-                    vec3ui tex_array_dst;
-                    tex_array_dst.x = ((c - min_char) % grid_size) * max_glyph_size.x;
-                    tex_array_dst.y = glyph_texture_dim.y - (((c - min_char) / grid_size) + 1) * max_glyph_size.y;
-                    //tex_array_dst.x = (c & 0x0F) * max_glyph_size.x;
-                    //tex_array_dst.y = glyph_texture_dim.y - ((c >> 4) + 1) * max_glyph_size.y;
-                    tex_array_dst.z = i;
-
-                    vec2i cur_core_box = vec2i(bitmap.width / glyph_bitmap_ycomp, bitmap.rows);
-                    vec2i cur_bm_bearing = vec2i(ft_font.get_face()->glyph->bitmap_left, ft_font.get_face()->glyph->bitmap_top - ft_font.get_face()->glyph->bitmap.rows);
-                    vec2i box_diff = vec2i::zero();
-                    if (_border_size > 0) {
-                        box_diff.x = max(0, cur_bm_bearing.x - cur_glyph._border_bearing.x);
-                        box_diff.y = max(0, cur_bm_bearing.y - cur_glyph._border_bearing.y);
-                    }
-                    cur_glyph._box_size.x = max(cur_glyph._box_size.x, cur_core_box.x);
-                    cur_glyph._box_size.y = max(cur_glyph._box_size.y, cur_core_box.y);
-
-                    cur_glyph._texture_origin   = vec2f(static_cast<float>(tex_array_dst.x) / glyph_texture_dim.x,
-                                                        static_cast<float>(tex_array_dst.y) / glyph_texture_dim.y);
-                    cur_glyph._texture_box_size = vec2f(static_cast<float>(cur_glyph._box_size.x) / glyph_texture_dim.x,
-                                                        static_cast<float>(cur_glyph._box_size.y) / glyph_texture_dim.y);
-
-                    if (ft_font.get_face()->face_flags & FT_FACE_FLAG_SCALABLE) {
-                        // linearHoriAdvance contains the 16.16 representation of the horizontal advance
-                        // horiAdvance contains only the rounded advance which can be off by 1 and
-                        // lead to sub styles beeing rendered to narrow
-                        cur_glyph._advance          =  FT_CeilFix(ft_font.get_face()->glyph->linearHoriAdvance) >> 16;
-                    }
-                    else if (ft_font.get_face()->face_flags & FT_FACE_FLAG_FIXED_SIZES) {
-                        cur_glyph._advance          = ft_font.get_face()->glyph->metrics.horiAdvance >> 6;
-                    }
-                    cur_glyph._bearing          = //vec2i(   ft_font.get_face()->glyph->metrics.horiBearingX >> 6,
-                                                  //        (ft_font.get_face()->glyph->metrics.horiBearingY >> 6)
-                                                  //      - (ft_font.get_face()->glyph->metrics.height >> 6))
-                                                    cur_bm_bearing
-                                                  - box_diff;
-                                                  //+ cur_glyph._border_bearing;
-                    // fill texture
-                    switch (bitmap.pixel_mode) {
-                        case FT_PIXEL_MODE_GRAY:
-                            for (unsigned dy = 0; dy < bitmap.rows; ++dy) {
-                                unsigned src_off = dy * bitmap.pitch;
-                                unsigned dst_off =    tex_array_dst.x + box_diff.x
-                                                   + (tex_array_dst.y + box_diff.y + bitmap.rows - 1 - dy) * glyph_texture_dim.x
-                                                   + i * (glyph_texture_dim.x * glyph_texture_dim.y);
-                                for (unsigned dx = 0; dx < bitmap.width; ++dx) {
-                                    glyph_texture[(dst_off + dx) * glyph_components] = bitmap.buffer[src_off + dx];
-                                }
-                            }
-                            break;
-                        case FT_PIXEL_MODE_LCD:
-                            for (unsigned dy = 0; dy < bitmap.rows; ++dy) {
-                                unsigned src_off = dy * bitmap.pitch;
-                                unsigned dst_off =    tex_array_dst.x + box_diff.x
-                                                   + (tex_array_dst.y + box_diff.y + bitmap.rows - 1 - dy) * glyph_texture_dim.x
-                                                   + i * (glyph_texture_dim.x * glyph_texture_dim.y);
-                                for (unsigned dx = 0; dx < bitmap.width / glyph_bitmap_ycomp; ++dx) {
-                                    glyph_texture[(dst_off + dx) * glyph_components    ] = bitmap.buffer[src_off + dx * glyph_bitmap_ycomp];
-                                    glyph_texture[(dst_off + dx) * glyph_components + 1] = bitmap.buffer[src_off + dx * glyph_bitmap_ycomp + 1];
-                                    glyph_texture[(dst_off + dx) * glyph_components + 2] = bitmap.buffer[src_off + dx * glyph_bitmap_ycomp + 2];
-                                }
-                            }
-                            break;
-                        case FT_PIXEL_MODE_MONO:
-                            for (unsigned dy = 0; dy < bitmap.rows; ++dy) {
-                                for (int dx = 0; dx < bitmap.pitch; ++dx) {
-                                    unsigned        src_off     = dx + dy * bitmap.pitch;
-                                    unsigned char   src_byte    = bitmap.buffer[src_off];
-                                    for (int bx = 0; bx < 8; ++bx) {
-                                        unsigned        dst_off =   (tex_array_dst.x + box_diff.x + dx * 8 + bx)
-                                                                  + (tex_array_dst.y + box_diff.y + bitmap.rows - 1 - dy) * glyph_texture_dim.x
-                                                                  + i * (glyph_texture_dim.x * glyph_texture_dim.y);
-                                        unsigned char   src_set = src_byte & (0x80 >> bx);
-                                        unsigned char*  plah    = &src_byte;
-                                        for (int l = 0; l < glyph_components; ++l) {
-                                            glyph_texture[dst_off * glyph_components + l] = src_set ? 255u : 0u;
-                                        }
-                                    }
-                                }
-                            }
-                            break;
-                        default:
-                            continue;
-                    }
-                }
-            }
-            // end generate texture image
-            std::vector<void*> image_array_data_raw;
-            image_array_data_raw.push_back(glyph_texture.get());
-
-            _font_styles_texture_array = device->create_texture_2d(vec2ui(glyph_texture_dim.x, glyph_texture_dim.y),
-                                                                   glyph_texture_format, 1, glyph_texture_dim.z, 1,
-                                                                   glyph_texture_format, image_array_data_raw);
-
-            if (!_font_styles_texture_array) {
-                std::ostringstream s;
-                s << "font_face::font_face(): unable to create texture object.";
-                throw(std::runtime_error(s.str()));
-            }
-
-            image_array_data_raw.clear();
         }
+        _atlas_layers.resize(atlas_layers);
 
-        glyph_texture.reset();
+        const double atlas_memory =   static_cast<double>(_atlas_size.x) * _atlas_size.y * atlas_layers
+                                    * size_of_format(ft._texture_format) / 1024.0;
 
         std::stringstream os;
         os << std::fixed << std::setprecision(2)
            << "font_face::font_face(): " << std::endl
-           << " - created font textures for font '" << font_file << "' "
+           << " - created glyph atlas for font '" << font_file << "' "
            << "(point size: " << point_size << ", border size: " << border_size << ")" << std::endl
-           << "   - style texture:  format " << gl::format_string(glyph_texture_format)
-                << ", size " <<      glyph_texture_dim
-                << ", glyph box " << max_glyph_size
-                << ", memory " <<      static_cast<double>(glyph_texture_dim.x * glyph_texture_dim.y * glyph_texture_dim.z * size_of_format(glyph_texture_format)) / 1024.0 << "KiB";
+           << "   - style atlas:  format " << gl::format_string(ft._texture_format)
+                << ", size " <<      vec3ui(_atlas_size, atlas_layers)
+                << ", max glyph box " << max_glyph_size
+                << ", memory " <<      atlas_memory << "KiB";
         if (_border_size > 0) {
             os << std::endl
-               << "   - border texture: format " << gl::format_string(glyph_texture_format)
-               << ", size " <<      glyph_texture_dim
-               << ", glyph box " << max_glyph_size
-               << ", memory " <<      static_cast<double>(glyph_texture_dim.x * glyph_texture_dim.y * glyph_texture_dim.z * size_of_format(glyph_texture_format)) / 1024.0 << "KiB";
+               << "   - border atlas: format " << gl::format_string(ft._texture_format)
+               << ", size " <<      vec3ui(_atlas_size, atlas_layers)
+               << ", memory " <<      atlas_memory << "KiB";
+        }
+        if (smooth_type == smooth_distance_field) {
+            _df_context.reset(new df_context);
+            _df_context->_workers   = df_context::shared_workers();
+            _df_context->_generator.reset(new df_context::generator);
+
+            df_context::generator& gen = *_df_context->_generator;
+            for (int i = 0; i < style_count; ++i) {
+                gen._style_files.push_back(_font_styles_available[i] ? font_style_files[i] : font_style_files[0]);
+            }
+            gen._font_size = font_size;
+            gen._dpi       = display_dpi;
+            gen._spread    = _distance_field_spread;
+
+            os << std::endl
+               << "   - distance field: spread " << _distance_field_spread
+               << ", supersampling " << distance_field_supersampling
+               << ", worker threads " << _df_context->_workers->thread_count();
         }
         glout() << log::info << os.str();
 
@@ -647,9 +735,19 @@ font_face::has_style(style_type s) const
 }
 
 const font_face::glyph_info&
-font_face::glyph(char c, style_type s) const
+font_face::glyph(scm::uint32 c, style_type s) const
 {
-    return (_font_styles[s]._glyphs[c]);
+    const glyph_key             k = (static_cast<glyph_key>(c) << 2) | static_cast<glyph_key>(s);
+    glyph_map::const_iterator   g = _glyphs.find(k);
+
+    if (g == _glyphs.end()) {
+        return (_df_context ? place_distance_field_glyph(c, s) : render_glyph(c, s));
+    }
+    if (g->second._box_size.x > 0) { // empty glyphs (e.g. space) are not placed in the atlas
+        _atlas_layers[g->second._texture_layer]._last_use = ++_atlas_use_count;
+    }
+
+    return (g->second);
 }
 
 unsigned
@@ -659,9 +757,32 @@ font_face::line_advance(style_type s) const
 }
 
 int
-font_face::kerning(char l, char r, style_type s) const
+font_face::kerning(scm::uint32 l, scm::uint32 r, style_type s) const
 {
-    return (_font_styles[s]._kerning_table[l][r]);
+    return (_ft_context->_faces[s]->get_kerning(l, r));
+}
+
+void
+font_face::request_glyphs(const std::vector<scm::uint32>& c, style_type s) const
+{
+    if (!_df_context) {
+        return;
+    }
+    for (std::vector<scm::uint32>::const_iterator i = c.begin(); i != c.end(); ++i) {
+        const glyph_key k = (static_cast<glyph_key>(*i) << 2) | static_cast<glyph_key>(s);
+        if (   _glyphs.find(k) == _glyphs.end()
+            && _df_context->_jobs.find(k) == _df_context->_jobs.end()) {
+            shared_ptr<df_context::job> j(new df_context::job(*i, s));
+            _df_context->_jobs[k] = j;
+            _df_context->_workers->submit(boost::bind(&df_context::generator::run, _df_context->_generator, j));
+        }
+    }
+}
+
+unsigned
+font_face::distance_field_spread() const
+{
+    return (_distance_field_spread);
 }
 
 int
@@ -676,14 +797,6 @@ font_face::underline_thickness(style_type s) const
     return (_font_styles[s]._underline_thickness);
 }
 
-void
-font_face::cleanup()
-{
-    _font_styles.clear();
-    _font_styles_available.clear();
-    _font_styles_texture_array.reset();
-}
-
 const texture_2d_ptr&
 font_face::styles_texture_array() const
 {
@@ -696,5 +809,300 @@ font_face::styles_border_texture_array() const
     return (_font_styles_border_texture_array);
 }
 
+scm::size_t
+font_face::atlas_generation() const
+{
+    return (_atlas_generation);
+}
+
+scm::size_t
+font_face::cached_glyph_count() const
+{
+    return (_glyphs.size());
+}
+
+font_face::glyph_info&
+font_face::render_glyph(scm::uint32 c, style_type s) const
+{
+    using namespace scm::math;
+
+    const glyph_key k         = (static_cast<glyph_key>(c) << 2) | static_cast<glyph_key>(s);
+    glyph_info&     cur_glyph = _glyphs[k]; // failed glyphs stay empty and are not retried
+    ft_context&     ft        = *_ft_context;
+    detail::ft_face& ft_font  = *ft._faces[s];
+    FT_Glyph        ft_glyph  = 0;
+
+    try {
+        // border
+        vec2i border_box     = vec2i::zero();
+        vec2i border_bearing = vec2i::zero();
+        if (ft._stroker) {
+            FT_Error ft_err;
+
+            ft_font.load_glyph(c, ft._load_flags);
+            ft_err = FT_Get_Glyph(ft_font.get_glyph(), &ft_glyph);
+            if (ft_err) {
+                throw std::runtime_error("error during FT_Get_Glyph");
+            }
+            ft_err = FT_Glyph_Stroke(&ft_glyph, ft._stroker->get_stroker(), true);
+            if (ft_err) {
+                throw std::runtime_error("error during FT_Glyph_Stroke");
+            }
+            ft_err = FT_Glyph_To_Bitmap(&ft_glyph, ft._render_mode, 0, true);
+            if (ft_err) {
+                throw std::runtime_error("error during FT_Glyph_To_Bitmap");
+            }
+            FT_BitmapGlyph ft_bitmap_glyph = (FT_BitmapGlyph)ft_glyph;
+            border_box     = vec2i(ft_bitmap_glyph->bitmap.width / ft._bitmap_ycomp, ft_bitmap_glyph->bitmap.rows);
+            border_bearing = vec2i(ft_bitmap_glyph->left, ft_bitmap_glyph->top - ft_bitmap_glyph->bitmap.rows);
+        }
+
+        // core
+        ft_font.load_glyph(c, ft._load_flags);
+        if (FT_Render_Glyph(ft_font.get_glyph(), ft._render_mode)) {
+            throw std::runtime_error("error during FT_Render_Glyph");
+        }
+        const FT_Bitmap& bitmap = ft_font.get_glyph()->bitmap;
+
+        vec2i core_box     = vec2i(bitmap.width / ft._bitmap_ycomp, bitmap.rows);
+        vec2i core_bearing = vec2i(ft_font.get_glyph()->bitmap_left, ft_font.get_glyph()->bitmap_top - bitmap.rows);
+        vec2i box_diff     = vec2i::zero();
+        if (ft._stroker) {
+            box_diff.x = max(0, core_bearing.x - border_bearing.x);
+            box_diff.y = max(0, core_bearing.y - border_bearing.y);
+        }
+        cur_glyph._box_size.x = max(border_box.x, core_box.x);
+        cur_glyph._box_size.y = max(border_box.y, core_box.y);
+        cur_glyph._bearing    = core_bearing - box_diff;
+
+        if (ft_font.get_face()->face_flags & FT_FACE_FLAG_SCALABLE) {
+            // linearHoriAdvance contains the 16.16 representation of the horizontal advance
+            // horiAdvance contains only the rounded advance which can be off by 1 and
+            // lead to sub styles beeing rendered to narrow
+            cur_glyph._advance = FT_CeilFix(ft_font.get_glyph()->linearHoriAdvance) >> 16;
+        }
+        else if (ft_font.get_face()->face_flags & FT_FACE_FLAG_FIXED_SIZES) {
+            cur_glyph._advance = ft_font.get_glyph()->metrics.horiAdvance >> 6;
+        }
+
+        if (cur_glyph._box_size.x > 0 && cur_glyph._box_size.y > 0) {
+            const vec2i                 image_box = max(cur_glyph._box_size, box_diff + core_box);
+            std::vector<unsigned char>  image(image_box.x * image_box.y * ft._components, 0u);
+            std::vector<unsigned char>  border_image;
+
+            if (ft._stroker) {
+                border_image.resize(image.size(), 0u);
+                detail::copy_glyph_bitmap(((FT_BitmapGlyph)ft_glyph)->bitmap, vec2i::zero(),
+                                          image_box.x, ft._components, ft._bitmap_ycomp, &border_image[0]);
+            }
+            detail::copy_glyph_bitmap(bitmap, box_diff,
+                                      image_box.x, ft._components, ft._bitmap_ycomp, &image[0]);
+
+            place_glyph_image(k, cur_glyph, image_box, &image[0], ft._stroker ? &border_image[0] : 0);
+        }
+    }
+    catch (const std::exception& e) {
+        glerr() << log::error
+                << "font_face::render_glyph(): unable to render glyph "
+                << "(font: " << _name << ", code point: " << c << ", style: " << s << "): " << e.what() << "." << log::end;
+        cur_glyph = glyph_info();
+    }
+    if (ft_glyph) {
+        FT_Done_Glyph(ft_glyph);
+    }
+
+    return (cur_glyph);
+}
+
+font_face::glyph_info&
+font_face::place_distance_field_glyph(scm::uint32 c, style_type s) const
+{
+    const glyph_key             k  = (static_cast<glyph_key>(c) << 2) | static_cast<glyph_key>(s);
+    df_context&                 df = *_df_context;
+    df_context::job_map::iterator j = df._jobs.find(k);
+
+    if (j == df._jobs.end()) {
+        request_glyphs(std::vector<scm::uint32>(1, c), s);
+        j = df._jobs.find(k);
+    }
+    shared_ptr<df_context::job> cur_job = j->second;
+    df._jobs.erase(j);
+    {
+        boost::mutex::scoped_lock lock(df._generator->_mutex);
+        while (!cur_job->_done) {
+            df._generator->_job_done.wait(lock);
+        }
+    }
+
+    glyph_info& cur_glyph = _glyphs[k]; // failed glyphs stay empty and are not retried
+
+    try {
+        if (!cur_job->_error.empty()) {
+            throw std::runtime_error(cur_job->_error);
+        }
+        cur_glyph = cur_job->_glyph;
+        if (cur_glyph._box_size.x > 0 && cur_glyph._box_size.y > 0) {
+            place_glyph_image(k, cur_glyph, cur_glyph._box_size, &cur_job->_field[0], 0);
+        }
+    }
+    catch (const std::exception& e) {
+        glerr() << log::error
+                << "font_face::place_distance_field_glyph(): unable to generate glyph "
+                << "(font: " << _name << ", code point: " << c << ", style: " << s << "): " << e.what() << "." << log::end;
+        cur_glyph = glyph_info();
+    }
+
+    return (cur_glyph);
+}
+
+void
+font_face::place_glyph_image(glyph_key                 k,
+                             glyph_info&               g,
+                             const math::vec2i&        image_box,
+                             const unsigned char*      image,
+                             const unsigned char*      border_image) const
+{
+    using namespace scm::math;
+
+    const unsigned      components = static_cast<unsigned>(_ft_context->_components);
+    const data_format   format     = _ft_context->_texture_format;
+
+    // one texel space to the neighbours, rows aligned to four texels for the upload
+    vec2ui              region_size((((image_box.x + 1) + 3) / 4) * 4, image_box.y + 1);
+    vec3ui              region_origin;
+
+    if (!allocate_atlas_region(region_size, region_origin)) {
+        std::ostringstream s;
+        s << "glyph larger than the atlas (glyph box: " << image_box << ", atlas size: " << _atlas_size << ")";
+        throw std::runtime_error(s.str());
+    }
+    render_device_ptr device = _device.lock();
+    if (!device) {
+        throw std::runtime_error("unable to obtain render device from weak pointer");
+    }
+    const render_context_ptr& context = device->main_context();
+    const texture_region      region(region_origin, vec3ui(region_size, 1u));
+
+    // the whole region is uploaded to clear the remains of evicted glyphs
+    std::vector<unsigned char>  region_image(region_size.x * region_size.y * components, 0u);
+    const unsigned char*        images[]   = { border_image, image };
+    const texture_2d_ptr*       textures[] = { &_font_styles_border_texture_array, &_font_styles_texture_array };
+
+    for (int i = 0; i < 2; ++i) {
+        if (images[i]) {
+            for (int y = 0; y < image_box.y; ++y) {
+                std::memcpy(&region_image[y * region_size.x * components],
+                            images[i] + y * image_box.x * components,
+                            image_box.x * components);
+            }
+            context->update_sub_texture(*textures[i], region, 0, format, &region_image[0]);
+        }
+    }
+
+    g._texture_origin   = vec2f(static_cast<float>(region_origin.x) / _atlas_size.x,
+                                static_cast<float>(region_origin.y) / _atlas_size.y);
+    g._texture_box_size = vec2f(static_cast<float>(g._box_size.x) / _atlas_size.x,
+                                static_cast<float>(g._box_size.y) / _atlas_size.y);
+    g._texture_layer    = region_origin.z;
+
+    atlas_layer& layer = _atlas_layers[region_origin.z];
+    layer._glyphs.push_back(k);
+    layer._last_use = ++_atlas_use_count;
+}
+
+bool
+font_face::allocate_atlas_region(math::vec2ui& io_size,
+                                 math::vec3ui& out_origin) const
+{
+    if (io_size.x > _atlas_size.x || io_size.y > _atlas_size.y) {
+        return (false);
+    }
+    for (unsigned l = 0; l < _atlas_layers.size(); ++l) {
+        if (allocate_in_layer(l, io_size, out_origin)) {
+            return (true);
+        }
+    }
+
+    // atlas full, evict the least recently used layer
+    unsigned lru_layer = 0;
+    for (unsigned l = 1; l < _atlas_layers.size(); ++l) {
+        if (_atlas_layers[l]._last_use < _atlas_layers[lru_layer]._last_use) {
+            lru_layer = l;
+        }
+    }
+    evict_atlas_layer(lru_layer);
+
+    return (allocate_in_layer(lru_layer, io_size, out_origin));
+}
+
+bool
+font_face::allocate_in_layer(unsigned      in_layer,
+                             math::vec2ui& io_size,
+                             math::vec3ui& out_origin) const
+{
+    atlas_layer& layer = _atlas_layers[in_layer];
+    atlas_shelf* shelf = 0;
+
+    // lowest shelf with room for the glyph
+    for (std::vector<atlas_shelf>::iterator i = layer._shelves.begin(); i != layer._shelves.end(); ++i) {
+        if (   i->_height >= io_size.y
+            && i->_used_width + io_size.x <= _atlas_size.x
+            && (!shelf || i->_height < shelf->_height)) {
+            shelf = &(*i);
+        }
+    }
+    // a new shelf if the best one wastes more than half the glyph height
+    if (   (!shelf || shelf->_height > io_size.y + io_size.y / 2)
+        && layer._used_height + io_size.y <= _atlas_size.y) {
+        atlas_shelf new_shelf;
+        new_shelf._y          = layer._used_height;
+        new_shelf._height     = io_size.y;
+        new_shelf._used_width = 0;
+
+        layer._shelves.push_back(new_shelf);
+        layer._used_height += io_size.y;
+        shelf = &layer._shelves.back();
+    }
+    if (!shelf) {
+        return (false);
+    }
+
+    out_origin = math::vec3ui(shelf->_used_width, shelf->_y, in_layer);
+    io_size.y  = shelf->_height; // the region covers the shelf height
+
+    shelf->_used_width += io_size.x;
+
+    return (true);
+}
+
+void
+font_face::evict_atlas_layer(unsigned in_layer) const
+{
+    atlas_layer& layer = _atlas_layers[in_layer];
+
+    for (std::vector<glyph_key>::const_iterator k = layer._glyphs.begin(); k != layer._glyphs.end(); ++k) {
+        _glyphs.erase(*k);
+    }
+    layer._glyphs.clear();
+    layer._shelves.clear();
+    layer._used_height = 0;
+    layer._last_use    = 0;
+
+    ++_atlas_generation;
+}
+
+void
+font_face::cleanup()
+{
+    _glyphs.clear();
+    _atlas_layers.clear();
+    _font_styles.clear();
+    _font_styles_available.clear();
+    _font_styles_texture_array.reset();
+    _font_styles_border_texture_array.reset();
+    _df_context.reset();
+    _ft_context.reset();
+}
+
 } // namespace gl
 } // namespace scm
@@ -10,9 +10,11 @@
 #include <string>
 #include <vector>
 
-#include <boost/multi_array.hpp>
+#include <boost/unordered_map.hpp>
 
 #include <scm/core/math.h>
+#include <scm/core/memory.h>
+#include <scm/core/numeric_types.h>
 
 #include <scm/gl_core/gl_core_fwd.h>
 
@@ -24,6 +26,13 @@
 namespace scm {
 namespace gl {
 
+// glyphs are rasterized on first use into a glyph atlas (a 2d texture array), every array
+// layer is packed with shelves of glyphs of all styles, when the atlas is full the least
+// recently used layer is evicted and atlas_generation() changes, glyph infos retrieved
+// before are stale then
+//  - smooth_distance_field faces store signed distance fields generated from the glyph
+//    outlines on a worker thread pool, the point size is the base size of the fields,
+//    the texts are scaled and outlined by the renderer instead of separate faces
 class __scm_export(gl_util) font_face
 {
 public:
@@ -38,12 +47,14 @@ public:
     typedef enum {
         smooth_normal   = 0x00,
         smooth_lcd,
+        smooth_distance_field,
 
         smooth_count
     } smooth_type;
     struct glyph_info {
         math::vec2f    _texture_origin;
         math::vec2f    _texture_box_size;
+        unsigned       _texture_layer;
 
         math::vec2i    _box_size;
         math::vec2i    _border_bearing;
@@ -53,6 +64,7 @@ public:
         glyph_info()
           : _texture_origin(math::vec2f::zero())
           , _texture_box_size(math::vec2f::zero())
+          , _texture_layer(0)
           , _box_size(math::vec2i::zero())
           , _border_bearing(math::vec2i::zero())
           , _advance(0)
@@ -61,33 +73,52 @@ public:
         }
     }; // struct glyph_info
 
-    static const unsigned       min_char = 32u;
-    static const unsigned       max_char = 128u;
+    static const unsigned       min_char = 32u;             // first printable code point
 
     static const unsigned       default_point_size   = 12;
     //static const float          default_border_size  = 0.0f;
     static const unsigned       default_display_dpi  = 72;
     static const smooth_type    default_smooth_style = smooth_normal;
+    static const unsigned       default_atlas_layers = 4;
+    static const unsigned       distance_field_supersampling = 4; // outline rasterization per field texel
 
 protected:
-    typedef std::vector<glyph_info>     glyph_container;
-    typedef boost::multi_array<char, 2> kerning_table;
     struct font_style {
-        glyph_container _glyphs;
-        kerning_table   _kerning_table;
         int             _underline_position;
         unsigned        _underline_thickness;
         unsigned        _line_spacing;
     }; // struct style_info
     typedef std::vector<font_style>     style_container;
 
+    struct ft_context;  // FreeType library, stroker and one face per style
+    struct df_context;  // distance field jobs and the worker FreeType faces
+
+    typedef scm::uint64                                 glyph_key;  // code point and style
+    typedef boost::unordered_map<glyph_key, glyph_info> glyph_map;
+
+    struct atlas_shelf {
+        unsigned        _y;
+        unsigned        _height;
+        unsigned        _used_width;
+    }; // struct atlas_shelf
+    struct atlas_layer {
+        atlas_layer() : _used_height(0), _last_use(0) {}
+
+        std::vector<atlas_shelf>    _shelves;
+        unsigned                    _used_height;
+        scm::uint64                 _last_use;
+        std::vector<glyph_key>      _glyphs;
+    }; // struct atlas_layer
+    typedef std::vector<atlas_layer>    atlas_layer_container;
+
 public:
     font_face(const render_device_ptr& device,                  
               const std::string&       font_file,
               unsigned                 point_size  = default_point_size,
               float                    border_size = 0.0f,//default_border_size,
               smooth_type              smooth_type = default_smooth_style,
-              unsigned                 display_dpi = default_display_dpi);
+              unsigned                 display_dpi = default_display_dpi,
+              unsigned                 atlas_layers = default_atlas_layers);
     virtual ~font_face();
 
     const std::string&              name() const;
@@ -97,9 +128,15 @@ public:
     smooth_type                     smooth_style() const;
     bool                            has_style(style_type s) const;
 
-    const glyph_info&               glyph(char c, style_type s = style_regular) const;
+    // rasterizes missing glyphs into the atlas, the reference is valid until the next call
+    const glyph_info&               glyph(scm::uint32 c, style_type s = style_regular) const;
     unsigned                        line_advance(style_type s = style_regular) const;
-    int                             kerning(char l, char r, style_type s = style_regular) const;
+    int                             kerning(scm::uint32 l, scm::uint32 r, style_type s = style_regular) const;
+    // starts the generation of missing distance field glyphs on the worker threads, the
+    // glyph lookup waits for them, no effect on the other smoothing styles
+    void                            request_glyphs(const std::vector<scm::uint32>& c, style_type s = style_regular) const;
+    // distance range in texels of the base size covered by the distance field values
+    unsigned                        distance_field_spread() const;
 
     int                             underline_position(style_type s = style_regular) const;
     int                             underline_thickness(style_type s = style_regular) const;
@@ -107,22 +144,52 @@ public:
     const texture_2d_ptr&           styles_texture_array() const;
     const texture_2d_ptr&           styles_border_texture_array() const;
 
+    scm::size_t                     atlas_generation() const;   // changes when glyphs are evicted
+    scm::size_t                     cached_glyph_count() const;
+
 protected:
-    void                            render_glyphs();
+    glyph_info&                     render_glyph(scm::uint32 c, style_type s) const;
+    glyph_info&                     place_distance_field_glyph(scm::uint32 c, style_type s) const;
+    // uploads the bottom up glyph images (image_box texels, border image optional) into a
+    // new atlas region and sets the texture coordinates of the glyph, throws on failure
+    void                            place_glyph_image(glyph_key                 k,
+                                                      glyph_info&               g,
+                                                      const math::vec2i&        image_box,
+                                                      const unsigned char*      image,
+                                                      const unsigned char*      border_image) const;
+    // the region height is extended to the height of the shelf it is placed in
+    bool                            allocate_atlas_region(math::vec2ui& io_size,
+                                                          math::vec3ui& out_origin) const;
+    bool                            allocate_in_layer(unsigned      in_layer,
+                                                      math::vec2ui& io_size,
+                                                      math::vec3ui& out_origin) const;
+    void                            evict_atlas_layer(unsigned in_layer) const;
 
     void                            cleanup();
 
 protected:
+    render_device_wptr              _device;
+    shared_ptr<ft_context>          _ft_context;
+    shared_ptr<df_context>          _df_context;
+
     style_container                 _font_styles;
     std::vector<bool>               _font_styles_available;
     texture_2d_ptr                  _font_styles_texture_array;
     texture_2d_ptr                  _font_styles_border_texture_array;
     smooth_type                     _font_smooth_style;
 
+    // glyph atlas, filled lazily by the const glyph lookup
+    mutable glyph_map               _glyphs;
+    mutable atlas_layer_container   _atlas_layers;
+    math::vec2ui                    _atlas_size;
+    mutable scm::uint64             _atlas_use_count;
+    mutable scm::size_t             _atlas_generation;
+
     std::string                     _name;
     unsigned                        _point_size;
     unsigned                        _border_size;
     unsigned                        _dpi;
+    unsigned                        _distance_field_spread;
 
 }; // class font_face
 
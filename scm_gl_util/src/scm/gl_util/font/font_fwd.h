@@ -12,6 +12,7 @@ namespace gl {
 
 class font_face;
 class text;
+class text_batch;
 class text_renderer;
 
 typedef shared_ptr<font_face>           font_face_ptr;
@@ -20,6 +21,9 @@ typedef shared_ptr<const font_face>     font_face_cptr;
 typedef shared_ptr<text>                text_ptr;
 typedef shared_ptr<const text>          text_cptr;
 
+typedef shared_ptr<text_batch>          text_batch_ptr;
+typedef shared_ptr<const text_batch>    text_batch_cptr;
+
 typedef shared_ptr<text_renderer>       text_renderer_ptr;
 typedef shared_ptr<const text_renderer> text_renderer_cptr;
 
@@ -11,6 +11,7 @@
 #include <stdexcept>
 #include <string>
 #include <sstream>
+#include <vector>
 
 #include <boost/assign/list_of.hpp>
 
@@ -22,6 +23,7 @@
 #include <scm/gl_core/buffer_objects/scoped_buffer_map.h>
 
 #include <scm/gl_util/font/font_face.h>
+#include <scm/gl_util/font/detail/utf8.h>
 
 #define GEOM_SHADER_FONT 1
 
@@ -30,11 +32,13 @@ struct vertex {
 #if GEOM_SHADER_FONT == 1
     scm::math::vec4f pos_bbox;
     scm::math::vec4f tex_bbox;
+    float            tex_layer;
 #else
     scm::math::vec2f pos;
-    scm::math::vec2f tex;
+    scm::math::vec3f tex;
 #endif
 };
+
 } // namespace
 
 namespace scm {
@@ -52,7 +56,10 @@ text::text(const render_device_ptr&     device,
   , _text_outline_color(math::vec4f(0.0f, 0.0f, 0.0f, 1.0f))
   , _text_shadow_color(math::vec4f(0.0f, 0.0f, 0.0f, 1.0f))
   , _text_shadow_offset(math::vec2i(1, -1))
+  , _text_scale(1.0f)
+  , _text_outline_width(1.0f)
   , _text_bounding_box(math::vec2i(0, 0))
+  , _font_generation(0)
   , _indices_count(0)
   , _topology(PRIMITIVE_TRIANGLE_LIST)
   , _glyph_capacity(20)
@@ -65,7 +72,8 @@ text::text(const render_device_ptr&     device,
     int num_vertices = _glyph_capacity; // one point per glyph 
     _vertex_buffer = device->create_buffer(BIND_VERTEX_BUFFER, USAGE_STREAM_DRAW, num_vertices * sizeof(vertex), 0);
     _vertex_array  = device->create_vertex_array(vertex_format(0, 0, TYPE_VEC4F, sizeof(vertex))
-                                                              (0, 2, TYPE_VEC4F, sizeof(vertex)),
+                                                              (0, 2, TYPE_VEC4F, sizeof(vertex))
+                                                              (0, 3, TYPE_FLOAT, sizeof(vertex)),
                                                  list_of(_vertex_buffer));
 #else
     int num_vertices = _glyph_capacity * 4; // one quad per glyph 
@@ -73,7 +81,7 @@ text::text(const render_device_ptr&     device,
     _vertex_buffer = device->create_buffer(BIND_VERTEX_BUFFER, USAGE_STREAM_DRAW, num_vertices * sizeof(vertex), 0);
     _index_buffer  = device->create_buffer(BIND_INDEX_BUFFER, USAGE_STREAM_DRAW,  num_indices  * sizeof(unsigned short), 0);
     _vertex_array  = device->create_vertex_array(vertex_format(0, 0, TYPE_VEC2F, sizeof(vertex))
-                                                              (0, 2, TYPE_VEC2F, sizeof(vertex)),
+                                                              (0, 2, TYPE_VEC3F, sizeof(vertex)),
                                                  list_of(_vertex_buffer));
 
     // fill index data
@@ -196,12 +204,42 @@ text::text_shadow_offset(const math::vec2i& o)
     _text_shadow_offset = o;
 }
 
+float
+text::text_scale() const
+{
+    return _text_scale;
+}
+
+void
+text::text_scale(float s)
+{
+    _text_scale = s;
+}
+
+float
+text::text_outline_width() const
+{
+    return _text_outline_width;
+}
+
+void
+text::text_outline_width(float w)
+{
+    _text_outline_width = w;
+}
+
 const math::vec2i&
 text::text_bounding_box() const
 {
     return _text_bounding_box;
 }
 
+bool
+text::glyphs_outdated() const
+{
+    return _font_generation != _font->atlas_generation();
+}
+
 void
 text::update()
 {
@@ -263,10 +301,24 @@ text::update()
     if (render_context_ptr context = _render_context.lock()) {
         using namespace scm::math;
 
+        if (_font->smooth_style() == font_face::smooth_distance_field) {
+            // start the generation of all missing glyphs before the layout waits for them
+            std::vector<scm::uint32>    code_points;
+            std::string::const_iterator c = _text_string.begin();
+            while (c != _text_string.end()) {
+                const scm::uint32 cur_char = detail::decode_utf8(c, _text_string.end());
+                if (font_face::min_char <= cur_char) {
+                    code_points.push_back(cur_char);
+                }
+            }
+            _font->request_glyphs(code_points, _text_style);
+        }
+
 #if GEOM_SHADER_FONT == 1
         if (_text_string.empty()) {
             _indices_count     = 0;
             _text_bounding_box = math::vec2i(0, 0);
+            _font_generation   = _font->atlas_generation();
         }
         else {
             scoped_buffer_map vb_map(context, _vertex_buffer, 0, _text_string.size() * sizeof(vertex), ACCESS_WRITE_INVALIDATE_BUFFER);
@@ -277,17 +329,85 @@ text::update()
                 return;
             }
             vertex*const    vertex_data = reinterpret_cast<vertex*const>(vb_map.data_ptr());
+
+            // glyphs rasterized for this text can evict glyphs placed before by the same
+            // text from the font atlas, the layout is repeated once in this case
+            for (int pass = 0; pass < 2; ++pass) {
+                vec2i           current_pos = vec2i(0, 0);
+                int             current_lw  = 0;
+                scm::uint32     prev_char   = 0;
+
+                _font_generation   = _font->atlas_generation();
+                _indices_count     = 0;
+                _text_bounding_box = vec2i(0, _font->line_advance(_text_style));
+                assert(_text_string.size() < (6 * (std::numeric_limits<unsigned short>::max)()));
+
+                std::string::const_iterator c = _text_string.begin();
+                while (c != _text_string.end()) {
+                    const scm::uint32 cur_char = detail::decode_utf8(c, _text_string.end());
+
+                    if (cur_char == '\n') {
+                        current_pos.x         = 0;
+                        current_pos.y        -= _font->line_advance(_text_style);
+                        prev_char             = 0;
+                        _text_bounding_box.y += _font->line_advance(_text_style);
+                        _text_bounding_box.x  = max(current_lw, _text_bounding_box.x);
+                        current_lw            = 0;
+                    }
+                    else if (font_face::min_char <= cur_char) {
+                        const font_face::glyph_info& cur_glyph = _font->glyph(cur_char, _text_style);
+                        // kerning
+                        if (_text_kerning && prev_char) {
+                            current_pos.x += _font->kerning(prev_char, cur_char, _text_style);
+                        }
+
+                        vec2f pos  = vec2f(current_pos + cur_glyph._bearing);   
+                        vec2f bbox = vec2f(cur_glyph._box_size);   
+                        vertex_data[_indices_count].pos_bbox  = vec4f(pos, bbox.x, bbox.y);
+                        vertex_data[_indices_count].tex_bbox  = vec4f(cur_glyph._texture_origin, cur_glyph._texture_box_size.x, cur_glyph._texture_box_size.y);
+                        vertex_data[_indices_count].tex_layer = static_cast<float>(cur_glyph._texture_layer);
+
+                        _indices_count += 1;
+                        // advance the position
+                        current_pos.x += cur_glyph._advance;
+                        current_lw    += cur_glyph._advance;
+
+                        // remember just drawn glyph for kerning
+                        prev_char = cur_char;
+                    }
+                }
+                _text_bounding_box.x  = max(current_lw, _text_bounding_box.x);
+
+                if (!glyphs_outdated()) {
+                    break;
+                }
+            }
+        }
+#else
+        vertex*         vertex_data = static_cast<vertex*>(context->map_buffer(_vertex_buffer, ACCESS_WRITE_INVALIDATE_BUFFER));
+
+        if (0 == vertex_data) {
+            err() << log::error
+                  << "text::update(): unable to map vertex element or index buffer." << log::end;
+            return;
+        }
+
+        // glyphs rasterized for this text can evict glyphs placed before by the same
+        // text from the font atlas, the layout is repeated once in this case
+        for (int pass = 0; pass < 2; ++pass) {
             vec2i           current_pos = vec2i(0, 0);
             int             current_lw  = 0;
-            char            prev_char   = 0;
+            scm::uint32     prev_char   = 0;
+            size_t          i           = 0;
 
+            _font_generation   = _font->atlas_generation();
             _indices_count     = 0;
             _text_bounding_box = vec2i(0, _font->line_advance(_text_style));
             assert(_text_string.size() < (6 * (std::numeric_limits<unsigned short>::max)()));
 
-            std::for_each(_text_string.begin(), _text_string.end(), [&](char cur_char) -> void {
-                using namespace scm::gl;
-                using namespace scm::math;
+            std::string::const_iterator c = _text_string.begin();
+            while (c != _text_string.end()) {
+                const scm::uint32 cur_char = detail::decode_utf8(c, _text_string.end());
 
                 if (cur_char == '\n') {
                     current_pos.x         = 0;
@@ -297,19 +417,27 @@ text::update()
                     _text_bounding_box.x  = max(current_lw, _text_bounding_box.x);
                     current_lw            = 0;
                 }
-                else if (font_face::min_char <= cur_char && cur_char < font_face::max_char) {
+                else if (font_face::min_char <= cur_char) {
                     const font_face::glyph_info& cur_glyph = _font->glyph(cur_char, _text_style);
                     // kerning
                     if (_text_kerning && prev_char) {
                         current_pos.x += _font->kerning(prev_char, cur_char, _text_style);
                     }
 
-                    vec2f pos  = vec2f(current_pos + cur_glyph._bearing);   
-                    vec2f bbox = vec2f(cur_glyph._box_size);   
-                    vertex_data[_indices_count].pos_bbox = vec4f(pos, bbox.x, bbox.y);
-                    vertex_data[_indices_count].tex_bbox = vec4f(cur_glyph._texture_origin, cur_glyph._texture_box_size.x, cur_glyph._texture_box_size.y);
+                    const float layer = static_cast<float>(cur_glyph._texture_layer);
+
+                    vertex_data[i * 4    ].pos = vec2f(current_pos + cur_glyph._bearing);                                   // 00
+                    vertex_data[i * 4 + 1].pos = vec2f(current_pos + cur_glyph._bearing + vec2i(cur_glyph._box_size.x, 0)); // 10
+                    vertex_data[i * 4 + 2].pos = vec2f(current_pos + cur_glyph._bearing + cur_glyph._box_size);             // 11
+                    vertex_data[i * 4 + 3].pos = vec2f(current_pos + cur_glyph._bearing + vec2i(0, cur_glyph._box_size.y)); // 01
 
-                    _indices_count += 1;
+                    vertex_data[i * 4    ].tex = vec3f(cur_glyph._texture_origin, layer);                                              // 00
+                    vertex_data[i * 4 + 1].tex = vec3f(cur_glyph._texture_origin + vec2f(cur_glyph._texture_box_size.x, 0.0f), layer); // 10
+                    vertex_data[i * 4 + 2].tex = vec3f(cur_glyph._texture_origin + cur_glyph._texture_box_size, layer);                // 11
+                    vertex_data[i * 4 + 3].tex = vec3f(cur_glyph._texture_origin + vec2f(0.0f, cur_glyph._texture_box_size.y), layer); // 01
+
+                    _indices_count += 6;
+                    ++i;
                     // advance the position
                     current_pos.x += cur_glyph._advance;
                     current_lw    += cur_glyph._advance;
@@ -317,80 +445,13 @@ text::update()
                     // remember just drawn glyph for kerning
                     prev_char = cur_char;
                 }
-                else {
-                }
-            });
-            _text_bounding_box.x  = max(current_lw, _text_bounding_box.x);
-        }
-#else
-        vec2i           current_pos = vec2i(0, 0);
-        int             current_lw  = 0;
-        char            prev_char   = 0;
-        //vertex*         vertex_data = static_cast<vertex*>(context->map_buffer_range(_vertex_buffer, 0, 4 * _text_string.size() * sizeof(vertex), ACCESS_WRITE_INVALIDATE_BUFFER));
-        vertex*         vertex_data = static_cast<vertex*>(context->map_buffer(_vertex_buffer, ACCESS_WRITE_INVALIDATE_BUFFER));
-
-        if (0 == vertex_data) {
-            err() << log::error
-                  << "text::update(): unable to map vertex element or index buffer." << log::end;
-            return;
-        }
-
-        _indices_count     = 0;
-        _text_bounding_box = vec2i(0, _font->line_advance(_text_style));
-        assert(_text_string.size() < (6 * (std::numeric_limits<unsigned short>::max)()));
-        //unsigned short str_size = static_cast<unsigned short>( _text_string.size());
-        size_t i = 0;
-        std::for_each(_text_string.begin(), _text_string.end(), [&](char cur_char) -> void {
-        //for (size_t i = 0; i < _text_string.size(); ++i) {
-        //    char  cur_char = _text_string[i];
-
-            using namespace scm::gl;
-            using namespace scm::math;
-
-            if (cur_char == '\n') {
-                current_pos.x         = 0;
-                current_pos.y        -= _font->line_advance(_text_style);
-                prev_char             = 0;
-                _text_bounding_box.y += _font->line_advance(_text_style);
-                _text_bounding_box.x  = max(current_lw, _text_bounding_box.x);
-                current_lw            = 0;
             }
-            else {
-                //if (!isalnum(cur_char) && (cur_char != ' ')) {
-                //    continue;
-                //}
-                const font_face::glyph_info& cur_glyph = _font->glyph(cur_char, _text_style);
-                // kerning
-                if (_text_kerning && prev_char) {
-                    current_pos.x += _font->kerning(prev_char, cur_char, _text_style);
-                }
+            _text_bounding_box.x  = max(current_lw, _text_bounding_box.x);
 
-                vertex_data[i * 4    ].pos = vec2f(current_pos + cur_glyph._bearing);                                   // 00
-                vertex_data[i * 4 + 1].pos = vec2f(current_pos + cur_glyph._bearing + vec2i(cur_glyph._box_size.x, 0)); // 10
-                vertex_data[i * 4 + 2].pos = vec2f(current_pos + cur_glyph._bearing + cur_glyph._box_size);             // 11
-                vertex_data[i * 4 + 3].pos = vec2f(current_pos + cur_glyph._bearing + vec2i(0, cur_glyph._box_size.y)); // 01
-
-                vertex_data[i * 4    ].tex = cur_glyph._texture_origin;                                              // 00
-                vertex_data[i * 4 + 1].tex = cur_glyph._texture_origin + vec2f(cur_glyph._texture_box_size.x, 0.0f); // 10
-                vertex_data[i * 4 + 2].tex = cur_glyph._texture_origin + cur_glyph._texture_box_size;                // 11
-                vertex_data[i * 4 + 3].tex = cur_glyph._texture_origin + vec2f(0.0f, cur_glyph._texture_box_size.y); // 01
-
-                //vertex_data[i * 4    ].tex.z = static_cast<float>(_text_style);
-                //vertex_data[i * 4 + 1].tex.z = static_cast<float>(_text_style);
-                //vertex_data[i * 4 + 2].tex.z = static_cast<float>(_text_style);
-                //vertex_data[i * 4 + 3].tex.z = static_cast<float>(_text_style);
-
-                _indices_count += 6;
-                ++i;
-                // advance the position
-                current_pos.x += cur_glyph._advance;
-                current_lw    += cur_glyph._advance;
-
-                // remember just drawn glyph for kerning
-                prev_char = cur_char;
+            if (!glyphs_outdated()) {
+                break;
             }
-        });
-        _text_bounding_box.x  = max(current_lw, _text_bounding_box.x);
+        }
         
         context->unmap_buffer(_vertex_buffer);
 #endif
@@ -31,7 +31,7 @@ public:
 
     const font_face_cptr&       font() const;
     const font_face::style_type text_style() const;
-    const std::string&          text_string() const;
+    const std::string&          text_string() const;     // UTF-8 encoded
     void                        text_string(const std::string& str);
     void                        text_string(const std::string& str,
                                             const font_face::style_type stl);
@@ -47,10 +47,18 @@ public:
     const math::vec2i&          text_shadow_offset() const;
     void                        text_shadow_offset(const math::vec2i& o);
 
-    const math::vec2i&          text_bounding_box() const;
+    // distance field fonts only, the scale is relative to the point size of the font and
+    // the outline width is given in pixels of the point size
+    float                       text_scale() const;
+    void                        text_scale(float s);
+    float                       text_outline_width() const;
+    void                        text_outline_width(float w);
+
+    const math::vec2i&          text_bounding_box() const; // unscaled
 
 protected:
     void                        update();
+    bool                        glyphs_outdated() const; // glyphs were evicted from the font atlas
 
 protected:
     font_face_cptr              _font;
@@ -62,8 +70,11 @@ protected:
     math::vec4f                 _text_outline_color;
     math::vec4f                 _text_shadow_color;
     math::vec2i                 _text_shadow_offset;
+    float                       _text_scale;
+    float                       _text_outline_width;
 
     math::vec2i                 _text_bounding_box;
+    scm::size_t                 _font_generation;
 
     int                         _glyph_capacity;
     buffer_ptr                  _vertex_buffer;
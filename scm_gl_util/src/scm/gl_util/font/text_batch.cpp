@@ -0,0 +1,546 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include "text_batch.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include <boost/assign/list_of.hpp>
+#include <boost/bind.hpp>
+
+#include <scm/core/utilities/thread_pool.h>
+
+#include <scm/gl_core/log.h>
+#include <scm/gl_core/math.h>
+#include <scm/gl_core/buffer_objects.h>
+#include <scm/gl_core/render_device.h>
+#include <scm/gl_core/shader_objects.h>
+#include <scm/gl_core/state_objects.h>
+#include <scm/gl_core/texture_objects.h>
+
+#include <scm/gl_util/font/text.h>
+#include <scm/gl_util/font/detail/utf8.h>
+
+namespace {
+
+struct vertex {
+    scm::math::vec4f pos_bbox;
+    scm::math::vec4f tex_bbox;
+    scm::math::vec4f color;
+    float            tex_layer;
+};
+
+std::string v_source = "\
+    #version 330 core                                                                               \n\
+                                                                                                    \n\
+    layout(location = 0) in vec4  in_position_bbox;                                                 \n\
+    layout(location = 1) in vec4  in_color;                                                         \n\
+    layout(location = 2) in vec4  in_texcoord_bbox;                                                 \n\
+    layout(location = 3) in float in_texcoord_layer;                                                \n\
+                                                                                                    \n\
+    out per_vertex {                                                                                \n\
+        vec4  position_bbox;                                                                        \n\
+        vec4  texcoord_bbox;                                                                        \n\
+        vec4  color;                                                                                \n\
+        float texcoord_layer;                                                                       \n\
+    } v_out;                                                                                        \n\
+                                                                                                    \n\
+    void main()                                                                                     \n\
+    {                                                                                               \n\
+        v_out.position_bbox  = in_position_bbox;                                                    \n\
+        v_out.texcoord_bbox  = in_texcoord_bbox;                                                    \n\
+        v_out.color          = in_color;                                                            \n\
+        v_out.texcoord_layer = in_texcoord_layer;                                                   \n\
+    }                                                                                               \n\
+    ";
+
+std::string g_source = "\
+    #version 330 core                                                                               \n\
+                                                                                                    \n\
+    layout(points, invocations = 1)          in;                                                    \n\
+    layout(triangle_strip, max_vertices = 4) out;                                                   \n\
+                                                                                                    \n\
+    uniform mat4  in_mvp;                                                                           \n\
+                                                                                                    \n\
+    in per_vertex {                                                                                 \n\
+        vec4  position_bbox;                                                                        \n\
+        vec4  texcoord_bbox;                                                                        \n\
+        vec4  color;                                                                                \n\
+        float texcoord_layer;                                                                       \n\
+    } v_in[];                                                                                       \n\
+                                                                                                    \n\
+    out per_vertex {                                                                                \n\
+        vec3 tex_coord;                                                                             \n\
+        vec4 color;                                                                                 \n\
+    } v_out;                                                                                        \n\
+                                                                                                    \n\
+    void main()                                                                                     \n\
+    {                                                                                               \n\
+        vec2  p  = v_in[0].position_bbox.xy;                                                        \n\
+        vec2  ps = v_in[0].position_bbox.zw;                                                        \n\
+        vec2  t  = v_in[0].texcoord_bbox.xy;                                                        \n\
+        vec2  ts = v_in[0].texcoord_bbox.zw;                                                        \n\
+        float tl = v_in[0].texcoord_layer;                                                          \n\
+                                                                                                    \n\
+        // 10, 11, 00, 01                                                                           \n\
+        gl_Position     = in_mvp * vec4(p + vec2(ps.x, 0.0), 0.0, 1.0);                             \n\
+        v_out.tex_coord =          vec3(t + vec2(ts.x, 0.0), tl);                                   \n\
+        v_out.color     = v_in[0].color;                                                            \n\
+        EmitVertex();                                                                               \n\
+        gl_Position     = in_mvp * vec4(p + ps, 0.0, 1.0);                                          \n\
+        v_out.tex_coord =          vec3(t + ts, tl);                                                \n\
+        v_out.color     = v_in[0].color;                                                            \n\
+        EmitVertex();                                                                               \n\
+        gl_Position     = in_mvp * vec4(p, 0.0, 1.0);                                               \n\
+        v_out.tex_coord =          vec3(t, tl);                                                     \n\
+        v_out.color     = v_in[0].color;                                                            \n\
+        EmitVertex();                                                                               \n\
+        gl_Position     = in_mvp * vec4(p + vec2(0.0, ps.y), 0.0, 1.0);                             \n\
+        v_out.tex_coord =          vec3(t + vec2(0.0, ts.y), tl);                                   \n\
+        v_out.color     = v_in[0].color;                                                            \n\
+        EmitVertex();                                                                               \n\
+        EndPrimitive();                                                                             \n\
+    }                                                                                               \n\
+    ";
+
+std::string f_source_gray = "\
+    #version 330 core                                                                               \n\
+                                                                                                    \n\
+    uniform sampler2DArray  in_font_array;                                                          \n\
+                                                                                                    \n\
+    layout(location = 0) out vec4 out_color;                                                        \n\
+                                                                                                    \n\
+    in per_vertex {                                                                                 \n\
+        vec3 tex_coord;                                                                             \n\
+        vec4 color;                                                                                 \n\
+    } v_in;                                                                                         \n\
+                                                                                                    \n\
+    void main()                                                                                     \n\
+    {                                                                                               \n\
+        float core    = texture(in_font_array, v_in.tex_coord).r;                                   \n\
+        out_color.rgb = v_in.color.rgb;                                                             \n\
+        out_color.a   = core * v_in.color.a;                                                        \n\
+    }                                                                                               \n\
+    ";
+
+std::string f_source_lcd = "\
+    #version 330 core                                                                               \n\
+                                                                                                    \n\
+    uniform sampler2DArray  in_font_array;                                                          \n\
+                                                                                                    \n\
+    layout(location = 0, index = 0) out vec4 out_color;                                             \n\
+    layout(location = 0, index = 1) out vec4 out_sup_pixel_blend;                                   \n\
+                                                                                                    \n\
+    in per_vertex {                                                                                 \n\
+        vec3 tex_coord;                                                                             \n\
+        vec4 color;                                                                                 \n\
+    } v_in;                                                                                         \n\
+                                                                                                    \n\
+    void main()                                                                                     \n\
+    {                                                                                               \n\
+        vec3 core           = texture(in_font_array, v_in.tex_coord).rgb;                           \n\
+        out_color           = v_in.color;                                                           \n\
+        out_sup_pixel_blend = vec4(core.rgb * v_in.color.a, 1.0);                                   \n\
+    }                                                                                               \n\
+    ";
+
+std::string f_source_distance_field = "\
+    #version 330 core                                                                               \n\
+                                                                                                    \n\
+    uniform sampler2DArray  in_font_array;                                                          \n\
+                                                                                                    \n\
+    layout(location = 0) out vec4 out_color;                                                        \n\
+                                                                                                    \n\
+    in per_vertex {                                                                                 \n\
+        vec3 tex_coord;                                                                             \n\
+        vec4 color;                                                                                 \n\
+    } v_in;                                                                                         \n\
+                                                                                                    \n\
+    void main()                                                                                     \n\
+    {                                                                                               \n\
+        float d       = texture(in_font_array, v_in.tex_coord).r;                                   \n\
+        float w       = max(0.5 * fwidth(d), 1.0e-4);                                               \n\
+        out_color.rgb = v_in.color.rgb;                                                             \n\
+        out_color.a   = smoothstep(0.5 - w, 0.5 + w, d) * v_in.color.a;                             \n\
+    }                                                                                               \n\
+    ";
+
+} // namespace
+
+namespace scm {
+namespace gl {
+
+text_batch::text_batch(const render_device_ptr& device,
+                       scm::size_t              max_frame_glyphs,
+                       unsigned                 layout_threads)
+  : _vertex_count(0)
+  , _max_frame_glyphs(max_frame_glyphs)
+  , _projection_matrix(math::mat4f::identity())
+  , _frame_glyph_count(0)
+  , _frame_draw_count(0)
+{
+    using boost::assign::list_of;
+
+    // room for three frames in flight, one vertex of padding to align the first vertex
+    _vertex_ring.reset(new frame_ring_buffer(device, 3 * (_max_frame_glyphs + 1) * sizeof(vertex), BIND_VERTEX_BUFFER));
+    _vertex_array = device->create_vertex_array(vertex_format(0, 0, TYPE_VEC4F, sizeof(vertex))
+                                                             (0, 2, TYPE_VEC4F, sizeof(vertex))
+                                                             (0, 1, TYPE_VEC4F, sizeof(vertex))
+                                                             (0, 3, TYPE_FLOAT, sizeof(vertex)),
+                                                list_of(_vertex_ring->ring_buffer()));
+    if (!_vertex_array) {
+        throw std::runtime_error("text_batch::text_batch(): error creating vertex array.");
+    }
+
+    shader_ptr v = device->create_shader(STAGE_VERTEX_SHADER,   v_source, "text_batch::v_source");
+    shader_ptr g = device->create_shader(STAGE_GEOMETRY_SHADER, g_source, "text_batch::g_source");
+
+    _program_gray           = device->create_program(list_of(v)(g)(device->create_shader(STAGE_FRAGMENT_SHADER, f_source_gray, "text_batch::f_source_gray")),
+                                                     "text_batch::program_gray");
+    _program_lcd            = device->create_program(list_of(v)(g)(device->create_shader(STAGE_FRAGMENT_SHADER, f_source_lcd, "text_batch::f_source_lcd")),
+                                                     "text_batch::program_lcd");
+    _program_distance_field = device->create_program(list_of(v)(g)(device->create_shader(STAGE_FRAGMENT_SHADER, f_source_distance_field, "text_batch::f_source_distance_field")),
+                                                     "text_batch::program_distance_field");
+    if (   !_program_gray
+        || !_program_lcd
+        || !_program_distance_field) {
+        throw std::runtime_error("text_batch::text_batch(): error creating shader programs.");
+    }
+
+    _sampler_state          = device->create_sampler_state(FILTER_MIN_MAG_NEAREST, WRAP_CLAMP_TO_EDGE);
+    _sampler_state_linear   = device->create_sampler_state(FILTER_MIN_MAG_LINEAR, WRAP_CLAMP_TO_EDGE);
+    _blend_gray             = device->create_blend_state(true, FUNC_SRC_ALPHA,  FUNC_ONE_MINUS_SRC_ALPHA,  FUNC_ONE, FUNC_ZERO);
+    _blend_lcd              = device->create_blend_state(true, FUNC_SRC1_COLOR, FUNC_ONE_MINUS_SRC1_COLOR, FUNC_ONE, FUNC_ZERO);
+    _dstate                 = device->create_depth_stencil_state(false, false, COMPARISON_LESS);
+    _raster_state           = device->create_rasterizer_state(FILL_SOLID, CULL_BACK, ORIENT_CCW, true);
+
+    if (   !_sampler_state
+        || !_sampler_state_linear
+        || !_blend_gray
+        || !_blend_lcd
+        || !_dstate
+        || !_raster_state) {
+        throw std::runtime_error("text_batch::text_batch(): error creating state objects.");
+    }
+
+    if (layout_threads != 1) {
+        _layout_workers.reset(new thread_pool(layout_threads));
+    }
+}
+
+text_batch::~text_batch()
+{
+    _layout_workers.reset();
+    _vertex_array.reset();
+    _vertex_ring.reset();
+}
+
+void
+text_batch::queue(const font_face_cptr&       font,
+                  const std::string&          str,
+                  const math::vec2f&          pos,
+                  const math::vec4f&          color,
+                  font_face::style_type       style,
+                  float                       scale,
+                  bool                        kerning)
+{
+    if (!font || str.empty()) {
+        return;
+    }
+    queued_string s;
+    s._font     = font;
+    s._style    = style;
+    s._string   = str;
+    s._position = pos;
+    s._color    = color;
+    s._scale    = (font->smooth_style() == font_face::smooth_distance_field) ? scale : 1.0f;
+    s._kerning  = kerning;
+
+    _strings.push_back(s);
+}
+
+void
+text_batch::queue(const text_cptr&            txt,
+                  const math::vec2i&          pos,
+                  bool                        shadowed)
+{
+    if (shadowed) {
+        queue(txt->font(), txt->text_string(),
+              math::vec2f(pos) + math::vec2f(txt->text_shadow_offset()) * txt->text_scale(),
+              txt->text_shadow_color(), txt->text_style(), txt->text_scale(), txt->text_kerning());
+    }
+    queue(txt->font(), txt->text_string(), math::vec2f(pos),
+          txt->text_color(), txt->text_style(), txt->text_scale(), txt->text_kerning());
+}
+
+void
+text_batch::draw(const render_context_ptr& context)
+{
+    using namespace scm::math;
+
+    _frame_glyph_count = 0;
+    _frame_draw_count  = 0;
+
+    gather_glyphs();
+
+    if (_vertex_count > _max_frame_glyphs) {
+        glerr() << log::warning
+                << "text_batch::draw(): "
+                << "more glyphs queued than the frame limit, dropping glyphs (glyphs: " << _vertex_count
+                << ", limit: " << _max_frame_glyphs << ")." << log::end;
+        _vertex_count = _max_frame_glyphs;
+    }
+    if (0 == _vertex_count) {
+        clear();
+        return;
+    }
+
+    frame_ring_buffer::allocation a = _vertex_ring->allocate(context, (_vertex_count + 1) * sizeof(vertex));
+    if (!a._data) {
+        clear();
+        return;
+    }
+    // draws address the ring in vertices, the first vertex is aligned to the vertex size
+    const scm::size_t   first_vertex = (a._offset + sizeof(vertex) - 1) / sizeof(vertex);
+    vertex*const        vertex_data  = reinterpret_cast<vertex*>(static_cast<scm::uint8*>(a._data)
+                                                                 + (first_vertex * sizeof(vertex) - a._offset));
+
+    if (_layout_workers && _ranges.size() > 1) {
+        _layout_workers->parallel_for(0, _ranges.size(), 64,
+                                      boost::bind(&text_batch::generate_vertices, this, _1, _2, vertex_data));
+    }
+    else {
+        generate_vertices(0, _ranges.size(), vertex_data);
+    }
+    _vertex_ring->commit(context, a);
+
+    {
+        context_vertex_input_guard  vig(context);
+        context_state_objects_guard csg(context);
+        context_texture_units_guard tug(context);
+        context_program_guard       cpg(context);
+
+        context->set_depth_stencil_state(_dstate);
+        context->set_rasterizer_state(_raster_state);
+        context->bind_vertex_array(_vertex_array);
+
+        for (std::vector<font_draw>::const_iterator d = _draws.begin(); d != _draws.end(); ++d) {
+            if (d->_first_vertex >= _vertex_count) {
+                break;
+            }
+            const scm::size_t count = (std::min)(d->_vertex_count, _vertex_count - d->_first_vertex);
+
+            switch (d->_font->smooth_style()) {
+                case font_face::smooth_normal:
+                    context->set_blend_state(_blend_gray);
+                    context->bind_texture(d->_font->styles_texture_array(), _sampler_state, 0);
+                    context->bind_program(_program_gray);
+                    break;
+                case font_face::smooth_lcd:
+                    context->set_blend_state(_blend_lcd);
+                    context->bind_texture(d->_font->styles_texture_array(), _sampler_state, 0);
+                    context->bind_program(_program_lcd);
+                    break;
+                case font_face::smooth_distance_field:
+                    context->set_blend_state(_blend_gray);
+                    context->bind_texture(d->_font->styles_texture_array(), _sampler_state_linear, 0);
+                    context->bind_program(_program_distance_field);
+                    break;
+                default:
+                    continue;
+            }
+            context->current_program()->uniform("in_mvp", _projection_matrix);
+            context->current_program()->uniform_sampler("in_font_array", 0);
+            context->apply();
+            context->draw_arrays(PRIMITIVE_POINT_LIST,
+                                 static_cast<int>(first_vertex + d->_first_vertex),
+                                 static_cast<int>(count));
+
+            _frame_glyph_count += count;
+            _frame_draw_count  += 1;
+        }
+    }
+
+    _vertex_ring->end_frame(context);
+    clear();
+}
+
+void
+text_batch::clear()
+{
+    _strings.clear();
+    _glyphs.clear();
+    _ranges.clear();
+    _draws.clear();
+    _vertex_count = 0;
+}
+
+void
+text_batch::projection_matrix(const math::mat4f& m)
+{
+    _projection_matrix = m;
+}
+
+scm::size_t
+text_batch::queued_strings() const
+{
+    return _strings.size();
+}
+
+scm::size_t
+text_batch::frame_glyph_count() const
+{
+    return _frame_glyph_count;
+}
+
+scm::size_t
+text_batch::frame_draw_count() const
+{
+    return _frame_draw_count;
+}
+
+void
+text_batch::gather_glyphs()
+{
+    // the fonts in the order of their first use, one draw per font
+    std::vector<font_face_cptr> fonts;
+    for (std::vector<queued_string>::const_iterator s = _strings.begin(); s != _strings.end(); ++s) {
+        if (std::find(fonts.begin(), fonts.end(), s->_font) == fonts.end()) {
+            fonts.push_back(s->_font);
+        }
+    }
+
+    for (std::vector<font_face_cptr>::const_iterator f = fonts.begin(); f != fonts.end(); ++f) {
+        const font_face& font = **f;
+
+        if (font.smooth_style() == font_face::smooth_distance_field) {
+            // start the generation of all missing glyphs before waiting for the first one
+            std::vector<std::vector<scm::uint32> > code_points(font_face::style_count);
+            for (std::vector<queued_string>::const_iterator s = _strings.begin(); s != _strings.end(); ++s) {
+                if (s->_font == *f) {
+                    std::string::const_iterator c = s->_string.begin();
+                    while (c != s->_string.end()) {
+                        const scm::uint32 cur_char = detail::decode_utf8(c, s->_string.end());
+                        if (font_face::min_char <= cur_char) {
+                            code_points[s->_style].push_back(cur_char);
+                        }
+                    }
+                }
+            }
+            for (int st = 0; st < font_face::style_count; ++st) {
+                if (!code_points[st].empty()) {
+                    font.request_glyphs(code_points[st], static_cast<font_face::style_type>(st));
+                }
+            }
+        }
+
+        // glyphs placed for this font can evict glyphs gathered before for the same font
+        // from the atlas, the font is gathered once more in this case
+        const scm::size_t glyphs_begin = _glyphs.size();
+        const scm::size_t ranges_begin = _ranges.size();
+        const scm::size_t vertex_begin = _vertex_count;
+        for (int pass = 0; pass < 2; ++pass) {
+            const scm::size_t generation = font.atlas_generation();
+
+            _glyphs.resize(glyphs_begin);
+            _ranges.resize(ranges_begin);
+            _vertex_count = vertex_begin;
+
+            for (scm::size_t i = 0; i < _strings.size(); ++i) {
+                const queued_string& s = _strings[i];
+                if (s._font != *f) {
+                    continue;
+                }
+                layout_range r;
+                r._string       = i;
+                r._first_glyph  = _glyphs.size();
+                r._first_vertex = _vertex_count;
+
+                scm::uint32                 prev_char = 0;
+                std::string::const_iterator c         = s._string.begin();
+                while (c != s._string.end()) {
+                    const scm::uint32 cur_char = detail::decode_utf8(c, s._string.end());
+                    layout_glyph      g;
+
+                    g._kerning    = 0;
+                    g._line_break = (cur_char == '\n');
+                    if (g._line_break) {
+                        prev_char = 0;
+                        _glyphs.push_back(g);
+                    }
+                    else if (font_face::min_char <= cur_char) {
+                        g._glyph = font.glyph(cur_char, s._style);
+                        if (s._kerning && prev_char) {
+                            g._kerning = font.kerning(prev_char, cur_char, s._style);
+                        }
+                        if (g._glyph._box_size.x > 0) {
+                            ++_vertex_count;
+                        }
+                        prev_char = cur_char;
+                        _glyphs.push_back(g);
+                    }
+                }
+                r._glyph_end = _glyphs.size();
+                _ranges.push_back(r);
+            }
+            if (generation == font.atlas_generation()) {
+                break;
+            }
+        }
+
+        font_draw d;
+        d._font         = *f;
+        d._first_vertex = vertex_begin;
+        d._vertex_count = _vertex_count - vertex_begin;
+        if (d._vertex_count > 0) {
+            _draws.push_back(d);
+        }
+    }
+}
+
+void
+text_batch::generate_vertices(scm::size_t in_begin,
+                              scm::size_t in_end,
+                              void*       out_vertices) const
+{
+    using namespace scm::math;
+
+    vertex*const vertex_data = static_cast<vertex*>(out_vertices);
+
+    for (scm::size_t r = in_begin; r < in_end; ++r) {
+        const layout_range&  range   = _ranges[r];
+        const queued_string& s       = _strings[range._string];
+        const float          advance = static_cast<float>(s._font->line_advance(s._style));
+        vec2f                pen     = vec2f(0.0f, 0.0f);
+        scm::size_t          v       = range._first_vertex;
+
+        for (scm::size_t i = range._first_glyph; i < range._glyph_end && v < _vertex_count; ++i) {
+            const layout_glyph& g = _glyphs[i];
+
+            if (g._line_break) {
+                pen.x  = 0.0f;
+                pen.y -= advance;
+                continue;
+            }
+            pen.x += static_cast<float>(g._kerning);
+            if (g._glyph._box_size.x > 0) {
+                const vec2f pos  = s._position + (pen + vec2f(g._glyph._bearing)) * s._scale;
+                const vec2f bbox = vec2f(g._glyph._box_size) * s._scale;
+
+                vertex_data[v].pos_bbox  = vec4f(pos.x, pos.y, bbox.x, bbox.y);
+                vertex_data[v].tex_bbox  = vec4f(g._glyph._texture_origin.x,   g._glyph._texture_origin.y,
+                                                 g._glyph._texture_box_size.x, g._glyph._texture_box_size.y);
+                vertex_data[v].color     = s._color;
+                vertex_data[v].tex_layer = static_cast<float>(g._glyph._texture_layer);
+                ++v;
+            }
+            pen.x += static_cast<float>(g._glyph._advance);
+        }
+    }
+}
+
+} // namespace gl
+} // namespace scm
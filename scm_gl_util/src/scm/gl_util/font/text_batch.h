@@ -0,0 +1,136 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_GL_UTIL_TEXT_BATCH_H_INCLUDED
+#define SCM_GL_UTIL_TEXT_BATCH_H_INCLUDED
+
+#include <string>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <scm/core/math.h>
+#include <scm/core/memory.h>
+#include <scm/core/numeric_types.h>
+
+#include <scm/gl_core/gl_core_fwd.h>
+
+#include <scm/gl_util/font/font_fwd.h>
+#include <scm/gl_util/font/font_face.h>
+
+#include <scm/core/platform/platform.h>
+#include <scm/core/utilities/platform_warning_disable.h>
+
+namespace scm {
+
+class thread_pool;
+
+namespace gl {
+
+// draws all strings queued during a frame from one streaming vertex buffer
+//  - the strings are laid out on the cpu into a frame_ring_buffer allocation, one point
+//    per glyph expanded to a quad by a geometry shader, color and position per glyph
+//  - the glyph lookup is serial, the vertex generation is split over the layout threads
+//  - one draw per font face, strings are drawn in queue order within a face
+//  - border (stroked) outlines are not supported, distance field fonts are scaled
+class __scm_export(gl_util) text_batch : boost::noncopyable
+{
+public:
+    // layout_threads == 1 lays out in the calling thread, 0 uses the hardware threads
+    text_batch(const render_device_ptr& device,
+               scm::size_t              max_frame_glyphs = 64 * 1024,
+               unsigned                 layout_threads   = 1);
+    virtual ~text_batch();
+
+    // pos is the origin of the first line in window coordinates, the scale is applied
+    // to distance field fonts only
+    void                    queue(const font_face_cptr&       font,
+                                  const std::string&          str,      // UTF-8 encoded
+                                  const math::vec2f&          pos,
+                                  const math::vec4f&          color,
+                                  font_face::style_type       style   = font_face::style_regular,
+                                  float                       scale   = 1.0f,
+                                  bool                        kerning = true);
+    // uses the font, string, style, color, scale and kerning settings of the text
+    void                    queue(const text_cptr&            txt,
+                                  const math::vec2i&          pos,
+                                  bool                        shadowed = false);
+
+    // lays out and draws the queued strings and clears the queue, call once per frame
+    void                    draw(const render_context_ptr& context);
+    void                    clear();
+
+    void                    projection_matrix(const math::mat4f& m);
+
+    scm::size_t             queued_strings() const;
+    scm::size_t             frame_glyph_count() const;  // of the last draw
+    scm::size_t             frame_draw_count() const;   // of the last draw
+
+protected:
+    struct queued_string {
+        font_face_cptr          _font;
+        font_face::style_type   _style;
+        std::string             _string;
+        math::vec2f             _position;
+        math::vec4f             _color;
+        float                   _scale;
+        bool                    _kerning;
+    }; // struct queued_string
+    struct layout_glyph {
+        font_face::glyph_info   _glyph;
+        int                     _kerning;
+        bool                    _line_break;
+    }; // struct layout_glyph
+    struct layout_range {
+        scm::size_t             _string;
+        scm::size_t             _first_glyph;
+        scm::size_t             _glyph_end;
+        scm::size_t             _first_vertex;
+    }; // struct layout_range
+    struct font_draw {
+        font_face_cptr          _font;
+        scm::size_t             _first_vertex;
+        scm::size_t             _vertex_count;
+    }; // struct font_draw
+
+    void                    gather_glyphs();
+    void                    generate_vertices(scm::size_t in_begin,
+                                              scm::size_t in_end,
+                                              void*       out_vertices) const;
+
+protected:
+    std::vector<queued_string>  _strings;
+    std::vector<layout_glyph>   _glyphs;
+    std::vector<layout_range>   _ranges;
+    std::vector<font_draw>      _draws;
+    scm::size_t                 _vertex_count;
+    scm::size_t                 _max_frame_glyphs;
+
+    frame_ring_buffer_ptr       _vertex_ring;
+    vertex_array_ptr            _vertex_array;
+    shared_ptr<thread_pool>     _layout_workers;
+
+    program_ptr                 _program_gray;
+    program_ptr                 _program_lcd;
+    program_ptr                 _program_distance_field;
+    sampler_state_ptr           _sampler_state;
+    sampler_state_ptr           _sampler_state_linear;
+    depth_stencil_state_ptr     _dstate;
+    rasterizer_state_ptr        _raster_state;
+    blend_state_ptr             _blend_gray;
+    blend_state_ptr             _blend_lcd;
+
+    math::mat4f                 _projection_matrix;
+
+    scm::size_t                 _frame_glyph_count;
+    scm::size_t                 _frame_draw_count;
+
+}; // class text_batch
+
+} // namespace gl
+} // namespace scm
+
+#include <scm/core/utilities/platform_warning_enable.h>
+
+#endif // SCM_GL_UTIL_TEXT_BATCH_H_INCLUDED
@@ -35,16 +35,19 @@ std::string v_source = "\
                                                                                                     \n\
     layout(location = 0) in vec4 in_position_bbox;                                                  \n\
     layout(location = 2) in vec4 in_texcoord_bbox;                                                  \n\
+    layout(location = 3) in float in_texcoord_layer;                                                \n\
                                                                                                     \n\
     out per_vertex {                                                                                \n\
         vec4 in_position_bbox;                                                                      \n\
         vec4 in_texcoord_bbox;                                                                      \n\
+        float in_texcoord_layer;                                                                    \n\
     } v_out;                                                                                        \n\
                                                                                                     \n\
     void main()                                                                                     \n\
     {                                                                                               \n\
         v_out.in_position_bbox  = in_position_bbox;                                                 \n\
         v_out.in_texcoord_bbox  = in_texcoord_bbox;                                                 \n\
+        v_out.in_texcoord_layer = in_texcoord_layer;                                                \n\
         //gl_Position             = in_mvp * vec4(in_position.xy, 0.0, 1.0);                        \n\
     }                                                                                               \n\
     ";
@@ -60,10 +63,11 @@ std::string g_source = "\
     in per_vertex {                                                                                 \n\
         vec4 in_position_bbox;                                                                      \n\
         vec4 in_texcoord_bbox;                                                                      \n\
+        float in_texcoord_layer;                                                                    \n\
     } v_in[];                                                                                       \n\
                                                                                                     \n\
     out per_vertex {                                                                                \n\
-        vec2 tex_coord;                                                                             \n\
+        vec3 tex_coord;                                                                             \n\
     } v_out;                                                                                        \n\
                                                                                                     \n\
     void main()                                                                                     \n\
@@ -73,25 +77,26 @@ std::string g_source = "\
                                                                                                     \n\
         vec2 t  = v_in[0].in_texcoord_bbox.xy;                                                      \n\
         vec2 ts = v_in[0].in_texcoord_bbox.zw;                                                      \n\
+        float tl = v_in[0].in_texcoord_layer;                                                       \n\
                                                                                                     \n\
         // 10                                                                                       \n\
         gl_Position       = in_mvp * vec4(p + vec2(ps.x, 0.0), 0.0, 1.0);                           \n\
-        v_out.tex_coord   =          vec2(t + vec2(ts.x, 0.0));                                     \n\
+        v_out.tex_coord   =          vec3(t + vec2(ts.x, 0.0), tl);                                 \n\
         EmitVertex();                                                                               \n\
                                                                                                     \n\
         // 11                                                                                       \n\
         gl_Position       = in_mvp * vec4(p + ps, 0.0, 1.0);                                        \n\
-        v_out.tex_coord   =          vec2(t + ts);                                                  \n\
+        v_out.tex_coord   =          vec3(t + ts, tl);                                              \n\
         EmitVertex();                                                                               \n\
                                                                                                     \n\
         // 00                                                                                       \n\
         gl_Position       = in_mvp * vec4(p, 0.0, 1.0);                                             \n\
-        v_out.tex_coord   = vec2(t);                                                                \n\
+        v_out.tex_coord   =          vec3(t, tl);                                                   \n\
         EmitVertex();                                                                               \n\
                                                                                                     \n\
         // 01                                                                                       \n\
         gl_Position       = in_mvp * vec4(p + vec2(0.0, ps.y), 0.0, 1.0);                           \n\
-        v_out.tex_coord   =          vec2(t + vec2(0.0, ts.y));                                     \n\
+        v_out.tex_coord   =          vec3(t + vec2(0.0, ts.y), tl);                                 \n\
         EmitVertex();                                                                               \n\
         EndPrimitive();                                                                             \n\
     }                                                                                               \n\
@@ -103,16 +108,16 @@ std::string v_source = "\
     uniform mat4  in_mvp;                                                                           \n\
                                                                                                     \n\
     layout(location = 0) in vec2 in_position;                                                       \n\
-    layout(location = 2) in vec2 in_texcoord;                                                       \n\
+    layout(location = 2) in vec3 in_texcoord;                                                       \n\
                                                                                                     \n\
     out per_vertex {                                                                                \n\
-        vec2 tex_coord;                                                                             \n\
+        vec3 tex_coord;                                                                             \n\
     } v_out;                                                                                        \n\
                                                                                                     \n\
     void main()                                                                                     \n\
     {                                                                                               \n\
         //v_out.os_position   = in_position;                                                        \n\
-        v_out.tex_coord     = in_texcoord.xy;                                                       \n\
+        v_out.tex_coord     = in_texcoord;                                                          \n\
         gl_Position         = in_mvp * vec4(in_position.xy, 0.0, 1.0);                              \n\
     }                                                                                               \n\
     ";
@@ -126,11 +131,11 @@ std::string g_source = "\
     uniform mat4  in_mvp;                                                                           \n\
                                                                                                     \n\
     in per_vertex {                                                                                 \n\
-        vec2 tex_coord;                                                                             \n\
+        vec3 tex_coord;                                                                             \n\
     } v_in[];                                                                                       \n\
                                                                                                     \n\
     out per_vertex {                                                                                \n\
-        vec2 tex_coord;                                                                             \n\
+        vec3 tex_coord;                                                                             \n\
     } v_out;                                                                                        \n\
                                                                                                     \n\
     void main()                                                                                     \n\
@@ -150,20 +155,19 @@ std::string g_source = "\
 std::string f_source_gray = "\
     #version 330 core                                                                               \n\
                                                                                                     \n\
-    uniform int             in_style;                                                               \n\
     uniform vec4            in_color;                                                               \n\
     uniform sampler2DArray  in_font_array;                                                          \n\
                                                                                                     \n\
     layout(location = 0) out vec4 out_color;                                                        \n\
                                                                                                     \n\
     in per_vertex {                                                                                 \n\
-        vec2 tex_coord;                                                                             \n\
+        vec3 tex_coord;                                                                             \n\
     } v_in;                                                                                         \n\
                                                                                                     \n\
     void main()                                                                                     \n\
     {                                                                                               \n\
         float core    = texture(in_font_array,                                                      \n\
-                                vec3(v_in.tex_coord, float(in_style))).r;                           \n\
+                                v_in.tex_coord).r;                                                  \n\
         out_color.rgb = in_color.rgb;                                                               \n\
         out_color.a   = core * in_color.a;                                                          \n\
     }                                                                                               \n\
@@ -172,7 +176,6 @@ std::string f_source_gray = "\
 std::string f_source_outline_gray = "\
     #version 330 core                                                                               \n\
                                                                                                     \n\
-    uniform int             in_style;                                                               \n\
     uniform vec4            in_color;                                                               \n\
     uniform vec4            in_outline_color;                                                       \n\
     uniform sampler2DArray  in_font_array;                                                          \n\
@@ -181,12 +184,12 @@ std::string f_source_outline_gray = "\
     layout(location = 0) out vec4 out_color;                                                        \n\
                                                                                                     \n\
     in per_vertex {                                                                                 \n\
-        vec2 tex_coord;                                                                             \n\
+        vec3 tex_coord;                                                                             \n\
     } v_in;                                                                                         \n\
                                                                                                     \n\
     void main()                                                                                     \n\
     {                                                                                               \n\
-        vec3  tc      = vec3(v_in.tex_coord, float(in_style));                                      \n\
+        vec3  tc      = v_in.tex_coord;                                                             \n\
         float core    = texture(in_font_array, tc).r;                                               \n\
         float outline = texture(in_font_border_array, tc).r;                                        \n\
                                                                                                     \n\
@@ -204,7 +207,6 @@ std::string f_source_lcd = "\
                                                                                                     \n\
     in vec2 tex_coord;                                                                              \n\
                                                                                                     \n\
-    uniform int             in_style;                                                               \n\
     uniform vec4            in_color;                                                               \n\
     uniform sampler2DArray  in_font_array;                                                          \n\
                                                                                                     \n\
@@ -212,13 +214,13 @@ std::string f_source_lcd = "\
     layout(location = 0, index = 1) out vec4 out_sup_pixel_blend;                                   \n\
                                                                                                     \n\
     in per_vertex {                                                                                 \n\
-        vec2 tex_coord;                                                                             \n\
+        vec3 tex_coord;                                                                             \n\
     } v_in;                                                                                         \n\
                                                                                                     \n\
     void main()                                                                                     \n\
     {                                                                                               \n\
         vec3 core           = texture(in_font_array,                                                \n\
-                                      vec3(v_in.tex_coord, float(in_style))).rgb;                   \n\
+                                      v_in.tex_coord).rgb;                                          \n\
                                                                                                     \n\
         out_color           = in_color;                                                             \n\
         out_sup_pixel_blend = vec4(core.rgb * in_color.a, 1.0);                                     \n\
@@ -230,7 +232,6 @@ std::string f_source_outline_lcd = "\
                                                                                                     \n\
     in vec2 tex_coord;                                                                              \n\
                                                                                                     \n\
-    uniform int             in_style;                                                               \n\
     uniform vec4            in_color;                                                               \n\
     uniform vec4            in_outline_color;                                                       \n\
     uniform sampler2DArray  in_font_array;                                                          \n\
@@ -240,12 +241,12 @@ std::string f_source_outline_lcd = "\
     layout(location = 0, index = 1) out vec4 out_sup_pixel_blend;                                   \n\
                                                                                                     \n\
     in per_vertex {                                                                                 \n\
-        vec2 tex_coord;                                                                             \n\
+        vec3 tex_coord;                                                                             \n\
     } v_in;                                                                                         \n\
                                                                                                     \n\
     void main()                                                                                     \n\
     {                                                                                               \n\
-        vec3 tc      = vec3(v_in.tex_coord, float(in_style));                                       \n\
+        vec3 tc      = v_in.tex_coord;                                                              \n\
         vec3 core    = texture(in_font_array, tc).rgb;                                              \n\
         vec3 outline = texture(in_font_border_array, tc).rgb;                                       \n\
                                                                                                     \n\
@@ -258,6 +259,33 @@ std::string f_source_outline_lcd = "\
     }                                                                                               \n\
     ";
 
+std::string f_source_distance_field = "\
+    #version 330 core                                                                               \n\
+                                                                                                    \n\
+    uniform vec4            in_color;                                                               \n\
+    uniform vec4            in_outline_color;                                                       \n\
+    uniform float           in_outline_width; // in distance field units, 0 without outline         \n\
+    uniform sampler2DArray  in_font_array;                                                          \n\
+                                                                                                    \n\
+    layout(location = 0) out vec4 out_color;                                                        \n\
+                                                                                                    \n\
+    in per_vertex {                                                                                 \n\
+        vec3 tex_coord;                                                                             \n\
+    } v_in;                                                                                         \n\
+                                                                                                    \n\
+    void main()                                                                                     \n\
+    {                                                                                               \n\
+        // 0.5 on the glyph outline, antialiased over about one screen pixel at all scales          \n\
+        float d       = texture(in_font_array, v_in.tex_coord).r;                                   \n\
+        float w       = max(0.5 * fwidth(d), 1.0e-4);                                               \n\
+        float core    = smoothstep(0.5 - w, 0.5 + w, d);                                            \n\
+        float outline = smoothstep(0.5 - in_outline_width - w, 0.5 - in_outline_width + w, d);      \n\
+                                                                                                    \n\
+        out_color.rgb = mix(in_outline_color.rgb, in_color.rgb, core);                              \n\
+        out_color.a   = mix(in_outline_color.a,   in_color.a,   core) * outline;                    \n\
+    }                                                                                               \n\
+    ";
+
 } // namespace
 
 
@@ -296,15 +324,24 @@ text_renderer::text_renderer(const render_device_ptr& device)
                                                                (device->create_shader(STAGE_FRAGMENT_SHADER, f_source_outline_lcd,  "text_renderer::f_source_outline_lcd")),
                                                 "text_renderer::font_program_outline_lcd");
 
+    _font_program_distance_field = device->create_program(list_of(device->create_shader(STAGE_VERTEX_SHADER,   v_source,      "text_renderer::v_source"))
+#if GEOM_SHADER_FONT == 1
+                                                                 (device->create_shader(STAGE_GEOMETRY_SHADER, g_source,      "text_renderer::g_source"))
+#endif
+                                                                 (device->create_shader(STAGE_FRAGMENT_SHADER, f_source_distance_field, "text_renderer::f_source_distance_field")),
+                                                "text_renderer::font_program_distance_field");
+
     if (   !_font_program_gray
         || !_font_program_lcd
         || !_font_program_outline_gray
-        || !_font_program_outline_lcd) {
+        || !_font_program_outline_lcd
+        || !_font_program_distance_field) {
         scm::err() << "font_renderer::font_renderer(): error creating shader programs." << log::end;
         throw std::runtime_error("font_renderer::font_renderer(): error creating shader programs.");
     }
 
     _font_sampler_state = device->create_sampler_state(FILTER_MIN_MAG_NEAREST, WRAP_CLAMP_TO_EDGE);
+    _font_sampler_state_linear = device->create_sampler_state(FILTER_MIN_MAG_LINEAR, WRAP_CLAMP_TO_EDGE);
     _font_blend_gray    = device->create_blend_state(true, FUNC_SRC_ALPHA,  FUNC_ONE_MINUS_SRC_ALPHA,  FUNC_ONE, FUNC_ZERO);
     _font_blend_lcd     = device->create_blend_state(true, FUNC_SRC1_COLOR, FUNC_ONE_MINUS_SRC1_COLOR, FUNC_ONE, FUNC_ZERO);
     //_font_blend_lcd     = device->create_blend_state(true, FUNC_ONE, FUNC_ZERO, FUNC_ONE, FUNC_ZERO);
@@ -312,6 +349,7 @@ text_renderer::text_renderer(const render_device_ptr& device)
     _font_raster_state  = device->create_rasterizer_state(FILL_SOLID, CULL_BACK, ORIENT_CCW, true);
 
     if (   !_font_sampler_state
+        || !_font_sampler_state_linear
         || !_font_blend_gray
         || !_font_blend_lcd
         || !_font_dstate
@@ -327,7 +365,11 @@ text_renderer::~text_renderer()
 {
     _font_program_gray.reset();
     _font_program_lcd.reset();
+    _font_program_outline_gray.reset();
+    _font_program_outline_lcd.reset();
+    _font_program_distance_field.reset();
     _font_sampler_state.reset();
+    _font_sampler_state_linear.reset();
     _font_dstate.reset();
     _font_raster_state.reset();
     _font_blend_gray.reset();
@@ -345,6 +387,14 @@ text_renderer::draw(const render_context_ptr& context,
     using namespace scm::gl;
     using namespace scm::math;
 
+    if (txt->font()->smooth_style() == font_face::smooth_distance_field) {
+        return draw_distance_field(context, vec2f(pos), txt, txt->text_color(), txt->text_outline_color(), 0.0f);
+    }
+
+    if (txt->glyphs_outdated()) { // relayout with the glyphs evicted from the font atlas
+        txt->update();
+    }
+
     context_vertex_input_guard  vig(context);
     context_state_objects_guard csg(context);
     context_texture_units_guard tug(context);
@@ -362,7 +412,6 @@ text_renderer::draw(const render_context_ptr& context,
     switch (txt->font()->smooth_style()) {
         case font_face::smooth_normal:
             _font_program_gray->uniform("in_mvp", mvp);
-            _font_program_gray->uniform("in_style", static_cast<int>(txt->text_style()));
             _font_program_gray->uniform("in_color", txt->text_color());
             _font_program_gray->uniform_sampler("in_font_array", 0);
 
@@ -371,7 +420,6 @@ text_renderer::draw(const render_context_ptr& context,
            break;
         case font_face::smooth_lcd:
             _font_program_lcd->uniform("in_mvp", mvp);
-            _font_program_lcd->uniform("in_style", static_cast<int>(txt->text_style()));
             _font_program_lcd->uniform("in_color", txt->text_color());
             _font_program_lcd->uniform_sampler("in_font_array", 0);
 
@@ -405,6 +453,10 @@ text_renderer::draw_outlined(const render_context_ptr& context,
                              const math::vec2i&        pos,
                              const text_ptr&           txt) const
 {
+    if (txt->font()->smooth_style() == font_face::smooth_distance_field) {
+        return draw_distance_field(context, math::vec2f(pos), txt,
+                                   txt->text_color(), txt->text_outline_color(), txt->text_outline_width());
+    }
     if (!txt->font()->styles_border_texture_array()) {
         return draw(context, pos, txt);
     }
@@ -413,6 +465,10 @@ text_renderer::draw_outlined(const render_context_ptr& context,
     using namespace scm::gl;
     using namespace scm::math;
 
+    if (txt->glyphs_outdated()) { // relayout with the glyphs evicted from the font atlas
+        txt->update();
+    }
+
     context_vertex_input_guard  vig(context);
     context_state_objects_guard csg(context);
     context_texture_units_guard tug(context);
@@ -433,7 +489,6 @@ text_renderer::draw_outlined(const render_context_ptr& context,
     switch (txt->font()->smooth_style()) {
         case font_face::smooth_normal:
             _font_program_outline_gray->uniform("in_mvp",               mvp);
-            _font_program_outline_gray->uniform("in_style",             static_cast<int>(txt->text_style()));
             _font_program_outline_gray->uniform("in_color",             txt->text_color());
             _font_program_outline_gray->uniform("in_outline_color",     txt->text_outline_color());
             _font_program_outline_gray->uniform_sampler("in_font_array",        0);
@@ -494,7 +549,6 @@ text_renderer::draw_outlined(const render_context_ptr& context,
             break;
         case font_face::smooth_lcd:
             _font_program_outline_lcd->uniform("in_mvp",               mvp);
-            _font_program_outline_lcd->uniform("in_style",             static_cast<int>(txt->text_style()));
             _font_program_outline_lcd->uniform("in_color",             txt->text_color());
             _font_program_outline_lcd->uniform("in_outline_color",     txt->text_outline_color());
             _font_program_outline_lcd->uniform_sampler("in_font_array",        0);
@@ -574,6 +628,19 @@ text_renderer::draw_shadowed(const render_context_ptr& context,
     using namespace scm::gl;
     using namespace scm::math;
 
+    if (txt->font()->smooth_style() == font_face::smooth_distance_field) {
+        // the shadow offset is given in pixels of the font point size as well
+        draw_distance_field(context, vec2f(pos) + vec2f(txt->text_shadow_offset()) * txt->text_scale(), txt,
+                            txt->text_shadow_color(), txt->text_shadow_color(), 0.0f);
+        draw_distance_field(context, vec2f(pos), txt,
+                            txt->text_color(), txt->text_outline_color(), 0.0f);
+        return;
+    }
+
+    if (txt->glyphs_outdated()) { // relayout with the glyphs evicted from the font atlas
+        txt->update();
+    }
+
     context_vertex_input_guard  vig(context);
     context_state_objects_guard csg(context);
     context_texture_units_guard tug(context);
@@ -600,7 +667,6 @@ text_renderer::draw_shadowed(const render_context_ptr& context,
                 mat4f mvp = _projection_matrix * v;
 
                 _font_program_gray->uniform("in_mvp", mvp);
-                _font_program_gray->uniform("in_style", static_cast<int>(txt->text_style()));
                 _font_program_gray->uniform("in_color", txt->text_shadow_color());
 
 #if GEOM_SHADER_FONT == 1
@@ -621,7 +687,6 @@ text_renderer::draw_shadowed(const render_context_ptr& context,
                 mat4f mvp = _projection_matrix * v;
 
                 _font_program_gray->uniform("in_mvp", mvp);
-                _font_program_gray->uniform("in_style", static_cast<int>(txt->text_style()));
                 _font_program_gray->uniform("in_color", txt->text_color());
 
 #if GEOM_SHADER_FONT == 1
@@ -645,7 +710,6 @@ text_renderer::draw_shadowed(const render_context_ptr& context,
                 mat4f mvp = _projection_matrix * v;
 
                 _font_program_lcd->uniform("in_mvp", mvp);
-                _font_program_lcd->uniform("in_style", static_cast<int>(txt->text_style()));
                 _font_program_lcd->uniform("in_color", txt->text_shadow_color());
                 context->set_blend_state(_font_blend_lcd/*, txt->text_shadow_color()*/);
 
@@ -667,7 +731,6 @@ text_renderer::draw_shadowed(const render_context_ptr& context,
                 mat4f mvp = _projection_matrix * v;
 
                 _font_program_lcd->uniform("in_mvp", mvp);
-                _font_program_lcd->uniform("in_style", static_cast<int>(txt->text_style()));
                 _font_program_lcd->uniform("in_color", txt->text_color());
                 context->set_blend_state(_font_blend_lcd/*, txt->text_color()*/);
 
@@ -691,6 +754,63 @@ text_renderer::draw_shadowed(const render_context_ptr& context,
     //_quad->draw(context, geometry::MODE_SOLID);
 }
 
+void
+text_renderer::draw_distance_field(const render_context_ptr& context,
+                                   const math::vec2f&        pos,
+                                   const text_ptr&           txt,
+                                   const math::vec4f&        color,
+                                   const math::vec4f&        outline_color,
+                                   float                     outline_width) const
+{
+    using namespace scm;
+    using namespace scm::gl;
+    using namespace scm::math;
+
+    if (txt->glyphs_outdated()) { // relayout with the glyphs evicted from the font atlas
+        txt->update();
+    }
+
+    context_vertex_input_guard  vig(context);
+    context_state_objects_guard csg(context);
+    context_texture_units_guard tug(context);
+    context_program_guard       cpg(context);
+
+    mat4f v = make_translation(vec3f(pos, 0.0f));
+    scale(v, txt->text_scale(), txt->text_scale(), 1.0f);
+    mat4f mvp = _projection_matrix * v;
+
+    // the field values cover 2 * spread texels of the point size
+    const float spread = static_cast<float>(txt->font()->distance_field_spread());
+    const float width  = clamp(outline_width / (2.0f * spread), 0.0f, 0.5f);
+
+    _font_program_distance_field->uniform("in_mvp",              mvp);
+    _font_program_distance_field->uniform("in_color",            color);
+    _font_program_distance_field->uniform("in_outline_color",    outline_color);
+    _font_program_distance_field->uniform("in_outline_width",    width);
+    _font_program_distance_field->uniform_sampler("in_font_array", 0);
+
+    context->set_depth_stencil_state(_font_dstate);
+    context->set_rasterizer_state(_font_raster_state);
+    context->set_blend_state(_font_blend_gray);
+    context->bind_texture(txt->font()->styles_texture_array(), _font_sampler_state_linear, 0);
+    context->bind_program(_font_program_distance_field);
+
+#if GEOM_SHADER_FONT == 1
+    if (txt->_indices_count > 0) {
+        context->bind_vertex_array(txt->_vertex_array);
+        context->apply();
+        context->draw_arrays(PRIMITIVE_POINT_LIST, 0, txt->_indices_count);
+    }
+#else
+    if (txt->_indices_count > 0) {
+        context->bind_vertex_array(txt->_vertex_array);
+        context->bind_index_buffer(txt->_index_buffer, txt->_topology, TYPE_USHORT);
+        context->apply();
+        context->draw_elements(txt->_indices_count);
+    }
+#endif
+}
+
 void
 text_renderer::projection_matrix(const math::mat4f& m)
 {
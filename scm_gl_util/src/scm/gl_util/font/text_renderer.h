@@ -36,12 +36,23 @@ public:
 
     void            projection_matrix(const math::mat4f& m);
 
+protected:
+    // distance field fonts, scaled by the text scale, outline width in pixels of the point size
+    void            draw_distance_field(const render_context_ptr& context,
+                                        const math::vec2f&        pos,
+                                        const text_ptr&           txt,
+                                        const math::vec4f&        color,
+                                        const math::vec4f&        outline_color,
+                                        float                     outline_width) const;
+
 protected:
     program_ptr                 _font_program_gray;
     program_ptr                 _font_program_lcd;
     program_ptr                 _font_program_outline_gray;
     program_ptr                 _font_program_outline_lcd;
+    program_ptr                 _font_program_distance_field;
     sampler_state_ptr           _font_sampler_state;
+    sampler_state_ptr           _font_sampler_state_linear;
     depth_stencil_state_ptr     _font_dstate;
     rasterizer_state_ptr        _font_raster_state;
     blend_state_ptr             _font_blend_gray;
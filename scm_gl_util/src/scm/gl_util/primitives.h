@@ -11,6 +11,9 @@
 #include <scm/gl_util/primitives/fullscreen_triangle.h>
 #include <scm/gl_util/primitives/geometry.h>
 #include <scm/gl_util/primitives/quad.h>
+#include <scm/gl_util/primitives/static_geometry_batch.h>
+#include <scm/gl_util/primitives/triangle_bvh.h>
+#include <scm/gl_util/primitives/loose_octree.h>
 #include <scm/gl_util/primitives/wavefront_obj.h>
 
 #endif // SCM_GL_UTIL_PRIMITIVES_H_INCLUDED
@@ -0,0 +1,512 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include "loose_octree.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include <scm/core/utilities/boost_warning_disable.h>
+#include <boost/thread/locks.hpp>
+#include <scm/core/utilities/boost_warning_enable.h>
+
+#include <scm/gl_core/primitives/frustum.h>
+#include <scm/gl_core/primitives/ray.h>
+
+namespace {
+
+using scm::math::vec3f;
+
+const unsigned      max_supported_depth = 31;
+const scm::size_t   query_stack_size    = 8 * max_supported_depth + 8;
+
+float
+half_extent(const vec3f& bmin, const vec3f& bmax)
+{
+    return 0.5f * (std::max)(bmax.x - bmin.x, (std::max)(bmax.y - bmin.y, bmax.z - bmin.z));
+}
+
+bool
+overlap(const vec3f& amin, const vec3f& amax,
+        const vec3f& bmin, const vec3f& bmax)
+{
+    return    amin.x <= bmax.x && amax.x >= bmin.x
+           && amin.y <= bmax.y && amax.y >= bmin.y
+           && amin.z <= bmax.z && amax.z >= bmin.z;
+}
+
+struct ray_slab
+{
+    ray_slab(const scm::gl::rayf& r, float t_max)
+      : _origin(r.origin()), _t_max(t_max)
+    {
+        for (unsigned a = 0; a < 3; ++a) {
+            _inv_dir[a] = 1.0f / r.direction()[a]; // +-inf for axis parallel rays
+        }
+    }
+
+    bool hit(const vec3f& bmin, const vec3f& bmax) const {
+        float t0 = 0.0f;
+        float t1 = _t_max;
+        for (unsigned a = 0; a < 3; ++a) {
+            float tn = (bmin[a] - _origin[a]) * _inv_dir[a];
+            float tf = (bmax[a] - _origin[a]) * _inv_dir[a];
+            if (tn > tf) {
+                std::swap(tn, tf);
+            }
+            // nan (origin on a slab plane of an axis parallel ray) keeps the range
+            t0 = tn > t0 ? tn : t0;
+            t1 = tf < t1 ? tf : t1;
+            if (t0 > t1) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    vec3f   _origin;
+    vec3f   _inv_dir;
+    float   _t_max;
+}; // struct ray_slab
+
+} // namespace
+
+namespace scm {
+namespace gl {
+
+const loose_octree::object_id   loose_octree::invalid_object;
+const scm::uint32               loose_octree::invalid_index;
+
+loose_octree::loose_octree(const boxf& world, unsigned max_depth)
+  : _max_depth((std::min)(max_depth, max_supported_depth))
+  , _object_count(0)
+{
+    const vec3f& wmin = world.min_vertex();
+    const vec3f& wmax = world.max_vertex();
+
+    if (   !(wmin.x < wmax.x)
+        || !(wmin.y < wmax.y)
+        || !(wmin.z < wmax.z)) {
+        throw std::runtime_error("loose_octree::loose_octree(): empty world bounds.");
+    }
+
+    // the root cell is a cube around the world bounds
+    node root;
+    root._center    = 0.5f * (wmin + wmax);
+    root._half_size = half_extent(wmin, wmax);
+    root._parent    = invalid_index;
+    std::fill(root._children, root._children + 8, invalid_index);
+    root._first_object = invalid_index;
+    root._octant    = 0;
+    root._depth     = 0;
+
+    _nodes.push_back(root);
+}
+
+loose_octree::~loose_octree()
+{
+}
+
+loose_octree::object_id
+loose_octree::insert(const boxf& b)
+{
+    boost::unique_lock<boost::shared_mutex> lock(_mutex);
+
+    object_id id;
+    if (_free_objects.empty()) {
+        id = static_cast<object_id>(_objects.size());
+        _objects.push_back(object_entry());
+    }
+    else {
+        id = _free_objects.back();
+        _free_objects.pop_back();
+    }
+
+    object_entry& o = _objects[id];
+    o._min = b.min_vertex();
+    o._max = b.max_vertex();
+
+    link(id, target_node(o._min, o._max));
+    ++_object_count;
+
+    return id;
+}
+
+void
+loose_octree::update(object_id id, const boxf& b)
+{
+    boost::unique_lock<boost::shared_mutex> lock(_mutex);
+
+    if (id >= _objects.size() || _objects[id]._node == invalid_index) {
+        throw std::runtime_error("loose_octree::update(): invalid object id.");
+    }
+
+    object_entry& o = _objects[id];
+    o._min = b.min_vertex();
+    o._max = b.max_vertex();
+
+    // the common case for tracked objects: small movements stay in the same cell
+    if (fits(_nodes[o._node], o._min, o._max)) {
+        return;
+    }
+
+    scm::uint32 old_node = o._node;
+    unlink(id);
+    link(id, target_node(o._min, o._max));
+    prune(old_node);
+}
+
+void
+loose_octree::remove(object_id id)
+{
+    boost::unique_lock<boost::shared_mutex> lock(_mutex);
+
+    if (id >= _objects.size() || _objects[id]._node == invalid_index) {
+        throw std::runtime_error("loose_octree::remove(): invalid object id.");
+    }
+
+    scm::uint32 old_node = _objects[id]._node;
+    unlink(id);
+    prune(old_node);
+
+    _objects[id]._node = invalid_index;
+    _free_objects.push_back(id);
+    --_object_count;
+}
+
+void
+loose_octree::clear()
+{
+    boost::unique_lock<boost::shared_mutex> lock(_mutex);
+
+    _nodes.resize(1);
+    std::fill(_nodes[0]._children, _nodes[0]._children + 8, invalid_index);
+    _nodes[0]._first_object = invalid_index;
+    _free_nodes.clear();
+    _objects.clear();
+    _free_objects.clear();
+    _object_count = 0;
+}
+
+const boxf
+loose_octree::bounds(object_id id) const
+{
+    boost::shared_lock<boost::shared_mutex> lock(_mutex);
+
+    if (id >= _objects.size() || _objects[id]._node == invalid_index) {
+        throw std::runtime_error("loose_octree::bounds(): invalid object id.");
+    }
+    return boxf(_objects[id]._min, _objects[id]._max);
+}
+
+scm::size_t
+loose_octree::object_count() const
+{
+    boost::shared_lock<boost::shared_mutex> lock(_mutex);
+    return _object_count;
+}
+
+scm::size_t
+loose_octree::node_count() const
+{
+    boost::shared_lock<boost::shared_mutex> lock(_mutex);
+    return _nodes.size() - _free_nodes.size();
+}
+
+void
+loose_octree::query(const frustumf&  f,
+                    object_id_array& results) const
+{
+    boost::shared_lock<boost::shared_mutex> lock(_mutex);
+
+    results.clear();
+
+    scm::uint32 stack[query_stack_size];
+    scm::size_t stack_size = 0;
+    stack[stack_size++] = 0;
+
+    while (stack_size > 0) {
+        const scm::uint32 ni = stack[--stack_size];
+        const node&       n  = _nodes[ni];
+
+        // the root also holds the objects outside the world cell, never reject it as a whole
+        if (ni != 0) {
+            frustumf::classification_result c = f.classify(loose_bounds(n));
+            if (c == frustumf::outside) {
+                continue;
+            }
+            else if (c == frustumf::inside) {
+                append_subtree(ni, results);
+                continue;
+            }
+        }
+
+        for (scm::uint32 oi = n._first_object; oi != invalid_index; oi = _objects[oi]._next) {
+            const object_entry& o = _objects[oi];
+            if (f.classify(boxf(o._min, o._max)) != frustumf::outside) {
+                results.push_back(oi);
+            }
+        }
+        for (unsigned c = 0; c < 8; ++c) {
+            if (n._children[c] != invalid_index) {
+                stack[stack_size++] = n._children[c];
+            }
+        }
+    }
+}
+
+void
+loose_octree::query(const boxf&      b,
+                    object_id_array& results) const
+{
+    boost::shared_lock<boost::shared_mutex> lock(_mutex);
+
+    results.clear();
+
+    const vec3f& bmin = b.min_vertex();
+    const vec3f& bmax = b.max_vertex();
+
+    scm::uint32 stack[query_stack_size];
+    scm::size_t stack_size = 0;
+    stack[stack_size++] = 0;
+
+    while (stack_size > 0) {
+        const scm::uint32 ni = stack[--stack_size];
+        const node&       n  = _nodes[ni];
+
+        if (ni != 0) {
+            const vec3f lext = vec3f(2.0f * n._half_size);
+            if (!overlap(n._center - lext, n._center + lext, bmin, bmax)) {
+                continue;
+            }
+        }
+
+        for (scm::uint32 oi = n._first_object; oi != invalid_index; oi = _objects[oi]._next) {
+            const object_entry& o = _objects[oi];
+            if (overlap(o._min, o._max, bmin, bmax)) {
+                results.push_back(oi);
+            }
+        }
+        for (unsigned c = 0; c < 8; ++c) {
+            if (n._children[c] != invalid_index) {
+                stack[stack_size++] = n._children[c];
+            }
+        }
+    }
+}
+
+void
+loose_octree::query(const rayf&      r,
+                    object_id_array& results,
+                    float            t_max) const
+{
+    boost::shared_lock<boost::shared_mutex> lock(_mutex);
+
+    results.clear();
+
+    const ray_slab slab(r, t_max);
+
+    scm::uint32 stack[query_stack_size];
+    scm::size_t stack_size = 0;
+    stack[stack_size++] = 0;
+
+    while (stack_size > 0) {
+        const scm::uint32 ni = stack[--stack_size];
+        const node&       n  = _nodes[ni];
+
+        if (ni != 0) {
+            const vec3f lext = vec3f(2.0f * n._half_size);
+            if (!slab.hit(n._center - lext, n._center + lext)) {
+                continue;
+            }
+        }
+
+        for (scm::uint32 oi = n._first_object; oi != invalid_index; oi = _objects[oi]._next) {
+            const object_entry& o = _objects[oi];
+            if (slab.hit(o._min, o._max)) {
+                results.push_back(oi);
+            }
+        }
+        for (unsigned c = 0; c < 8; ++c) {
+            if (n._children[c] != invalid_index) {
+                stack[stack_size++] = n._children[c];
+            }
+        }
+    }
+}
+
+scm::uint32
+loose_octree::allocate_node(scm::uint32 parent, unsigned octant)
+{
+    const node& p = _nodes[parent];
+    const float h = 0.5f * p._half_size;
+
+    node n;
+    n._center       = vec3f(p._center.x + ((octant & 1u) ? h : -h),
+                            p._center.y + ((octant & 2u) ? h : -h),
+                            p._center.z + ((octant & 4u) ? h : -h));
+    n._half_size    = h;
+    n._parent       = parent;
+    std::fill(n._children, n._children + 8, invalid_index);
+    n._first_object = invalid_index;
+    n._octant       = static_cast<scm::uint8>(octant);
+    n._depth        = static_cast<scm::uint8>(p._depth + 1);
+
+    scm::uint32 ni;
+    if (_free_nodes.empty()) {
+        ni = static_cast<scm::uint32>(_nodes.size());
+        _nodes.push_back(n); // invalidates p
+    }
+    else {
+        ni = _free_nodes.back();
+        _free_nodes.pop_back();
+        _nodes[ni] = n;
+    }
+
+    _nodes[parent]._children[octant] = ni;
+
+    return ni;
+}
+
+scm::uint32
+loose_octree::target_node(const vec3f& bmin, const vec3f& bmax)
+{
+    const vec3f c   = 0.5f * (bmin + bmax);
+    const float ext = half_extent(bmin, bmax);
+
+    scm::uint32 ni = 0;
+    {
+        const node& root = _nodes[0];
+        const vec3f d    = c - root._center;
+        if (   std::abs(d.x) > root._half_size
+            || std::abs(d.y) > root._half_size
+            || std::abs(d.z) > root._half_size
+            || ext > root._half_size) {
+            return 0;
+        }
+    }
+
+    // descend while the object still fits into the loose bounds of the child
+    while (   _nodes[ni]._depth < _max_depth
+           && ext <= 0.5f * _nodes[ni]._half_size) {
+        const node&    n      = _nodes[ni];
+        const unsigned octant =   (c.x >= n._center.x ? 1u : 0u)
+                                | (c.y >= n._center.y ? 2u : 0u)
+                                | (c.z >= n._center.z ? 4u : 0u);
+        scm::uint32    child  = n._children[octant];
+        if (child == invalid_index) {
+            child = allocate_node(ni, octant);
+        }
+        ni = child;
+    }
+
+    return ni;
+}
+
+bool
+loose_octree::fits(const node& n, const vec3f& bmin, const vec3f& bmax) const
+{
+    const vec3f c   = 0.5f * (bmin + bmax);
+    const float ext = half_extent(bmin, bmax);
+
+    if (n._depth == 0) {
+        // objects outside the world cell always stay in the root
+        const vec3f d = c - n._center;
+        const bool  outside_world =    std::abs(d.x) > n._half_size
+                                    || std::abs(d.y) > n._half_size
+                                    || std::abs(d.z) > n._half_size
+                                    || ext > n._half_size;
+        return outside_world || (_max_depth == 0) || ext > 0.5f * n._half_size;
+    }
+
+    // same node as target_node would pick: center in the cell, size matching the depth
+    const vec3f d = c - n._center;
+    return    std::abs(d.x) <= n._half_size
+           && std::abs(d.y) <= n._half_size
+           && std::abs(d.z) <= n._half_size
+           && ext <= n._half_size
+           && (n._depth == _max_depth || ext > 0.5f * n._half_size);
+}
+
+void
+loose_octree::link(object_id id, scm::uint32 n)
+{
+    object_entry& o = _objects[id];
+    o._node = n;
+    o._prev = invalid_index;
+    o._next = _nodes[n]._first_object;
+    if (o._next != invalid_index) {
+        _objects[o._next]._prev = id;
+    }
+    _nodes[n]._first_object = id;
+}
+
+void
+loose_octree::unlink(object_id id)
+{
+    object_entry& o = _objects[id];
+    if (o._prev != invalid_index) {
+        _objects[o._prev]._next = o._next;
+    }
+    else {
+        _nodes[o._node]._first_object = o._next;
+    }
+    if (o._next != invalid_index) {
+        _objects[o._next]._prev = o._prev;
+    }
+    o._prev = o._next = invalid_index;
+}
+
+void
+loose_octree::prune(scm::uint32 ni)
+{
+    // return empty leaf nodes to the pool up to the first non empty ancestor
+    while (ni != 0) {
+        node& n = _nodes[ni];
+        if (n._first_object != invalid_index) {
+            return;
+        }
+        for (unsigned c = 0; c < 8; ++c) {
+            if (n._children[c] != invalid_index) {
+                return;
+            }
+        }
+        const scm::uint32 parent = n._parent;
+        _nodes[parent]._children[n._octant] = invalid_index;
+        n._parent = invalid_index;
+        _free_nodes.push_back(ni);
+        ni = parent;
+    }
+}
+
+const boxf
+loose_octree::loose_bounds(const node& n) const
+{
+    const vec3f lext = vec3f(2.0f * n._half_size);
+    return boxf(n._center - lext, n._center + lext);
+}
+
+void
+loose_octree::append_subtree(scm::uint32 root, object_id_array& results) const
+{
+    scm::uint32 stack[query_stack_size];
+    scm::size_t stack_size = 0;
+    stack[stack_size++] = root;
+
+    while (stack_size > 0) {
+        const node& n = _nodes[stack[--stack_size]];
+        for (scm::uint32 oi = n._first_object; oi != invalid_index; oi = _objects[oi]._next) {
+            results.push_back(oi);
+        }
+        for (unsigned c = 0; c < 8; ++c) {
+            if (n._children[c] != invalid_index) {
+                stack[stack_size++] = n._children[c];
+            }
+        }
+    }
+}
+
+} // namespace gl
+} // namespace scm
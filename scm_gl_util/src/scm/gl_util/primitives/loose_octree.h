@@ -0,0 +1,120 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_GL_UTIL_PRIMITIVES_LOOSE_OCTREE_H_INCLUDED
+#define SCM_GL_UTIL_PRIMITIVES_LOOSE_OCTREE_H_INCLUDED
+
+#include <limits>
+#include <vector>
+
+#include <scm/core/utilities/boost_warning_disable.h>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/shared_mutex.hpp>
+#include <scm/core/utilities/boost_warning_enable.h>
+
+#include <scm/core/numeric_types.h>
+#include <scm/core/math.h>
+
+#include <scm/gl_core/primitives/primitives_fwd.h>
+#include <scm/gl_core/primitives/box.h>
+
+#include <scm/core/platform/platform.h>
+#include <scm/core/utilities/platform_warning_disable.h>
+
+namespace scm {
+namespace gl {
+
+// loose octree (loose factor 2) over axis aligned object bounds
+//  - objects are stored in the deepest node whose cell is at least as large as the
+//    object and which contains the object center, the loose node bounds (twice the
+//    cell size) then always enclose the object
+//  - insert, update and remove walk a single path of at most max_depth nodes, moving
+//    objects within their cell only rewrite the stored bounds
+//  - nodes and object entries are recycled through free lists, empty leaf nodes
+//    are returned to the pool
+//  - objects outside the world cell are kept in the root node
+//  - queries take a shared lock and may run concurrently, modifications are exclusive
+class __scm_export(gl_util) loose_octree : boost::noncopyable
+{
+public:
+    typedef scm::uint32                 object_id;
+    typedef std::vector<object_id>      object_id_array;
+
+    static const object_id              invalid_object = 0xffffffffu;
+
+public:
+    loose_octree(const boxf& world, unsigned max_depth = 8);
+    virtual ~loose_octree();
+
+    object_id               insert(const boxf& b);
+    void                    update(object_id id, const boxf& b);
+    void                    remove(object_id id);
+    void                    clear();
+
+    const boxf              bounds(object_id id) const;
+    scm::size_t             object_count() const;
+    scm::size_t             node_count() const;
+
+    // the queries clear results and fill in the objects intersecting the query
+    void                    query(const frustumf&  f,
+                                  object_id_array& results) const;
+    void                    query(const boxf&      b,
+                                  object_id_array& results) const;
+    void                    query(const rayf&      r,
+                                  object_id_array& results,
+                                  float            t_max = (std::numeric_limits<float>::max)()) const;
+
+protected:
+    static const scm::uint32 invalid_index = 0xffffffffu;
+
+    struct node
+    {
+        math::vec3f         _center;
+        float               _half_size;         // of the cell, the loose bounds are twice as large
+        scm::uint32         _parent;
+        scm::uint32         _children[8];
+        scm::uint32         _first_object;
+        scm::uint8          _octant;            // in the parent
+        scm::uint8          _depth;
+    }; // struct node
+
+    struct object_entry
+    {
+        math::vec3f         _min;
+        math::vec3f         _max;
+        scm::uint32         _node;              // invalid_index for free entries
+        scm::uint32         _prev;
+        scm::uint32         _next;
+    }; // struct object_entry
+
+    scm::uint32             allocate_node(scm::uint32 parent, unsigned octant);
+    scm::uint32             target_node(const math::vec3f& bmin, const math::vec3f& bmax);
+    bool                    fits(const node& n, const math::vec3f& bmin, const math::vec3f& bmax) const;
+
+    void                    link(object_id id, scm::uint32 n);
+    void                    unlink(object_id id);
+    void                    prune(scm::uint32 n);
+
+    const boxf              loose_bounds(const node& n) const;
+    void                    append_subtree(scm::uint32 n, object_id_array& results) const;
+
+protected:
+    unsigned                    _max_depth;
+
+    std::vector<node>           _nodes;             // _nodes[0] is the root
+    std::vector<scm::uint32>    _free_nodes;
+    std::vector<object_entry>   _objects;
+    std::vector<object_id>      _free_objects;
+    scm::size_t                 _object_count;
+
+    mutable boost::shared_mutex _mutex;
+
+}; // class loose_octree
+
+} // namespace gl
+} // namespace scm
+
+#include <scm/core/utilities/platform_warning_enable.h>
+
+#endif // SCM_GL_UTIL_PRIMITIVES_LOOSE_OCTREE_H_INCLUDED
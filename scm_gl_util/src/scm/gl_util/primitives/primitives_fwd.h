@@ -22,6 +22,10 @@ class box_volume_geometry;
 class quad_geometry;
 class fullscreen_triangle;
 class wavefront_obj_geometry;
+class triangle_bvh;
+class loose_octree;
+class static_batch_builder;
+class static_geometry_batch;
 
 typedef shared_ptr<geometry>                        geometry_ptr;
 typedef shared_ptr<geometry const>                  geometry_cptr;
@@ -37,6 +41,14 @@ typedef shared_ptr<fullscreen_triangle>             fullscreen_triangle_ptr;
 typedef shared_ptr<fullscreen_triangle const>       fullscreen_triangle_cptr;
 typedef shared_ptr<wavefront_obj_geometry>          wavefront_obj_geometry_ptr;
 typedef shared_ptr<wavefront_obj_geometry const>    wavefront_obj_geometry_cptr;
+typedef shared_ptr<triangle_bvh>                    triangle_bvh_ptr;
+typedef shared_ptr<triangle_bvh const>              triangle_bvh_cptr;
+typedef shared_ptr<loose_octree>                    loose_octree_ptr;
+typedef shared_ptr<loose_octree const>              loose_octree_cptr;
+typedef shared_ptr<static_batch_builder>            static_batch_builder_ptr;
+typedef shared_ptr<static_batch_builder const>      static_batch_builder_cptr;
+typedef shared_ptr<static_geometry_batch>           static_geometry_batch_ptr;
+typedef shared_ptr<static_geometry_batch const>     static_geometry_batch_cptr;
 
 } // namespace gl
 } // namespace scm
@@ -0,0 +1,274 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include "static_geometry_batch.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+#include <boost/assign/list_of.hpp>
+
+#include <scm/gl_core/render_device.h>
+#include <scm/gl_core/buffer_objects.h>
+#include <scm/gl_core/render_device/context_guards.h>
+
+namespace scm {
+namespace gl {
+
+// static_batch_builder ///////////////////////////////////////////////////////////////////////////
+static_batch_builder::static_batch_builder(scm::size_t in_vertex_stride)
+  : _vertex_stride(in_vertex_stride)
+{
+    if (0 == _vertex_stride) {
+        throw std::runtime_error("static_batch_builder::static_batch_builder(): invalid vertex stride.");
+    }
+}
+
+static_batch_builder::~static_batch_builder()
+{
+}
+
+static_batch_builder::mesh_id
+static_batch_builder::add_mesh(const void*        in_vertices,
+                               scm::size_t        in_vertex_count,
+                               const scm::uint32* in_indices,
+                               scm::size_t        in_index_count)
+{
+    assert(in_vertices || 0 == in_vertex_count);
+    assert(in_indices  || 0 == in_index_count);
+
+    mesh_range m;
+    m._first_index  = static_cast<scm::uint32>(_index_data.size());
+    m._index_count  = static_cast<scm::uint32>(in_index_count);
+    m._base_vertex  = static_cast<scm::int32>(vertex_count());
+    m._vertex_count = static_cast<scm::uint32>(in_vertex_count);
+
+    const scm::uint8* v = static_cast<const scm::uint8*>(in_vertices);
+    _vertex_data.insert(_vertex_data.end(), v, v + in_vertex_count * _vertex_stride);
+    _index_data.insert(_index_data.end(), in_indices, in_indices + in_index_count);
+    _meshes.push_back(m);
+
+    return static_cast<mesh_id>(_meshes.size() - 1);
+}
+
+void
+static_batch_builder::clear()
+{
+    _vertex_data.clear();
+    _index_data.clear();
+    _meshes.clear();
+}
+
+scm::size_t
+static_batch_builder::vertex_stride() const
+{
+    return _vertex_stride;
+}
+
+scm::size_t
+static_batch_builder::vertex_count() const
+{
+    return _vertex_data.size() / _vertex_stride;
+}
+
+scm::size_t
+static_batch_builder::mesh_count() const
+{
+    return _meshes.size();
+}
+
+const static_batch_builder::mesh_range&
+static_batch_builder::mesh(mesh_id in_mesh) const
+{
+    assert(in_mesh < _meshes.size());
+    return _meshes[in_mesh];
+}
+
+const std::vector<scm::uint8>&
+static_batch_builder::vertex_data() const
+{
+    return _vertex_data;
+}
+
+const std::vector<scm::uint32>&
+static_batch_builder::index_data() const
+{
+    return _index_data;
+}
+
+void
+static_batch_builder::build_commands(const draw_reference_array& in_visible,
+                                     draw_command_array&         out_commands,
+                                     bucket_range_array&         out_buckets) const
+{
+    out_commands.clear();
+    out_buckets.clear();
+
+    // bucket in the upper, reference index in the lower half keeps the sort stable
+    std::vector<scm::uint64> order(in_visible.size());
+    for (scm::size_t i = 0; i < in_visible.size(); ++i) {
+        order[i] = (static_cast<scm::uint64>(in_visible[i]._bucket) << 32) | static_cast<scm::uint64>(i);
+    }
+    std::sort(order.begin(), order.end());
+
+    out_commands.reserve(in_visible.size());
+    for (scm::size_t i = 0; i < order.size(); ++i) {
+        const draw_reference& r = in_visible[static_cast<scm::size_t>(order[i] & 0xffffffffu)];
+        assert(r._mesh < _meshes.size());
+        const mesh_range& m = _meshes[r._mesh];
+
+        if (out_buckets.empty() || out_buckets.back()._bucket != r._bucket) {
+            bucket_range b;
+            b._bucket        = r._bucket;
+            b._first_command = static_cast<scm::uint32>(out_commands.size());
+            b._command_count = 0;
+            out_buckets.push_back(b);
+        }
+        else {
+            draw_command& prev = out_commands.back();
+            if (   prev._first_index == m._first_index
+                && prev._count       == m._index_count
+                && prev._base_vertex == m._base_vertex
+                && prev._base_instance + prev._instance_count == r._instance) {
+                ++prev._instance_count;
+                continue;
+            }
+        }
+
+        draw_command c;
+        c._count          = m._index_count;
+        c._instance_count = 1;
+        c._first_index    = m._first_index;
+        c._base_vertex    = m._base_vertex;
+        c._base_instance  = r._instance;
+        out_commands.push_back(c);
+        ++out_buckets.back()._command_count;
+    }
+}
+
+// static_geometry_batch //////////////////////////////////////////////////////////////////////////
+static_geometry_batch::static_geometry_batch(const render_device_ptr&    in_device,
+                                             const static_batch_builder& in_builder,
+                                             const vertex_format&        in_vertex_format,
+                                             const primitive_topology    in_topology)
+  : _device(in_device)
+  , _topology(in_topology)
+  , _indirect_buffer_size(0)
+{
+    using boost::assign::list_of;
+
+    if (   in_builder.vertex_data().empty()
+        || in_builder.index_data().empty()) {
+        throw std::runtime_error("static_geometry_batch::static_geometry_batch(): empty batch.");
+    }
+
+    _vertex_buffer = in_device->create_buffer(BIND_VERTEX_BUFFER, USAGE_STATIC_DRAW,
+                                              in_builder.vertex_data().size(), &in_builder.vertex_data()[0]);
+    _index_buffer  = in_device->create_buffer(BIND_INDEX_BUFFER, USAGE_STATIC_DRAW,
+                                              in_builder.index_data().size() * sizeof(scm::uint32), &in_builder.index_data()[0]);
+    if (!_vertex_buffer || !_index_buffer) {
+        throw std::runtime_error("static_geometry_batch::static_geometry_batch(): unable to create vertex or index buffer.");
+    }
+
+    _vertex_array = in_device->create_vertex_array(in_vertex_format, list_of(_vertex_buffer));
+    if (!_vertex_array) {
+        throw std::runtime_error("static_geometry_batch::static_geometry_batch(): unable to create vertex array.");
+    }
+}
+
+static_geometry_batch::~static_geometry_batch()
+{
+    _indirect_buffer.reset();
+    _vertex_array.reset();
+    _index_buffer.reset();
+    _vertex_buffer.reset();
+}
+
+void
+static_geometry_batch::draw(const render_context_ptr&                         in_context,
+                            const static_batch_builder::draw_command_array&   in_commands,
+                            const static_batch_builder::bucket_range_array&   in_buckets,
+                            const bucket_setup_func&                          in_bucket_setup)
+{
+    if (in_commands.empty()) {
+        return;
+    }
+
+    const scm::size_t cmd_size = in_commands.size() * sizeof(static_batch_builder::draw_command);
+
+    // the indirect buffer grows to the next power of two and is orphaned on every upload
+    if (cmd_size > _indirect_buffer_size) {
+        scm::size_t new_size = (std::max)(_indirect_buffer_size, scm::size_t(4096));
+        while (new_size < cmd_size) {
+            new_size *= 2;
+        }
+        render_device_ptr device = _device.lock();
+        if (!device) {
+            throw std::runtime_error("static_geometry_batch::draw(): render device expired.");
+        }
+        if (!_indirect_buffer) {
+            _indirect_buffer = device->create_buffer(BIND_INDIRECT_BUFFER, USAGE_STREAM_DRAW, new_size);
+            if (!_indirect_buffer) {
+                throw std::runtime_error("static_geometry_batch::draw(): unable to create indirect buffer.");
+            }
+        }
+        else if (!device->resize_buffer(_indirect_buffer, new_size)) {
+            throw std::runtime_error("static_geometry_batch::draw(): unable to resize indirect buffer.");
+        }
+        _indirect_buffer_size = new_size;
+    }
+
+    void* cmd_data = in_context->map_buffer_range(_indirect_buffer, 0, cmd_size, ACCESS_WRITE_INVALIDATE_BUFFER);
+    if (!cmd_data) {
+        return;
+    }
+    std::memcpy(cmd_data, &in_commands[0], cmd_size);
+    in_context->unmap_buffer(_indirect_buffer);
+
+    context_vertex_input_guard cvg(in_context);
+
+    const buffer_ptr save_indirect_buffer = in_context->current_indirect_buffer();
+
+    in_context->bind_vertex_array(_vertex_array);
+    in_context->bind_index_buffer(_index_buffer, _topology, TYPE_UINT);
+    in_context->bind_indirect_buffer(_indirect_buffer);
+
+    for (scm::size_t b = 0; b < in_buckets.size(); ++b) {
+        const static_batch_builder::bucket_range& r = in_buckets[b];
+        if (0 == r._command_count) {
+            continue;
+        }
+        if (in_bucket_setup) {
+            in_bucket_setup(r._bucket);
+        }
+        in_context->apply();
+        in_context->multi_draw_elements_indirect(static_cast<int>(r._command_count),
+                                                 r._first_command * sizeof(static_batch_builder::draw_command));
+    }
+
+    in_context->bind_indirect_buffer(save_indirect_buffer);
+}
+
+const buffer_ptr&
+static_geometry_batch::vertex_buffer() const
+{
+    return _vertex_buffer;
+}
+
+const buffer_ptr&
+static_geometry_batch::index_buffer() const
+{
+    return _index_buffer;
+}
+
+const vertex_array_ptr&
+static_geometry_batch::vertex_array() const
+{
+    return _vertex_array;
+}
+
+} // namespace gl
+} // namespace scm
@@ -0,0 +1,143 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_GL_UTIL_STATIC_GEOMETRY_BATCH_H_INCLUDED
+#define SCM_GL_UTIL_STATIC_GEOMETRY_BATCH_H_INCLUDED
+
+#include <vector>
+
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <scm/core/numeric_types.h>
+
+#include <scm/gl_core/constants.h>
+#include <scm/gl_core/gl_core_fwd.h>
+#include <scm/gl_core/buffer_objects/vertex_format.h>
+
+#include <scm/gl_util/primitives/primitives_fwd.h>
+
+#include <scm/core/platform/platform.h>
+#include <scm/core/utilities/platform_warning_disable.h>
+
+namespace scm {
+namespace gl {
+
+// cpu side of static geometry batching, does not touch the GL
+//  - meshes sharing one vertex layout are appended to a single vertex and 32 bit index
+//    array, each mesh keeps its index range and base vertex
+//  - build_commands turns a visible set into DrawElementsIndirectCommand structures
+//    grouped by bucket (e.g. material) in ascending bucket order, references to the same
+//    mesh with consecutive instances are merged into one instanced command
+class __scm_export(gl_util) static_batch_builder
+{
+public:
+    typedef scm::uint32 mesh_id;
+
+    struct mesh_range {
+        scm::uint32         _first_index;
+        scm::uint32         _index_count;
+        scm::int32          _base_vertex;
+        scm::uint32         _vertex_count;
+    }; // struct mesh_range
+
+    // layout of DrawElementsIndirectCommand
+    struct draw_command {
+        scm::uint32         _count;
+        scm::uint32         _instance_count;
+        scm::uint32         _first_index;
+        scm::int32          _base_vertex;
+        scm::uint32         _base_instance;
+    }; // struct draw_command
+
+    struct draw_reference {
+        mesh_id             _mesh;
+        unsigned            _bucket;
+        scm::uint32         _instance;      // base instance of the command, indexes per draw data
+    }; // struct draw_reference
+
+    struct bucket_range {
+        unsigned            _bucket;
+        scm::uint32         _first_command;
+        scm::uint32         _command_count;
+    }; // struct bucket_range
+
+    typedef std::vector<draw_reference> draw_reference_array;
+    typedef std::vector<draw_command>   draw_command_array;
+    typedef std::vector<bucket_range>   bucket_range_array;
+
+public:
+    static_batch_builder(scm::size_t in_vertex_stride);
+    virtual ~static_batch_builder();
+
+    // indices are relative to the first vertex of the mesh
+    mesh_id                         add_mesh(const void*        in_vertices,
+                                             scm::size_t        in_vertex_count,
+                                             const scm::uint32* in_indices,
+                                             scm::size_t        in_index_count);
+    void                            clear();
+
+    scm::size_t                     vertex_stride() const;
+    scm::size_t                     vertex_count() const;
+    scm::size_t                     mesh_count() const;
+    const mesh_range&               mesh(mesh_id in_mesh) const;
+
+    const std::vector<scm::uint8>&  vertex_data() const;
+    const std::vector<scm::uint32>& index_data() const;
+
+    void                            build_commands(const draw_reference_array& in_visible,
+                                                   draw_command_array&         out_commands,
+                                                   bucket_range_array&         out_buckets) const;
+
+protected:
+    scm::size_t                     _vertex_stride;
+    std::vector<scm::uint8>         _vertex_data;
+    std::vector<scm::uint32>        _index_data;
+    std::vector<mesh_range>         _meshes;
+
+}; // class static_batch_builder
+
+// gpu side, the builder contents in one vertex array drawn with one multi draw
+// indirect per bucket
+class __scm_export(gl_util) static_geometry_batch : boost::noncopyable
+{
+public:
+    typedef boost::function<void (unsigned)>    bucket_setup_func;
+
+public:
+    static_geometry_batch(const render_device_ptr&    in_device,
+                          const static_batch_builder& in_builder,
+                          const vertex_format&        in_vertex_format,
+                          const primitive_topology    in_topology = PRIMITIVE_TRIANGLE_LIST);
+    virtual ~static_geometry_batch();
+
+    // uploads the commands to the indirect buffer, in_bucket_setup is called before the
+    // draw of each bucket to bind its material
+    void                    draw(const render_context_ptr&                         in_context,
+                                 const static_batch_builder::draw_command_array&   in_commands,
+                                 const static_batch_builder::bucket_range_array&   in_buckets,
+                                 const bucket_setup_func&                          in_bucket_setup = bucket_setup_func());
+
+    const buffer_ptr&       vertex_buffer() const;
+    const buffer_ptr&       index_buffer() const;
+    const vertex_array_ptr& vertex_array() const;
+
+protected:
+    render_device_wptr      _device;
+    primitive_topology      _topology;
+
+    buffer_ptr              _vertex_buffer;
+    buffer_ptr              _index_buffer;
+    vertex_array_ptr        _vertex_array;
+    buffer_ptr              _indirect_buffer;
+    scm::size_t             _indirect_buffer_size;
+
+}; // class static_geometry_batch
+
+} // namespace gl
+} // namespace scm
+
+#include <scm/core/utilities/platform_warning_enable.h>
+
+#endif // SCM_GL_UTIL_STATIC_GEOMETRY_BATCH_H_INCLUDED
@@ -0,0 +1,757 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include "triangle_bvh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include <boost/scoped_ptr.hpp>
+
+#include <scm/core/utilities/foreach.h>
+#include <scm/core/utilities/thread_pool.h>
+
+#include <scm/gl_core/primitives/box.h>
+#include <scm/gl_core/primitives/ray.h>
+
+#include <scm/gl_util/primitives/util/wavefront_obj_file.h>
+#include <scm/gl_util/primitives/util/wavefront_obj_to_vertex_array.h>
+
+#if SCM_CORE_MATH_SIMD == SCM_CORE_MATH_SIMD_SSE
+#include <emmintrin.h>
+#endif // SCM_CORE_MATH_SIMD == SCM_CORE_MATH_SIMD_SSE
+
+namespace {
+
+using scm::math::vec3f;
+
+const unsigned      sah_bin_count       = 16;
+const scm::uint32   max_leaf_triangles  = 4;    // smaller ranges always become leaves
+const scm::uint32   force_split_count   = 32;   // larger ranges are split even against the heuristic
+const float         traversal_cost      = 1.0f; // relative to one triangle test
+const scm::size_t   packet_grain        = 64;   // packets per parallel task
+const unsigned      traversal_stack     = 64;
+const unsigned      max_tree_depth      = traversal_stack - 1;
+
+struct triangle_bounds
+{
+    vec3f       _min;
+    vec3f       _max;
+    vec3f       _centroid;
+}; // struct triangle_bounds
+
+struct aabb
+{
+    aabb() : _min((std::numeric_limits<float>::max)()), _max(-(std::numeric_limits<float>::max)()) {}
+
+    void extend(const vec3f& p) {
+        _min = scm::math::min(_min, p);
+        _max = scm::math::max(_max, p);
+    }
+    void extend(const aabb& b) {
+        _min = scm::math::min(_min, b._min);
+        _max = scm::math::max(_max, b._max);
+    }
+    float half_area() const {
+        const vec3f d = _max - _min;
+        return (d.x < 0.0f) ? 0.0f : d.x * d.y + d.y * d.z + d.z * d.x;
+    }
+
+    vec3f       _min;
+    vec3f       _max;
+}; // struct aabb
+
+struct build_node
+{
+    build_node(scm::uint32 b, scm::uint32 e) : _begin(b), _end(e), _axis(0) {}
+
+    aabb                            _bounds;
+    scm::uint32                     _begin;
+    scm::uint32                     _end;
+    unsigned                        _axis;
+    boost::scoped_ptr<build_node>   _children[2];
+}; // struct build_node
+
+class bvh_builder
+{
+public:
+    bvh_builder(const std::vector<triangle_bounds>& tris,
+                std::vector<scm::uint32>&           ids)
+      : _tris(tris)
+      , _ids(ids)
+    {}
+
+    // splits the node and recurses, nodes at defer_depth are collected for parallel processing
+    void build(build_node* n, unsigned depth, unsigned defer_depth, std::vector<build_node*>* deferred) {
+        compute_bounds(n);
+
+        if (!deferred) {
+            build_subtree(n, depth);
+        }
+        else if (depth == defer_depth) {
+            deferred->push_back(n);
+        }
+        else if (split(n)) {
+            build(n->_children[0].get(), depth + 1, defer_depth, deferred);
+            build(n->_children[1].get(), depth + 1, defer_depth, deferred);
+        }
+    }
+
+    // expects the bounds of n to be computed
+    void build_subtree(build_node* n, unsigned depth) {
+        if (depth < max_tree_depth && split(n)) {
+            for (unsigned c = 0; c < 2; ++c) {
+                compute_bounds(n->_children[c].get());
+                build_subtree(n->_children[c].get(), depth + 1);
+            }
+        }
+    }
+
+protected:
+    void compute_bounds(build_node* n) const {
+        for (scm::uint32 i = n->_begin; i < n->_end; ++i) {
+            const triangle_bounds& t = _tris[_ids[i]];
+            n->_bounds.extend(t._min);
+            n->_bounds.extend(t._max);
+        }
+    }
+
+    bool split(build_node* n) {
+        const scm::uint32 count = n->_end - n->_begin;
+        if (count <= max_leaf_triangles) {
+            return false;
+        }
+
+        aabb centroid_bounds;
+        for (scm::uint32 i = n->_begin; i < n->_end; ++i) {
+            centroid_bounds.extend(_tris[_ids[i]]._centroid);
+        }
+
+        // binned surface area heuristic on all three axes
+        float       best_cost = (std::numeric_limits<float>::max)();
+        unsigned    best_axis = 0;
+        unsigned    best_bin  = 0;
+
+        for (unsigned a = 0; a < 3; ++a) {
+            const float extent = centroid_bounds._max[a] - centroid_bounds._min[a];
+            if (extent <= 0.0f) {
+                continue;
+            }
+            const float scale = float(sah_bin_count) / extent;
+
+            aabb        bin_bounds[sah_bin_count];
+            scm::uint32 bin_counts[sah_bin_count] = {0};
+
+            for (scm::uint32 i = n->_begin; i < n->_end; ++i) {
+                const triangle_bounds& t = _tris[_ids[i]];
+                const unsigned         b = bin_index(t._centroid[a], centroid_bounds._min[a], scale);
+                ++bin_counts[b];
+                bin_bounds[b].extend(t._min);
+                bin_bounds[b].extend(t._max);
+            }
+
+            // sweep from the right, then evaluate split planes from the left
+            float       right_area[sah_bin_count];
+            scm::uint32 right_count[sah_bin_count];
+            aabb        acc;
+            scm::uint32 acc_count = 0;
+            for (unsigned b = sah_bin_count - 1; b > 0; --b) {
+                acc.extend(bin_bounds[b]);
+                acc_count += bin_counts[b];
+                right_area[b]  = acc.half_area();
+                right_count[b] = acc_count;
+            }
+
+            acc       = aabb();
+            acc_count = 0;
+            for (unsigned b = 0; b < sah_bin_count - 1; ++b) {
+                acc.extend(bin_bounds[b]);
+                acc_count += bin_counts[b];
+                if (acc_count == 0 || right_count[b + 1] == 0) {
+                    continue;
+                }
+                const float cost = acc.half_area() * float(acc_count) + right_area[b + 1] * float(right_count[b + 1]);
+                if (cost < best_cost) {
+                    best_cost = cost;
+                    best_axis = a;
+                    best_bin  = b;
+                }
+            }
+        }
+
+        scm::uint32 mid = n->_begin;
+
+        if (best_cost < (std::numeric_limits<float>::max)()) {
+            const float leaf_cost  = float(count);
+            const float split_cost = traversal_cost + best_cost / n->_bounds.half_area();
+            if (split_cost >= leaf_cost && count <= force_split_count) {
+                return false;
+            }
+
+            const float extent = centroid_bounds._max[best_axis] - centroid_bounds._min[best_axis];
+            const float scale  = float(sah_bin_count) / extent;
+            const float cmin   = centroid_bounds._min[best_axis];
+            mid = static_cast<scm::uint32>(std::partition(_ids.begin() + n->_begin, _ids.begin() + n->_end,
+                                                          [&](scm::uint32 id) {
+                                                              return bin_index(_tris[id]._centroid[best_axis], cmin, scale) <= best_bin;
+                                                          }) - _ids.begin());
+            n->_axis = best_axis;
+        }
+        else {
+            // all centroids coincide, split large ranges in the middle
+            if (count <= force_split_count) {
+                return false;
+            }
+            mid = n->_begin + count / 2;
+            n->_axis = 0;
+        }
+
+        n->_children[0].reset(new build_node(n->_begin, mid));
+        n->_children[1].reset(new build_node(mid, n->_end));
+
+        return true;
+    }
+
+    static unsigned bin_index(float c, float cmin, float scale) {
+        const int b = static_cast<int>((c - cmin) * scale);
+        return static_cast<unsigned>(std::max(0, std::min(int(sah_bin_count) - 1, b)));
+    }
+
+protected:
+    const std::vector<triangle_bounds>& _tris;
+    std::vector<scm::uint32>&           _ids;
+}; // class bvh_builder
+
+// depth first layout, the first child directly follows its parent
+void
+flatten(const build_node* b, std::vector<scm::gl::triangle_bvh::node>& nodes)
+{
+    const std::size_t index = nodes.size();
+    nodes.push_back(scm::gl::triangle_bvh::node());
+
+    for (unsigned c = 0; c < 3; ++c) {
+        nodes[index]._min[c] = b->_bounds._min[c];
+        nodes[index]._max[c] = b->_bounds._max[c];
+    }
+
+    if (b->_children[0]) {
+        flatten(b->_children[0].get(), nodes);
+        nodes[index]._offset = static_cast<scm::uint32>(nodes.size());
+        nodes[index]._flags  = b->_axis;
+        flatten(b->_children[1].get(), nodes);
+    }
+    else {
+        nodes[index]._offset = b->_begin;
+        nodes[index]._flags  = ((b->_end - b->_begin) << 2) | 3u;
+    }
+}
+
+inline bool
+intersect_node(const scm::gl::triangle_bvh::node& n,
+               const vec3f&                       org,
+               const vec3f&                       inv_dir,
+               float                              t_max)
+{
+    float t0 = 0.0f;
+    float t1 = t_max;
+    for (unsigned a = 0; a < 3; ++a) {
+        float tn = (n._min[a] - org[a]) * inv_dir[a];
+        float tf = (n._max[a] - org[a]) * inv_dir[a];
+        if (tn > tf) {
+            std::swap(tn, tf);
+        }
+        t0 = tn > t0 ? tn : t0;
+        t1 = tf < t1 ? tf : t1;
+    }
+    return t0 <= t1;
+}
+
+// moeller-trumbore, tri holds v0, e1, e2
+inline bool
+intersect_triangle(const float*  tri,
+                   const vec3f&  org,
+                   const vec3f&  dir,
+                   float         t_max,
+                   float&        t,
+                   float&        u,
+                   float&        v)
+{
+    using namespace scm::math;
+
+    const vec3f v0(tri[0], tri[1], tri[2]);
+    const vec3f e1(tri[3], tri[4], tri[5]);
+    const vec3f e2(tri[6], tri[7], tri[8]);
+
+    const vec3f p   = cross(dir, e2);
+    const float det = dot(e1, p);
+    if (std::fabs(det) < 1.0e-12f) {
+        return false;
+    }
+    const float inv_det = 1.0f / det;
+    const vec3f s = org - v0;
+    u = dot(s, p) * inv_det;
+    if (u < 0.0f || u > 1.0f) {
+        return false;
+    }
+    const vec3f q = cross(s, e1);
+    v = dot(dir, q) * inv_det;
+    if (v < 0.0f || u + v > 1.0f) {
+        return false;
+    }
+    t = dot(e2, q) * inv_det;
+    return t > 0.0f && t < t_max;
+}
+
+inline vec3f
+inverse_direction(const vec3f& d)
+{
+    return vec3f(1.0f / d.x, 1.0f / d.y, 1.0f / d.z);
+}
+
+} // namespace
+
+namespace scm {
+namespace gl {
+
+const scm::uint32 ray_hit::invalid_triangle;
+
+triangle_bvh::triangle_bvh(const math::vec3f*  vertices,
+                           scm::size_t         vertex_count,
+                           const scm::uint32*  indices,
+                           scm::size_t         triangle_count,
+                           thread_pool*        pool)
+{
+    build(vertices, vertex_count, indices, triangle_count, pool);
+}
+
+triangle_bvh::triangle_bvh(const util::wavefront_model& model,
+                           thread_pool*                 pool)
+{
+    using namespace util;
+
+    // obj face indices are one based
+    std::vector<scm::uint32> indices;
+    foreach (const wavefront_object& obj, model._objects) {
+        foreach (const wavefront_object_group& grp, obj._groups) {
+            for (std::size_t f = 0; f < grp._num_tri_faces; ++f) {
+                for (unsigned k = 0; k < 3; ++k) {
+                    if (grp._tri_faces[f]._vertices[k] == 0) {
+                        throw std::runtime_error("triangle_bvh::triangle_bvh(): invalid wavefront face vertex index.");
+                    }
+                    indices.push_back(grp._tri_faces[f]._vertices[k] - 1);
+                }
+            }
+        }
+    }
+
+    build(model._vertices.get(), model._num_vertices,
+          indices.empty() ? 0 : &indices[0], indices.size() / 3, pool);
+}
+
+triangle_bvh::triangle_bvh(const util::vertexbuffer_data& data,
+                           bool                           interleaved,
+                           thread_pool*                   pool)
+{
+    const scm::size_t vertex_count = data._vert_array_count;
+
+    // gather the positions into a contiguous array
+    scm::size_t stride = 3;
+    if (interleaved) {
+        stride += data._normals_offset   ? 3 : 0;
+        stride += data._texcoords_offset ? 2 : 0;
+    }
+
+    std::vector<math::vec3f> positions(vertex_count);
+    for (scm::size_t i = 0; i < vertex_count; ++i) {
+        const float* p = data._vert_array.get() + i * stride;
+        positions[i] = math::vec3f(p[0], p[1], p[2]);
+    }
+
+    std::vector<scm::uint32> indices;
+    for (std::size_t a = 0; a < data._index_arrays.size(); ++a) {
+        const scm::uint32* ia = data._index_arrays[a].get();
+        indices.insert(indices.end(), ia, ia + data._index_array_counts[a]);
+    }
+
+    build(positions.empty() ? 0 : &positions[0], vertex_count,
+          indices.empty() ? 0 : &indices[0], indices.size() / 3, pool);
+}
+
+triangle_bvh::~triangle_bvh()
+{
+}
+
+scm::size_t
+triangle_bvh::triangle_count() const
+{
+    return _triangle_ids.size();
+}
+
+scm::size_t
+triangle_bvh::node_count() const
+{
+    return _nodes.size();
+}
+
+const std::vector<triangle_bvh::node>&
+triangle_bvh::nodes() const
+{
+    return _nodes;
+}
+
+const boxf
+triangle_bvh::bounds() const
+{
+    if (_triangle_ids.empty()) {
+        return boxf(math::vec3f(0.0f), math::vec3f(0.0f));
+    }
+    return boxf(math::vec3f(_nodes[0]._min[0], _nodes[0]._min[1], _nodes[0]._min[2]),
+                math::vec3f(_nodes[0]._max[0], _nodes[0]._max[1], _nodes[0]._max[2]));
+}
+
+void
+triangle_bvh::build(const math::vec3f*  vertices,
+                    scm::size_t         vertex_count,
+                    const scm::uint32*  indices,
+                    scm::size_t         triangle_count,
+                    thread_pool*        pool)
+{
+    _nodes.clear();
+    _triangles.clear();
+    _triangle_ids.clear();
+
+    if (triangle_count == 0) {
+        return;
+    }
+    if (triangle_count > (std::numeric_limits<scm::uint32>::max)() >> 2) {
+        throw std::runtime_error("triangle_bvh::build(): too many triangles.");
+    }
+    for (scm::size_t i = 0; i < triangle_count * 3; ++i) {
+        if (indices[i] >= vertex_count) {
+            throw std::runtime_error("triangle_bvh::build(): vertex index out of range.");
+        }
+    }
+
+    std::vector<triangle_bounds> tris(triangle_count);
+    _triangle_ids.resize(triangle_count);
+
+    for (scm::size_t t = 0; t < triangle_count; ++t) {
+        const math::vec3f& v0 = vertices[indices[3 * t    ]];
+        const math::vec3f& v1 = vertices[indices[3 * t + 1]];
+        const math::vec3f& v2 = vertices[indices[3 * t + 2]];
+
+        tris[t]._min      = math::min(v0, math::min(v1, v2));
+        tris[t]._max      = math::max(v0, math::max(v1, v2));
+        tris[t]._centroid = (tris[t]._min + tris[t]._max) * 0.5f;
+        _triangle_ids[t]  = static_cast<scm::uint32>(t);
+    }
+
+    bvh_builder                 builder(tris, _triangle_ids);
+    build_node                  root(0, static_cast<scm::uint32>(triangle_count));
+    std::vector<build_node*>    deferred;
+
+    if (pool && pool->thread_count() > 0) {
+        // top levels sequentially, the subtrees below in parallel on disjoint id ranges
+        unsigned defer_depth = 2;
+        while ((1u << defer_depth) < 4 * pool->thread_count() && defer_depth < 8) {
+            ++defer_depth;
+        }
+        builder.build(&root, 0, defer_depth, &deferred);
+        pool->parallel_for(0, deferred.size(), 1, [&](scm::size_t b, scm::size_t e) {
+            for (scm::size_t d = b; d < e; ++d) {
+                builder.build_subtree(deferred[d], defer_depth);
+            }
+        });
+    }
+    else {
+        builder.build(&root, 0, 0, 0);
+    }
+
+    _nodes.reserve(2 * triangle_count / max_leaf_triangles + 1);
+    flatten(&root, _nodes);
+
+    _triangles.resize(9 * triangle_count);
+    for (scm::size_t t = 0; t < triangle_count; ++t) {
+        const scm::uint32  id = _triangle_ids[t];
+        const math::vec3f& v0 = vertices[indices[3 * id    ]];
+        const math::vec3f  e1 = vertices[indices[3 * id + 1]] - v0;
+        const math::vec3f  e2 = vertices[indices[3 * id + 2]] - v0;
+
+        float* dst = &_triangles[9 * t];
+        for (unsigned c = 0; c < 3; ++c) {
+            dst[c]     = v0[c];
+            dst[3 + c] = e1[c];
+            dst[6 + c] = e2[c];
+        }
+    }
+}
+
+bool
+triangle_bvh::closest_hit(const rayf&  r,
+                          ray_hit&     hit,
+                          float        t_max) const
+{
+    hit = ray_hit();
+    if (_nodes.empty()) {
+        return false;
+    }
+
+    const math::vec3f& org     = r.origin();
+    const math::vec3f& dir     = r.direction();
+    const math::vec3f  inv_dir = inverse_direction(dir);
+
+    scm::uint32 stack[traversal_stack];
+    unsigned    stack_size = 0;
+    scm::uint32 current    = 0;
+
+    for (;;) {
+        const node& n = _nodes[current];
+
+        if (intersect_node(n, org, inv_dir, t_max)) {
+            if (n.leaf()) {
+                const scm::uint32 end = n._offset + n.triangle_count();
+                for (scm::uint32 t = n._offset; t < end; ++t) {
+                    float ht, hu, hv;
+                    if (intersect_triangle(&_triangles[9 * t], org, dir, t_max, ht, hu, hv)) {
+                        t_max          = ht;
+                        hit._t         = ht;
+                        hit._u         = hu;
+                        hit._v         = hv;
+                        hit._triangle  = _triangle_ids[t];
+                    }
+                }
+            }
+            else {
+                // visit the child on the near side of the split axis first
+                const bool        reverse = dir[n.axis()] < 0.0f;
+                const scm::uint32 near_child = reverse ? n._offset   : current + 1;
+                const scm::uint32 far_child  = reverse ? current + 1 : n._offset;
+                stack[stack_size++] = far_child;
+                current = near_child;
+                continue;
+            }
+        }
+        if (stack_size == 0) {
+            break;
+        }
+        current = stack[--stack_size];
+    }
+
+    return hit.valid();
+}
+
+bool
+triangle_bvh::any_hit(const rayf&  r,
+                      float        t_max) const
+{
+    if (_nodes.empty()) {
+        return false;
+    }
+
+    const math::vec3f& org     = r.origin();
+    const math::vec3f& dir     = r.direction();
+    const math::vec3f  inv_dir = inverse_direction(dir);
+
+    scm::uint32 stack[traversal_stack];
+    unsigned    stack_size = 0;
+    scm::uint32 current    = 0;
+
+    for (;;) {
+        const node& n = _nodes[current];
+
+        if (intersect_node(n, org, inv_dir, t_max)) {
+            if (n.leaf()) {
+                const scm::uint32 end = n._offset + n.triangle_count();
+                for (scm::uint32 t = n._offset; t < end; ++t) {
+                    float ht, hu, hv;
+                    if (intersect_triangle(&_triangles[9 * t], org, dir, t_max, ht, hu, hv)) {
+                        return true;
+                    }
+                }
+            }
+            else {
+                stack[stack_size++] = n._offset;
+                current = current + 1;
+                continue;
+            }
+        }
+        if (stack_size == 0) {
+            break;
+        }
+        current = stack[--stack_size];
+    }
+
+    return false;
+}
+
+void
+triangle_bvh::closest_hit(const rayf*  rays,
+                          ray_hit*     hits,
+                          scm::size_t  count,
+                          thread_pool* pool) const
+{
+    const scm::size_t packet_count = (count + 3) / 4;
+
+    if (pool) {
+        pool->parallel_for(0, packet_count, packet_grain, [&](scm::size_t b, scm::size_t e) {
+            closest_hit_packet(rays + 4 * b, hits + 4 * b, std::min(count, 4 * e) - 4 * b);
+        });
+    }
+    else {
+        closest_hit_packet(rays, hits, count);
+    }
+}
+
+void
+triangle_bvh::closest_hit_packet(const rayf*  rays,
+                                 ray_hit*     hits,
+                                 scm::size_t  count) const
+{
+#if SCM_CORE_MATH_SIMD == SCM_CORE_MATH_SIMD_SSE
+    for (scm::size_t p = 0; p < count; p += 4) {
+        const unsigned lanes = static_cast<unsigned>(std::min<scm::size_t>(4, count - p));
+
+        for (unsigned l = 0; l < lanes; ++l) {
+            hits[p + l] = ray_hit();
+        }
+        if (_nodes.empty()) {
+            continue;
+        }
+
+        // packet in structure of arrays form, missing lanes repeat the first ray
+        scm_align(16) float o[3][4];
+        scm_align(16) float d[3][4];
+        scm_align(16) float id[3][4];
+        for (unsigned l = 0; l < 4; ++l) {
+            const rayf&       r   = rays[p + (l < lanes ? l : 0)];
+            const math::vec3f inv = inverse_direction(r.direction());
+            for (unsigned c = 0; c < 3; ++c) {
+                o[c][l]  = r.origin()[c];
+                d[c][l]  = r.direction()[c];
+                id[c][l] = inv[c];
+            }
+        }
+
+        const __m128 ox = _mm_load_ps(o[0]),  oy = _mm_load_ps(o[1]),  oz = _mm_load_ps(o[2]);
+        const __m128 dx = _mm_load_ps(d[0]),  dy = _mm_load_ps(d[1]),  dz = _mm_load_ps(d[2]);
+        const __m128 ix = _mm_load_ps(id[0]), iy = _mm_load_ps(id[1]), iz = _mm_load_ps(id[2]);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one  = _mm_set1_ps(1.0f);
+        const __m128 eps  = _mm_set1_ps(1.0e-12f);
+
+        __m128  t_best  = _mm_set1_ps((std::numeric_limits<float>::max)());
+        __m128  u_best  = zero;
+        __m128  v_best  = zero;
+        __m128i id_best = _mm_set1_epi32(-1);
+
+        scm::uint32 stack[traversal_stack];
+        unsigned    stack_size = 0;
+        scm::uint32 current    = 0;
+
+        for (;;) {
+            const node& n = _nodes[current];
+
+            // slab test for the four rays
+            const __m128 tx0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(n._min[0]), ox), ix);
+            const __m128 tx1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(n._max[0]), ox), ix);
+            const __m128 ty0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(n._min[1]), oy), iy);
+            const __m128 ty1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(n._max[1]), oy), iy);
+            const __m128 tz0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(n._min[2]), oz), iz);
+            const __m128 tz1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(n._max[2]), oz), iz);
+
+            const __m128 t_near = _mm_max_ps(_mm_max_ps(_mm_min_ps(tx0, tx1), _mm_min_ps(ty0, ty1)),
+                                             _mm_max_ps(_mm_min_ps(tz0, tz1), zero));
+            const __m128 t_far  = _mm_min_ps(_mm_min_ps(_mm_max_ps(tx0, tx1), _mm_max_ps(ty0, ty1)),
+                                             _mm_min_ps(_mm_max_ps(tz0, tz1), t_best));
+
+            if (_mm_movemask_ps(_mm_cmple_ps(t_near, t_far)) != 0) {
+                if (n.leaf()) {
+                    const scm::uint32 end = n._offset + n.triangle_count();
+                    for (scm::uint32 t = n._offset; t < end; ++t) {
+                        const float* tri = &_triangles[9 * t];
+                        const __m128 v0x = _mm_set1_ps(tri[0]), v0y = _mm_set1_ps(tri[1]), v0z = _mm_set1_ps(tri[2]);
+                        const __m128 e1x = _mm_set1_ps(tri[3]), e1y = _mm_set1_ps(tri[4]), e1z = _mm_set1_ps(tri[5]);
+                        const __m128 e2x = _mm_set1_ps(tri[6]), e2y = _mm_set1_ps(tri[7]), e2z = _mm_set1_ps(tri[8]);
+
+                        // p = cross(d, e2)
+                        const __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+                        const __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+                        const __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+                        const __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+                        const __m128 abs_det = _mm_max_ps(det, _mm_sub_ps(zero, det));
+                        const __m128 inv_det = _mm_div_ps(one, det);
+
+                        // s = o - v0
+                        const __m128 sx = _mm_sub_ps(ox, v0x);
+                        const __m128 sy = _mm_sub_ps(oy, v0y);
+                        const __m128 sz = _mm_sub_ps(oz, v0z);
+                        const __m128 u  = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), inv_det);
+
+                        // q = cross(s, e1)
+                        const __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+                        const __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+                        const __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+                        const __m128 v  = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), inv_det);
+                        const __m128 th = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), inv_det);
+
+                        __m128 m = _mm_cmpge_ps(abs_det, eps);
+                        m = _mm_and_ps(m, _mm_cmpge_ps(u, zero));
+                        m = _mm_and_ps(m, _mm_cmple_ps(u, one));
+                        m = _mm_and_ps(m, _mm_cmpge_ps(v, zero));
+                        m = _mm_and_ps(m, _mm_cmple_ps(_mm_add_ps(u, v), one));
+                        m = _mm_and_ps(m, _mm_cmpgt_ps(th, zero));
+                        m = _mm_and_ps(m, _mm_cmplt_ps(th, t_best));
+
+                        if (_mm_movemask_ps(m) != 0) {
+                            t_best  = _mm_or_ps(_mm_and_ps(m, th), _mm_andnot_ps(m, t_best));
+                            u_best  = _mm_or_ps(_mm_and_ps(m, u),  _mm_andnot_ps(m, u_best));
+                            v_best  = _mm_or_ps(_mm_and_ps(m, v),  _mm_andnot_ps(m, v_best));
+                            const __m128i mi = _mm_castps_si128(m);
+                            id_best = _mm_or_si128(_mm_and_si128(mi, _mm_set1_epi32(static_cast<int>(_triangle_ids[t]))),
+                                                   _mm_andnot_si128(mi, id_best));
+                        }
+                    }
+                }
+                else {
+                    // near child order from the first ray of the (coherent) packet
+                    const bool        reverse    = d[n.axis()][0] < 0.0f;
+                    const scm::uint32 near_child = reverse ? n._offset   : current + 1;
+                    const scm::uint32 far_child  = reverse ? current + 1 : n._offset;
+                    stack[stack_size++] = far_child;
+                    current = near_child;
+                    continue;
+                }
+            }
+            if (stack_size == 0) {
+                break;
+            }
+            current = stack[--stack_size];
+        }
+
+        scm_align(16) float       ht[4], hu[4], hv[4];
+        scm_align(16) scm::uint32 hid[4];
+        _mm_store_ps(ht, t_best);
+        _mm_store_ps(hu, u_best);
+        _mm_store_ps(hv, v_best);
+        _mm_store_si128(reinterpret_cast<__m128i*>(hid), id_best);
+
+        for (unsigned l = 0; l < lanes; ++l) {
+            if (hid[l] != ray_hit::invalid_triangle) {
+                hits[p + l]._triangle = hid[l];
+                hits[p + l]._t        = ht[l];
+                hits[p + l]._u        = hu[l];
+                hits[p + l]._v        = hv[l];
+            }
+        }
+    }
+#else // SCM_CORE_MATH_SIMD == SCM_CORE_MATH_SIMD_SSE
+    for (scm::size_t r = 0; r < count; ++r) {
+        closest_hit(rays[r], hits[r]);
+    }
+#endif // SCM_CORE_MATH_SIMD == SCM_CORE_MATH_SIMD_SSE
+}
+
+} // namespace gl
+} // namespace scm
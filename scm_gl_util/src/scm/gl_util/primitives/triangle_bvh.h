@@ -0,0 +1,131 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_GL_UTIL_PRIMITIVES_TRIANGLE_BVH_H_INCLUDED
+#define SCM_GL_UTIL_PRIMITIVES_TRIANGLE_BVH_H_INCLUDED
+
+#include <limits>
+#include <vector>
+
+#include <scm/core/numeric_types.h>
+#include <scm/core/math.h>
+
+#include <scm/gl_core/primitives/primitives_fwd.h>
+
+#include <scm/gl_util/primitives/primitives_fwd.h>
+
+#include <scm/core/platform/platform.h>
+#include <scm/core/utilities/platform_warning_disable.h>
+
+namespace scm {
+
+class thread_pool;
+
+namespace gl {
+namespace util {
+
+struct wavefront_model;
+struct vertexbuffer_data;
+
+} // namespace util
+
+// closest intersection along a ray
+//  - t is the ray parameter of the hit, origin + t * direction
+//  - u, v are the barycentric coordinates of the hit relative to the second
+//    and third triangle vertex
+struct ray_hit
+{
+    static const scm::uint32 invalid_triangle = 0xffffffffu;
+
+    ray_hit() : _triangle(invalid_triangle), _t((std::numeric_limits<float>::max)()), _u(0.0f), _v(0.0f) {}
+
+    bool                valid() const { return _triangle != invalid_triangle; }
+
+    scm::uint32         _triangle;
+    float               _t;
+    float               _u;
+    float               _v;
+}; // struct ray_hit
+
+// bounding volume hierarchy over a static triangle set for ray queries (picking, measuring)
+//  - built with the binned surface area heuristic, subtrees are built in parallel
+//    when a thread pool is given
+//  - nodes are stored depth first in 32 byte records, the first child of an inner
+//    node directly follows its parent
+//  - triangle indices reported in ray_hit refer to the input triangle order, for
+//    models with several groups or index arrays the triangles are numbered
+//    consecutively across them
+class __scm_export(gl_util) triangle_bvh
+{
+public:
+    struct node
+    {
+        bool            leaf() const            { return (_flags & 3u) == 3u; }
+        unsigned        axis() const            { return _flags & 3u; }
+        scm::uint32     triangle_count() const  { return _flags >> 2; }
+
+        float           _min[3];
+        scm::uint32     _offset;    // leaf: first triangle, inner: second child node
+        float           _max[3];
+        scm::uint32     _flags;     // leaf: (triangle count << 2) | 3, inner: split axis
+    }; // struct node
+
+public:
+    // indices hold three vertex indices per triangle
+    triangle_bvh(const math::vec3f*  vertices,
+                 scm::size_t         vertex_count,
+                 const scm::uint32*  indices,
+                 scm::size_t         triangle_count,
+                 thread_pool*        pool = 0);
+    triangle_bvh(const util::wavefront_model& model,
+                 thread_pool*                 pool = 0);
+    // interleaved has to match the flag used for util::generate_vertex_buffer
+    triangle_bvh(const util::vertexbuffer_data& data,
+                 bool                           interleaved,
+                 thread_pool*                   pool = 0);
+    virtual ~triangle_bvh();
+
+    scm::size_t             triangle_count() const;
+    scm::size_t             node_count() const;
+    const std::vector<node>& nodes() const;
+    const boxf              bounds() const;
+
+    bool                    closest_hit(const rayf&  r,
+                                        ray_hit&     hit,
+                                        float        t_max = (std::numeric_limits<float>::max)()) const;
+    // true if any triangle is hit closer than t_max, stops at the first hit found
+    bool                    any_hit(const rayf&  r,
+                                    float        t_max = (std::numeric_limits<float>::max)()) const;
+
+    // closest hits for count rays, traversed in packets of four rays sharing the
+    // node visits, coherent rays (e.g. neighboring pixels) profit the most
+    void                    closest_hit(const rayf*  rays,
+                                        ray_hit*     hits,
+                                        scm::size_t  count,
+                                        thread_pool* pool = 0) const;
+
+protected:
+    void                    build(const math::vec3f*  vertices,
+                                  scm::size_t         vertex_count,
+                                  const scm::uint32*  indices,
+                                  scm::size_t         triangle_count,
+                                  thread_pool*        pool);
+
+    void                    closest_hit_packet(const rayf*  rays,
+                                               ray_hit*     hits,
+                                               scm::size_t  count) const;
+
+protected:
+    std::vector<node>           _nodes;
+    std::vector<float>          _triangles;     // v0, v1 - v0, v2 - v0 per triangle in leaf order
+    std::vector<scm::uint32>    _triangle_ids;  // input index per triangle in leaf order
+
+}; // class triangle_bvh
+
+} // namespace gl
+} // namespace scm
+
+#include <scm/core/utilities/platform_warning_enable.h>
+
+#endif // SCM_GL_UTIL_PRIMITIVES_TRIANGLE_BVH_H_INCLUDED
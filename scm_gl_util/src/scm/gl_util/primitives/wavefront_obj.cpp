@@ -8,6 +8,7 @@
 #include <iostream>
 
 #include <boost/assign/list_of.hpp>
+#include <boost/bind.hpp>
 
 #include <scm/core/memory.h>
 #include <scm/core/utilities/foreach.h>
@@ -105,6 +106,14 @@ wavefront_obj_geometry::wavefront_obj_geometry(const render_device_ptr& in_devic
         }
         next_start_index += obj_vbuf._index_array_counts[i];
     }
+    for (scm::size_t i = 0; i < _opaque_object_materials.size(); ++i) {
+        _opaque_queue_materials.push_back(make_shared<render_queue::material>());
+        _opaque_queue_materials.back()->_apply_uniforms = boost::bind(&wavefront_obj_geometry::apply_material, _opaque_object_materials[i], _1);
+    }
+    for (scm::size_t i = 0; i < _transparent_object_materials.size(); ++i) {
+        _transparent_queue_materials.push_back(make_shared<render_queue::material>());
+        _transparent_queue_materials.back()->_apply_uniforms = boost::bind(&wavefront_obj_geometry::apply_material, _transparent_object_materials[i], _1);
+    }
     //assert((_transparent_object_start_indices.size() + _opaque_object_start_indices.size()) == _object_indices_count.size());
 
     if ( obj_vbuf._vert_array_count < (1 << 16)) {
@@ -166,13 +175,7 @@ wavefront_obj_geometry::draw(const render_context_ptr& in_context,
 
         in_context->set_blend_state(_no_blend_state);
         for (scm::size_t i = 0; i < _opaque_object_start_indices.size(); ++i) {
-            const material& m = _opaque_object_materials[i];
-            program_ptr p = in_context->current_program();
-            p->uniform("material_diffuse",   m._diffuse);
-            p->uniform("material_specular",  m._specular);
-            p->uniform("material_ambient",   m._ambient);
-            p->uniform("material_shininess", m._shininess);
-            p->uniform("material_opacity",   m._opacity);
+            apply_material(_opaque_object_materials[i], in_context->current_program());
             in_context->apply();
             in_context->draw_elements(_opaque_object_indices_count[i], _opaque_object_start_indices[i]);
         }
@@ -180,13 +183,7 @@ wavefront_obj_geometry::draw(const render_context_ptr& in_context,
         in_context->set_blend_state(_alpha_blend);
 
         for (scm::size_t i = 0; i < _transparent_object_start_indices.size(); ++i) {
-            const material& m = _transparent_object_materials[i];
-            program_ptr p = in_context->current_program();
-            p->uniform("material_diffuse",   m._diffuse);
-            p->uniform("material_specular",  m._specular);
-            p->uniform("material_ambient",   m._ambient);
-            p->uniform("material_shininess", m._shininess);
-            p->uniform("material_opacity",   m._opacity);
+            apply_material(_transparent_object_materials[i], in_context->current_program());
             in_context->apply();
             in_context->draw_elements(_transparent_object_indices_count[i], _transparent_object_start_indices[i]);
         }
@@ -216,6 +213,48 @@ wavefront_obj_geometry::draw_raw(const render_context_ptr& in_context,
     }
 }
 
+void
+wavefront_obj_geometry::enqueue(render_queue&      in_queue,
+                                const program_ptr& in_program,
+                                float              in_depth,
+                                unsigned           in_opaque_pass,
+                                unsigned           in_transparent_pass) const
+{
+    render_queue::draw_item d;
+
+    d._depth        = in_depth;
+    d._program      = in_program;
+    d._vertex_array = _vertex_array;
+    d._index_buffer = _index_buffer;
+    d._index_type   = _index_type;
+    d._topology     = PRIMITIVE_TRIANGLE_LIST;
+
+    d._pass = in_opaque_pass;
+    for (scm::size_t i = 0; i < _opaque_object_start_indices.size(); ++i) {
+        d._material = _opaque_queue_materials[i];
+        d._first    = _opaque_object_start_indices[i];
+        d._count    = _opaque_object_indices_count[i];
+        in_queue.push(d);
+    }
+    d._pass = in_transparent_pass;
+    for (scm::size_t i = 0; i < _transparent_object_start_indices.size(); ++i) {
+        d._material = _transparent_queue_materials[i];
+        d._first    = _transparent_object_start_indices[i];
+        d._count    = _transparent_object_indices_count[i];
+        in_queue.push(d);
+    }
+}
+
+void
+wavefront_obj_geometry::apply_material(const material& in_material, const program_ptr& in_program)
+{
+    in_program->uniform("material_diffuse",   in_material._diffuse);
+    in_program->uniform("material_specular",  in_material._specular);
+    in_program->uniform("material_ambient",   in_material._ambient);
+    in_program->uniform("material_shininess", in_material._shininess);
+    in_program->uniform("material_opacity",   in_material._opacity);
+}
+
 const buffer_ptr&
 wavefront_obj_geometry::vertex_buffer() const
 {
@@ -16,6 +16,7 @@
 
 #include <scm/gl_util/primitives/primitives_fwd.h>
 #include <scm/gl_util/primitives/geometry.h>
+#include <scm/gl_util/utilities/render_queue.h>
 
 #include <scm/core/platform/platform.h>
 #include <scm/core/utilities/platform_warning_disable.h>
@@ -40,11 +41,21 @@ public:
                              const draw_mode           in_draw_mode = MODE_SOLID) const;
     void                draw_raw(const render_context_ptr& in_context,
                                  const draw_mode           in_draw_mode = MODE_SOLID) const;
+    // queues one draw per object with its material, the transparent pass should
+    // blend and sort back to front (see render_queue::set_pass_state)
+    void                enqueue(render_queue&      in_queue,
+                                const program_ptr& in_program,
+                                float              in_depth,
+                                unsigned           in_opaque_pass = 0,
+                                unsigned           in_transparent_pass = 1) const;
 
     const buffer_ptr&       vertex_buffer() const;
     const buffer_ptr&       index_buffer() const;
     const vertex_array_ptr& vertex_array() const;
 
+protected:
+    static void             apply_material(const material& in_material, const program_ptr& in_program);
+
 protected:
     buffer_ptr              _vertex_buffer;
     buffer_ptr              _index_buffer;
@@ -55,6 +66,8 @@ protected:
     std::vector<int>        _transparent_object_indices_count;
     std::vector<material>   _opaque_object_materials;
     std::vector<material>   _transparent_object_materials;
+    std::vector<render_queue::material_ptr> _opaque_queue_materials;
+    std::vector<render_queue::material_ptr> _transparent_queue_materials;
     vertex_array_ptr        _vertex_array;
     blend_state_ptr         _no_blend_state;
     blend_state_ptr         _alpha_blend;
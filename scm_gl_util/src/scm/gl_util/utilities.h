@@ -11,8 +11,10 @@
 #include <scm/gl_util/utilities/accum_timer_query.h>
 #include <scm/gl_util/utilities/coordinate_cross.h>
 #include <scm/gl_util/utilities/geometry_highlight.h>
+#include <scm/gl_util/utilities/occlusion_culler.h>
 #include <scm/gl_util/utilities/overlay_text_output.h>
 #include <scm/gl_util/utilities/profiling_host.h>
+#include <scm/gl_util/utilities/render_queue.h>
 #include <scm/gl_util/utilities/texture_output.h>
 
 #endif // SCM_GL_UTIL_UTILITIES_H_INCLUDED
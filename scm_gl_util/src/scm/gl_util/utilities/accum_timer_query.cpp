@@ -101,6 +101,7 @@ accum_timer_query::collect()
             _detailed_accumulated_time.user   += _detailed_last_time.user;
             _detailed_accumulated_time.system += _detailed_last_time.system;
 
+            record_statistics(_last_time);
             ++_accumulation_count;
             _timer_query_finished = true;
         }
@@ -139,6 +140,7 @@ accum_timer_query::force_collect()
         _detailed_accumulated_time.user   += _detailed_last_time.user;
         _detailed_accumulated_time.system += _detailed_last_time.system;
 
+        record_statistics(_last_time);
         ++_accumulation_count;
         _timer_query_finished = true;
     }
@@ -153,6 +155,7 @@ accum_timer_query::update(int interval)
         _update_interval = 0;
 
         _average_time = (_accumulation_count > 0) ? _accumulated_time / _accumulation_count : 0;
+        update_statistics();
 
         _detailed_average_time.gl =
         _detailed_average_time.wall =
@@ -0,0 +1,484 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include "occlusion_culler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include <scm/core/utilities/boost_warning_disable.h>
+#include <boost/thread/mutex.hpp>
+#include <scm/core/utilities/boost_warning_enable.h>
+
+#include <scm/core/utilities/thread_pool.h>
+
+#include <scm/gl_core/primitives/box.h>
+
+#include <scm/gl_util/viewer/camera.h>
+
+#if SCM_CORE_MATH_SIMD == SCM_CORE_MATH_SIMD_SSE
+#include <xmmintrin.h>
+#endif // SCM_CORE_MATH_SIMD == SCM_CORE_MATH_SIMD_SSE
+
+namespace {
+
+const unsigned      band_rows       = 16;   // rows rasterized per parallel task
+const scm::size_t   cull_grain      = 1024; // boxes tested per parallel task
+const float         min_clip_w      = 1.0e-5f;
+
+// signed distance to the near plane in clip space (z >= -w inside)
+inline float
+near_distance(const scm::math::vec4f& c)
+{
+    return c.z + c.w;
+}
+
+// clamps in float before the conversion, projected coordinates far outside the
+// screen do not fit the integer types (NaN maps to lo)
+inline int
+clamped_texel(float v, int lo, int hi)
+{
+    return static_cast<int>(std::min(static_cast<float>(hi), std::max(static_cast<float>(lo), std::floor(v))));
+}
+
+} // namespace
+
+namespace scm {
+namespace gl {
+
+occlusion_culler::occlusion_culler(const math::vec2ui& resolution,
+                                   thread_pool*        pool)
+  : _resolution(math::vec2ui((std::max(4u, resolution.x) + 3u) & ~3u, std::max(1u, resolution.y)))
+  , _pool(pool)
+  , _view_projection(math::mat4f::identity())
+{
+    // depth pyramid down to a single texel
+    math::vec2ui s = _resolution;
+    for (;;) {
+        _level_sizes.push_back(s);
+        _levels.push_back(std::vector<float>(s.x * s.y, 1.0f));
+        if (s.x == 1 && s.y == 1) {
+            break;
+        }
+        s = math::vec2ui((s.x + 1) / 2, (s.y + 1) / 2);
+    }
+}
+
+occlusion_culler::~occlusion_culler()
+{
+}
+
+const math::vec2ui&
+occlusion_culler::resolution() const
+{
+    return _resolution;
+}
+
+void
+occlusion_culler::begin_frame(const math::mat4f& view_projection)
+{
+    _view_projection = view_projection;
+    _triangles.clear();
+
+    for (std::size_t l = 0; l < _levels.size(); ++l) {
+        std::fill(_levels[l].begin(), _levels[l].end(), 1.0f);
+    }
+}
+
+void
+occlusion_culler::begin_frame(const camera& cam)
+{
+    begin_frame(cam.view_projection_matrix());
+}
+
+void
+occlusion_culler::add_occluder(const math::mat4f&  model_matrix,
+                               const math::vec3f*  vertices,
+                               scm::size_t         vertex_count,
+                               const scm::uint32*  indices,
+                               scm::size_t         triangle_count)
+{
+    using namespace scm::math;
+
+    const mat4f mvp = _view_projection * model_matrix;
+
+    _clip_vertices.resize(vertex_count);
+    for (scm::size_t v = 0; v < vertex_count; ++v) {
+        _clip_vertices[v] = mvp * vec4f(vertices[v], 1.0f);
+    }
+
+    for (scm::size_t t = 0; t < triangle_count; ++t) {
+        const scm::uint32 i0 = indices[3 * t];
+        const scm::uint32 i1 = indices[3 * t + 1];
+        const scm::uint32 i2 = indices[3 * t + 2];
+        if (i0 >= vertex_count || i1 >= vertex_count || i2 >= vertex_count) {
+            throw std::runtime_error("occlusion_culler::add_occluder(): vertex index out of range.");
+        }
+
+        const vec4f c[3] = { _clip_vertices[i0], _clip_vertices[i1], _clip_vertices[i2] };
+
+        // clip against the near plane, the result is a triangle or a quad
+        vec4f        poly[4];
+        unsigned     poly_size = 0;
+        for (unsigned e = 0; e < 3; ++e) {
+            const vec4f& a  = c[e];
+            const vec4f& b  = c[(e + 1) % 3];
+            const float  da = near_distance(a);
+            const float  db = near_distance(b);
+
+            if (da >= 0.0f) {
+                poly[poly_size++] = a;
+            }
+            if ((da >= 0.0f) != (db >= 0.0f)) {
+                poly[poly_size++] = lerp(a, b, da / (da - db));
+            }
+        }
+
+        for (unsigned p = 2; p < poly_size; ++p) {
+            emit_triangle(poly[0], poly[p - 1], poly[p]);
+        }
+    }
+}
+
+void
+occlusion_culler::end_occluders()
+{
+    const unsigned band_count = (_resolution.y + band_rows - 1) / band_rows;
+
+    if (_pool) {
+        _pool->parallel_for(0, band_count, 1, [this](scm::size_t b, scm::size_t e) {
+            rasterize_band(static_cast<unsigned>(b * band_rows),
+                           std::min(_resolution.y, static_cast<unsigned>(e * band_rows)));
+        });
+    }
+    else {
+        rasterize_band(0, _resolution.y);
+    }
+
+    build_hierarchy();
+}
+
+bool
+occlusion_culler::visible(const boxf& b) const
+{
+    return visible(b.min_vertex(), b.max_vertex());
+}
+
+scm::size_t
+occlusion_culler::cull(const math::const_box3f_stream& boxes,
+                       const index_array&              candidates,
+                       index_array&                    visible) const
+{
+    visible.clear();
+
+    if (!_pool || candidates.size() < 2 * cull_grain) {
+        visible.reserve(candidates.size());
+        cull_range(boxes, candidates, 0, candidates.size(), visible);
+        return visible.size();
+    }
+
+    // per chunk index lists, concatenated in candidate order afterwards
+    typedef std::pair<scm::size_t, index_array> chunk_result;
+
+    std::vector<chunk_result>   chunks;
+    boost::mutex                chunks_mutex;
+
+    _pool->parallel_for(0, candidates.size(), cull_grain, [&](scm::size_t b, scm::size_t e) {
+        index_array chunk_visible;
+        chunk_visible.reserve(e - b);
+        cull_range(boxes, candidates, b, e, chunk_visible);
+
+        boost::mutex::scoped_lock lock(chunks_mutex);
+        chunks.push_back(chunk_result(b, index_array()));
+        chunks.back().second.swap(chunk_visible);
+    });
+
+    std::sort(chunks.begin(), chunks.end(),
+              [](const chunk_result& lhs, const chunk_result& rhs) { return lhs.first < rhs.first; });
+
+    for (std::size_t c = 0; c < chunks.size(); ++c) {
+        visible.insert(visible.end(), chunks[c].second.begin(), chunks[c].second.end());
+    }
+
+    return visible.size();
+}
+
+void
+occlusion_culler::cull_range(const math::const_box3f_stream& boxes,
+                             const index_array&              candidates,
+                             scm::size_t                     b,
+                             scm::size_t                     e,
+                             index_array&                    visible) const
+{
+    for (scm::size_t c = b; c < e; ++c) {
+        const scm::uint32 i = candidates[c];
+        if (this->visible(math::vec3f(boxes.min.x[i], boxes.min.y[i], boxes.min.z[i]),
+                          math::vec3f(boxes.max.x[i], boxes.max.y[i], boxes.max.z[i]))) {
+            visible.push_back(i);
+        }
+    }
+}
+
+const std::vector<float>&
+occlusion_culler::depth_buffer() const
+{
+    return _levels.front();
+}
+
+scm::size_t
+occlusion_culler::occluder_triangle_count() const
+{
+    return _triangles.size();
+}
+
+void
+occlusion_culler::emit_triangle(const math::vec4f& c0,
+                                const math::vec4f& c1,
+                                const math::vec4f& c2)
+{
+    const math::vec4f* c[3] = { &c0, &c1, &c2 };
+
+    screen_triangle t;
+    for (unsigned v = 0; v < 3; ++v) {
+        const float inv_w = 1.0f / std::max(min_clip_w, c[v]->w);
+        t._x[v] = (c[v]->x * inv_w * 0.5f + 0.5f) * static_cast<float>(_resolution.x);
+        t._y[v] = (c[v]->y * inv_w * 0.5f + 0.5f) * static_cast<float>(_resolution.y);
+        t._z[v] =  c[v]->z * inv_w * 0.5f + 0.5f;
+    }
+
+    // counter clockwise winding for the edge functions, occluders are rasterized two sided
+    const float area = (t._x[1] - t._x[0]) * (t._y[2] - t._y[0]) - (t._x[2] - t._x[0]) * (t._y[1] - t._y[0]);
+    if (std::fabs(area) < 1.0e-8f) {
+        return;
+    }
+    if (area < 0.0f) {
+        std::swap(t._x[1], t._x[2]);
+        std::swap(t._y[1], t._y[2]);
+        std::swap(t._z[1], t._z[2]);
+    }
+
+    _triangles.push_back(t);
+}
+
+void
+occlusion_culler::rasterize_band(unsigned row_begin,
+                                 unsigned row_end)
+{
+    for (std::size_t t = 0; t < _triangles.size(); ++t) {
+        rasterize_triangle(_triangles[t], row_begin, row_end);
+    }
+}
+
+void
+occlusion_culler::rasterize_triangle(const screen_triangle& t,
+                                     unsigned               row_begin,
+                                     unsigned               row_end)
+{
+    const float fminy = std::min(t._y[0], std::min(t._y[1], t._y[2]));
+    const float fmaxy = std::max(t._y[0], std::max(t._y[1], t._y[2]));
+    if (fmaxy < static_cast<float>(row_begin) || fminy >= static_cast<float>(row_end)) {
+        return;
+    }
+    const float fminx = std::min(t._x[0], std::min(t._x[1], t._x[2]));
+    const float fmaxx = std::max(t._x[0], std::max(t._x[1], t._x[2]));
+    if (fmaxx < 0.0f || fminx >= static_cast<float>(_resolution.x)) {
+        return;
+    }
+
+    const int min_x = clamped_texel(fminx, 0,              int(_resolution.x) - 1);
+    const int max_x = clamped_texel(fmaxx, 0,              int(_resolution.x) - 1);
+    const int min_y = clamped_texel(fminy, int(row_begin), int(row_end) - 1);
+    const int max_y = clamped_texel(fmaxy, int(row_begin), int(row_end) - 1);
+
+    // edge functions e(x, y) = a * x + b * y + c, positive inside
+    float ea[3], eb[3], ec[3];
+    for (unsigned e = 0; e < 3; ++e) {
+        const unsigned n = (e + 1) % 3;
+        ea[e] = -(t._y[n] - t._y[e]);
+        eb[e] =   t._x[n] - t._x[e];
+        ec[e] = -(ea[e] * t._x[e] + eb[e] * t._y[e]);
+    }
+
+    // depth plane z(x, y) = za * x + zb * y + zc
+    const float area = (t._x[1] - t._x[0]) * (t._y[2] - t._y[0]) - (t._x[2] - t._x[0]) * (t._y[1] - t._y[0]);
+    const float za   = ((t._z[1] - t._z[0]) * (t._y[2] - t._y[0]) - (t._z[2] - t._z[0]) * (t._y[1] - t._y[0])) / area;
+    const float zb   = ((t._z[2] - t._z[0]) * (t._x[1] - t._x[0]) - (t._z[1] - t._z[0]) * (t._x[2] - t._x[0])) / area;
+    const float zc   = t._z[0] - za * t._x[0] - zb * t._y[0];
+
+    std::vector<float>& depth = _levels.front();
+
+#if SCM_CORE_MATH_SIMD == SCM_CORE_MATH_SIMD_SSE
+    const __m128 lane_offset = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+    const __m128 zero        = _mm_setzero_ps();
+    const __m128 ea0 = _mm_set1_ps(ea[0]), ea1 = _mm_set1_ps(ea[1]), ea2 = _mm_set1_ps(ea[2]);
+    const __m128 za4 = _mm_set1_ps(za);
+    const __m128 max_x4 = _mm_set1_ps(static_cast<float>(max_x) + 0.5f);
+
+    for (int y = min_y; y <= max_y; ++y) {
+        const float py   = static_cast<float>(y) + 0.5f;
+        const __m128 eb0 = _mm_set1_ps(eb[0] * py + ec[0]);
+        const __m128 eb1 = _mm_set1_ps(eb[1] * py + ec[1]);
+        const __m128 eb2 = _mm_set1_ps(eb[2] * py + ec[2]);
+        const __m128 zy  = _mm_set1_ps(zb * py + zc);
+        float*       row = &depth[y * _resolution.x];
+
+        for (int x = min_x & ~3; x <= max_x; x += 4) {
+            const __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), lane_offset);
+            const __m128 e0 = _mm_add_ps(_mm_mul_ps(ea0, px), eb0);
+            const __m128 e1 = _mm_add_ps(_mm_mul_ps(ea1, px), eb1);
+            const __m128 e2 = _mm_add_ps(_mm_mul_ps(ea2, px), eb2);
+
+            const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)),
+                                             _mm_and_ps(_mm_cmpge_ps(e2, zero), _mm_cmple_ps(px, max_x4)));
+            if (_mm_movemask_ps(inside) == 0) {
+                continue;
+            }
+
+            const __m128 z     = _mm_add_ps(_mm_mul_ps(za4, px), zy);
+            const __m128 old_z = _mm_loadu_ps(row + x);
+            const __m128 new_z = _mm_min_ps(old_z, z);
+            _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, new_z), _mm_andnot_ps(inside, old_z)));
+        }
+    }
+#else // SCM_CORE_MATH_SIMD == SCM_CORE_MATH_SIMD_SSE
+    for (int y = min_y; y <= max_y; ++y) {
+        const float py  = static_cast<float>(y) + 0.5f;
+        float*      row = &depth[y * _resolution.x];
+
+        for (int x = min_x; x <= max_x; ++x) {
+            const float px = static_cast<float>(x) + 0.5f;
+            if (   ea[0] * px + eb[0] * py + ec[0] >= 0.0f
+                && ea[1] * px + eb[1] * py + ec[1] >= 0.0f
+                && ea[2] * px + eb[2] * py + ec[2] >= 0.0f) {
+                row[x] = std::min(row[x], za * px + zb * py + zc);
+            }
+        }
+    }
+#endif // SCM_CORE_MATH_SIMD == SCM_CORE_MATH_SIMD_SSE
+}
+
+void
+occlusion_culler::build_hierarchy()
+{
+    // each texel holds the farthest depth of the up to four texels below it
+    for (std::size_t l = 1; l < _levels.size(); ++l) {
+        const math::vec2ui&       ss  = _level_sizes[l - 1];
+        const math::vec2ui&       ds  = _level_sizes[l];
+        const std::vector<float>& src = _levels[l - 1];
+        std::vector<float>&       dst = _levels[l];
+
+        for (unsigned y = 0; y < ds.y; ++y) {
+            const unsigned y0 = 2 * y;
+            const unsigned y1 = std::min(y0 + 1, ss.y - 1);
+            for (unsigned x = 0; x < ds.x; ++x) {
+                const unsigned x0 = 2 * x;
+                const unsigned x1 = std::min(x0 + 1, ss.x - 1);
+                dst[y * ds.x + x] = std::max(std::max(src[y0 * ss.x + x0], src[y0 * ss.x + x1]),
+                                             std::max(src[y1 * ss.x + x0], src[y1 * ss.x + x1]));
+            }
+        }
+    }
+}
+
+bool
+occlusion_culler::visible(const math::vec3f& bmin,
+                          const math::vec3f& bmax) const
+{
+    using namespace scm::math;
+
+    float sx_min =  (std::numeric_limits<float>::max)();
+    float sy_min =  (std::numeric_limits<float>::max)();
+    float sx_max = -(std::numeric_limits<float>::max)();
+    float sy_max = -(std::numeric_limits<float>::max)();
+    float z_min  =  (std::numeric_limits<float>::max)();
+
+    for (unsigned c = 0; c < 8; ++c) {
+        const vec4f p = _view_projection * vec4f(c & 1 ? bmax.x : bmin.x,
+                                                 c & 2 ? bmax.y : bmin.y,
+                                                 c & 4 ? bmax.z : bmin.z,
+                                                 1.0f);
+        // boxes reaching through the near plane cannot be culled
+        if (p.w < min_clip_w || near_distance(p) < 0.0f) {
+            return true;
+        }
+        const float inv_w = 1.0f / p.w;
+        const float sx    = (p.x * inv_w * 0.5f + 0.5f) * static_cast<float>(_resolution.x);
+        const float sy    = (p.y * inv_w * 0.5f + 0.5f) * static_cast<float>(_resolution.y);
+        sx_min = std::min(sx_min, sx);
+        sx_max = std::max(sx_max, sx);
+        sy_min = std::min(sy_min, sy);
+        sy_max = std::max(sy_max, sy);
+        z_min  = std::min(z_min, p.z * inv_w * 0.5f + 0.5f);
+    }
+
+    // completely off screen or beyond the far plane
+    if (   sx_max < 0.0f || sx_min >= static_cast<float>(_resolution.x)
+        || sy_max < 0.0f || sy_min >= static_cast<float>(_resolution.y)
+        || z_min > 1.0f) {
+        return false;
+    }
+
+    unsigned rect[4]; // x0, y0, x1, y1 at level 0
+    rect[0] = static_cast<unsigned>(clamped_texel(sx_min, 0, int(_resolution.x) - 1));
+    rect[1] = static_cast<unsigned>(clamped_texel(sy_min, 0, int(_resolution.y) - 1));
+    rect[2] = static_cast<unsigned>(clamped_texel(sx_max, 0, int(_resolution.x) - 1));
+    rect[3] = static_cast<unsigned>(clamped_texel(sy_max, 0, int(_resolution.y) - 1));
+
+    // start on the level where the footprint covers at most 2x2 texels
+    unsigned level = 0;
+    while (   level + 1 < _levels.size()
+           && ((rect[2] >> level) - (rect[0] >> level) > 1 || (rect[3] >> level) - (rect[1] >> level) > 1)) {
+        ++level;
+    }
+
+    for (unsigned y = rect[1] >> level; y <= (rect[3] >> level); ++y) {
+        for (unsigned x = rect[0] >> level; x <= (rect[2] >> level); ++x) {
+            if (!occluded(level, x, y, rect, z_min)) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+bool
+occlusion_culler::occluded(unsigned        level,
+                           unsigned        x,
+                           unsigned        y,
+                           const unsigned* rect,
+                           float           zmin) const
+{
+    const math::vec2ui& s = _level_sizes[level];
+    if (zmin > _levels[level][y * s.x + x]) {
+        return true;
+    }
+    if (level == 0) {
+        return false;
+    }
+
+    // refine into the children covered by the footprint
+    const unsigned      cl = level - 1;
+    const math::vec2ui& cs = _level_sizes[cl];
+    const unsigned      x0 = std::max(2 * x, rect[0] >> cl);
+    const unsigned      x1 = std::min(std::min(2 * x + 1, cs.x - 1), rect[2] >> cl);
+    const unsigned      y0 = std::max(2 * y, rect[1] >> cl);
+    const unsigned      y1 = std::min(std::min(2 * y + 1, cs.y - 1), rect[3] >> cl);
+
+    for (unsigned cy = y0; cy <= y1; ++cy) {
+        for (unsigned cx = x0; cx <= x1; ++cx) {
+            if (!occluded(cl, cx, cy, rect, zmin)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+} // namespace gl
+} // namespace scm
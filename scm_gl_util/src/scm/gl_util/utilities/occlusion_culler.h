@@ -0,0 +1,129 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_GL_UTIL_UTILITIES_OCCLUSION_CULLER_H_INCLUDED
+#define SCM_GL_UTIL_UTILITIES_OCCLUSION_CULLER_H_INCLUDED
+
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <scm/core/numeric_types.h>
+#include <scm/core/math.h>
+#include <scm/core/math/batch.h>
+
+#include <scm/gl_core/primitives/primitives_fwd.h>
+
+#include <scm/gl_util/viewer/viewer_fwd.h>
+
+#include <scm/core/platform/platform.h>
+#include <scm/core/utilities/platform_warning_disable.h>
+
+namespace scm {
+
+class thread_pool;
+
+namespace gl {
+
+// software occlusion culling against a low resolution depth buffer
+//  - the width is rounded up to a multiple of four
+//  - occluder triangles are clipped against the near plane and rasterized on the
+//    cpu (four pixels per step with SSE), the screen is split into bands of rows
+//    which are rasterized in parallel when a thread pool is given
+//  - a max depth pyramid (hierarchical z) is built from the depth buffer, boxes are
+//    tested hierarchically with the nearest depth of their projected corners
+//  - boxes crossing the near plane are always reported visible; occluders are
+//    sampled at pixel centers, so very thin slivers behind occluder edges may be
+//    culled
+//
+//  usage per frame:
+//      begin_frame(view_projection); add_occluder(...)...; end_occluders();
+//      visible(box) / cull(boxes, candidates, visible)
+class __scm_export(gl_util) occlusion_culler : boost::noncopyable
+{
+public:
+    typedef std::vector<scm::uint32>    index_array;
+
+public:
+    occlusion_culler(const math::vec2ui& resolution = math::vec2ui(256, 128),
+                     thread_pool*        pool       = 0);
+    virtual ~occlusion_culler();
+
+    const math::vec2ui&     resolution() const;
+
+    void                    begin_frame(const math::mat4f& view_projection);
+    void                    begin_frame(const camera& cam);
+
+    // indices hold three vertex indices per triangle
+    void                    add_occluder(const math::mat4f&  model_matrix,
+                                         const math::vec3f*  vertices,
+                                         scm::size_t         vertex_count,
+                                         const scm::uint32*  indices,
+                                         scm::size_t         triangle_count);
+    // rasterizes the occluders and builds the depth pyramid
+    void                    end_occluders();
+
+    // world space boxes
+    bool                    visible(const boxf& b) const;
+    // tests the boxes referenced by candidates (e.g. the output of frustum_culler::cull)
+    // and fills visible with the ones not occluded, the order of candidates is kept
+    scm::size_t             cull(const math::const_box3f_stream& boxes,
+                                 const index_array&              candidates,
+                                 index_array&                    visible) const;
+
+    // depth in [0, 1], row major, 1 where no occluder was rasterized
+    const std::vector<float>& depth_buffer() const;
+    scm::size_t             occluder_triangle_count() const;
+
+protected:
+    struct screen_triangle
+    {
+        float               _x[3];
+        float               _y[3];
+        float               _z[3];
+    }; // struct screen_triangle
+
+    void                    emit_triangle(const math::vec4f& c0,
+                                          const math::vec4f& c1,
+                                          const math::vec4f& c2);
+    void                    rasterize_band(unsigned row_begin,
+                                           unsigned row_end);
+    void                    rasterize_triangle(const screen_triangle& t,
+                                               unsigned               row_begin,
+                                               unsigned               row_end);
+    void                    build_hierarchy();
+
+    void                    cull_range(const math::const_box3f_stream& boxes,
+                                       const index_array&              candidates,
+                                       scm::size_t                     b,
+                                       scm::size_t                     e,
+                                       index_array&                    visible) const;
+
+    bool                    visible(const math::vec3f& bmin,
+                                    const math::vec3f& bmax) const;
+    bool                    occluded(unsigned level,
+                                     unsigned x,
+                                     unsigned y,
+                                     const unsigned* rect,
+                                     float           zmin) const;
+
+protected:
+    math::vec2ui                        _resolution;
+    thread_pool*                        _pool;
+
+    math::mat4f                         _view_projection;
+    std::vector<math::vec4f>            _clip_vertices;
+    std::vector<screen_triangle>        _triangles;
+
+    std::vector<std::vector<float> >    _levels;        // level 0 is the depth buffer
+    std::vector<math::vec2ui>           _level_sizes;
+
+}; // class occlusion_culler
+
+} // namespace gl
+} // namespace scm
+
+#include <scm/core/utilities/platform_warning_enable.h>
+
+#endif // SCM_GL_UTIL_UTILITIES_OCCLUSION_CULLER_H_INCLUDED
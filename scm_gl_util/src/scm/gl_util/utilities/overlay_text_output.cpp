@@ -7,9 +7,11 @@
 #include <algorithm>
 #include <cassert>
 #include <exception>
+#include <iomanip>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 #include <scm/gl_core/math.h>
 #include <scm/gl_core/render_device.h>
@@ -21,6 +23,7 @@
 #include <scm/gl_util/font/text_renderer.h>
 #include <scm/gl_util/primitives/quad.h>
 #include <scm/gl_util/utilities/geometry_highlight.h>
+#include <scm/gl_util/utilities/profiling_host.h>
 
 namespace scm {
 namespace gl {
@@ -144,6 +147,30 @@ overlay_text_output::update(const gl::render_context_ptr& context,
     _output_text_background->update(context, vec2f(ll), vec2f(ur));
 }
 
+void
+overlay_text_output::update(const gl::render_context_ptr& context,
+                            const profiling_host_cptr&    phost,
+                            time::time_io                 unit)
+{
+    std::stringstream   os;
+    std::vector<std::string> tnames = phost->timer_names();
+
+    std::string::size_type tname_width = 0;
+    for (auto ti = tnames.begin(); ti != tnames.end(); ++ti) {
+        tname_width = (std::max)(tname_width, ti->size());
+    }
+
+    for (auto ti = tnames.begin(); ti != tnames.end(); ++ti) {
+        if (ti != tnames.begin()) {
+            os << std::endl;
+        }
+        os << std::setw(static_cast<int>(tname_width)) << std::left << *ti << " : "
+           << profiling_result(phost, *ti, unit);
+    }
+
+    update(context, os.str());
+}
+
 void
 overlay_text_output::draw(const gl::render_context_ptr& context)
 {
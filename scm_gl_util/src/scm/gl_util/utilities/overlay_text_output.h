@@ -12,6 +12,7 @@
 #include <scm/core/math.h>
 #include <scm/core/numeric_types.h>
 #include <scm/core/memory.h>
+#include <scm/core/time/timer_base.h>
 
 #include <scm/gl_core/data_formats.h>
 #include <scm/gl_core/gl_core_fwd.h>
@@ -50,6 +51,10 @@ public:
                                                const math::vec2i&            out_pos);
     void                                update(const gl::render_context_ptr& context,
                                                const std::string&            text);
+    // one line per timer of the profiling host, including duration statistics when enabled
+    void                                update(const gl::render_context_ptr& context,
+                                               const profiling_host_cptr&    phost,
+                                               time::time_io                 unit = time::time_io(time::time_io::msec));
     void                                draw(const gl::render_context_ptr& context);
 protected:
     math::vec2ui                        _viewport_size;
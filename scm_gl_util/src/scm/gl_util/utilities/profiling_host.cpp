@@ -47,6 +47,7 @@ namespace util {
 
 profiling_host::profiling_host()
   : _enabled(false)
+  , _statistics_enabled(false)
   , _update_interval(0)
 {
 }
@@ -68,6 +69,24 @@ profiling_host::enabled(bool e)
     _enabled = e;
 }
 
+bool
+profiling_host::statistics_enabled() const
+{
+    return _statistics_enabled;
+}
+
+void
+profiling_host::statistics_enabled(bool e)
+{
+    using namespace std;
+
+    _statistics_enabled = e;
+
+    for_each(_timers.begin(), _timers.end(), [e](timer_map::value_type& t) -> void {
+        t.second._timer->statistics_enabled(e);
+    });
+}
+
 void
 profiling_host::cpu_start(const std::string& tname)
 {
@@ -76,6 +95,7 @@ profiling_host::cpu_start(const std::string& tname)
         auto             ti = _timers.find(tname);
         if (ti == _timers.end()) {
             t  = new cpu_accum_timer();
+            t->statistics_enabled(_statistics_enabled);
             _timers.insert(timer_map::value_type(tname, timer_instance(CPU_TIMER, t)));
         }
         else {
@@ -105,6 +125,7 @@ profiling_host::gl_start(const std::string& tname, const render_context_ptr& con
             // EVIL!!!111einseinself
             render_device_ptr d(&(context->parent_device()), null_deleter());
             t = new gl_accum_timer(d);
+            t->statistics_enabled(_statistics_enabled);
             _timers.insert(timer_map::value_type(tname, timer_instance(GL_TIMER, t)));
         }
         else {
@@ -133,6 +154,7 @@ profiling_host::cu_start(const std::string& tname, const cu::cuda_command_stream
         auto            ti = _timers.find(tname);
         if (ti == _timers.end()) {
             t  = new cu_accum_timer();
+            t->statistics_enabled(_statistics_enabled);
             _timers.insert(timer_map::value_type(tname, timer_instance(CU_TIMER, t)));
         }
         else {
@@ -165,6 +187,7 @@ profiling_host::cl_start(const std::string& tname)
         auto            ti = _timers.find(tname);
         if (ti == _timers.end()) {
             t  = new cl_accum_timer();
+            t->statistics_enabled(_statistics_enabled);
             _timers.insert(timer_map::value_type(tname, timer_instance(CL_TIMER, t)));
         }
         else {
@@ -329,6 +352,17 @@ profiling_host::average_time(const std::string& tname) const
     return 0;
 }
 
+time::time_statistics
+profiling_host::statistics(const std::string& tname) const
+{
+    timer_ptr t = find_timer(tname);
+    if (t) {
+        return t->statistics();
+    }
+
+    return time::time_statistics();
+}
+
 std::string
 profiling_host::timer_type_string(timer_type ttype) const
 {
@@ -389,6 +423,19 @@ profiling_host::find_timer(const std::string& tname) const
     }
 }
 
+std::vector<std::string>
+profiling_host::timer_names() const
+{
+    std::vector<std::string> names;
+    names.reserve(_timers.size());
+
+    for (auto ti = _timers.begin(); ti != _timers.end(); ++ti) {
+        names.push_back(ti->first);
+    }
+
+    return names;
+}
+
 scoped_timer::scoped_timer(profiling_host& phost, const std::string& tname)
   : _phost(phost)
   , _tname(tname)
@@ -464,6 +511,12 @@ profiling_result::throughput() const
     return time::time_io::to_throughput_unit(_unit._tp_unit, d, _dsize);
 }
 
+time::time_statistics
+profiling_result::statistics() const
+{
+    return _phost->statistics(_tname);
+}
+
 std::ostream& operator<<(std::ostream& os, const profiling_result& pres)
 {
     std::ostream::sentry const  out_sentry(os);
@@ -493,6 +546,11 @@ std::ostream& operator<<(std::ostream& os, const profiling_result& pres)
                 else {
                     t->detailed_report(os, pres._dsize, pres._unit);
                 }
+
+                if (t->statistics_enabled() && 0 < t->statistics()._count) {
+                    os << ", ";
+                    t->statistics().report(os, pres._unit);
+                }
             }
         }
         else {
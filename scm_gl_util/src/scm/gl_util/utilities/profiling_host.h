@@ -10,6 +10,7 @@
 #include <map>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <scm/config.h>
 #include <scm/core/math.h>
@@ -71,6 +72,10 @@ public:
     bool                    enabled() const;
     void                    enabled(bool e);
 
+    // duration histograms (p50/p95/p99/max) for all current and future timers
+    bool                    statistics_enabled() const;
+    void                    statistics_enabled(bool e);
+
     void                    cpu_start(const std::string& tname);
     void                    gl_start(const std::string& tname, const render_context_ptr& context);
 #if SCM_ENABLE_CUDA_CL_SUPPORT
@@ -94,16 +99,19 @@ public:
     unsigned                accumulation_count(const std::string& tname) const;
 
     nanosec_type            average_time(const std::string& tname) const;
+    time::time_statistics   statistics(const std::string& tname) const;
 
     std::string             timer_prefix_string(const std::string& tname) const;
     std::string             timer_prefix_string(timer_type ttype) const;
     std::string             timer_type_string(timer_type ttype) const;
 
     timer_ptr               find_timer(const std::string& tname) const;
+    std::vector<std::string> timer_names() const;
 protected:
 
 protected:
     bool                    _enabled;
+    bool                    _statistics_enabled;
     timer_map               _timers;
     int                     _update_interval;
 
@@ -142,6 +150,7 @@ struct __scm_export(gl_util) profiling_result
     std::string         throughput_string() const;
     double              time() const;
     double              throughput() const;
+    time::time_statistics statistics() const;
 
     profiling_host_cptr _phost;
     std::string         _tname;
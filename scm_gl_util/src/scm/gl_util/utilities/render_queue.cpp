@@ -0,0 +1,345 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include "render_queue.h"
+
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+#include <scm/gl_core/render_device.h>
+#include <scm/gl_core/render_device/context_guards.h>
+#include <scm/gl_core/shader_objects.h>
+
+namespace {
+
+const unsigned          ordinal_bits   = 12;
+const unsigned          max_ordinal    = (1u << ordinal_bits) - 1;
+const unsigned          depth_bits     = 24;
+const scm::uint32       max_depth_key  = (1u << depth_bits) - 1;
+
+// ordering of non negative floats is preserved by their bit patterns
+inline
+scm::uint32
+depth_key(float d)
+{
+    if (!(d > 0.0f)) {
+        return 0u;
+    }
+    scm::uint32 b;
+    std::memcpy(&b, &d, sizeof(scm::uint32));
+
+    return (b >> (31 - depth_bits)) & max_depth_key;
+}
+
+inline
+bool
+same_index_binding(const scm::gl::render_queue::draw_item& a,
+                   const scm::gl::render_queue::draw_item& b)
+{
+    return    a._index_buffer == b._index_buffer
+           && (!a._index_buffer || (   a._index_type == b._index_type
+                                    && a._topology   == b._topology));
+}
+
+// counts the changes between subsequent draws
+void
+count_change(const scm::gl::render_queue::draw_item* prev,
+             const scm::gl::render_queue::draw_item& cur,
+             scm::gl::render_queue::state_changes&   changes)
+{
+    if (!prev || prev->_pass != cur._pass)                  ++changes._passes;
+    if (!prev || prev->_program != cur._program)            ++changes._programs;
+    if (!prev || prev->_material != cur._material)          ++changes._materials;
+    if (!prev || prev->_vertex_array != cur._vertex_array)  ++changes._vertex_arrays;
+    if (!prev || !same_index_binding(*prev, cur))           ++changes._index_buffers;
+}
+
+} // namespace
+
+namespace scm {
+namespace gl {
+
+render_queue::draw_item::draw_item()
+  : _pass(0)
+  , _depth(0.0f)
+  , _index_type(TYPE_UINT)
+  , _topology(PRIMITIVE_TRIANGLE_LIST)
+  , _first(0)
+  , _count(0)
+  , _base_vertex(0)
+  , _instance_count(1)
+{
+}
+
+render_queue::state_changes::state_changes()
+  : _passes(0)
+  , _programs(0)
+  , _materials(0)
+  , _vertex_arrays(0)
+  , _index_buffers(0)
+{
+}
+
+render_queue::statistics::statistics()
+  : _draws(0)
+{
+}
+
+render_queue::pass_state::pass_state()
+  : _sort_mode(SORT_STATE)
+{
+}
+
+render_queue::render_queue()
+{
+}
+
+render_queue::~render_queue()
+{
+}
+
+void
+render_queue::set_pass_state(unsigned                       in_pass,
+                             const blend_state_ptr&         in_blend_state,
+                             const depth_stencil_state_ptr& in_depth_stencil_state,
+                             const rasterizer_state_ptr&    in_rasterizer_state,
+                             sort_mode                      in_sort_mode)
+{
+    if (in_pass >= max_pass_count) {
+        throw std::runtime_error("render_queue::set_pass_state(): pass index out of range.");
+    }
+    pass_state& p = _pass_states[in_pass];
+
+    p._blend_state          = in_blend_state;
+    p._depth_stencil_state  = in_depth_stencil_state;
+    p._rasterizer_state     = in_rasterizer_state;
+    p._sort_mode            = in_sort_mode;
+}
+
+void
+render_queue::push(const draw_item& in_draw)
+{
+    if (in_draw._pass >= max_pass_count) {
+        throw std::runtime_error("render_queue::push(): pass index out of range.");
+    }
+    assert(in_draw._program);
+
+    _keys.push_back(make_key(in_draw));
+    _draws.push_back(in_draw);
+}
+
+void
+render_queue::clear()
+{
+    _draws.clear();
+    _keys.clear();
+    _program_ordinals.clear();
+    _material_ordinals.clear();
+    _vertex_array_ordinals.clear();
+}
+
+scm::size_t
+render_queue::size() const
+{
+    return _draws.size();
+}
+
+bool
+render_queue::empty() const
+{
+    return _draws.empty();
+}
+
+void
+render_queue::submit(const render_context_ptr& in_context)
+{
+    _statistics = statistics();
+    _statistics._draws = _draws.size();
+
+    if (_draws.empty()) {
+        return;
+    }
+
+    sort();
+    count_unsorted_changes();
+
+    context_program_guard       cpg(in_context);
+    context_vertex_input_guard  cvg(in_context);
+    context_state_objects_guard csg(in_context);
+    context_texture_units_guard ctg(in_context);
+
+    const draw_item* prev = 0;
+    for (scm::size_t i = 0; i < _order.size(); ++i) {
+        const draw_item& d = _draws[_order[i]];
+
+        count_change(prev, d, _statistics._submitted);
+
+        if (!prev || prev->_pass != d._pass) {
+            const pass_state& p = _pass_states[d._pass];
+            if (p._blend_state) {
+                in_context->set_blend_state(p._blend_state);
+            }
+            if (p._depth_stencil_state) {
+                in_context->set_depth_stencil_state(p._depth_stencil_state);
+            }
+            if (p._rasterizer_state) {
+                in_context->set_rasterizer_state(p._rasterizer_state);
+            }
+        }
+
+        const bool program_changed = !prev || prev->_program != d._program;
+        if (program_changed) {
+            in_context->bind_program(d._program);
+        }
+        // uniforms are program state, a program change reapplies the material
+        if (d._material && (program_changed || prev->_material != d._material)) {
+            const material& m = *d._material;
+            for (scm::size_t t = 0; t < m._textures.size(); ++t) {
+                in_context->bind_texture(m._textures[t]._texture, m._textures[t]._sampler_state, m._textures[t]._unit);
+            }
+            if (m._apply_uniforms) {
+                m._apply_uniforms(d._program);
+            }
+        }
+        if (!prev || prev->_vertex_array != d._vertex_array) {
+            in_context->bind_vertex_array(d._vertex_array);
+        }
+        if (d._index_buffer && (!prev || !same_index_binding(*prev, d))) {
+            in_context->bind_index_buffer(d._index_buffer, d._topology, d._index_type);
+        }
+
+        in_context->apply();
+
+        if (d._index_buffer) {
+            if (d._instance_count > 1) {
+                in_context->draw_elements_instanced(d._count, d._first, d._instance_count, d._base_vertex);
+            }
+            else {
+                in_context->draw_elements(d._count, d._first, d._base_vertex);
+            }
+        }
+        else {
+            if (d._instance_count > 1) {
+                in_context->draw_arrays_instanced(d._topology, d._first, d._count, d._instance_count);
+            }
+            else {
+                in_context->draw_arrays(d._topology, d._first, d._count);
+            }
+        }
+        prev = &d;
+    }
+
+    clear();
+}
+
+const render_queue::statistics&
+render_queue::last_statistics() const
+{
+    return _statistics;
+}
+
+unsigned
+render_queue::ordinal(ordinal_map& m, const void* in_object)
+{
+    if (!in_object) {
+        return 0;
+    }
+    std::pair<ordinal_map::iterator, bool> o =
+        m.insert(ordinal_map::value_type(in_object, static_cast<unsigned>(m.size()) + 1));
+
+    return (o.first->second < max_ordinal) ? o.first->second : max_ordinal;
+}
+
+render_queue::sort_key
+render_queue::make_key(const draw_item& in_draw)
+{
+    const sort_key pass  = in_draw._pass;
+    const sort_key prog  = ordinal(_program_ordinals,      in_draw._program.get());
+    const sort_key mat   = ordinal(_material_ordinals,     in_draw._material.get());
+    const sort_key vao   = ordinal(_vertex_array_ordinals, in_draw._vertex_array.get());
+    const sort_key depth = depth_key(in_draw._depth);
+
+    if (_pass_states[in_draw._pass]._sort_mode == SORT_BACK_TO_FRONT) {
+        return   (pass                     << 60)
+               | ((max_depth_key - depth)  << 36)
+               | (prog                     << 24)
+               | (mat                      << 12)
+               |  vao;
+    }
+    else {
+        return   (pass  << 60)
+               | (prog  << 48)
+               | (mat   << 36)
+               | (vao   << 24)
+               |  depth;
+    }
+}
+
+// least significant digit radix sort of the keys with 8 bit digits, digits equal for
+// all keys are skipped
+void
+render_queue::sort()
+{
+    const scm::size_t n = _keys.size();
+
+    _order.resize(n);
+    _sort_keys_temp.resize(n);
+    _sort_order_temp.resize(n);
+    for (scm::size_t i = 0; i < n; ++i) {
+        _order[i] = static_cast<scm::uint32>(i);
+    }
+
+    scm::uint32 histograms[8][256];
+    std::memset(histograms, 0, sizeof(histograms));
+    for (scm::size_t i = 0; i < n; ++i) {
+        const sort_key k = _keys[i];
+        for (unsigned d = 0; d < 8; ++d) {
+            ++histograms[d][(k >> (d * 8)) & 0xff];
+        }
+    }
+
+    sort_key*    keys_in   = &_keys[0];
+    scm::uint32* order_in  = &_order[0];
+    sort_key*    keys_out  = &_sort_keys_temp[0];
+    scm::uint32* order_out = &_sort_order_temp[0];
+
+    for (unsigned d = 0; d < 8; ++d) {
+        scm::uint32* h = histograms[d];
+        if (h[(keys_in[0] >> (d * 8)) & 0xff] == n) {
+            continue;
+        }
+        scm::uint32 offset = 0;
+        for (unsigned b = 0; b < 256; ++b) {
+            const scm::uint32 c = h[b];
+            h[b]    = offset;
+            offset += c;
+        }
+        for (scm::size_t i = 0; i < n; ++i) {
+            const scm::uint32 o = h[(keys_in[i] >> (d * 8)) & 0xff]++;
+            keys_out[o]  = keys_in[i];
+            order_out[o] = order_in[i];
+        }
+        std::swap(keys_in,  keys_out);
+        std::swap(order_in, order_out);
+    }
+
+    if (order_in != &_order[0]) {
+        _order.swap(_sort_order_temp);
+        _keys.swap(_sort_keys_temp);
+    }
+}
+
+void
+render_queue::count_unsorted_changes()
+{
+    const draw_item* prev = 0;
+    for (scm::size_t i = 0; i < _draws.size(); ++i) {
+        count_change(prev, _draws[i], _statistics._unsorted);
+        prev = &_draws[i];
+    }
+}
+
+} // namespace gl
+} // namespace scm
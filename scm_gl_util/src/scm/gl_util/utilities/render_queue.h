@@ -0,0 +1,160 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_GL_UTIL_RENDER_QUEUE_H_INCLUDED
+#define SCM_GL_UTIL_RENDER_QUEUE_H_INCLUDED
+
+#include <vector>
+
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/unordered_map.hpp>
+
+#include <scm/core/memory.h>
+#include <scm/core/numeric_types.h>
+
+#include <scm/gl_core/constants.h>
+#include <scm/gl_core/data_types.h>
+#include <scm/gl_core/gl_core_fwd.h>
+
+#include <scm/gl_util/utilities/utilities_fwd.h>
+
+#include <scm/core/platform/platform.h>
+#include <scm/core/utilities/platform_warning_disable.h>
+
+namespace scm {
+namespace gl {
+
+// per frame queue of draws submitted in sort key order
+//  - every draw is packed into a 64 bit key, most significant first:
+//      pass (4 bit), program (12 bit), material (12 bit), vertex array (12 bit), depth (24 bit)
+//    passes sorted back to front place the depth right after the pass
+//  - programs, materials and vertex arrays get ordinals in order of their first use in
+//    the frame, ordinals beyond the key range share the last value (order only, the
+//    submission still compares the objects themselves)
+//  - keys are radix sorted, submission only changes the state that differs from the
+//    previous draw and counts the changes against the insertion order
+class __scm_export(gl_util) render_queue : boost::noncopyable
+{
+public:
+    typedef scm::uint64     sort_key;
+
+    static const unsigned   max_pass_count = 16;
+
+    typedef enum {
+        SORT_STATE          = 0x00,     // state first, front to back within equal state
+        SORT_BACK_TO_FRONT              // depth first, for blended passes
+    } sort_mode;
+
+    struct texture_binding {
+        texture_ptr         _texture;
+        sampler_state_ptr   _sampler_state;
+        unsigned            _unit;
+    }; // struct texture_binding
+
+    // textures and uniform values shared by draws, compared by identity
+    struct material {
+        std::vector<texture_binding>                _textures;
+        boost::function<void (const program_ptr&)>  _apply_uniforms;
+    }; // struct material
+    typedef shared_ptr<material>        material_ptr;
+    typedef shared_ptr<material const>  material_cptr;
+
+    struct draw_item {
+        draw_item();
+
+        unsigned            _pass;
+        float               _depth;         // view space distance
+        program_ptr         _program;
+        material_cptr       _material;
+        vertex_array_ptr    _vertex_array;
+        buffer_ptr          _index_buffer;  // draws arrays if null
+        data_type           _index_type;
+        primitive_topology  _topology;
+        int                 _first;         // start index or first vertex
+        int                 _count;
+        int                 _base_vertex;
+        int                 _instance_count;
+    }; // struct draw_item
+
+    struct state_changes {
+        state_changes();
+
+        scm::size_t         _passes;
+        scm::size_t         _programs;
+        scm::size_t         _materials;
+        scm::size_t         _vertex_arrays;
+        scm::size_t         _index_buffers;
+    }; // struct state_changes
+
+    struct statistics {
+        statistics();
+
+        scm::size_t         _draws;
+        state_changes       _submitted;     // in sort key order
+        state_changes       _unsorted;      // as they would have been in insertion order
+    }; // struct statistics
+
+public:
+    render_queue();
+    virtual ~render_queue();
+
+    // state applied when the pass is entered, null states keep the context state
+    void                    set_pass_state(unsigned                       in_pass,
+                                           const blend_state_ptr&         in_blend_state,
+                                           const depth_stencil_state_ptr& in_depth_stencil_state = depth_stencil_state_ptr(),
+                                           const rasterizer_state_ptr&    in_rasterizer_state = rasterizer_state_ptr(),
+                                           sort_mode                      in_sort_mode = SORT_STATE);
+
+    void                    push(const draw_item& in_draw);
+    void                    clear();
+
+    scm::size_t             size() const;
+    bool                    empty() const;
+
+    // sorts and draws all queued items, the queue is cleared afterwards
+    void                    submit(const render_context_ptr& in_context);
+
+    const statistics&       last_statistics() const;
+
+protected:
+    struct pass_state {
+        pass_state();
+
+        blend_state_ptr         _blend_state;
+        depth_stencil_state_ptr _depth_stencil_state;
+        rasterizer_state_ptr    _rasterizer_state;
+        sort_mode               _sort_mode;
+    }; // struct pass_state
+
+    typedef boost::unordered_map<const void*, unsigned> ordinal_map;
+
+    static unsigned         ordinal(ordinal_map& m, const void* in_object);
+    sort_key                make_key(const draw_item& in_draw);
+    void                    sort();
+    void                    count_unsorted_changes();
+
+protected:
+    pass_state                  _pass_states[max_pass_count];
+
+    std::vector<draw_item>      _draws;
+    std::vector<sort_key>       _keys;
+    std::vector<scm::uint32>    _order;
+    std::vector<sort_key>       _sort_keys_temp;
+    std::vector<scm::uint32>    _sort_order_temp;
+
+    ordinal_map                 _program_ordinals;
+    ordinal_map                 _material_ordinals;
+    ordinal_map                 _vertex_array_ordinals;
+
+    statistics                  _statistics;
+
+}; // class render_queue
+
+} // namespace gl
+} // namespace scm
+
+#include <scm/core/utilities/platform_warning_enable.h>
+
+#endif // SCM_GL_UTIL_RENDER_QUEUE_H_INCLUDED
@@ -22,6 +22,14 @@ class geometry_highlight;
 typedef shared_ptr<geometry_highlight>              geometry_highlight_ptr;
 typedef shared_ptr<geometry_highlight const>        geometry_highlight_cptr;
 
+class occlusion_culler;
+typedef shared_ptr<occlusion_culler>                occlusion_culler_ptr;
+typedef shared_ptr<occlusion_culler const>          occlusion_culler_cptr;
+
+class render_queue;
+typedef shared_ptr<render_queue>                    render_queue_ptr;
+typedef shared_ptr<render_queue const>              render_queue_cptr;
+
 class texture_output;
 typedef shared_ptr<texture_output>                  texture_output_ptr;
 typedef shared_ptr<texture_output const>            texture_output_cptr;
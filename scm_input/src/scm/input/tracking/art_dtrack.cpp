@@ -7,6 +7,13 @@
 #include <boost/numeric/conversion/cast.hpp>
 
 #include <cassert>
+#include <vector>
+
+#include <scm/core/utilities/boost_warning_disable.h>
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <scm/core/utilities/boost_warning_enable.h>
 
 #include <scm/log.h>
 
@@ -25,12 +32,80 @@ const std::size_t   dtrack_default_udp_bufsize  = 10000;
 namespace scm {
 namespace inp {
 
+struct art_dtrack::receiver
+{
+    struct body_state {
+        std::size_t                     _id;
+        float                           _quality;
+        scm::math::mat4f                _transform;
+    }; // struct body_state
+    struct frame_state {
+        frame_state() : _frame_number(0), _time_stamp(0.0), _time(0.0), _body_count(0) {}
+
+        unsigned long                   _frame_number;
+        double                          _time_stamp;        // dtrack clock, -1 if not sent
+        double                          _time;              // tracker::current_time() base
+        std::size_t                     _body_count;
+        std::vector<body_state>         _bodies;
+    }; // struct frame_state
+
+    static const scm::uint32            fresh_frame = 0x4u; // set on the latest slot until it is read
+
+    receiver(std::size_t max_bodies)
+      : _stop(false),
+        _bodies(max_bodies),
+        _latest(1u),
+        _write_slot(0u),
+        _read_slot(2u),
+        _received_frames(0),
+        _receive_errors(0)
+    {
+        for (int i = 0; i < 3; ++i) {
+            _frames[i]._bodies.resize(max_bodies);
+        }
+    }
+
+    // receiver thread, swaps the written slot with the latest slot
+    void publish()
+    {
+        const scm::uint32 prev = _latest.exchange(_write_slot | fresh_frame, boost::memory_order_acq_rel);
+        _write_slot = prev & 0x3u;
+    }
+    // reading thread, swaps the read slot with the latest slot if it was not read before,
+    // false if no new frame was published since the last call
+    bool acquire()
+    {
+        if (!(_latest.load(boost::memory_order_relaxed) & fresh_frame)) {
+            return (false);
+        }
+        const scm::uint32 prev = _latest.exchange(_read_slot, boost::memory_order_acq_rel);
+        _read_slot = prev & 0x3u;
+
+        return (true);
+    }
+
+    shared_ptr<boost::thread>           _thread;
+    boost::atomic<bool>                 _stop;
+    std::vector<dtrack_body_type>       _bodies;            // receive buffer
+
+    frame_state                         _frames[3];
+    boost::atomic<scm::uint32>          _latest;
+    scm::uint32                         _write_slot;
+    scm::uint32                         _read_slot;
+
+    boost::atomic<std::size_t>          _received_frames;
+    boost::atomic<std::size_t>          _receive_errors;
+}; // struct art_dtrack::receiver
+
 art_dtrack::art_dtrack(std::size_t listening_port,
-                       std::size_t timeout)
+                       std::size_t timeout,
+                       std::size_t max_bodies)
   : tracker(std::string("art_dtrack")),
     _dtrack(new DTrack),
+    _receiver(new receiver(max_bodies)),
     _listening_port(listening_port),
     _timeout(timeout),
+    _max_bodies(max_bodies),
     _initialized(false)
 {
 }
@@ -82,6 +157,9 @@ bool art_dtrack::initialize()
                    << "unable to enable cameras and calculation (error: '" << error_dtrack << "')" << log::end;
     }
 
+    _receiver->_stop.store(false);
+    _receiver->_thread.reset(new boost::thread(boost::bind(&art_dtrack::receive_loop, this)));
+
     _initialized = true;
 
     return (true);
@@ -96,6 +174,11 @@ bool art_dtrack::shutdown()
         return (true);
     }
 
+    // the receiver thread leaves after the current receive call returned
+    _receiver->_stop.store(true);
+    _receiver->_thread->join();
+    _receiver->_thread.reset();
+
     // try to shutdown dtrack device
     int error_dtrack = 0;
     
@@ -116,55 +199,116 @@ bool art_dtrack::shutdown()
 
 void art_dtrack::update(target_container& targets)
 {
-    typedef target_container::value_type    val_type;
+    if (!_initialized || !_receiver->acquire()) {
+        return;
+    }
 
-    int                 error_dtrack        = 0;
-    unsigned long       frame_nr            = 0;
-    double              time_stamp          = 0.;
-    int                 num_cal_bodies      = 0;
-    int                 num_tracked_bodies  = 0;
-    unsigned            max_tracked_bodies  = 0;
-    int                 dummy               = 0;
+    const receiver::frame_state& frame = _receiver->_frames[_receiver->_read_slot];
 
-    boost::scoped_array<dtrack_body_type>   bodies;
+    for (std::size_t i = 0; i < frame._body_count; ++i) {
+        target_container::iterator target_it = targets.find(frame._bodies[i]._id + 1);
 
-    foreach (const val_type& tar, targets) {
-        max_tracked_bodies = scm::math::max(boost::numeric_cast<unsigned>(tar.first), max_tracked_bodies);
+        if (target_it != targets.end()) {
+            target_it->second.transform(frame._bodies[i]._transform, frame._time, frame._frame_number);
+        }
     }
+}
 
-    bodies.reset(new dtrack_body_type[max_tracked_bodies]);
+std::size_t art_dtrack::listening_port() const
+{
+    return (_listening_port);
+}
 
-    // try to receive dtrack packet
-    error_dtrack = _dtrack->receive_udp_ascii(  &frame_nr,              &time_stamp,    &num_cal_bodies,
-                                                &num_tracked_bodies,    bodies.get(),   max_tracked_bodies,
-                                                &dummy,                 0,              0,
-                                                &dummy,                 0,              0,
-                                                &dummy,                 0,              0);
+std::size_t art_dtrack::timeout() const
+{
+    return (_timeout);
+}
 
-    if (error_dtrack != DTRACK_ERR_NONE) {
-        scm::err() << log::warning
-                   << "art_dtrack::update(): "
-                   << "unable to receive dtrack packet (error: '" << error_dtrack << "')" << log::end;
-        return;
-    }
+std::size_t art_dtrack::max_bodies() const
+{
+    return (_max_bodies);
+}
 
-    const unsigned              max_bodies = scm::math::min(max_tracked_bodies, boost::numeric_cast<unsigned>(num_tracked_bodies));
-    target_container::iterator  target_it;
+std::size_t art_dtrack::received_frames() const
+{
+    return (_receiver->_received_frames.load());
+}
+
+std::size_t art_dtrack::receive_errors() const
+{
+    return (_receiver->_receive_errors.load());
+}
+
+void art_dtrack::receive_loop()
+{
+    receiver&           r                   = *_receiver;
+    int                 error_dtrack        = 0;
+    int                 last_error_dtrack   = DTRACK_ERR_NONE;
+    unsigned long       frame_nr            = 0;
+    double              time_stamp          = 0.;
+    int                 num_cal_bodies      = 0;
+    int                 num_tracked_bodies  = 0;
+    int                 dummy               = 0;
+    double              clock_offset        = 0.;
+    bool                clock_offset_valid  = false;
 
     scm::math::mat4f  track_to_opengl(scm::math::mat4f::identity());
     //scm::math::rotate(track_to_opengl, -180.0f, 0.f, 1.f, 0.f);
 
+    while (!r._stop.load()) {
+        // blocks for up to the receive timeout
+        error_dtrack = _dtrack->receive_udp_ascii(  &frame_nr,              &time_stamp,        &num_cal_bodies,
+                                                    &num_tracked_bodies,    r._bodies.empty() ? 0 : &r._bodies[0],
+                                                                            boost::numeric_cast<int>(r._bodies.size()),
+                                                    &dummy,                 0,                  0,
+                                                    &dummy,                 0,                  0,
+                                                    &dummy,                 0,                  0);
+
+        if (error_dtrack != DTRACK_ERR_NONE) {
+            ++r._receive_errors;
+            if (error_dtrack != last_error_dtrack) { // log changes only, not every timeout
+                scm::err() << log::warning
+                           << "art_dtrack::receive_loop(): "
+                           << "unable to receive dtrack packet (error: '" << error_dtrack << "')" << log::end;
+            }
+            last_error_dtrack = error_dtrack;
+            continue;
+        }
+        last_error_dtrack = DTRACK_ERR_NONE;
+
+        receiver::frame_state& frame        = r._frames[r._write_slot];
+        const double           receive_time = tracker::current_time();
+
+        frame._frame_number = frame_nr;
+        frame._time_stamp   = time_stamp;
+
+        // the dtrack time stamps (seconds since midnight on the tracking pc) are mapped to
+        // the local clock by the smallest transfer delay seen, it relaxes slowly to follow
+        // clock drift and is reset on jumps (midnight, restarted tracking pc)
+        if (time_stamp >= 0.0) {
+            const double offset = receive_time - time_stamp;
+            if (!clock_offset_valid || scm::math::abs(offset - clock_offset) > 1.0) {
+                clock_offset        = offset;
+                clock_offset_valid  = true;
+            }
+            else {
+                clock_offset = scm::math::min(clock_offset + 1e-5, offset);
+            }
+            frame._time = time_stamp + clock_offset;
+        }
+        else {
+            frame._time = receive_time;
+        }
+        frame._body_count   = scm::math::min(r._bodies.size(), static_cast<std::size_t>(scm::math::max(0, num_tracked_bodies)));
 
-    for (unsigned i = 0; i < max_bodies; ++i) {
-        target_it = targets.find(bodies[i].id + 1);
-        //console.get() << con::log_level(con::error) << bodies[i].id << std::endl;
+        for (std::size_t i = 0; i < frame._body_count; ++i) {
+            const dtrack_body_type& body = r._bodies[i];
 
-        if (target_it != targets.end()) {
-            scm::math::vec4f    pos   = scm::math::vec4f(bodies[i].loc[0], bodies[i].loc[1],  bodies[i].loc[2], 1.0f);
-            scm::math::mat4f    ori   =scm:: math::mat4f(bodies[i].rot[0], bodies[i].rot[1], bodies[i].rot[2], 0.0f,   // 1st column
-                                                         bodies[i].rot[3], bodies[i].rot[4], bodies[i].rot[5], 0.0f,   // 2nd column
-                                                         bodies[i].rot[6], bodies[i].rot[7], bodies[i].rot[8], 0.0f,   // 3rd column
-                                                         0.0f,             0.0f,             0.0f,             1.0f);  // 4th column
+            scm::math::vec4f    pos   = scm::math::vec4f(body.loc[0], body.loc[1],  body.loc[2], 1.0f);
+            scm::math::mat4f    ori   = scm::math::mat4f(body.rot[0], body.rot[1], body.rot[2], 0.0f,   // 1st column
+                                                         body.rot[3], body.rot[4], body.rot[5], 0.0f,   // 2nd column
+                                                         body.rot[6], body.rot[7], body.rot[8], 0.0f,   // 3rd column
+                                                         0.0f,        0.0f,        0.0f,        1.0f);  // 4th column
 
             pos = track_to_opengl * pos;
             ori = track_to_opengl * ori;
@@ -174,8 +318,13 @@ void art_dtrack::update(target_container& targets)
             ori.m14 = pos.z;
             ori.m15 = pos.w;
 
-            target_it->second.transform(ori);
+            frame._bodies[i]._id        = body.id;
+            frame._bodies[i]._quality   = body.quality;
+            frame._bodies[i]._transform = ori;
         }
+
+        r.publish();
+        ++r._received_frames;
     }
 }
 
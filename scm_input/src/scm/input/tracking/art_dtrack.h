@@ -19,26 +19,42 @@ class DTrack;
 namespace scm {
 namespace inp {
 
+// the packets are received and parsed on a receiver thread started by initialize(), the
+// newest frame is published through a lock-free triple buffer, update() neither blocks
+// nor allocates and applies frames not seen before to the targets, recording their poses
+// with the frame time stamp mapped to tracker::current_time()
 class __scm_export(input) art_dtrack : public tracker
 {
 public:
     art_dtrack(std::size_t /*listening_port*/ = 5000,
-               std::size_t /*timeout*/        = 1000000);
+               std::size_t /*timeout*/        = 1000000,
+               std::size_t /*max_bodies*/     = 32);
     virtual ~art_dtrack();
 
     bool                        initialize();
     void                        update(target_container& /*targets*/);
+    // waits for the receiver thread, up to the receive timeout
     bool                        shutdown();
 
     std::size_t                  listening_port() const;
     std::size_t                  timeout() const;
+    std::size_t                  max_bodies() const;
+
+    // statistics of the receiver thread
+    std::size_t                  received_frames() const;
+    std::size_t                  receive_errors() const;
 
 protected:
+    struct receiver;    // receiver thread, receive buffers and published frames
+
+    void                        receive_loop();
 
 private:
     const boost::scoped_ptr<DTrack> _dtrack;
+    boost::scoped_ptr<receiver>     _receiver;
     std::size_t                     _listening_port;
     std::size_t                     _timeout;
+    std::size_t                     _max_bodies;
 
     bool                            _initialized;
 
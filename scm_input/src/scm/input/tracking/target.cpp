@@ -5,14 +5,63 @@
 #include "target.h"
 
 #include <algorithm>
+#include <cassert>
+
+namespace {
+
+const double max_prediction_time = 0.1; // seconds past the newest pose
+
+scm::math::vec4f
+quat_components(const scm::math::quatf& q)
+{
+    return (scm::math::vec4f(q.x, q.y, q.z, q.w));
+}
+
+scm::math::quatf
+components_quat(const scm::math::vec4f& c)
+{
+    return (scm::math::normalize(scm::math::quatf(c.w, c.x, c.y, c.z)));
+}
+
+// u outside [0, 1] extrapolates
+scm::inp::target::pose
+interpolate(const scm::inp::target::pose& a,
+            const scm::inp::target::pose& b,
+            float                         u)
+{
+    scm::inp::target::pose p;
+
+    p._frame_number = b._frame_number;
+    p._position     = a._position + (b._position - a._position) * u;
+    p._orientation  = scm::math::slerp(a._orientation, b._orientation, u);
+
+    return (p);
+}
+
+} // namespace
 
 namespace scm {
 namespace inp {
 
-target::target(std::size_t id)
+target::pose::pose()
+  : _time(0.0),
+    _frame_number(0),
+    _position(scm::math::vec3f(0.0f)),
+    _orientation(scm::math::quatf::identity())
+{
+}
+
+target::target(std::size_t id,
+               std::size_t history_size)
   : _id(id),
-    _transform(scm::math::mat4f::identity())
+    _transform(scm::math::mat4f::identity()),
+    _history(history_size),
+    _history_newest(0),
+    _history_count(0),
+    _smoothing(0.5f)
 {
+    std::fill(_smoothed_position,    _smoothed_position + 2,    scm::math::vec3f(0.0f));
+    std::fill(_smoothed_orientation, _smoothed_orientation + 2, quat_components(scm::math::quatf::identity()));
 }
 
 target::~target()
@@ -21,14 +70,27 @@ target::~target()
 
 target::target(const target& ref)
   : _id(ref._id),
-    _transform(ref._transform)
+    _transform(ref._transform),
+    _history(ref._history),
+    _history_newest(ref._history_newest),
+    _history_count(ref._history_count),
+    _smoothing(ref._smoothing)
 {
+    std::copy(ref._smoothed_position,    ref._smoothed_position + 2,    _smoothed_position);
+    std::copy(ref._smoothed_orientation, ref._smoothed_orientation + 2, _smoothed_orientation);
 }
 
 const target& target::operator=(const target& rhs)
 {
-    _id         = rhs._id;
-    _transform  = rhs._transform;
+    _id             = rhs._id;
+    _transform      = rhs._transform;
+    _history        = rhs._history;
+    _history_newest = rhs._history_newest;
+    _history_count  = rhs._history_count;
+    _smoothing      = rhs._smoothing;
+
+    std::copy(rhs._smoothed_position,    rhs._smoothed_position + 2,    _smoothed_position);
+    std::copy(rhs._smoothed_orientation, rhs._smoothed_orientation + 2, _smoothed_orientation);
 
     return (*this);
 }
@@ -37,6 +99,12 @@ void target::swap(target& ref)
 {
     std::swap(_id, ref._id);
     std::swap(_transform, ref._transform);
+    std::swap(_history, ref._history);
+    std::swap(_history_newest, ref._history_newest);
+    std::swap(_history_count, ref._history_count);
+    std::swap(_smoothing, ref._smoothing);
+    std::swap_ranges(_smoothed_position,    _smoothed_position + 2,    ref._smoothed_position);
+    std::swap_ranges(_smoothed_orientation, _smoothed_orientation + 2, ref._smoothed_orientation);
 }
 
 std::size_t target::id() const
@@ -54,5 +122,172 @@ void target::transform(const scm::math::mat4f& trans)
     _transform  = trans;
 }
 
+void target::transform(const scm::math::mat4f& trans,
+                       double                  time,
+                       std::size_t             frame_number)
+{
+    using namespace scm::math;
+
+    _transform  = trans;
+
+    if (   _history.empty()
+        || (_history_count > 0 && time <= recorded_pose(0)._time)) {
+        return;
+    }
+
+    pose p;
+    p._time         = time;
+    p._frame_number = frame_number;
+    p._position     = vec3f(trans.m12, trans.m13, trans.m14);
+    p._orientation  = normalize(quatf::from_matrix(trans));
+
+    // consecutive orientations in the same hemisphere, interpolation and smoothing
+    // take the short way then
+    if (_history_count > 0 && dot(quat_components(p._orientation), quat_components(recorded_pose(0)._orientation)) < 0.0f) {
+        p._orientation = quatf(-p._orientation.w, -p._orientation.x, -p._orientation.y, -p._orientation.z);
+    }
+
+    _history_newest = (_history_newest + 1) % _history.size();
+    _history_count  = (std::min)(_history_count + 1, _history.size());
+    _history[_history_newest] = p;
+
+    const vec4f q = quat_components(p._orientation);
+    if (_history_count == 1) {
+        _smoothed_position[0]    = _smoothed_position[1]    = p._position;
+        _smoothed_orientation[0] = _smoothed_orientation[1] = q;
+    }
+    else {
+        const float a = _smoothing;
+        _smoothed_position[0]    = a * p._position           + (1.0f - a) * _smoothed_position[0];
+        _smoothed_position[1]    = a * _smoothed_position[0] + (1.0f - a) * _smoothed_position[1];
+        _smoothed_orientation[0] = a * q                        + (1.0f - a) * _smoothed_orientation[0];
+        _smoothed_orientation[1] = a * _smoothed_orientation[0] + (1.0f - a) * _smoothed_orientation[1];
+    }
+}
+
+std::size_t target::history_size() const
+{
+    return (_history.size());
+}
+
+std::size_t target::pose_count() const
+{
+    return (_history_count);
+}
+
+const target::pose& target::recorded_pose(std::size_t i) const
+{
+    assert(i < _history_count);
+
+    return (_history[(_history_newest + _history.size() - i) % _history.size()]);
+}
+
+void target::clear_history()
+{
+    _history_newest = 0;
+    _history_count  = 0;
+}
+
+target::pose target::pose_at(double          time,
+                             prediction_type pred) const
+{
+    if (_history_count == 0) {
+        pose p;
+        p._time         = time;
+        p._position     = scm::math::vec3f(_transform.m12, _transform.m13, _transform.m14);
+        p._orientation  = scm::math::normalize(scm::math::quatf::from_matrix(_transform));
+        return (p);
+    }
+
+    if (time > recorded_pose(0)._time) {
+        return (pred == prediction_double_exponential ? predict_double_exponential(time)
+                                                      : predict_constant_velocity(time));
+    }
+
+    // newest to oldest, the bracketing poses are interpolated
+    for (std::size_t i = 1; i < _history_count; ++i) {
+        const pose& older = recorded_pose(i);
+        const pose& newer = recorded_pose(i - 1);
+
+        if (time >= older._time) {
+            pose p  = interpolate(older, newer, static_cast<float>((time - older._time) / (newer._time - older._time)));
+            p._time = time;
+            return (p);
+        }
+    }
+
+    pose p  = recorded_pose(_history_count - 1);
+    p._time = time;
+
+    return (p);
+}
+
+scm::math::mat4f target::transform_at(double          time,
+                                      prediction_type pred) const
+{
+    const pose       p = pose_at(time, pred);
+    scm::math::mat4f m = p._orientation.to_matrix();
+
+    m.m12 = p._position.x;
+    m.m13 = p._position.y;
+    m.m14 = p._position.z;
+
+    return (m);
+}
+
+float target::smoothing() const
+{
+    return (_smoothing);
+}
+
+void target::smoothing(float a)
+{
+    _smoothing = scm::math::clamp(a, 0.01f, 0.99f);
+}
+
+target::pose target::predict_constant_velocity(double time) const
+{
+    const pose&  newer = recorded_pose(0);
+    const double t     = (std::min)(time, newer._time + max_prediction_time);
+
+    if (_history_count < 2) {
+        pose p  = newer;
+        p._time = time;
+        return (p);
+    }
+
+    const pose& older = recorded_pose(1);
+    pose        p     = interpolate(older, newer, static_cast<float>(1.0 + (t - newer._time) / (newer._time - older._time)));
+
+    p._time = time;
+
+    return (p);
+}
+
+target::pose target::predict_double_exponential(double time) const
+{
+    using namespace scm::math;
+
+    const pose&  newest = recorded_pose(0);
+    const double t      = (std::min)(time, newest._time + max_prediction_time);
+
+    pose p  = newest;
+    p._time = time;
+
+    if (_history_count < 2) {
+        return (p);
+    }
+
+    // prediction tau sampling intervals ahead (LaViola, double exponential smoothing-based prediction)
+    const double interval = (newest._time - recorded_pose(_history_count - 1)._time) / (_history_count - 1);
+    const float  tau      = static_cast<float>((t - newest._time) / interval);
+    const float  k        = _smoothing * tau / (1.0f - _smoothing);
+
+    p._position    = (2.0f + k) * _smoothed_position[0] - (1.0f + k) * _smoothed_position[1];
+    p._orientation = components_quat((2.0f + k) * _smoothed_orientation[0] - (1.0f + k) * _smoothed_orientation[1]);
+
+    return (p);
+}
+
 } // namespace inp
 } // namespace scm
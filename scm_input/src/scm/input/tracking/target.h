@@ -6,6 +6,7 @@
 #define SCM_INPUT_TARGET_H_INCLUDED
 
 #include <cstddef>
+#include <vector>
 
 #include <scm/core/math/math.h>
 
@@ -15,10 +16,33 @@
 namespace scm {
 namespace inp {
 
+// keeps a fixed size ring of timestamped poses next to the latest transform
+//  - pose queries interpolate between the recorded poses and extrapolate past the newest
+//    one to compensate the tracking and display latency, extrapolation is limited to
+//    100ms, later times return the 100ms prediction
+//  - times are in seconds in the time base of tracker::current_time()
 class __scm_export(input) target
 {
 public:
-    target(std::size_t /*id*/);
+    struct pose {
+        pose();
+
+        double                  _time;
+        std::size_t             _frame_number;
+        scm::math::vec3f        _position;
+        scm::math::quatf        _orientation;
+    }; // struct pose
+
+    typedef enum {
+        prediction_constant_velocity = 0x00,    // from the two newest poses
+        prediction_double_exponential           // double exponential smoothing of all recorded poses
+    } prediction_type;
+
+    static const std::size_t    default_history_size = 16;
+
+public:
+    target(std::size_t /*id*/,
+           std::size_t /*history_size*/ = default_history_size);
     target(const target& /*ref*/);
     virtual ~target();
 
@@ -27,12 +51,44 @@ public:
 
     std::size_t                 id() const;
     const scm::math::mat4f&     transform() const;
-    void                        transform(const scm::math::mat4f& /*trans*/);
+    void                        transform(const scm::math::mat4f& /*trans*/);   // not recorded
+    // sets the transform and records the pose, poses not newer than the newest recorded
+    // pose are ignored, the transform is expected to be rigid
+    void                        transform(const scm::math::mat4f& /*trans*/,
+                                          double                  /*time*/,
+                                          std::size_t             /*frame_number*/ = 0);
+
+    std::size_t                 history_size() const;
+    std::size_t                 pose_count() const;
+    const pose&                 recorded_pose(std::size_t /*i*/) const;  // 0 is the newest pose
+    void                        clear_history();
+
+    pose                        pose_at(double          /*time*/,
+                                        prediction_type /*pred*/ = prediction_constant_velocity) const;
+    scm::math::mat4f            transform_at(double          /*time*/,
+                                             prediction_type /*pred*/ = prediction_constant_velocity) const;
+
+    // double exponential smoothing factor in (0, 1), larger values follow the poses closer
+    float                       smoothing() const;
+    void                        smoothing(float /*a*/);
+
+protected:
+    pose                        predict_constant_velocity(double /*time*/) const;
+    pose                        predict_double_exponential(double /*time*/) const;
 
 protected:
     std::size_t                 _id;
     scm::math::mat4f            _transform;
 
+    std::vector<pose>           _history;               // ring, allocated once
+    std::size_t                 _history_newest;
+    std::size_t                 _history_count;
+
+    // double exponential smoothing state, updated by every recorded pose
+    float                       _smoothing;
+    scm::math::vec3f            _smoothed_position[2];
+    scm::math::vec4f            _smoothed_orientation[2];  // quaternion components
+
 private:
 
 }; // class target
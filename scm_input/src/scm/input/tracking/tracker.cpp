@@ -4,6 +4,8 @@
 
 #include "tracker.h"
 
+#include <boost/chrono.hpp>
+
 #include <scm/input/tracking/target.h>
 
 namespace scm {
@@ -23,5 +25,12 @@ const std::string& tracker::name() const
     return (_name);
 }
 
+double tracker::current_time()
+{
+    using namespace boost::chrono;
+
+    return (duration_cast<duration<double> >(steady_clock::now().time_since_epoch()).count());
+}
+
 } // namespace inp
 } // namespace scm
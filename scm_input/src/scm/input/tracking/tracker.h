@@ -34,6 +34,10 @@ public:
 
     const std::string&  name() const;
 
+    // seconds of a monotonic clock (arbitrary origin, unaffected by system clock changes),
+    // the time base of the recorded target poses
+    static double       current_time();
+
 protected:
 
 private: